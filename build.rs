@@ -0,0 +1,39 @@
+//! Build script: PyO3's interpreter cfgs (`Py_GIL_DISABLED` on free-threaded CPython) and
+//! the resolved PyO3 version, both reported by `build_info()`.
+
+use std::path::PathBuf;
+
+/// Version of `name` in the resolved lock file, if there is one.
+fn locked_version(lock: &str, name: &str) -> Option<String> {
+    let mut lines = lock.lines().map(str::trim);
+    let want = format!("name = \"{}\"", name);
+    while let Some(line) = lines.next() {
+        if line == want {
+            let version = lines.next()?.strip_prefix("version = \"")?.strip_suffix('"')?;
+            return Some(version.to_string());
+        }
+    }
+    None
+}
+
+/// Requirement of `name` in `[dependencies]` (fallback when no lock file is around).
+fn required_version(manifest: &str, name: &str) -> Option<String> {
+    let line = manifest.lines().find(|l| l.split('=').next().map(str::trim) == Some(name))?;
+    let v = line.split('"').nth(1)?;
+    Some(v.to_string())
+}
+
+fn main() {
+    pyo3_build_config::use_pyo3_cfgs();
+    println!("cargo:rustc-check-cfg=cfg(Py_GIL_DISABLED)");
+
+    let dir = PathBuf::from(std::env::var("CARGO_MANIFEST_DIR").unwrap());
+    println!("cargo:rerun-if-changed=Cargo.lock");
+    println!("cargo:rerun-if-changed=Cargo.toml");
+    let version = std::fs::read_to_string(dir.join("Cargo.lock")).ok()
+        .and_then(|lock| locked_version(&lock, "pyo3"))
+        .or_else(|| std::fs::read_to_string(dir.join("Cargo.toml")).ok()
+            .and_then(|manifest| required_version(&manifest, "pyo3")))
+        .unwrap_or_else(|| "unknown".to_string());
+    println!("cargo:rustc-env=VF_PYO3_VERSION={}", version);
+}
@@ -0,0 +1,57 @@
+"""
+Shared plumbing for the bench_*.py tools: extension import, wall-clock timing and the JSON
+report (written to `--json` when given, always printed).
+"""
+from __future__ import annotations
+import json, os, statistics, time
+
+
+def load_extension():
+    """The compiled `_vulkan_forge` module, or exit with the import error."""
+    try:
+        import _vulkan_forge as vf
+    except Exception:
+        try:
+            import vulkan_forge._vulkan_forge as vf
+        except Exception as e:
+            raise SystemExit(f"Failed to import compiled extension '_vulkan_forge': {e}")
+    return vf
+
+
+class stopwatch:
+    """`with stopwatch() as sw: ...`, then `sw.s` (seconds) or `sw.ms` (milliseconds)."""
+
+    def __enter__(self):
+        self.s = self.ms = 0.0
+        self._t0 = time.perf_counter()
+        return self
+
+    def __exit__(self, *exc):
+        self.s = time.perf_counter() - self._t0
+        self.ms = self.s * 1e3
+        return False
+
+
+def sample_ms(fn, runs: int, warmup: int = 0) -> list[float]:
+    """Milliseconds of `runs` calls of `fn()`, after `warmup` untimed calls."""
+    for _ in range(warmup):
+        fn()
+    out = []
+    for _ in range(runs):
+        with stopwatch() as sw:
+            fn()
+        out.append(sw.ms)
+    return out
+
+
+def median_ms(fn, runs: int, warmup: int = 0) -> float:
+    return statistics.median(sample_ms(fn, runs, warmup))
+
+
+def write_report(rep: dict, path: str = "") -> None:
+    """Write `rep` to `path` (parent directories created) when given, and print it."""
+    if path:
+        os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+        with open(path, "w", encoding="utf-8") as f:
+            json.dump(rep, f, indent=2)
+    print(json.dumps(rep, indent=2))
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""
+Frame budget benchmark: how well `render_budgeted` holds a target frame time.
+
+For each target a Scene orbits the terrain for `--frames` budgeted frames and reports the
+share of frames over target, median and p95 frame time, the number of quality changes and
+the level the controller spent most frames on, next to the median `render_rgba` time.
+
+Usage:
+  python python/tools/bench_budget.py --size 1280x720 --grid 512 --targets 4,8,16 --json out/budget.json
+"""
+from __future__ import annotations
+import argparse, collections, math, statistics
+from _bench import load_extension, sample_ms, write_report
+
+vf = load_extension()
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--size", default="1280x720")
+    ap.add_argument("--grid", type=int, default=512)
+    ap.add_argument("--dem", type=int, default=1024)
+    ap.add_argument("--targets", default="4,8,16")
+    ap.add_argument("--max-aa", type=int, default=2)
+    ap.add_argument("--frames", type=int, default=240)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    w, h = (int(v) for v in args.size.split("x"))
+    scn = vf.Scene(w, h, grid=args.grid, colormap="terrain")
+    scn.generate_height(args.dem, args.dem, kind="fbm", seed=4)
+    orbit = [((3 * math.cos(a), 2.0, 3 * math.sin(a)), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+             for a in (2 * math.pi * i / args.frames for i in range(args.frames))]
+    scn.set_camera_look_at(*orbit[0])
+    full = sample_ms(scn.render_rgba, 32, warmup=1)
+
+    rows = []
+    for target in (float(t) for t in args.targets.split(",")):
+        ladder = scn.set_frame_budget(target, max_aa=args.max_aa)
+        frames = []
+        for cam in orbit:
+            scn.set_camera_look_at(*cam)
+            frames.append(scn.render_budgeted())
+        ms = sorted(f["timings"]["total_ms"] for f in frames)
+        levels = [f["quality"]["level"] for f in frames]
+        mode = collections.Counter(levels).most_common(1)[0][0]
+        gpu = [f["timings"]["gpu_terrain_ms"] for f in frames if f["timings"]["gpu_terrain_ms"] is not None]
+        rows.append({"target_ms": target, "levels": len(ladder), "over_budget": sum(m > target for m in ms) / len(ms),
+                     "median_ms": statistics.median(ms), "p95_ms": ms[int(0.95 * (len(ms) - 1))],
+                     "level_changes": sum(a != b for a, b in zip(levels, levels[1:])),
+                     "settled_level": ladder[mode], "gpu_terrain_ms": statistics.median(gpu) if gpu else None})
+    scn.set_frame_budget(None)
+
+    rep = {"size": [w, h], "grid": args.grid, "frames": args.frames,
+           "render_rgba_ms": statistics.median(full), "runs": rows}
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""
+N-client benchmark: one Scene per process vs one shared render daemon.
+
+"local" starts N processes that each create their own Scene (device + pipelines + DEM
+upload) and render F frames. "daemon" starts one render daemon and N processes that use
+`RemoteScene` for the same work. Reports wall time, per-client setup and per-frame
+latency, frames/s and the daemon's batching counters.
+
+Usage:
+  python python/tools/bench_daemon.py --clients 8 --frames 32 --json out/daemon.json
+"""
+from __future__ import annotations
+import argparse, math, multiprocessing as mp, os, statistics, tempfile
+from _bench import stopwatch, write_report
+
+import numpy as np
+
+
+def orbit(i: int, n: int) -> tuple:
+    a = 2.0 * math.pi * i / max(1, n)
+    return (3.0 * math.cos(a), 2.0, 3.0 * math.sin(a)), (0.0, 0.0, 0.0), (0.0, 1.0, 0.0)
+
+
+def client(mode: str, args: dict, socket_path: str, seed: int, out: "mp.Queue") -> None:
+    with stopwatch() as setup:
+        if mode == "local":
+            from vulkan_forge import _ext
+            scn = _ext.Scene(args["width"], args["height"], grid=args["grid"], colormap="viridis")
+        else:
+            from vulkan_forge.daemon import RemoteScene
+            scn = RemoteScene(args["width"], args["height"], grid=args["grid"], colormap="viridis", socket_path=socket_path)
+        scn.set_height_from_r32f(np.load(args["dem"]))
+    frame_ms = []
+    for i in range(args["frames"]):
+        eye, target, up = orbit(i + seed, args["frames"])
+        scn.set_camera_look_at(eye, target, up, 45.0, 0.1, 100.0)
+        with stopwatch() as sw:
+            scn.render_rgba()
+        frame_ms.append(sw.ms)
+    out.put({"setup_ms": setup.ms, "frame_ms": statistics.median(frame_ms)})
+
+
+def run(mode: str, args: dict, socket_path: str) -> dict:
+    ctx = mp.get_context("spawn")
+    q = ctx.Queue()
+    with stopwatch() as sw:
+        procs = [ctx.Process(target=client, args=(mode, args, socket_path, k, q)) for k in range(args["clients"])]
+        for p in procs:
+            p.start()
+        results = [q.get() for _ in procs]
+        for p in procs:
+            p.join()
+    wall = sw.s
+    frames = args["clients"] * args["frames"]
+    return {"wall_s": wall, "fps": frames / wall,
+            "setup_ms_median": statistics.median(r["setup_ms"] for r in results),
+            "frame_ms_median": statistics.median(r["frame_ms"] for r in results)}
+
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--clients", type=int, default=8)
+    ap.add_argument("--frames", type=int, default=32)
+    ap.add_argument("--width", type=int, default=512)
+    ap.add_argument("--height", type=int, default=512)
+    ap.add_argument("--grid", type=int, default=256)
+    ap.add_argument("--batch-window-ms", type=float, default=2.0)
+    ap.add_argument("--json", default="")
+    a = ap.parse_args(argv)
+
+    from vulkan_forge.daemon import RenderDaemon
+
+    tmp = tempfile.mkdtemp(prefix="vf-bench-daemon-")
+    dem = os.path.join(tmp, "dem.npy")
+    yy, xx = np.mgrid[0:512, 0:512].astype(np.float32) / 512.0
+    np.save(dem, (0.5 + 0.25 * np.sin(6.0 * xx) * np.cos(4.0 * yy)).astype(np.float32))
+    args = {"clients": a.clients, "frames": a.frames, "width": a.width, "height": a.height,
+            "grid": a.grid, "dem": dem}
+    socket_path = os.path.join(tmp, "vf.sock")
+
+    rep = {"clients": a.clients, "frames": a.frames, "width": a.width, "height": a.height,
+           "local": run("local", args, socket_path)}
+    with RenderDaemon(socket_path, batch_window_ms=a.batch_window_ms) as daemon:
+        rep["daemon"] = run("daemon", args, socket_path)
+        rep["daemon_stats"] = daemon.stats()
+    rep["speedup"] = rep["local"]["wall_s"] / rep["daemon"]["wall_s"]
+
+    write_report(rep, a.json)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Dataset render benchmark: Scene.render_dataset (one MRT pass) vs separate passes.
+
+"Separate" is today's pipeline: a colour render per view (render_views_rgba) plus a CPU
+reprojection of the DEM grid (point splat into a z-buffer) for depth, normals and class
+labels. Both produce the same four fields per frame; reports frames/s for each.
+
+Usage:
+  python python/tools/bench_dataset.py --frames 64 --width 512 --height 512 --json out/dataset.json
+"""
+from __future__ import annotations
+import argparse, math
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+import numpy as np
+
+SCALE = 1.5  # Scene grid spans [-SCALE, SCALE] in x/z
+
+def orbit_views(n: int) -> np.ndarray:
+    mats = [vf.camera_look_at((3.0 * math.cos(2 * math.pi * i / n), 2.0, 3.0 * math.sin(2 * math.pi * i / n)),
+                              (0.0, 0.0, 0.0), (0.0, 1.0, 0.0)) for i in range(n)]
+    return np.ascontiguousarray(np.stack(mats), dtype=np.float32)
+
+def make_inputs(grid: int):
+    yy, xx = np.mgrid[0:grid, 0:grid].astype(np.float32) / grid
+    dem = np.ascontiguousarray(0.2 * np.sin(6.0 * xx) * np.cos(4.0 * yy), dtype=np.float32)
+    classes = np.ascontiguousarray((xx * 4).astype(np.uint8) + 4 * (yy * 2).astype(np.uint8))
+    return dem, classes
+
+def cpu_aux(view, proj, dem, classes, width, height):
+    """Depth / view normal / class by splatting every DEM texel (the CPU reprojection path)."""
+    g = dem.shape[0]
+    u = np.linspace(0.0, 1.0, g, dtype=np.float32)
+    x, z = np.meshgrid(-SCALE + 2 * SCALE * u, -SCALE + 2 * SCALE * u)
+    y = dem + np.sin(x * 1.3) * 0.25 + np.cos(z * 1.1) * 0.25  # + ANALYTIC_FALLBACK, as the shader
+    world = np.stack([x, y, z, np.ones_like(x)], axis=-1).reshape(-1, 4).astype(np.float32)
+    vpos = world @ view.T
+    clip = vpos @ proj.T
+    w = clip[:, 3]
+    ok = w > 1e-6
+    px = ((clip[:, 0] / w * 0.5 + 0.5) * width).astype(np.int64)
+    py = ((0.5 - clip[:, 1] / w * 0.5) * height).astype(np.int64)
+    ok &= (px >= 0) & (px < width) & (py >= 0) & (py < height)
+    idx = (py * width + px)[ok]
+    depth_v = w[ok]
+    order = np.lexsort((depth_v, idx))  # nearest first per pixel
+    idx_s, first = np.unique(idx[order], return_index=True)
+    win = np.flatnonzero(ok)[order[first]]
+    gy, gx = np.gradient(y)
+    n = np.stack([-gx, np.ones_like(gx) * (2 * SCALE / g), -gy], axis=-1).reshape(-1, 3)
+    n /= np.linalg.norm(n, axis=1, keepdims=True)
+    nv = n[win] @ view[:3, :3].T
+    depth = np.zeros(height * width, np.float32)
+    normal = np.zeros((height * width, 2), np.float16)
+    cls = np.full(height * width, 255, np.uint8)
+    depth[idx_s] = w[win]
+    normal[idx_s] = nv[:, :2]
+    cls[idx_s] = classes.reshape(-1)[win]
+    return depth.reshape(height, width), normal.reshape(height, width, 2), cls.reshape(height, width)
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--width", type=int, default=512)
+    ap.add_argument("--height", type=int, default=512)
+    ap.add_argument("--grid", type=int, default=256)
+    ap.add_argument("--frames", type=int, default=64)
+    ap.add_argument("--chunk", type=int, default=8)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    scene = vf.Scene(args.width, args.height, grid=args.grid, colormap="viridis")
+    dem, classes = make_inputs(args.grid)
+    scene.set_height_from_r32f(dem)
+    scene.set_class_raster(classes)
+    scene.set_camera_look_at((3, 2, 3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    proj = np.asarray(vf.camera_perspective(45.0, args.width / args.height, 0.1, 100.0), dtype=np.float32)
+    views = orbit_views(args.frames)
+    scene.render_dataset(views[:2])  # warm-up (compiles the DATASET permutation)
+
+    with stopwatch() as mrt:
+        batch = scene.render_dataset(views, chunk=args.chunk)
+    with stopwatch() as colour:
+        rgba = scene.render_views_rgba(views)
+    with stopwatch() as cpu:
+        for v in views:
+            cpu_aux(v, proj, dem, classes, args.width, args.height)
+    mrt_s, colour_s, cpu_s = mrt.s, colour.s, cpu.s
+
+    covered = float(np.mean(batch["class"] != 255))
+    rep = {"width": args.width, "height": args.height, "grid": args.grid, "frames": args.frames,
+           "chunk": args.chunk, "record_bytes": batch.dtype.itemsize,
+           "mrt_s": mrt_s, "separate_s": colour_s + cpu_s, "colour_s": colour_s, "cpu_reproject_s": cpu_s,
+           "mrt_fps": args.frames / mrt_s, "separate_fps": args.frames / (colour_s + cpu_s),
+           "speedup": (colour_s + cpu_s) / mrt_s, "coverage": covered, "colour_shape": list(rgba.shape)}
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+DEM differencing benchmark: NumPy difference + statistics + upload vs Scene.set_diff/diff_stats.
+
+NumPy path: d = a - b, numpy.histogram, cut/fill sums, then set_height_from_r32f(d) and a
+render. GPU path: set_diff(a, b) (both epochs uploaded once), diff_stats() (compute
+reduction) and a render; then one epoch is patched with update_epoch and both paths repeat.
+
+Usage:
+  python python/tools/bench_diff.py --dem 2048 --bins 64 --json out/diff.json
+"""
+from __future__ import annotations
+import argparse
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+import numpy as np
+
+def make_epochs(n: int):
+    yy, xx = np.mgrid[0:n, 0:n].astype(np.float32) / n
+    a = np.ascontiguousarray(0.3 * np.sin(6.0 * xx) * np.cos(4.0 * yy), dtype=np.float32)
+    b = np.ascontiguousarray(a + 0.02 * np.sin(40.0 * xx + 13.0 * yy), dtype=np.float32)
+    return a, b
+
+def numpy_path(scene, a, b, bins):
+    d = a - b
+    hist, _ = np.histogram(d, bins=bins)
+    fill, cut = float(d[d > 0].sum()), float(-d[d < 0].sum())
+    scene.set_height_from_r32f(d)
+    scene.render_rgba()
+    return hist, fill, cut
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--width", type=int, default=512)
+    ap.add_argument("--height", type=int, default=512)
+    ap.add_argument("--dem", type=int, default=2048)
+    ap.add_argument("--bins", type=int, default=64)
+    ap.add_argument("--patch", type=int, default=128, help="side of the update_epoch window")
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    scene = vf.Scene(args.width, args.height, grid=256, colormap="viridis")
+    scene.set_camera_look_at((3, 2, 3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    a, b = make_epochs(args.dem)
+    patch = np.full((args.patch, args.patch), 0.1, np.float32)
+    numpy_path(scene, a[:64, :64].copy(), b[:64, :64].copy(), args.bins)  # warm-up
+
+    with stopwatch() as sw:
+        hist_np, fill_np, cut_np = numpy_path(scene, a, b, args.bins)
+    numpy_s = sw.s
+
+    with stopwatch() as sw:
+        scene.set_diff(a, b)
+        stats = scene.diff_stats(bins=args.bins)
+        scene.render_rgba()
+    gpu_s = sw.s
+
+    b[:args.patch, :args.patch] = patch
+    with stopwatch() as sw:
+        numpy_path(scene, a, b, args.bins)
+    numpy_update_s = sw.s
+    with stopwatch() as sw:
+        scene.update_epoch("b", patch)
+        scene.diff_stats(bins=args.bins)
+        scene.render_rgba()
+    gpu_update_s = sw.s
+
+    rep = {"width": args.width, "height": args.height, "dem": args.dem, "bins": args.bins, "patch": args.patch,
+           "numpy_s": numpy_s, "gpu_s": gpu_s, "speedup": numpy_s / gpu_s,
+           "numpy_update_s": numpy_update_s, "gpu_update_s": gpu_update_s, "update_speedup": numpy_update_s / gpu_update_s,
+           "fill_rel_err": abs(stats["fill_volume"] - fill_np) / max(fill_np, 1e-12),
+           "cut_rel_err": abs(stats["cut_volume"] - cut_np) / max(cut_np, 1e-12),
+           "hist_mismatch": int(np.abs(stats["hist"].astype(np.int64) - hist_np).sum())}
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""
+Erosion benchmark: Scene.erode throughput by grid size and batch size.
+
+For each DEM size the terrain is generated on the GPU and eroded for `--iterations`
+iterations at each `--batch` size (one submission per batch, terrain stored after each).
+Reports iterations per second and Mcell-iterations per second; `erosion_fields()` forces the
+last batch to finish before the clock stops. `--cpu` also times `erosion_cpu` on the
+smallest size and reports the largest GPU/CPU height difference.
+
+Usage:
+  python python/tools/bench_erosion.py --sizes 256,512,1024 --batch 1,8,32,128 --json out/erosion.json
+"""
+from __future__ import annotations
+import argparse
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+import numpy as np
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--sizes", default="256,512,1024")
+    ap.add_argument("--batch", default="1,8,32,128")
+    ap.add_argument("--iterations", type=int, default=256)
+    ap.add_argument("--seed", type=int, default=7)
+    ap.add_argument("--cpu", action="store_true")
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    sizes = [int(s) for s in args.sizes.split(",")]
+    batches = [int(b) for b in args.batch.split(",")]
+    scn = vf.Scene(256, 256, grid=128, colormap="terrain")
+    rows = []
+    for n in sizes:
+        for b in batches:
+            scn.generate_height(n, n, kind="ridged", seed=args.seed)
+            scn.erode(b, batch=b)   # warm-up: state allocation and pipeline compile
+            scn.erosion_fields()
+            with stopwatch() as sw:
+                scn.erode(args.iterations, batch=b)
+                scn.erosion_fields()
+            sec = sw.s
+            rows.append({"size": n, "batch": b, "ms": sec * 1e3,
+                         "iterations_per_s": args.iterations / sec,
+                         "mcell_iterations_per_s": n * n * args.iterations / sec / 1e6})
+
+    rep = {"iterations": args.iterations, "runs": rows}
+    if args.cpu:
+        n = sizes[0]
+        dem = np.ascontiguousarray(vf.procedural_dem(n, n, kind="ridged", seed=args.seed), dtype=np.float32)
+        scn.set_height_from_r32f(dem)
+        scn.erode(args.iterations, batch=max(batches))
+        gpu = scn.erosion_fields()["height"]
+        with stopwatch() as sw:
+            cpu = vf.erosion_cpu(dem, args.iterations)["height"]
+        rep["cpu"] = {"size": n, "ms": sw.ms,
+                      "max_abs_diff": float(np.nanmax(np.abs(gpu - cpu)))}
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
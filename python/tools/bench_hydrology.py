@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""
+Hydrology thread-scaling benchmark: hydrology(dem, threads=n) for n = 1, 2, 4, ... 64.
+
+Times the three stages (depression fill, flow direction, flow accumulation) as reported in
+the result's `ms`, takes the best of `--repeat` runs per thread count, and reports speedup and
+parallel efficiency against one thread. Every run is checked against the one-thread output
+(tiling and thread count must not change the result).
+
+Usage:
+  python python/tools/bench_hydrology.py --dem 4096 --method d8 --json out/hydrology.json
+"""
+from __future__ import annotations
+import argparse, os
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+import numpy as np
+
+def make_dem(n: int, seed: int):
+    return np.ascontiguousarray(vf.procedural_dem(n, n, kind="eroded", seed=seed), dtype=np.float32)
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--dem", type=int, default=2048)
+    ap.add_argument("--method", choices=("d8", "dinf"), default="d8")
+    ap.add_argument("--tile", type=int, default=512)
+    ap.add_argument("--threads", default="1,2,4,8,16,32,64")
+    ap.add_argument("--repeat", type=int, default=3)
+    ap.add_argument("--seed", type=int, default=7)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    dem = make_dem(args.dem, args.seed)
+    threads = [int(t) for t in args.threads.split(",")]
+    rows, ref, mismatch = [], None, 0
+    for n in threads:
+        best = None
+        for _ in range(args.repeat):
+            with stopwatch() as sw:
+                hyd = vf.hydrology(dem, method=args.method, tile=args.tile, threads=n)
+            total_ms = sw.ms
+            if best is None or total_ms < best["total_ms"]:
+                best = {"threads": n, "total_ms": total_ms, **{f"{k}_ms": v for k, v in hyd["ms"].items()}}
+        if ref is None:
+            ref = hyd
+        elif not all(np.array_equal(hyd[k], ref[k], equal_nan=True) for k in ("filled", "direction", "accumulation")):
+            mismatch += 1
+        rows.append(best)
+    base = rows[0]["total_ms"]
+    for r in rows:
+        r["speedup"] = base / r["total_ms"]
+        r["efficiency"] = r["speedup"] * rows[0]["threads"] / r["threads"]
+
+    rep = {"dem": args.dem, "method": args.method, "tile": args.tile, "cpus": os.cpu_count(),
+           "runs": rows, "mismatch": mismatch}
+    write_report(rep, args.json)
+    return 0 if mismatch == 0 else 1
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""
+Multi-view batch benchmark: push-constant fast path vs Globals UBO fallback.
+
+Renders N orbit views per batch with Scene.render_views_rgba on two Scenes: one with
+push constants (when the adapter supports them) and one forced onto the UBO path with
+VF_NO_PUSH_CONSTANTS=1. Reports per-batch timings for both.
+
+Usage:
+  python python/tools/bench_multiview.py --views 16 --runs 10 --json out/multiview.json
+"""
+from __future__ import annotations
+import argparse, math, os, statistics as stats
+from _bench import load_extension, sample_ms, write_report
+
+vf = load_extension()
+import numpy as np
+
+def orbit_views(n: int) -> np.ndarray:
+    mats = [vf.camera_look_at((3.0 * math.cos(2 * math.pi * i / n), 2.0, 3.0 * math.sin(2 * math.pi * i / n)),
+                              (0.0, 0.0, 0.0), (0.0, 1.0, 0.0)) for i in range(n)]
+    return np.ascontiguousarray(np.stack(mats), dtype=np.float32)
+
+def time_batches(scene, views, runs: int, warmups: int):
+    samples = sample_ms(lambda: scene.render_views_rgba(views), runs, warmup=max(0, warmups))
+    return {"median_ms": stats.median(samples), "mean_ms": stats.fmean(samples), "min_ms": min(samples)}
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--width", type=int, default=256)
+    ap.add_argument("--height", type=int, default=256)
+    ap.add_argument("--grid", type=int, default=128)
+    ap.add_argument("--views", type=int, default=16)
+    ap.add_argument("--runs", type=int, default=10)
+    ap.add_argument("--warmups", type=int, default=2)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    views = orbit_views(args.views)
+    rep = {"width": args.width, "height": args.height, "views": args.views, "runs": args.runs}
+
+    fast = vf.Scene(args.width, args.height, grid=args.grid, colormap="viridis")
+    rep["push_constants_available"] = fast.push_constants_enabled()
+    rep["push_constants"] = time_batches(fast, views, args.runs, args.warmups)
+    del fast
+
+    os.environ["VF_NO_PUSH_CONSTANTS"] = "1"
+    slow = vf.Scene(args.width, args.height, grid=args.grid, colormap="viridis")
+    rep["ubo"] = time_batches(slow, views, args.runs, args.warmups)
+
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
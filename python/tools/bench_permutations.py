@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""
+Shader permutation benchmark for vulkan-forge Scene.
+
+Renders the same scene with several terrain feature sets and reports per-variant
+timings, so the cost of each feature (and the zero cost of disabled ones) is visible.
+The first render per variant includes pipeline compilation (reported as compile_ms).
+
+Usage:
+  python python/tools/bench_permutations.py --width 1024 --height 768 --runs 30 --json out/perm.json
+"""
+from __future__ import annotations
+import argparse, statistics as stats
+from _bench import load_extension, sample_ms, stopwatch, write_report
+
+Scene = load_extension().Scene
+
+VARIANTS = {
+    "minimal":      ["height_tex"],
+    "lut":          ["height_tex", "lut"],
+    "default":      ["height_tex", "analytic_fallback", "lut"],
+    "normal_map":   ["height_tex", "lut", "normal_map"],
+    "shadows":      ["height_tex", "lut", "normal_map", "shadows"],
+    "full":         ["height_tex", "lut", "normal_map", "shadows", "ao"],
+}
+
+def run_variant(scene, features, runs: int, warmups: int):
+    scene.set_features(features)
+    with stopwatch() as compile_:
+        scene.render_rgba()
+    samples = sample_ms(scene.render_rgba, runs, warmup=max(0, warmups))
+    return {
+        "features": scene.features(),
+        "compile_ms": compile_.ms,
+        "median_ms": stats.median(samples),
+        "mean_ms": stats.fmean(samples),
+        "min_ms": min(samples),
+    }
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--width", type=int, default=1024)
+    ap.add_argument("--height", type=int, default=768)
+    ap.add_argument("--grid", type=int, default=512)
+    ap.add_argument("--dem", type=int, default=1024, help="Procedural height texture size")
+    ap.add_argument("--runs", type=int, default=30)
+    ap.add_argument("--warmups", type=int, default=3)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    scene = Scene(args.width, args.height, grid=args.grid, colormap="viridis")
+    scene.generate_height(args.dem, args.dem, kind="ridged", seed=1)
+
+    rep = {"width": args.width, "height": args.height, "grid": args.grid, "runs": args.runs, "variants": {}}
+    for name, feats in VARIANTS.items():
+        rep["variants"][name] = run_variant(scene, feats, args.runs, args.warmups)
+    # Re-selecting a compiled variant must hit the cache.
+    scene.set_features(VARIANTS["default"])
+    compiled, hits, misses = scene.pipeline_cache_stats()
+    rep["cache"] = {"compiled": compiled, "hits": hits, "misses": misses}
+
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""
+Progressive rendering benchmark: preview latency vs refinement cost.
+
+For each output size a Scene renders `--frames` progressive frames per `--aa` setting and
+reports the median preview latency (call to preview pixels), refinement queueing delay and
+refinement time from `ProgressiveFrame.stats()`, next to the median `render_rgba` time of
+the same camera.
+
+Usage:
+  python python/tools/bench_progressive.py --sizes 640x480,1920x1080 --grid 512 --aa 1,2,4 --json out/progressive.json
+"""
+from __future__ import annotations
+import argparse, statistics
+from _bench import load_extension, sample_ms, write_report
+
+vf = load_extension()
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--sizes", default="640x480,1920x1080")
+    ap.add_argument("--grid", type=int, default=512)
+    ap.add_argument("--dem", type=int, default=1024)
+    ap.add_argument("--aa", default="1,2,4")
+    ap.add_argument("--preview-scale", type=int, default=4)
+    ap.add_argument("--frames", type=int, default=20)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    rows = []
+    for size in args.sizes.split(","):
+        w, h = (int(v) for v in size.split("x"))
+        scn = vf.Scene(w, h, grid=args.grid, colormap="terrain")
+        scn.generate_height(args.dem, args.dem, kind="fbm", seed=4)
+        scn.set_camera_look_at((3, 2, 3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+        full = sample_ms(scn.render_rgba, args.frames, warmup=1)
+        for aa in (int(a) for a in args.aa.split(",")):
+            scn.render_progressive(preview_scale=args.preview_scale, aa=aa).result()   # warm-up
+            stats = []
+            for _ in range(args.frames):
+                pf = scn.render_progressive(preview_scale=args.preview_scale, aa=aa)
+                pf.result()
+                stats.append(pf.stats())
+            med = lambda k: statistics.median(s[k] for s in stats)
+            rows.append({"size": [w, h], "aa": aa, "preview_size": list(stats[0]["preview_size"]),
+                         "preview_grid": stats[0]["preview_grid"], "preview_ms": med("preview_ms"),
+                         "refine_queue_ms": med("refine_queue_ms"), "refine_ms": med("refine_ms"),
+                         "render_rgba_ms": statistics.median(full)})
+
+    rep = {"grid": args.grid, "frames": args.frames, "runs": rows}
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
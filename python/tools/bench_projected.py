@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Projected grid benchmark: screen-space grid vs the world-space Scene mesh.
+
+For each DEM size, the Scene mesh at each `--grids` resolution and the projected grid at each
+`--cells` spacing render the same camera orbit. The report gives median frame time, vertex
+count and mean absolute error against a dense-mesh reference (`--ref-grid`) of the same
+orbit. Projected vertex counts depend only on the output size and cell.
+
+Usage:
+  python python/tools/bench_projected.py --size 1280x720 --dems 1024,4096 --grids 256,1024 --cells 2,4 --json out/projected.json
+"""
+from __future__ import annotations
+import argparse, math, statistics
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+
+import numpy as np
+
+def orbit(n: int):
+    return [((2.5 * math.cos(a), 1.2, 2.5 * math.sin(a)), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+            for a in (2 * math.pi * i / n for i in range(n))]
+
+def run(scn, cams):
+    """Median ms and the frames of `cams`."""
+    scn.set_camera_look_at(*cams[0])
+    scn.render_rgba()   # warm-up
+    ms, imgs = [], []
+    for cam in cams:
+        scn.set_camera_look_at(*cam)
+        with stopwatch() as sw:
+            imgs.append(scn.render_rgba())
+        ms.append(sw.ms)
+    return statistics.median(ms), imgs
+
+def mae(imgs, ref):
+    return float(np.mean([np.abs(a.astype(np.int16) - b.astype(np.int16)).mean() for a, b in zip(imgs, ref)]))
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--size", default="1280x720")
+    ap.add_argument("--dems", default="1024,4096")
+    ap.add_argument("--grids", default="256,1024")
+    ap.add_argument("--cells", default="2,4")
+    ap.add_argument("--ref-grid", type=int, default=2048)
+    ap.add_argument("--margin", type=float, default=0.05)
+    ap.add_argument("--frames", type=int, default=24)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    w, h = (int(v) for v in args.size.split("x"))
+    cams = orbit(args.frames)
+    rows = []
+    for dem in (int(d) for d in args.dems.split(",")):
+        def scene(grid):
+            scn = vf.Scene(w, h, grid=grid, colormap="terrain")
+            scn.generate_height(dem, dem, kind="fbm", seed=4)
+            return scn
+        _, ref = run(scene(args.ref_grid), cams)
+        for grid in (int(g) for g in args.grids.split(",")):
+            scn = scene(grid)
+            ms, imgs = run(scn, cams)
+            rows.append({"dem": dem, "mode": "mesh", "grid": grid, "vertices": grid * grid,
+                         "median_ms": ms, "mae_vs_ref": mae(imgs, ref)})
+        scn = scene(64)
+        for cell in (int(c) for c in args.cells.split(",")):
+            scn.set_projected_grid(cell=cell, margin=args.margin)
+            ms, imgs = run(scn, cams)
+            rows.append({"dem": dem, "mode": "projected", "cell": cell,
+                         "vertices": scn.projected_grid_stats()["vertices"],
+                         "median_ms": ms, "mae_vs_ref": mae(imgs, ref)})
+
+    rep = {"size": [w, h], "frames": args.frames, "ref_grid": args.ref_grid, "runs": rows}
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
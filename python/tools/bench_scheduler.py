@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+Scheduler benchmark: interactive latency under bulk load, and submission merging.
+
+A bulk job (many views on one Scene) and a stream of single-frame interactive jobs on
+other Scenes go through one RenderScheduler. Reports interactive queue/exec latency with
+priority on and off, jobs per GPU submission, and deadline misses.
+
+Usage:
+  python python/tools/bench_scheduler.py --bulk-views 256 --interactive 32 --json out/sched.json
+"""
+from __future__ import annotations
+import argparse, math, statistics, time
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+import numpy as np
+
+
+def orbit_views(n: int) -> np.ndarray:
+    mats = [vf.camera_look_at((3.0 * math.cos(2 * math.pi * i / n), 2.0, 3.0 * math.sin(2 * math.pi * i / n)),
+                              (0.0, 0.0, 0.0), (0.0, 1.0, 0.0)) for i in range(n)]
+    return np.ascontiguousarray(np.stack(mats), dtype=np.float32)
+
+
+def run(args, interactive_priority: int) -> dict:
+    # One shared device, so the scheduler can merge jobs across these Scenes.
+    bulk_scene = vf.Scene(args.width, args.height, grid=args.grid, colormap="viridis", shared_device=True)
+    ui_scenes = [vf.Scene(args.width, args.height, grid=args.grid, colormap="viridis", shared_device=True)
+                 for _ in range(args.ui_scenes)]
+    for s in [bulk_scene, *ui_scenes]:
+        s.generate_height(512, 512, seed=7)
+    sched = vf.RenderScheduler(max_in_flight=args.max_in_flight, max_frames_per_submit=args.chunk)
+    with stopwatch() as sw:
+        bulk = sched.submit(bulk_scene, orbit_views(args.bulk_views), priority=0)
+        ui = []
+        for i in range(args.interactive):
+            t = sched.submit(ui_scenes[i % len(ui_scenes)], priority=interactive_priority, deadline_ms=args.deadline_ms)
+            t.result()
+            ui.append(t.timings())
+            time.sleep(args.interval_ms / 1000.0)
+        bulk.result()
+    wall = sw.s
+    st = sched.stats()
+    sched.close()
+    lat = [u["queue_ms"] + u["exec_ms"] for u in ui]
+    return {
+        "interactive_priority": interactive_priority,
+        "wall_s": wall,
+        "interactive_p50_ms": statistics.median(lat),
+        "interactive_max_ms": max(lat),
+        "interactive_queue_ms": statistics.mean(u["queue_ms"] for u in ui),
+        "interactive_exec_ms": statistics.mean(u["exec_ms"] for u in ui),
+        "bulk": bulk.timings(),
+        "scheduler": st,
+    }
+
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--width", type=int, default=512)
+    ap.add_argument("--height", type=int, default=512)
+    ap.add_argument("--grid", type=int, default=256)
+    ap.add_argument("--bulk-views", type=int, default=256)
+    ap.add_argument("--interactive", type=int, default=32)
+    ap.add_argument("--ui-scenes", type=int, default=4)
+    ap.add_argument("--interval-ms", type=float, default=5.0)
+    ap.add_argument("--deadline-ms", type=float, default=33.0)
+    ap.add_argument("--max-in-flight", type=int, default=2)
+    ap.add_argument("--chunk", type=int, default=8, help="max_frames_per_submit")
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    rep = {"width": args.width, "height": args.height, "bulk_views": args.bulk_views,
+           "fifo": run(args, 0), "priority": run(args, 10)}
+    write_report(rep, args.json)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""
+Temporal DEM playback benchmark: Scene.render_sequence vs a per-step upload loop.
+
+Writes a (T, H, W) float32 series to an .npy file, opens it memmapped, and plays it once
+with set_height_from_r32f + render_rgba per step and once through render_sequence (steps
+streamed into a texture-array ring while frames render). Reports frames/s and the effective
+read bandwidth of each; --substeps plays fractional times (GPU-interpolated) in between.
+
+Usage:
+  python python/tools/bench_sequence.py --steps 64 --dem 1024 --ring 8 --json out/sequence.json
+"""
+from __future__ import annotations
+import argparse, os, tempfile
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+import numpy as np
+
+def write_series(path: str, steps: int, n: int) -> None:
+    mm = np.lib.format.open_memmap(path, mode="w+", dtype=np.float32, shape=(steps, n, n))
+    yy, xx = np.mgrid[0:n, 0:n].astype(np.float32) / n
+    for k in range(steps):
+        mm[k] = 0.3 * np.sin(6.0 * xx + 0.1 * k) * np.cos(4.0 * yy - 0.05 * k)
+    mm.flush()
+    del mm
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--width", type=int, default=512)
+    ap.add_argument("--height", type=int, default=512)
+    ap.add_argument("--dem", type=int, default=1024, help="DEM side length (texels)")
+    ap.add_argument("--steps", type=int, default=64)
+    ap.add_argument("--substeps", type=int, default=1, help="frames per step (>1 interpolates)")
+    ap.add_argument("--ring", type=int, default=8)
+    ap.add_argument("--depth", type=int, default=3)
+    ap.add_argument("--file", default="", help="series .npy (default: temporary file)")
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    path = args.file or os.path.join(tempfile.mkdtemp(prefix="vf_seq_"), "series.npy")
+    if not os.path.exists(path):
+        write_series(path, args.steps, args.dem)
+    series = np.load(path, mmap_mode="r")
+    steps = series.shape[0]
+    step_mb = series[0].nbytes / (1024 * 1024)
+    times = np.linspace(0.0, steps - 1, (steps - 1) * args.substeps + 1).tolist()
+
+    scene = vf.Scene(args.width, args.height, grid=256, colormap="viridis")
+    scene.set_camera_look_at((3, 2, 3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    scene.render_sequence(series[:2], ring=2)  # warm-up (compiles the HEIGHT_SEQ permutation)
+
+    with stopwatch() as loop:
+        for k in range(steps):
+            scene.set_height_from_r32f(np.ascontiguousarray(series[k]))
+            scene.render_rgba()
+    loop_s = loop.s
+
+    with stopwatch() as seq:
+        frames = scene.render_sequence(series, times=times, ring=args.ring, depth=args.depth)
+    seq_s = seq.s
+    stats = scene.sequence_stats()
+
+    rep = {"width": args.width, "height": args.height, "dem": list(series.shape[1:]), "steps": steps,
+           "frames": len(times), "ring": args.ring, "depth": args.depth, "step_mb": step_mb,
+           "loop_s": loop_s, "loop_fps": steps / loop_s, "loop_mb_s": steps * step_mb / loop_s,
+           "sequence_s": seq_s, "sequence_fps": len(times) / seq_s, "sequence_mb_s": steps * step_mb / seq_s,
+           "speedup": loop_s / seq_s, "stats": stats,
+           "frames_shape": list(frames.shape)}
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
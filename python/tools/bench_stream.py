@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+Streaming render benchmark: Scene.render_stream vs render-then-consume.
+
+Renders N orbit cameras and "consumes" each frame (a PNG-sized numpy reduction plus an
+optional sleep standing in for I/O). Reports render-only, consume-only, serial and
+streamed wall times; with overlap the streamed time approaches max(render, consume).
+
+Usage:
+  python python/tools/bench_stream.py --frames 64 --depth 3 --consume-ms 5 --json out/stream.json
+"""
+from __future__ import annotations
+import argparse, math, time
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+import numpy as np
+
+def orbit_views(n: int) -> np.ndarray:
+    mats = [vf.camera_look_at((3.0 * math.cos(2 * math.pi * i / n), 2.0, 3.0 * math.sin(2 * math.pi * i / n)),
+                              (0.0, 0.0, 0.0), (0.0, 1.0, 0.0)) for i in range(n)]
+    return np.ascontiguousarray(np.stack(mats), dtype=np.float32)
+
+def consume(img, consume_ms: float) -> None:
+    img.astype(np.float32).mean(axis=(0, 1))
+    if consume_ms > 0:
+        time.sleep(consume_ms / 1000.0)
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--width", type=int, default=512)
+    ap.add_argument("--height", type=int, default=512)
+    ap.add_argument("--grid", type=int, default=256)
+    ap.add_argument("--frames", type=int, default=64)
+    ap.add_argument("--depth", type=int, default=3)
+    ap.add_argument("--consume-ms", type=float, default=5.0)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    scene = vf.Scene(args.width, args.height, grid=args.grid, colormap="viridis")
+    scene.generate_height(512, 512, seed=3)
+    views = orbit_views(args.frames)
+    singles = [views[i:i + 1] for i in range(args.frames)]
+    list(scene.render_stream(views[:4], depth=args.depth))  # warm-up
+
+    with stopwatch() as sw:
+        imgs = [scene.render_views_rgba(v)[0] for v in singles]
+    render_s = sw.s
+
+    with stopwatch() as sw:
+        for img in imgs:
+            consume(img, args.consume_ms)
+    consume_s = sw.s
+
+    with stopwatch() as sw:
+        for v in singles:
+            consume(scene.render_views_rgba(v)[0], args.consume_ms)
+    serial_s = sw.s
+
+    with stopwatch() as sw:
+        stream = scene.render_stream(views, depth=args.depth)
+        for img in stream:
+            consume(img, args.consume_ms)
+    stream_s = sw.s
+
+    rep = {"width": args.width, "height": args.height, "frames": args.frames, "depth": args.depth,
+           "consume_ms": args.consume_ms,
+           "render_s": render_s, "consume_s": consume_s, "serial_s": serial_s, "stream_s": stream_s,
+           "ideal_s": max(render_s, consume_s), "stream_wait_ms": stream.stats()["wait_ms"],
+           "speedup": serial_s / stream_s}
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Concurrent Scene rendering benchmark.
+
+One Scene, N Python threads, each rendering its own orbit camera with
+Scene.render_views_rgba (the GIL is released while rendering). Reports frames/s and
+speedup over one thread for every thread count, plus the Scene's render-slot pool size.
+
+--python-work adds per-frame Python-side post-processing (it holds the GIL on regular
+CPython). Run once on a GIL build and once on free-threaded 3.13t, then pass the first
+report as --baseline to get the per-thread-count gain.
+
+Usage:
+  python python/tools/bench_threads.py --threads 1 2 4 8 --frames 32 --json out/threads.json
+  python3.13t python/tools/bench_threads.py --threads 1 2 4 8 16 32 --python-work \
+      --baseline out/threads_gil.json --json out/threads_ft.json
+"""
+from __future__ import annotations
+import argparse, json, math, os, sys, sysconfig, threading
+from _bench import load_extension, stopwatch, write_report
+
+vf = load_extension()
+import numpy as np
+
+def orbit_view(i: int, n: int) -> np.ndarray:
+    a = 2.0 * math.pi * i / max(n, 1)
+    m = vf.camera_look_at((3.0 * math.cos(a), 2.0, 3.0 * math.sin(a)), (0.0, 0.0, 0.0), (0.0, 1.0, 0.0))
+    return np.ascontiguousarray(np.asarray(m, dtype=np.float32)[None])
+
+def post_process(img) -> float:
+    # Pure-Python reduction over a row subset: the kind of per-frame glue that serializes on the GIL.
+    acc = 0
+    for row in img[::8, ::8, 0].tolist():
+        acc += sum(row)
+    return acc
+
+def run(scene, threads: int, frames: int, python_work: bool = False) -> float:
+    """Wall time (s) for `threads` workers to render `frames` frames each."""
+    views = [orbit_view(i, threads) for i in range(threads)]
+    barrier = threading.Barrier(threads + 1)
+
+    def worker(i: int):
+        barrier.wait()
+        for _ in range(frames):
+            img = scene.render_views_rgba(views[i])
+            if python_work:
+                post_process(img[0])
+
+    ts = [threading.Thread(target=worker, args=(i,)) for i in range(threads)]
+    for t in ts:
+        t.start()
+    barrier.wait()
+    with stopwatch() as sw:
+        for t in ts:
+            t.join()
+    return sw.s
+
+def main(argv=None) -> int:
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--width", type=int, default=256)
+    ap.add_argument("--height", type=int, default=256)
+    ap.add_argument("--grid", type=int, default=128)
+    ap.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    ap.add_argument("--frames", type=int, default=32, help="frames per thread")
+    ap.add_argument("--python-work", action="store_true", help="per-frame Python post-processing")
+    ap.add_argument("--baseline", default="", help="report from another build to compare against")
+    ap.add_argument("--json", default="")
+    args = ap.parse_args(argv)
+
+    scene = vf.Scene(args.width, args.height, grid=args.grid, colormap="viridis")
+    scene.generate_height(256, 256, seed=1)
+    run(scene, 1, 2)  # warm-up
+
+    gil_enabled = getattr(sys, "_is_gil_enabled", lambda: True)()
+    rep = {"width": args.width, "height": args.height, "frames_per_thread": args.frames,
+           "python_work": args.python_work, "cpu_count": os.cpu_count(),
+           "python": sys.version.split()[0],
+           "free_threaded_build": bool(sysconfig.get_config_var("Py_GIL_DISABLED")),
+           "gil_enabled": gil_enabled,
+           "build": vf.build_info() if hasattr(vf, "build_info") else None,
+           "results": []}
+    base = None
+    for n in args.threads:
+        secs = run(scene, n, args.frames, args.python_work)
+        fps = n * args.frames / secs
+        base = base or fps
+        rep["results"].append({"threads": n, "seconds": secs, "fps": fps, "speedup": fps / base})
+    rep["render_slots"] = scene.render_slot_stats()[0]
+
+    if args.baseline:
+        with open(args.baseline, "r", encoding="utf-8") as f:
+            other = {r["threads"]: r["fps"] for r in json.load(f)["results"]}
+        for r in rep["results"]:
+            if r["threads"] in other:
+                r["gain_vs_baseline"] = r["fps"] / other[r["threads"]]
+
+    write_report(rep, args.json)
+    return 0
+
+if __name__ == "__main__":
+    raise SystemExit(main())
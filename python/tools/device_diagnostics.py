@@ -7,8 +7,11 @@ Device diagnostics & failure modes for vulkan-forge.
 - Probes per-backend device creation and classifies outcomes (ok/unsupported/error).
 - Writes JSON report; optional text summary.
 
+- With --rank, benchmarks every adapter and caches the ranking (fastest becomes default).
+
 Usage:
   python python/tools/device_diagnostics.py --json out/diag.json --summary
+  python python/tools/device_diagnostics.py --rank [--force]
 """
 from __future__ import annotations
 import argparse, json, os, platform, sys
@@ -42,6 +45,8 @@ def main(argv=None) -> int:
     ap.add_argument("--json", default="device_diagnostics.json")
     ap.add_argument("--summary", action="store_true")
     ap.add_argument("--backends", nargs="*", default=None)
+    ap.add_argument("--rank", action="store_true", help="benchmark adapters and cache the ranking")
+    ap.add_argument("--force", action="store_true", help="with --rank: ignore cached results")
     args = ap.parse_args(argv)
 
     os.makedirs(os.path.dirname(args.json) or ".", exist_ok=True)
@@ -71,6 +76,18 @@ def main(argv=None) -> int:
             rep = {"backend_request": b, "status": "error", "message": str(e)}
         report["probes"][b] = rep
 
+    # Adapter ranking (standard terrain frame per adapter, cached on disk)
+    if args.rank:
+        try:
+            from _vulkan_forge import rank_adapters, adapter_cache_path
+        except Exception:
+            from vulkan_forge._vulkan_forge import rank_adapters, adapter_cache_path
+        try:
+            report["ranking"] = rank_adapters(args.force)
+            report["ranking_cache"] = adapter_cache_path()
+        except Exception as e:
+            report["ranking_error"] = str(e)
+
     # Write JSON + optional summary
     with open(args.json, "w", encoding="utf-8") as f:
         json.dump(report, f, indent=2)
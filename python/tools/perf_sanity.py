@@ -6,6 +6,8 @@ Performance sanity harness for vulkan-forge.
 Measures:
   - init_ms: Renderer(...) + first render (cold)
   - steady_ms: repeated render_triangle_rgba() timings (warmups excluded)
+  - ttff_ms: time to first frame, from before the optional warmup()/--app-work-ms to the first render
+  - dem (optional, --dem N): procedural_dem N×N generate time and add_terrain + height upload time
 Outputs:
   - JSON report with stats (mean, median, p95, stdev, min, max), dims, runs, warmups
   - Optional CSV of per-iteration timings
@@ -35,12 +37,14 @@ def percentile(values: List[float], p: float) -> float:
     d1 = values[c] * (k - f)
     return d0 + d1
 
-def measure(width: int, height: int, runs: int, warmups: int) -> Dict[str, Any]:
+def measure(width: int, height: int, runs: int, warmups: int, t_start: float) -> Dict[str, Any]:
     t0 = time.perf_counter()
     r = Renderer(width, height)
     # cold render included in init cost
     r.render_triangle_rgba()
-    init_ms = (time.perf_counter() - t0) * 1000.0
+    t_first = time.perf_counter()
+    init_ms = (t_first - t0) * 1000.0
+    ttff_ms = (t_first - t_start) * 1000.0
 
     # warmups (not recorded)
     for _ in range(max(0, warmups)):
@@ -58,6 +62,7 @@ def measure(width: int, height: int, runs: int, warmups: int) -> Dict[str, Any]:
         "width": width, "height": height,
         "runs": runs, "warmups": warmups,
         "init_ms": init_ms,
+        "ttff_ms": ttff_ms,
         "steady": {
             "samples_ms": steady,  # raw list for CSV if desired
             "mean_ms": stats.fmean(steady) if steady else float("nan"),
@@ -70,6 +75,19 @@ def measure(width: int, height: int, runs: int, warmups: int) -> Dict[str, Any]:
     }
     return rep
 
+def measure_dem(size: int, device: str) -> Dict[str, Any]:
+    from vulkan_forge import procedural_dem
+    t0 = time.perf_counter()
+    Z = procedural_dem(size, size, kind="fbm", seed=0, device=device)
+    generate_ms = (time.perf_counter() - t0) * 1000.0
+
+    r = Renderer(16, 16)
+    t0 = time.perf_counter()
+    r.add_terrain(Z, (1.0, 1.0), 1.0, colormap="viridis")
+    r.upload_height_r32f()
+    upload_ms = (time.perf_counter() - t0) * 1000.0
+    return {"size": size, "device": device, "generate_ms": generate_ms, "upload_ms": upload_ms}
+
 def load_json(path: str) -> Dict[str, Any]:
     with open(path, "r", encoding="utf-8") as f:
         return json.load(f)
@@ -82,6 +100,10 @@ def main(argv=None) -> int:
     ap.add_argument("--warmups", type=int, default=3)
     ap.add_argument("--json", default="perf_report.json")
     ap.add_argument("--csv", default="")
+    ap.add_argument("--warmup", action="store_true", help="Call vulkan_forge.warmup() before the simulated app work")
+    ap.add_argument("--app-work-ms", type=float, default=0.0, help="Sleep this long before the first Renderer (simulated startup work)")
+    ap.add_argument("--dem", type=int, default=0, help="Also time a procedural N×N DEM fixture (0 = off)")
+    ap.add_argument("--dem-device", choices=["cpu", "gpu"], default="cpu")
     ap.add_argument("--baseline", default="")
     ap.add_argument("--regress-pct", type=float, default=50.0, help="Allow this % over baseline p95 before failing (VF_ENFORCE_PERF=1)")
     ap.add_argument("--budget-mult", type=float, default=3.0, help="Multiplier for scaled budget when baseline is not provided (VF_ENFORCE_PERF=1)")
@@ -91,7 +113,18 @@ def main(argv=None) -> int:
     if args.csv:
         os.makedirs(os.path.dirname(args.csv) or ".", exist_ok=True)
 
-    rep = measure(args.width, args.height, args.runs, args.warmups)
+    t_start = time.perf_counter()
+    if args.warmup:
+        from vulkan_forge import warmup
+        warmup()
+    if args.app_work_ms > 0:
+        time.sleep(args.app_work_ms / 1000.0)
+    rep = measure(args.width, args.height, args.runs, args.warmups, t_start)
+    if args.warmup:
+        from vulkan_forge import warmup_status
+        rep["warmup"] = warmup_status()
+    if args.dem > 0:
+        rep["dem"] = measure_dem(args.dem, args.dem_device)
 
     # Optional CSV
     if args.csv:
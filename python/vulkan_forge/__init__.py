@@ -45,6 +45,12 @@ def _load_extension():
 _ext = _load_extension()
 Renderer = _ext.Renderer
 
+# Opt-in background device/pipeline creation so the first Renderer(...) blocks only on
+# whatever is not ready yet. Also available as vulkan_forge.warmup().
+import os as _os
+if _os.environ.get("VF_WARMUP", "").strip() == "1" and hasattr(_ext, "warmup"):
+    _ext.warmup()
+
 # IMPORTANT: only define TerrainSpike when the extension actually exposes it.
 # When the cargo feature is not built, we do NOT create a TerrainSpike name at all,
 # so `hasattr(vulkan_forge, "TerrainSpike")` is False and tests can skip.
@@ -177,6 +183,65 @@ except NameError:
     __all__ = ["grid_generate", "generate_grid"]
 # T11-END:grid-python-helpers
 
+# Background initialization
+try:
+    warmup = _ext.warmup
+    warmup_status = _ext.warmup_status
+    __all__ += ["warmup", "warmup_status"]
+except AttributeError:
+    pass
+
+# Negotiated device fast paths / limits of the shared context
+try:
+    context_caps = _ext.context_caps
+    __all__ += ["context_caps"]
+except AttributeError:
+    pass
+
+# Build flavour (abi3 vs version-specific / free-threaded)
+try:
+    build_info = _ext.build_info
+    __all__ += ["build_info"]
+except AttributeError:
+    pass
+
+# Adapter ranking (benchmark + cache; the fastest adapter becomes the default)
+try:
+    rank_adapters = _ext.rank_adapters
+    adapter_cache_path = _ext.adapter_cache_path
+    __all__ += ["rank_adapters", "adapter_cache_path"]
+except AttributeError:
+    pass
+
+# Procedural DEMs (CPU rayon / GPU compute)
+try:
+    procedural_dem = _ext.procedural_dem
+    __all__ += ["procedural_dem"]
+except AttributeError:
+    pass
+
+# Flood-inundation CPU references (validate Scene.flood / flood_sweep)
+try:
+    flood_depth_cpu = _ext.flood_depth_cpu
+    flood_spill_cpu = _ext.flood_spill_cpu
+    __all__ += ["flood_depth_cpu", "flood_spill_cpu"]
+except AttributeError:
+    pass
+
+# Hydrology kernels (depression filling, D8 / D-inf direction, flow accumulation)
+try:
+    hydrology = _ext.hydrology
+    __all__ += ["hydrology"]
+except AttributeError:
+    pass
+
+# Erosion CPU reference (the GPU simulation is Scene.erode)
+try:
+    erosion_cpu = _ext.erosion_cpu
+    __all__ += ["erosion_cpu"]
+except AttributeError:
+    pass
+
 # Type annotations for editors/mypy - these are added to help type checkers
 # but don't override the runtime behavior since the real functions are defined above.
 from typing import TYPE_CHECKING
@@ -0,0 +1,686 @@
+"""
+Local render daemon + `RemoteScene` client.
+
+One daemon process owns the GPU device, caches Scenes (per size/grid/colormap) and DEMs
+(by content hash), and batches render requests from many client processes into single
+`Scene.render_views_rgba` calls. Requests travel over a Unix socket as small JSON
+messages; pixels (and uploaded DEMs) travel through POSIX shared memory instead of the
+socket. The daemon writes each frame into a per-connection segment that the next render
+reuses, so the client copies it out once before returning it.
+
+    python -m vulkan_forge.daemon --socket /tmp/vf.sock          # server
+
+    from vulkan_forge.daemon import RemoteScene                  # any number of clients
+    scn = RemoteScene(512, 512, grid=256, colormap="viridis", socket_path="/tmp/vf.sock")
+    scn.set_height_from_r32f(dem)                                # uploaded once per daemon
+    scn.set_camera_look_at((3, 2, 3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    img = scn.render_rgba()                                      # (H, W, 4) uint8
+
+Socket path: `socket_path=`, else `$VF_DAEMON_SOCKET`, else
+`$XDG_RUNTIME_DIR/vulkan-forge.sock`, else `/tmp/vulkan-forge-<uid>.sock`.
+POSIX only (AF_UNIX + `multiprocessing.shared_memory`).
+"""
+from __future__ import annotations
+import argparse, hashlib, json, os, queue, socket, struct, threading, time
+from collections import OrderedDict
+from multiprocessing import shared_memory
+
+import numpy as np
+
+__all__ = ["RemoteScene", "RenderDaemon", "default_socket_path", "daemon_stats"]
+
+_HEADER = struct.Struct("!I")
+_MAX_MESSAGE = 64 << 20
+# Match the 2×2 placeholder height and the camera a fresh Scene starts with.
+_DEFAULT_DEM = np.array([[0.00, 0.25], [0.50, 0.75]], dtype=np.float32)
+_DEFAULT_CAMERA = ((3.0, 2.0, 3.0), (0.0, 0.0, 0.0), (0.0, 1.0, 0.0))
+_DEFAULT_PROJ = (45.0, 0.1, 100.0)
+
+
+def default_socket_path() -> str:
+    p = os.environ.get("VF_DAEMON_SOCKET", "").strip()
+    if p:
+        return p
+    run = os.environ.get("XDG_RUNTIME_DIR", "").strip()
+    if run:
+        return os.path.join(run, "vulkan-forge.sock")
+    return f"/tmp/vulkan-forge-{os.getuid()}.sock"
+
+
+# ---------------------------------------------------------------------------------------
+# Wire format: 4-byte big-endian length + UTF-8 JSON object.
+
+def _send(sock: socket.socket, msg: dict) -> None:
+    data = json.dumps(msg).encode("utf-8")
+    sock.sendall(_HEADER.pack(len(data)) + data)
+
+
+def _recv_exact(sock: socket.socket, n: int) -> bytes | None:
+    buf = bytearray()
+    while len(buf) < n:
+        chunk = sock.recv(n - len(buf))
+        if not chunk:
+            return None
+        buf += chunk
+    return bytes(buf)
+
+
+def _recv(sock: socket.socket) -> dict | None:
+    head = _recv_exact(sock, _HEADER.size)
+    if head is None:
+        return None
+    (n,) = _HEADER.unpack(head)
+    if n > _MAX_MESSAGE:
+        raise ConnectionError(f"message of {n} bytes exceeds the {_MAX_MESSAGE} byte limit")
+    body = _recv_exact(sock, n)
+    if body is None:
+        return None
+    return json.loads(body.decode("utf-8"))
+
+
+# Segments created by this process (a daemon and its clients may share one in tests).
+_OWNED: set[str] = set()
+
+
+def _create(size: int) -> shared_memory.SharedMemory:
+    shm = shared_memory.SharedMemory(create=True, size=max(size, 1))
+    _OWNED.add(shm.name)
+    return shm
+
+
+def _destroy(shm: shared_memory.SharedMemory) -> None:
+    shm.close()
+    _OWNED.discard(shm.name)
+    try:
+        shm.unlink()
+    except FileNotFoundError:
+        pass
+
+
+def _attach(name: str) -> shared_memory.SharedMemory:
+    """Attach to a segment owned by the other side without adopting it.
+
+    Before 3.13 every attach registers the segment with this process's resource tracker,
+    which would unlink it (and warn) when this process exits.
+    """
+    try:
+        return shared_memory.SharedMemory(name=name, track=False)  # type: ignore[call-arg]
+    except TypeError:
+        shm = shared_memory.SharedMemory(name=name)
+        if shm.name in _OWNED:
+            return shm
+        try:
+            from multiprocessing import resource_tracker
+            resource_tracker.unregister(shm._name, "shared_memory")  # type: ignore[attr-defined]
+        except Exception:
+            pass
+        return shm
+
+
+# ---------------------------------------------------------------------------------------
+# Server
+
+class _Handle:
+    """Client-side Scene state, kept by the daemon; applied to a shared Scene per batch."""
+
+    def __init__(self, width: int, height: int, grid: int | None, colormap: str | None):
+        self.config = (int(width), int(height), grid, colormap)
+        self.camera: tuple | None = None   # (eye, target, up)
+        self.proj: tuple | None = None     # (fovy_deg, znear, zfar)
+        self.dem: tuple | None = None      # ("r32f", key) | ("gen", params)
+        self.features: tuple | None = None
+
+
+class _Job:
+    def __init__(self, conn: "_Connection", handle: _Handle, views: np.ndarray | None):
+        self.conn = conn
+        self.scene_key = handle.config
+        self.proj = handle.proj or _DEFAULT_PROJ
+        self.camera = handle.camera
+        self.dem = handle.dem
+        self.features = handle.features
+        self.views = views
+        self.enqueued = time.perf_counter()
+
+
+class _Connection:
+    def __init__(self, sock: socket.socket):
+        self.sock = sock
+        self.send_lock = threading.Lock()
+        self.handles: dict[int, _Handle] = {}
+        self.out: shared_memory.SharedMemory | None = None
+        self.out_lock = threading.Lock()
+
+    def reply(self, msg: dict) -> None:
+        with self.send_lock:
+            _send(self.sock, msg)
+
+    def output(self, nbytes: int) -> shared_memory.SharedMemory:
+        """Per-connection frame segment, grown (never shrunk) on demand."""
+        if self.out is None or self.out.size < nbytes:
+            self.release()
+            with self.out_lock:
+                self.out = _create(nbytes)
+        return self.out
+
+    def release(self) -> None:
+        with self.out_lock:
+            if self.out is not None:
+                _destroy(self.out)
+                self.out = None
+
+
+class _SceneEntry:
+    def __init__(self, scene, default_features: list[str]):
+        self.scene = scene
+        self.default_features = default_features
+        self.dem: object = None
+        self.features: object = None
+        self.proj: tuple = _DEFAULT_PROJ
+
+
+class RenderDaemon:
+    """Owns the device, the Scene/DEM caches and the single render worker.
+
+    Scenes are cached per size/grid/colormap; the DEM, features and projection of a request
+    are applied to the cached Scene before it renders. Requests that arrive within
+    `batch_window_ms` of each other and share a Scene, DEM, feature set and projection are
+    rendered by one `render_views_rgba` call (at most `max_batch` frames).
+    """
+
+    def __init__(self, socket_path: str | None = None, *, batch_window_ms: float = 2.0,
+                 max_batch: int = 64, max_scenes: int = 8, max_dem_bytes: int = 1 << 30):
+        from . import _ext
+        self._ext = _ext
+        self.socket_path = socket_path or default_socket_path()
+        self.batch_window = max(0.0, float(batch_window_ms)) / 1000.0
+        self.max_batch = max(1, int(max_batch))
+        self.max_scenes = max(1, int(max_scenes))
+        self.max_dem_bytes = int(max_dem_bytes)
+        self._scenes: "OrderedDict[tuple, _SceneEntry]" = OrderedDict()
+        self._scenes_lock = threading.Lock()
+        self._dems: "OrderedDict[str, np.ndarray]" = OrderedDict()
+        self._dem_bytes = 0
+        self._dems_lock = threading.Lock()
+        self._jobs: "queue.Queue[_Job | None]" = queue.Queue()
+        self._next_handle = 1
+        self._counters = {"clients": 0, "requests": 0, "batches": 0, "frames": 0,
+                          "queue_ms": 0.0, "render_ms": 0.0}
+        self._counters_lock = threading.Lock()
+        self._listener: socket.socket | None = None
+        self._threads: list[threading.Thread] = []
+        self._conns: set[_Connection] = set()
+        self._conns_lock = threading.Lock()
+        self._stopping = threading.Event()
+
+    # -- lifecycle ----------------------------------------------------------------------
+
+    def _bind(self) -> None:
+        if os.path.exists(self.socket_path):
+            probe = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            try:
+                probe.connect(self.socket_path)
+                raise RuntimeError(f"a render daemon is already listening on {self.socket_path}")
+            except (ConnectionRefusedError, FileNotFoundError):
+                os.unlink(self.socket_path)  # stale socket from a dead daemon
+            finally:
+                probe.close()
+        s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        # Create the socket file owner-only; a chmod after bind leaves a window open to others.
+        old = os.umask(0o177)
+        try:
+            s.bind(self.socket_path)
+        finally:
+            os.umask(old)
+        s.listen(64)
+        self._listener = s
+
+    def start(self) -> "RenderDaemon":
+        """Listen and serve on background threads; returns once the socket accepts."""
+        self._bind()
+        for target, name in ((self._worker, "vf-daemon-render"), (self._accept_loop, "vf-daemon-accept")):
+            t = threading.Thread(target=target, name=name, daemon=True)
+            t.start()
+            self._threads.append(t)
+        return self
+
+    def serve_forever(self) -> None:
+        self.start()
+        try:
+            while not self._stopping.wait(0.5):
+                pass
+        except KeyboardInterrupt:
+            pass
+        finally:
+            self.shutdown()
+
+    def shutdown(self) -> None:
+        if self._stopping.is_set():
+            return
+        self._stopping.set()
+        self._jobs.put(None)
+        if self._listener is not None:
+            try:
+                self._listener.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+            self._listener.close()
+        with self._conns_lock:
+            conns = list(self._conns)
+        for conn in conns:
+            try:
+                conn.sock.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+            conn.release()
+        try:
+            os.unlink(self.socket_path)
+        except FileNotFoundError:
+            pass
+
+    def __enter__(self) -> "RenderDaemon":
+        return self.start()
+
+    def __exit__(self, *exc) -> None:
+        self.shutdown()
+
+    def stats(self) -> dict:
+        with self._counters_lock:
+            c = dict(self._counters)
+        with self._scenes_lock:
+            c["scenes"] = len(self._scenes)
+        with self._dems_lock:
+            c["dems"] = len(self._dems)
+            c["dem_bytes"] = self._dem_bytes
+        c["avg_batch"] = c["frames"] / c["batches"] if c["batches"] else 0.0
+        return c
+
+    # -- caches -------------------------------------------------------------------------
+
+    def _scene(self, key: tuple) -> _SceneEntry:
+        with self._scenes_lock:
+            entry = self._scenes.get(key)
+            if entry is not None:
+                self._scenes.move_to_end(key)
+                return entry
+        width, height, grid, colormap = key
+        scene = self._ext.Scene(width, height, grid=grid, colormap=colormap, shared_device=True)
+        entry = _SceneEntry(scene, list(scene.features()))
+        with self._scenes_lock:
+            entry = self._scenes.setdefault(key, entry)
+            while len(self._scenes) > self.max_scenes:
+                self._scenes.popitem(last=False)
+        return entry
+
+    def _put_dem(self, key: str, arr: np.ndarray) -> None:
+        with self._dems_lock:
+            if key in self._dems:
+                self._dems.move_to_end(key)
+                return
+            self._dems[key] = arr
+            self._dem_bytes += arr.nbytes
+            while self._dem_bytes > self.max_dem_bytes and len(self._dems) > 1:
+                _, old = self._dems.popitem(last=False)
+                self._dem_bytes -= old.nbytes
+
+    def _get_dem(self, key: str) -> np.ndarray | None:
+        with self._dems_lock:
+            arr = self._dems.get(key)
+            if arr is not None:
+                self._dems.move_to_end(key)
+            return arr
+
+    # -- connections --------------------------------------------------------------------
+
+    def _accept_loop(self) -> None:
+        assert self._listener is not None
+        while not self._stopping.is_set():
+            try:
+                sock, _ = self._listener.accept()
+            except OSError:
+                return
+            with self._counters_lock:
+                self._counters["clients"] += 1
+            t = threading.Thread(target=self._serve_connection, args=(sock,), name="vf-daemon-conn", daemon=True)
+            t.start()
+
+    def _serve_connection(self, sock: socket.socket) -> None:
+        conn = _Connection(sock)
+        with self._conns_lock:
+            self._conns.add(conn)
+        try:
+            while True:
+                msg = _recv(sock)
+                if msg is None:
+                    return
+                try:
+                    reply = self._dispatch(conn, msg)
+                except Exception as e:
+                    reply = {"ok": False, "type": type(e).__name__, "error": str(e)}
+                if reply is not None:
+                    conn.reply(reply)
+        except (ConnectionError, OSError):
+            return
+        finally:
+            with self._conns_lock:
+                self._conns.discard(conn)
+            conn.release()
+            sock.close()
+
+    def _handle(self, conn: _Connection, msg: dict) -> _Handle:
+        h = conn.handles.get(int(msg.get("handle", -1)))
+        if h is None:
+            raise ValueError("unknown or closed scene handle")
+        return h
+
+    def _dispatch(self, conn: _Connection, msg: dict) -> dict | None:
+        op = msg.get("op")
+        if op == "open":
+            h = _Handle(msg["width"], msg["height"], msg.get("grid"), msg.get("colormap"))
+            self._scene(h.config)  # surfaces size/grid/colormap errors now
+            with self._counters_lock:
+                hid = self._next_handle
+                self._next_handle += 1
+            conn.handles[hid] = h
+            return {"ok": True, "handle": hid}
+        if op == "close":
+            conn.handles.pop(int(msg.get("handle", -1)), None)
+            return {"ok": True}
+        if op == "stats":
+            return {"ok": True, "stats": self.stats()}
+        h = self._handle(conn, msg)
+        if op == "camera":
+            cam = (tuple(msg["eye"]), tuple(msg["target"]), tuple(msg["up"]))
+            proj = (float(msg["fovy_deg"]), float(msg["znear"]), float(msg["zfar"]))
+            self._ext.camera_look_at(*cam)  # validates eye/target/up
+            self._ext.camera_perspective(proj[0], h.config[0] / h.config[1], proj[1], proj[2])
+            h.camera, h.proj = cam, proj
+            return {"ok": True}
+        if op == "height":
+            key = str(msg["key"])
+            if self._get_dem(key) is None:
+                if "shm" not in msg:
+                    return {"ok": True, "cached": False}
+                shm = _attach(msg["shm"])
+                try:
+                    arr = np.ndarray(tuple(msg["shape"]), dtype=np.float32, buffer=shm.buf).copy()
+                finally:
+                    shm.close()
+                self._put_dem(key, arr)
+            h.dem = ("r32f", key)
+            return {"ok": True, "cached": True}
+        if op == "generate":
+            h.dem = ("gen", tuple(msg["params"]))
+            return {"ok": True}
+        if op == "features":
+            h.features = tuple(str(f) for f in msg["features"])
+            return {"ok": True}
+        if op == "render":
+            views = None
+            if msg.get("views") is not None:
+                views = np.asarray(msg["views"], dtype=np.float32).reshape(-1, 4, 4)
+                if views.shape[0] == 0:
+                    raise ValueError("views must be float32 with shape (N, 4, 4), N >= 1")
+            with self._counters_lock:
+                self._counters["requests"] += 1
+            self._jobs.put(_Job(conn, h, views))
+            return None  # the render worker replies
+        raise ValueError(f"unknown op {op!r}")
+
+    # -- render worker ------------------------------------------------------------------
+
+    def _worker(self) -> None:
+        while True:
+            first = self._jobs.get()
+            if first is None:
+                return
+            batch = [first]
+            deadline = time.perf_counter() + self.batch_window
+            while len(batch) < self.max_batch:
+                timeout = deadline - time.perf_counter()
+                try:
+                    job = self._jobs.get(timeout=timeout) if timeout > 0 else self._jobs.get_nowait()
+                except queue.Empty:
+                    break
+                if job is None:
+                    self._jobs.put(None)
+                    break
+                batch.append(job)
+            groups: "OrderedDict[tuple, list[_Job]]" = OrderedDict()
+            for job in batch:
+                groups.setdefault((job.scene_key, job.proj, job.dem, job.features), []).append(job)
+            for jobs in groups.values():
+                self._render_group(jobs)
+
+    def _configure(self, entry: _SceneEntry, proj, dem, features) -> None:
+        if entry.proj != proj:
+            # Views come with each render; the Scene camera stays the default one, which
+            # is what requests without a camera render.
+            entry.scene.set_camera_look_at(*_DEFAULT_CAMERA, *proj)
+            entry.proj = proj
+        if entry.dem != dem:
+            if dem is None:
+                entry.scene.set_height_from_r32f(_DEFAULT_DEM)
+            elif dem[0] == "r32f":
+                arr = self._get_dem(dem[1])
+                if arr is None:
+                    raise RuntimeError("DEM was evicted from the daemon cache; call set_height_from_r32f again")
+                entry.scene.set_height_from_r32f(arr)
+            else:
+                entry.scene.generate_height(*dem[1])
+            entry.dem = dem
+        if entry.features != features:
+            entry.scene.set_features(list(features) if features is not None else entry.default_features)
+            entry.features = features
+
+    def _render_group(self, jobs: list[_Job]) -> None:
+        t0 = time.perf_counter()
+        try:
+            entry = self._scene(jobs[0].scene_key)
+            self._configure(entry, jobs[0].proj, jobs[0].dem, jobs[0].features)
+            # Jobs with a view (explicit or from their camera) share one multi-view render;
+            # jobs on the Scene's default camera all get the same single frame.
+            stacked, spans, default_jobs = [], [], []
+            for job in jobs:
+                if job.views is not None:
+                    v = job.views
+                elif job.camera is not None:
+                    v = np.asarray(self._ext.camera_look_at(*job.camera), dtype=np.float32)[None]
+                else:
+                    default_jobs.append(job)
+                    continue
+                spans.append((job, len(stacked), len(v)))
+                stacked.extend(v)
+            results: list[tuple[_Job, np.ndarray]] = []
+            if stacked:
+                frames = entry.scene.render_views_rgba(np.ascontiguousarray(np.stack(stacked), dtype=np.float32))
+                for job, start, n in spans:
+                    out = frames[start:start + n]
+                    results.append((job, out if job.views is not None else out[0]))
+            if default_jobs:
+                img = entry.scene.render_rgba()
+                results.extend((job, img) for job in default_jobs)
+        except Exception as e:
+            err = {"ok": False, "type": type(e).__name__, "error": str(e)}
+            for job in jobs:
+                self._safe_reply(job.conn, err)
+            return
+        t1 = time.perf_counter()
+        with self._counters_lock:
+            self._counters["batches"] += 1
+            self._counters["frames"] += len(stacked) + (1 if default_jobs else 0)
+            self._counters["render_ms"] += (t1 - t0) * 1000.0
+            self._counters["queue_ms"] += sum((t0 - j.enqueued) * 1000.0 for j in jobs)
+        for job, arr in results:
+            try:
+                shm = job.conn.output(arr.nbytes)
+                np.ndarray(arr.shape, dtype=np.uint8, buffer=shm.buf)[...] = arr
+                self._safe_reply(job.conn, {"ok": True, "shm": shm.name, "shape": list(arr.shape),
+                                            "batch": len(jobs)})
+            except Exception as e:
+                self._safe_reply(job.conn, {"ok": False, "type": type(e).__name__, "error": str(e)})
+
+    @staticmethod
+    def _safe_reply(conn: _Connection, msg: dict) -> None:
+        try:
+            conn.reply(msg)
+        except OSError:
+            pass  # client went away; its connection thread cleans up
+
+
+# ---------------------------------------------------------------------------------------
+# Client
+
+_ERRORS = {"ValueError": ValueError, "TypeError": TypeError, "KeyError": KeyError}
+
+
+class _Channel:
+    """One socket per process, shared by every RemoteScene of that process."""
+
+    _instances: dict[str, "_Channel"] = {}
+    _instances_lock = threading.Lock()
+
+    def __init__(self, path: str):
+        self.path = path
+        self.pid = os.getpid()
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            self.sock.connect(path)
+        except (FileNotFoundError, ConnectionRefusedError) as e:
+            self.sock.close()
+            raise RuntimeError(f"no render daemon on {path} (start one with `python -m vulkan_forge.daemon`): {e}")
+        self.lock = threading.Lock()
+        self.frames: shared_memory.SharedMemory | None = None
+        self.broken = False
+
+    @classmethod
+    def get(cls, path: str) -> "_Channel":
+        with cls._instances_lock:
+            ch = cls._instances.get(path)
+            if ch is None or ch.broken or ch.pid != os.getpid():  # never share a socket across fork()
+                ch = cls._instances[path] = cls(path)
+            return ch
+
+    def call(self, msg: dict) -> dict:
+        with self.lock:
+            try:
+                _send(self.sock, msg)
+                reply = _recv(self.sock)
+            except OSError:
+                reply, self.broken = None, True
+            if reply is None:
+                self.broken = True
+                raise RuntimeError("render daemon closed the connection")
+            if not reply.get("ok"):
+                raise _ERRORS.get(reply.get("type", ""), RuntimeError)(reply.get("error", "render daemon error"))
+            if "shm" in reply:
+                # Copy out under the lock: the segment is reused by the next render.
+                if self.frames is None or self.frames.name.lstrip("/") != reply["shm"].lstrip("/"):
+                    if self.frames is not None:
+                        self.frames.close()
+                    self.frames = _attach(reply["shm"])
+                shape = tuple(reply["shape"])
+                reply["pixels"] = np.ndarray(shape, dtype=np.uint8, buffer=self.frames.buf).copy()
+            return reply
+
+
+class RemoteScene:
+    """`Scene` look-alike backed by the render daemon.
+
+    Mirrors `Scene(width, height, grid=None, colormap=None)`, `set_camera_look_at`,
+    `set_height_from_r32f`, `generate_height`, `set_features`, `render_rgba` and
+    `render_views_rgba`. DEMs are keyed by content hash, so a DEM already uploaded by any
+    client is not sent again.
+    """
+
+    def __init__(self, width: int, height: int, grid: int | None = None, colormap: str | None = None,
+                 *, socket_path: str | None = None):
+        self.width, self.height = int(width), int(height)
+        self._ch = _Channel.get(socket_path or default_socket_path())
+        self._handle = self._ch.call({"op": "open", "width": self.width, "height": self.height,
+                                      "grid": grid, "colormap": colormap})["handle"]
+        self._features: list[str] | None = None
+
+    def set_camera_look_at(self, eye, target, up, fovy_deg: float, znear: float, zfar: float) -> None:
+        self._call({"op": "camera", "eye": [float(x) for x in eye], "target": [float(x) for x in target],
+                    "up": [float(x) for x in up], "fovy_deg": float(fovy_deg), "znear": float(znear),
+                    "zfar": float(zfar)})
+
+    def set_height_from_r32f(self, height_r32f) -> None:
+        a = np.asarray(height_r32f)
+        if a.ndim != 2 or a.dtype != np.float32 or not a.flags["C_CONTIGUOUS"]:
+            raise RuntimeError("height must be C-contiguous float32[H,W]")
+        key = hashlib.sha1(a.tobytes()).hexdigest() + f":{a.shape[0]}x{a.shape[1]}"
+        if self._call({"op": "height", "key": key})["cached"]:
+            return
+        shm = _create(a.nbytes)
+        try:
+            np.ndarray(a.shape, dtype=np.float32, buffer=shm.buf)[...] = a
+            self._call({"op": "height", "key": key, "shm": shm.name, "shape": list(a.shape)})
+        finally:
+            _destroy(shm)
+
+    def generate_height(self, width: int, height: int, kind: str = "fbm", seed: int = 0, octaves: int = 6,
+                        frequency: float = 4.0, lacunarity: float = 2.0, gain: float = 0.5,
+                        amplitude: float = 0.25) -> None:
+        params = [int(width), int(height), str(kind), int(seed), int(octaves), float(frequency),
+                  float(lacunarity), float(gain), float(amplitude)]
+        self._call({"op": "generate", "params": params})
+
+    def set_features(self, features) -> None:
+        self._features = [str(f) for f in features]
+        self._call({"op": "features", "features": self._features})
+
+    def render_rgba(self) -> np.ndarray:
+        return self._call({"op": "render", "views": None})["pixels"]
+
+    def render_views_rgba(self, views) -> np.ndarray:
+        v = np.asarray(views, dtype=np.float32)
+        if v.ndim != 3 or v.shape[1:] != (4, 4) or v.shape[0] == 0:
+            raise ValueError("views must be float32 with shape (N, 4, 4), N >= 1")
+        return self._call({"op": "render", "views": v.reshape(-1).tolist()})["pixels"]
+
+    def close(self) -> None:
+        if self._handle is not None:
+            try:
+                self._ch.call({"op": "close", "handle": self._handle})
+            except (RuntimeError, OSError):
+                pass
+            self._handle = None
+
+    def __enter__(self) -> "RemoteScene":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def _call(self, msg: dict) -> dict:
+        if self._handle is None:
+            raise RuntimeError("RemoteScene is closed")
+        msg["handle"] = self._handle
+        return self._ch.call(msg)
+
+
+def daemon_stats(socket_path: str | None = None) -> dict:
+    """Counters of the running daemon: clients, requests, batches, frames, avg_batch,
+    queue_ms/render_ms totals, cached scenes and DEMs."""
+    return _Channel.get(socket_path or default_socket_path()).call({"op": "stats"})["stats"]
+
+
+def main(argv: list[str] | None = None) -> int:
+    ap = argparse.ArgumentParser(description="vulkan-forge local render daemon")
+    ap.add_argument("--socket", default="", help="Unix socket path (default: see module docs)")
+    ap.add_argument("--batch-window-ms", type=float, default=2.0)
+    ap.add_argument("--max-batch", type=int, default=64)
+    ap.add_argument("--max-scenes", type=int, default=8)
+    ap.add_argument("--max-dem-mb", type=int, default=1024)
+    args = ap.parse_args(argv)
+    d = RenderDaemon(args.socket or None, batch_window_ms=args.batch_window_ms, max_batch=args.max_batch,
+                     max_scenes=args.max_scenes, max_dem_bytes=args.max_dem_mb << 20)
+    print(f"vulkan-forge daemon listening on {d.socket_path}", flush=True)
+    d.serve_forever()
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,243 @@
+//! Adapter auto-selection by micro-benchmark, with an on-disk ranking cache.
+//!
+//! `HighPerformance` is a hint, not a measurement: on hosts with lavapipe, llvmpipe GL and
+//! a real GPU side by side, the adapter it returns can be 10× slower than the best one.
+//! `rank_adapters()` renders a short standard terrain frame on every adapter, records the
+//! median frame time per adapter in a JSON cache keyed by name/backend/driver/version, and
+//! `preferred_adapter` (used by `WgpuContext` and `Scene`) then picks the fastest adapter
+//! that is still present. Without a cache the old `HighPerformance` choice is kept.
+//!
+//! Environment:
+//! - `VF_ADAPTER_CACHE=path`: cache file (default `$XDG_CACHE_HOME/vulkan-forge/adapters.json`,
+//!   else `~/.cache/vulkan-forge/adapters.json`)
+//! - `VF_ADAPTER_AUTOSELECT=1`: benchmark adapters missing from the cache on first use
+//! - `VF_ADAPTER_AUTOSELECT=0`: ignore the cache and use `HighPerformance`
+
+use std::path::PathBuf;
+use std::time::{Instant, SystemTime, UNIX_EPOCH};
+
+use pyo3::prelude::*;
+use pyo3::types::{PyDict, PyList};
+use serde_json::{json, Map, Value};
+
+const CACHE_VERSION: u64 = 1;
+/// Standard benchmark: 256×256 target, 128² grid, 256² fBm DEM, median of `BENCH_FRAMES`.
+const BENCH_SIZE: u32 = 256;
+const BENCH_GRID: u32 = 128;
+const BENCH_FRAMES: usize = 8;
+
+/// One adapter's benchmark outcome (`median_ms` is `None` when the benchmark failed).
+#[derive(Debug, Clone)]
+pub struct Ranked {
+    pub key: String,
+    pub name: String,
+    pub backend: String,
+    pub device_type: String,
+    pub median_ms: Option<f64>,
+    pub error: Option<String>,
+    pub cached: bool,
+}
+
+pub fn cache_path() -> Option<PathBuf> {
+    if let Ok(p) = std::env::var("VF_ADAPTER_CACHE") {
+        if !p.trim().is_empty() {
+            return Some(PathBuf::from(p));
+        }
+    }
+    let base = std::env::var_os("XDG_CACHE_HOME")
+        .map(PathBuf::from)
+        .or_else(|| std::env::var_os("HOME").map(|h| PathBuf::from(h).join(".cache")))
+        .or_else(|| std::env::var_os("LOCALAPPDATA").map(PathBuf::from))?;
+    Some(base.join("vulkan-forge").join("adapters.json"))
+}
+
+/// Cache key: changes whenever the driver or its version changes, so stale rankings are
+/// simply not found (and re-benchmarked) after a driver update.
+pub fn adapter_key(info: &wgpu::AdapterInfo) -> String {
+    format!(
+        "{}|{:?}|{}|{}|{:04x}:{:04x}",
+        info.name, info.backend, info.driver, info.driver_info, info.vendor, info.device
+    )
+}
+
+fn load_entries() -> Map<String, Value> {
+    let parsed = cache_path()
+        .and_then(|p| std::fs::read_to_string(p).ok())
+        .and_then(|s| serde_json::from_str::<Value>(&s).ok());
+    match parsed {
+        Some(Value::Object(mut root)) if root.get("version").and_then(Value::as_u64) == Some(CACHE_VERSION) => {
+            match root.remove("entries") {
+                Some(Value::Object(entries)) => entries,
+                _ => Map::new(),
+            }
+        }
+        _ => Map::new(),
+    }
+}
+
+fn save_entries(entries: &Map<String, Value>) -> Result<PathBuf, String> {
+    let path = cache_path().ok_or_else(|| "no cache directory (set VF_ADAPTER_CACHE)".to_string())?;
+    if let Some(dir) = path.parent() {
+        std::fs::create_dir_all(dir).map_err(|e| format!("{}: {}", dir.display(), e))?;
+    }
+    let doc = json!({ "version": CACHE_VERSION, "entries": entries });
+    // Write-then-rename so a concurrent reader never sees a truncated file.
+    let tmp = path.with_extension("json.tmp");
+    std::fs::write(&tmp, serde_json::to_string_pretty(&doc).unwrap_or_default())
+        .and_then(|_| std::fs::rename(&tmp, &path))
+        .map_err(|e| format!("{}: {}", path.display(), e))?;
+    Ok(path)
+}
+
+/// Median frame time (ms) of the standard terrain frame on `adapter`.
+///
+/// Errors are plain strings and `PyErr`s are never formatted: this may run on the warmup
+/// thread, which must not touch the GIL (formatting a `PyErr` would).
+pub fn benchmark_adapter(adapter: &wgpu::Adapter) -> Result<f64, String> {
+    let scene = crate::scene::Scene::with_adapter(adapter, BENCH_SIZE, BENCH_SIZE, BENCH_GRID, None, false)
+        .map_err(|e| format!("device or scene setup failed: {e}"))?;
+    use crate::terrain::procgen::{NoiseKind, ProcParams};
+    scene.write_procedural_height(&ProcParams::new(BENCH_SIZE, BENCH_SIZE, NoiseKind::Fbm, 1, 6, 4.0, 2.0, 0.5, 0.25));
+    // First frame pays for lazy driver work; not timed.
+    scene.render_pixels()?;
+    let mut times = (0..BENCH_FRAMES)
+        .map(|_| {
+            let t0 = Instant::now();
+            scene.render_pixels()?;
+            Ok(t0.elapsed().as_secs_f64() * 1000.0)
+        })
+        .collect::<Result<Vec<f64>, String>>()?;
+    times.sort_by(|a, b| a.total_cmp(b));
+    Ok(times[times.len() / 2])
+}
+
+fn all_adapters(instance: &wgpu::Instance) -> Vec<wgpu::Adapter> {
+    instance.enumerate_adapters(wgpu::Backends::all())
+}
+
+fn ranked_from_entry(key: &str, info: &wgpu::AdapterInfo, entry: &Value) -> Ranked {
+    Ranked {
+        key: key.to_string(),
+        name: info.name.clone(),
+        backend: crate::backend_str(info.backend).to_string(),
+        device_type: crate::devtype_str(info.device_type).to_string(),
+        median_ms: entry.get("median_ms").and_then(Value::as_f64),
+        error: entry.get("error").and_then(Value::as_str).map(str::to_string),
+        cached: true,
+    }
+}
+
+/// Rank every adapter on `instance`, fastest first (failed adapters last).
+///
+/// Cached results are reused unless `force`; new results are merged into the cache, so
+/// entries of adapters that are not present right now survive a forced re-rank.
+/// Returned indices refer to `all_adapters(instance)`.
+fn rank(instance: &wgpu::Instance, force: bool) -> (Vec<(usize, Ranked)>, Result<Option<PathBuf>, String>) {
+    let mut entries = load_entries();
+    let mut dirty = false;
+    let mut out = Vec::new();
+    for (i, adapter) in all_adapters(instance).iter().enumerate() {
+        let info = adapter.get_info();
+        let key = adapter_key(&info);
+        if let Some(entry) = entries.get(&key).filter(|_| !force) {
+            out.push((i, ranked_from_entry(&key, &info, entry)));
+            continue;
+        }
+        let result = benchmark_adapter(adapter);
+        let stamp = SystemTime::now().duration_since(UNIX_EPOCH).map(|d| d.as_secs()).unwrap_or(0);
+        let entry = json!({
+            "name": info.name,
+            "backend": crate::backend_str(info.backend),
+            "device_type": crate::devtype_str(info.device_type),
+            "median_ms": result.as_ref().ok(),
+            "error": result.as_ref().err(),
+            "timestamp": stamp,
+        });
+        let mut r = ranked_from_entry(&key, &info, &entry);
+        r.cached = false;
+        out.push((i, r));
+        entries.insert(key, entry);
+        dirty = true;
+    }
+    out.sort_by(|(_, a), (_, b)| match (a.median_ms, b.median_ms) {
+        (Some(x), Some(y)) => x.total_cmp(&y),
+        (Some(_), None) => std::cmp::Ordering::Less,
+        (None, Some(_)) => std::cmp::Ordering::Greater,
+        (None, None) => std::cmp::Ordering::Equal,
+    });
+    let saved = if dirty { save_entries(&entries).map(Some) } else { Ok(None) };
+    (out, saved)
+}
+
+/// Adapter for the shared context and new Scenes: the fastest cached adapter that is still
+/// present, else `HighPerformance`.
+pub fn preferred_adapter(instance: &wgpu::Instance) -> Option<wgpu::Adapter> {
+    let mode = std::env::var("VF_ADAPTER_AUTOSELECT").map(|v| v.trim().to_string()).unwrap_or_default();
+    if mode != "0" {
+        let best = if mode == "1" {
+            rank(instance, false).0.into_iter().find(|(_, r)| r.median_ms.is_some()).map(|(i, _)| i)
+        } else {
+            let entries = load_entries();
+            all_adapters(instance)
+                .iter()
+                .enumerate()
+                .filter_map(|(i, a)| {
+                    let ms = entries.get(&adapter_key(&a.get_info()))?.get("median_ms")?.as_f64()?;
+                    Some((i, ms))
+                })
+                .min_by(|a, b| a.1.total_cmp(&b.1))
+                .map(|(i, _)| i)
+        };
+        if let Some(i) = best {
+            if let Some(adapter) = all_adapters(instance).into_iter().nth(i) {
+                return Some(adapter);
+            }
+        }
+    }
+    pollster::block_on(instance.request_adapter(&wgpu::RequestAdapterOptions {
+        power_preference: wgpu::PowerPreference::HighPerformance,
+        compatible_surface: None,
+        force_fallback_adapter: false,
+    }))
+}
+
+/// Benchmark every adapter (cached unless `force`) and return them fastest first.
+/// The fastest one becomes the default for Scenes created after this call, and for the
+/// shared `Renderer` context if it does not exist yet. The context is created once per
+/// process, so ranking after it exists warns with `RuntimeWarning` and leaves it as is.
+#[pyfunction]
+#[pyo3(signature = (force=false))]
+#[pyo3(text_signature = "(force=False)")]
+pub fn rank_adapters(py: Python<'_>, force: bool) -> PyResult<PyObject> {
+    let (ranked, saved) = py.allow_threads(|| {
+        let instance = wgpu::Instance::new(wgpu::InstanceDescriptor { backends: wgpu::Backends::all(), ..Default::default() });
+        rank(&instance, force)
+    });
+    if let Err(e) = saved {
+        return Err(pyo3::exceptions::PyRuntimeError::new_err(format!("could not write adapter cache: {}", e)));
+    }
+    if crate::WGPU_CTX.get().is_some() {
+        let category = py.get_type::<pyo3::exceptions::PyRuntimeWarning>();
+        PyErr::warn(py, &category, c"the Renderer context already exists; only new Scenes use this ranking", 1)?;
+    }
+    let out = PyList::empty(py);
+    for (_, r) in ranked {
+        let d = PyDict::new(py);
+        d.set_item("name", r.name)?;
+        d.set_item("backend", r.backend)?;
+        d.set_item("device_type", r.device_type)?;
+        d.set_item("median_ms", r.median_ms)?;
+        d.set_item("error", r.error)?;
+        d.set_item("cached", r.cached)?;
+        d.set_item("key", r.key)?;
+        out.append(d)?;
+    }
+    Ok(out.into_any().unbind())
+}
+
+/// Path of the adapter ranking cache (it may not exist yet).
+#[pyfunction]
+#[pyo3(text_signature = "()")]
+pub fn adapter_cache_path() -> Option<String> {
+    cache_path().map(|p| p.display().to_string())
+}
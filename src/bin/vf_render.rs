@@ -0,0 +1,62 @@
+//! `vf-render`: render the jobs of a JSON/TOML manifest without Python.
+//!
+//! ```text
+//! vf-render MANIFEST [--report PATH] [--depth N] [--encoders N] [--job NAME]...
+//! ```
+//! The timing report (one `perf_sanity.py`-style entry per job) goes to `--report`, or to
+//! stdout when omitted. See `vulkan_forge::scene::batch` for the manifest format.
+
+use std::path::PathBuf;
+use std::process::ExitCode;
+
+use vulkan_forge::scene::batch::{run_manifest, Overrides};
+
+const USAGE: &str = "usage: vf-render MANIFEST [--report PATH] [--depth N] [--encoders N] [--job NAME]...";
+
+fn parse_args() -> Result<(PathBuf, Option<PathBuf>, Overrides), String> {
+    let mut args = std::env::args().skip(1);
+    let mut manifest = None;
+    let mut report = None;
+    let mut overrides = Overrides::default();
+    while let Some(arg) = args.next() {
+        let mut value = |flag: &str| args.next().ok_or_else(|| format!("{} needs a value\n{}", flag, USAGE));
+        match arg.as_str() {
+            "-h" | "--help" => return Err(USAGE.to_string()),
+            "--report" => report = Some(PathBuf::from(value("--report")?)),
+            "--depth" => overrides.depth = Some(value("--depth")?.parse().map_err(|_| "--depth must be an integer".to_string())?),
+            "--encoders" => overrides.encoders = Some(value("--encoders")?.parse().map_err(|_| "--encoders must be an integer".to_string())?),
+            "--job" => overrides.only.push(value("--job")?),
+            s if s.starts_with('-') => return Err(format!("unknown option {}\n{}", s, USAGE)),
+            s if manifest.is_none() => manifest = Some(PathBuf::from(s)),
+            _ => return Err(USAGE.to_string()),
+        }
+    }
+    Ok((manifest.ok_or(USAGE)?, report, overrides))
+}
+
+fn main() -> ExitCode {
+    let (manifest, report, overrides) = match parse_args() {
+        Ok(a) => a,
+        Err(e) => {
+            eprintln!("{}", e);
+            return ExitCode::from(2);
+        }
+    };
+    let result = run_manifest(&manifest, &overrides).and_then(|rep| {
+        let text = serde_json::to_string_pretty(&rep).map_err(|e| e.to_string())?;
+        match &report {
+            Some(path) => std::fs::write(path, text).map_err(|e| format!("{}: {}", path.display(), e)),
+            None => {
+                println!("{}", text);
+                Ok(())
+            }
+        }
+    });
+    match result {
+        Ok(()) => ExitCode::SUCCESS,
+        Err(e) => {
+            eprintln!("vf-render: {}", e);
+            ExitCode::FAILURE
+        }
+    }
+}
@@ -101,7 +101,7 @@ fn mat4_to_numpy<'py>(py: Python<'py>, mat: Mat4) -> PyResult<Bound<'py, PyArray
         (0..4).map(move |col| data[col][row])
     }).collect();
     
-    let array = PyArray2::from_vec2_bound(py, &vec![
+    let array = PyArray2::from_vec2(py, &vec![
         flat[0..4].to_vec(),
         flat[4..8].to_vec(), 
         flat[8..12].to_vec(),
@@ -229,12 +229,32 @@ pub fn validate_camera_params(
     znear: f32,
     zfar: f32,
 ) -> PyResult<()> {
-    validate_vec3_finite(eye, "eye")?;
-    validate_vec3_finite(target, "target")?;
-    validate_vec3_finite(up, "up")?;
-    validate_up_not_colinear(eye, target, up)?;
-    validate_fovy(fovy_deg)?;
-    validate_near(znear)?;
-    validate_far(zfar, znear)?;
+    check_camera_params(eye, target, up, fovy_deg, znear, zfar).map_err(pyo3::exceptions::PyRuntimeError::new_err)
+}
+
+/// `validate_camera_params` with a plain message, for callers without an interpreter
+pub fn check_camera_params(
+    eye: Vec3,
+    target: Vec3,
+    up: Vec3,
+    fovy_deg: f32,
+    znear: f32,
+    zfar: f32,
+) -> Result<(), &'static str> {
+    if !eye.is_finite() || !target.is_finite() || !up.is_finite() {
+        return Err(ERROR_VECFINITE);
+    }
+    if (target - eye).normalize_or_zero().cross(up.normalize_or_zero()).length_squared() < 1e-6 {
+        return Err(ERROR_UPCOLINEAR);
+    }
+    if !fovy_deg.is_finite() || fovy_deg <= 0.0 || fovy_deg >= 180.0 {
+        return Err(ERROR_FOVY);
+    }
+    if !znear.is_finite() || znear <= 0.0 {
+        return Err(ERROR_NEAR);
+    }
+    if !zfar.is_finite() || zfar <= znear {
+        return Err(ERROR_FAR);
+    }
     Ok(())
 }
\ No newline at end of file
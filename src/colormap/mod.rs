@@ -55,6 +55,30 @@ pub fn decode_png_rgba8(name: &str) -> Result<Vec<u8>, String> {
     Ok(rgba.as_raw().clone())
 }
 
+/// ColorBrewer RdBu control points (sRGB), low → high: red for negative, blue for positive.
+const RDBU: [[u8; 3]; 11] = [
+    [0x67, 0x00, 0x1f], [0xb2, 0x18, 0x2b], [0xd6, 0x60, 0x4d], [0xf4, 0xa5, 0x82], [0xfd, 0xdb, 0xc7],
+    [0xf7, 0xf7, 0xf7],
+    [0xd1, 0xe5, 0xf0], [0x92, 0xc5, 0xde], [0x43, 0x93, 0xc3], [0x21, 0x66, 0xac], [0x05, 0x30, 0x61],
+];
+
+/// Diverging 256×1 RGBA8 (sRGB encoded) ramp for signed data such as DEM differences;
+/// entries 127/128 straddle the near-white midpoint. Not a `SUPPORTED` name (signed data only).
+pub fn diverging_rgba8() -> Vec<u8> {
+    let mut out = Vec::with_capacity(256 * 4);
+    for i in 0..256 {
+        let x = i as f32 / 255.0 * (RDBU.len() - 1) as f32;
+        let k = (x as usize).min(RDBU.len() - 2);
+        let t = x - k as f32;
+        for c in 0..3 {
+            let v = RDBU[k][c] as f32 * (1.0 - t) + RDBU[k + 1][c] as f32 * t;
+            out.push((v + 0.5) as u8);
+        }
+        out.push(255);
+    }
+    out
+}
+
 /// Convert sRGB RGBA8 bytes to linear RGBA8 (apply sRGB→linear curve to RGB channels only)
 pub fn to_linear_u8_rgba(src_srgb_rgba8: &[u8]) -> Vec<u8> {
     let mut result = Vec::with_capacity(src_srgb_rgba8.len());
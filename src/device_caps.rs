@@ -0,0 +1,128 @@
+//! Capability-aware device negotiation shared by `WgpuContext`, `Scene` and diagnostics.
+//!
+//! Instead of hard-coding `Limits::downlevel_defaults()` with no features, `negotiate`
+//! requests the adapter's own (best) limits plus every optional feature we have a fast
+//! path for. `DeviceCaps` records the outcome so render paths can branch at runtime.
+//! `request_device` falls back to the downlevel baseline if the negotiated request fails.
+//!
+//! Environment overrides (testing / debugging):
+//! - `VF_DOWNLEVEL=1`: downlevel limits and no optional features (the old behaviour)
+//! - `VF_NO_PUSH_CONSTANTS=1`: keep everything else, but use the UBO camera path
+
+use pyo3::prelude::*;
+use pyo3::types::PyDict;
+
+/// Bytes of push-constant space the terrain fast path needs (see `terrain::DrawPush`).
+pub const TERRAIN_PUSH_BYTES: u32 = 112;
+
+/// Optional features with a fast path somewhere in the crate.
+const WANTED: wgpu::Features = wgpu::Features::PUSH_CONSTANTS
+    .union(wgpu::Features::TIMESTAMP_QUERY)
+    .union(wgpu::Features::TEXTURE_FORMAT_16BIT_NORM);
+
+/// Outcome of negotiating with one adapter.
+#[derive(Debug, Clone)]
+pub struct DeviceCaps {
+    pub features: wgpu::Features,
+    pub limits: wgpu::Limits,
+    /// True when running on the downlevel baseline (forced, or negotiation failed).
+    pub downlevel: bool,
+    /// `adapter_rank::adapter_key` of the adapter negotiated with (empty for `baseline()`).
+    pub adapter: String,
+}
+
+impl DeviceCaps {
+    /// Downlevel limits, no optional features.
+    pub fn baseline() -> Self {
+        Self { features: wgpu::Features::empty(), limits: wgpu::Limits::downlevel_defaults(), downlevel: true, adapter: String::new() }
+    }
+
+    pub fn push_constants(&self) -> bool {
+        self.features.contains(wgpu::Features::PUSH_CONSTANTS)
+            && self.limits.max_push_constant_size >= TERRAIN_PUSH_BYTES
+    }
+
+    pub fn timestamp_query(&self) -> bool {
+        self.features.contains(wgpu::Features::TIMESTAMP_QUERY)
+    }
+
+    pub fn norm16_textures(&self) -> bool {
+        self.features.contains(wgpu::Features::TEXTURE_FORMAT_16BIT_NORM)
+    }
+
+    /// Named fast paths in a stable order (reported by diagnostics).
+    pub fn fast_paths(&self) -> [(&'static str, bool); 3] {
+        [
+            ("push_constants", self.push_constants()),
+            ("timestamp_query", self.timestamp_query()),
+            ("norm16_textures", self.norm16_textures()),
+        ]
+    }
+
+    /// Error text when a `width × height` 2D texture exceeds the device limit.
+    pub fn check_texture_2d(&self, width: u32, height: u32) -> Result<(), String> {
+        let max = self.limits.max_texture_dimension_2d;
+        if width > max || height > max {
+            return Err(format!(
+                "texture {}x{} exceeds this device's max_texture_dimension_2d ({}){}",
+                width, height, max,
+                if self.downlevel { "; running on downlevel limits" } else { "" }
+            ));
+        }
+        Ok(())
+    }
+
+    pub fn to_pydict<'py>(&self, py: Python<'py>) -> Bound<'py, PyDict> {
+        let d = PyDict::new(py);
+        for (name, on) in self.fast_paths() {
+            d.set_item(name, on).ok();
+        }
+        d.set_item("downlevel", self.downlevel).ok();
+        d.set_item("adapter_key", &self.adapter).ok();
+        d.set_item("max_texture_dimension_2d", self.limits.max_texture_dimension_2d).ok();
+        d.set_item("max_buffer_size", self.limits.max_buffer_size).ok();
+        d.set_item("max_storage_buffer_binding_size", self.limits.max_storage_buffer_binding_size).ok();
+        d.set_item("max_push_constant_size", self.limits.max_push_constant_size).ok();
+        d
+    }
+}
+
+fn env_on(name: &str) -> bool {
+    std::env::var(name).map(|v| v.trim() == "1").unwrap_or(false)
+}
+
+/// Best supported limits plus the wanted optional features the adapter reports.
+pub fn negotiate(adapter: &wgpu::Adapter) -> DeviceCaps {
+    let adapter_key = crate::adapter_rank::adapter_key(&adapter.get_info());
+    if env_on("VF_DOWNLEVEL") {
+        return DeviceCaps { adapter: adapter_key, ..DeviceCaps::baseline() };
+    }
+    let limits = adapter.limits();
+    let mut wanted = WANTED;
+    if env_on("VF_NO_PUSH_CONSTANTS") || limits.max_push_constant_size < TERRAIN_PUSH_BYTES {
+        wanted.remove(wgpu::Features::PUSH_CONSTANTS);
+    }
+    DeviceCaps { features: adapter.features() & wanted, limits, downlevel: false, adapter: adapter_key }
+}
+
+/// Create a device with the negotiated caps, retrying on the baseline if that fails.
+pub fn request_device(adapter: &wgpu::Adapter, label: &str)
+    -> Result<(wgpu::Device, wgpu::Queue, DeviceCaps), wgpu::RequestDeviceError> {
+    let caps = negotiate(adapter);
+    let request = |caps: &DeviceCaps| pollster::block_on(adapter.request_device(
+        &wgpu::DeviceDescriptor {
+            label: Some(label),
+            required_features: caps.features,
+            required_limits: caps.limits.clone(),
+        },
+        None,
+    ));
+    match request(&caps) {
+        Ok((device, queue)) => Ok((device, queue, caps)),
+        Err(_) if !caps.downlevel => {
+            let base = DeviceCaps { adapter: caps.adapter.clone(), ..DeviceCaps::baseline() };
+            request(&base).map(|(device, queue)| (device, queue, base))
+        }
+        Err(e) => Err(e),
+    }
+}
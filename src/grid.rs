@@ -72,6 +72,7 @@ pub fn generate_grid(nx: u32, nz: u32, spacing: (f32, f32), origin: GridOrigin)
 }
 
 #[pyfunction]
+#[pyo3(signature = (nx, nz, spacing, origin=None))]
 #[pyo3(text_signature = "(nx, nz, spacing=(1.0,1.0), origin='center')")]
 pub fn grid_generate(py: Python<'_>, nx: u32, nz: u32, spacing: (f32, f32), origin: Option<String>)
     -> pyo3::PyResult<(Bound<'_, PyArray2<f32>>, Bound<'_, PyArray2<f32>>, Bound<'_, PyArray1<u32>>)>
@@ -100,9 +101,9 @@ pub fn grid_generate(py: Python<'_>, nx: u32, nz: u32, spacing: (f32, f32), orig
     let uv_array = Array2::from_shape_vec((n_verts, 2), uv_flat)
         .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
 
-    let pos_arr = pos_array.to_pyarray_bound(py);
-    let uv_arr  = uv_array.to_pyarray_bound(py);
-    let idx_arr = PyArray1::from_vec_bound(py, mesh.indices);
+    let pos_arr = pos_array.to_pyarray(py);
+    let uv_arr  = uv_array.to_pyarray(py);
+    let idx_arr = PyArray1::from_vec(py, mesh.indices);
 
     Ok((pos_arr, uv_arr, idx_arr))
 }
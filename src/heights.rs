@@ -0,0 +1,341 @@
+//! Host-side DEM storage for `Renderer` terrain.
+//!
+//! `add_terrain` keeps a CPU copy of the heights so stats and normalization work
+//! after upload. By default that copy is full `f32`; opting into `f16` or `u16`
+//! (quantized with a per-terrain `scale`/`offset`) halves host RAM, and the
+//! compact payload uploads straight to `R16Float` / `R16Unorm` without a widening pass.
+//!
+//! Encode/decode go through `half`'s slice converters (F16C/NEON when available)
+//! or plain chunked loops that the compiler vectorizes; stats are computed on the
+//! compact form without materializing an `f32` copy.
+
+use half::f16;
+use half::slice::HalfFloatSliceExt;
+
+/// Elements converted per stack-buffer chunk when streaming compact data as `f32`.
+const CHUNK: usize = 4096;
+
+/// Requested host representation (`add_terrain(..., storage=...)`).
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum HeightStorage {
+    F32,
+    F16,
+    U16,
+}
+
+impl std::str::FromStr for HeightStorage {
+    type Err = String;
+
+    fn from_str(s: &str) -> Result<Self, String> {
+        match s.to_lowercase().as_str() {
+            "f32" | "float32" => Ok(HeightStorage::F32),
+            "f16" | "float16" => Ok(HeightStorage::F16),
+            "u16" | "uint16" => Ok(HeightStorage::U16),
+            _ => Err(format!("storage must be 'f32', 'f16' or 'u16' (got '{}')", s)),
+        }
+    }
+}
+
+impl HeightStorage {
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            HeightStorage::F32 => "f32",
+            HeightStorage::F16 => "f16",
+            HeightStorage::U16 => "u16",
+        }
+    }
+}
+
+/// What happens to the host copy once the height texture has been uploaded.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum HostPolicy {
+    Keep,
+    DropAfterUpload,
+}
+
+impl std::str::FromStr for HostPolicy {
+    type Err = String;
+
+    fn from_str(s: &str) -> Result<Self, String> {
+        match s.to_lowercase().as_str() {
+            "keep" => Ok(HostPolicy::Keep),
+            "drop_after_upload" | "drop" => Ok(HostPolicy::DropAfterUpload),
+            _ => Err(format!("host_policy must be 'keep' or 'drop_after_upload' (got '{}')", s)),
+        }
+    }
+}
+
+#[derive(Debug, Clone)]
+pub enum HostHeights {
+    F32(Vec<f32>),
+    F16(Vec<f16>),
+    /// `value = offset + q * scale`
+    U16 { data: Vec<u16>, scale: f32, offset: f32 },
+    /// Host copy freed after upload (`HostPolicy::DropAfterUpload`).
+    Dropped,
+}
+
+impl HostHeights {
+    /// Encode `src` into the requested representation. `src` is consumed so the
+    /// `f32` path does not copy. `u16` has no code for NaN / inf (nodata would silently
+    /// become the minimum), so non-finite input is rejected for it.
+    pub fn encode(src: Vec<f32>, storage: HeightStorage) -> Result<Self, String> {
+        Ok(match storage {
+            HeightStorage::F32 => HostHeights::F32(src),
+            HeightStorage::F16 => {
+                let mut out = vec![f16::ZERO; src.len()];
+                out.convert_from_f32_slice(&src);
+                HostHeights::F16(out)
+            }
+            HeightStorage::U16 => {
+                let bad = src.iter().filter(|v| !v.is_finite()).count();
+                if bad > 0 {
+                    return Err(format!("storage='u16' cannot hold non-finite heights ({} NaN/inf cells); \
+                                        fill nodata first or use 'f32' / 'f16'", bad));
+                }
+                let (lo, hi) = finite_min_max(&src);
+                let scale = if hi > lo { (hi - lo) / u16::MAX as f32 } else { 1.0 };
+                let inv = 1.0 / scale;
+                let max_q = u16::MAX as f32;
+                let data = src
+                    .iter()
+                    .map(|&v| ((v - lo) * inv + 0.5).max(0.0).min(max_q) as u16)
+                    .collect();
+                HostHeights::U16 { data, scale, offset: lo }
+            }
+        })
+    }
+
+    pub fn storage(&self) -> Option<HeightStorage> {
+        match self {
+            HostHeights::F32(_) => Some(HeightStorage::F32),
+            HostHeights::F16(_) => Some(HeightStorage::F16),
+            HostHeights::U16 { .. } => Some(HeightStorage::U16),
+            HostHeights::Dropped => None,
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        match self {
+            HostHeights::F32(v) => v.len(),
+            HostHeights::F16(v) => v.len(),
+            HostHeights::U16 { data, .. } => data.len(),
+            HostHeights::Dropped => 0,
+        }
+    }
+
+    /// Bytes currently held on the host for the heights payload.
+    pub fn host_bytes(&self) -> usize {
+        match self {
+            HostHeights::F32(v) => v.len() * 4,
+            HostHeights::F16(v) => v.len() * 2,
+            HostHeights::U16 { data, .. } => data.len() * 2,
+            HostHeights::Dropped => 0,
+        }
+    }
+
+    /// Stream the heights as `f32` chunks without allocating a full copy.
+    pub fn for_each_chunk<F: FnMut(&[f32])>(&self, mut f: F) {
+        match self {
+            HostHeights::F32(v) => {
+                for c in v.chunks(CHUNK) {
+                    f(c);
+                }
+            }
+            HostHeights::F16(v) => {
+                let mut buf = [0f32; CHUNK];
+                for c in v.chunks(CHUNK) {
+                    let dst = &mut buf[..c.len()];
+                    c.convert_to_f32_slice(dst);
+                    f(dst);
+                }
+            }
+            HostHeights::U16 { data, scale, offset } => {
+                let mut buf = [0f32; CHUNK];
+                for c in data.chunks(CHUNK) {
+                    let dst = &mut buf[..c.len()];
+                    for (d, &q) in dst.iter_mut().zip(c) {
+                        *d = *offset + q as f32 * *scale;
+                    }
+                    f(dst);
+                }
+            }
+            HostHeights::Dropped => {}
+        }
+    }
+
+    /// Full `f32` copy (used by the `R32Float` upload path and normalization of `f16`).
+    pub fn decode(&self) -> Vec<f32> {
+        if let HostHeights::F32(v) = self {
+            return v.clone();
+        }
+        let mut out = Vec::with_capacity(self.len());
+        self.for_each_chunk(|c| out.extend_from_slice(c));
+        out
+    }
+
+    /// min / max / mean / std computed directly on the stored representation.
+    pub fn stats(&self) -> Option<crate::DemStats> {
+        match self {
+            HostHeights::Dropped => None,
+            HostHeights::F32(v) => Some(crate::dem_stats_from_slice(v)),
+            HostHeights::U16 { data, scale, offset } => Some(u16_stats(data, *scale, *offset)),
+            HostHeights::F16(_) => {
+                let n = self.len();
+                if n == 0 {
+                    return Some(crate::DemStats { min: 0.0, max: 0.0, mean: 0.0, std: 0.0 });
+                }
+                let (mut min, mut max, mut sum) = (f32::INFINITY, f32::NEG_INFINITY, 0.0f64);
+                self.for_each_chunk(|c| {
+                    for &h in c {
+                        if h < min { min = h; }
+                        if h > max { max = h; }
+                        sum += h as f64;
+                    }
+                });
+                let mean = sum / n as f64;
+                let mut var = 0.0f64;
+                self.for_each_chunk(|c| {
+                    for &h in c {
+                        let d = h as f64 - mean;
+                        var += d * d;
+                    }
+                });
+                let std = (var / n as f64).sqrt();
+                Some(crate::DemStats { min, max, mean: mean as f32, std: std as f32 })
+            }
+        }
+    }
+
+    /// Apply min-max / z-score normalization in place.
+    /// `u16` is an affine re-parameterization (scale/offset only, data untouched);
+    /// `f16` round-trips through `f32` chunks.
+    pub fn normalize(&mut self, mode: crate::NormalizeMode, eps: f32, range: (f32, f32), stats: &crate::DemStats) {
+        let (a, b) = match mode {
+            crate::NormalizeMode::MinMax => {
+                let (lo, hi) = range;
+                let s = (hi - lo) / (stats.max - stats.min).abs().max(eps);
+                (s, lo - stats.min * s)
+            }
+            crate::NormalizeMode::ZScore => {
+                let s = 1.0 / stats.std.max(eps);
+                (s, -stats.mean * s)
+            }
+        };
+        match self {
+            HostHeights::F32(v) => crate::normalize_in_place(v, mode, eps, range, stats),
+            HostHeights::U16 { scale, offset, .. } => {
+                *offset = *offset * a + b;
+                *scale *= a;
+            }
+            HostHeights::F16(v) => {
+                let mut buf = [0f32; CHUNK];
+                for c in v.chunks_mut(CHUNK) {
+                    let tmp = &mut buf[..c.len()];
+                    c.convert_to_f32_slice(tmp);
+                    for x in tmp.iter_mut() {
+                        *x = *x * a + b;
+                    }
+                    c.convert_from_f32_slice(tmp);
+                }
+            }
+            HostHeights::Dropped => {}
+        }
+    }
+}
+
+fn finite_min_max(v: &[f32]) -> (f32, f32) {
+    let (mut lo, mut hi) = (f32::INFINITY, f32::NEG_INFINITY);
+    for &x in v {
+        if x.is_finite() {
+            lo = lo.min(x);
+            hi = hi.max(x);
+        }
+    }
+    if lo > hi { (0.0, 0.0) } else { (lo, hi) }
+}
+
+fn u16_stats(data: &[u16], scale: f32, offset: f32) -> crate::DemStats {
+    if data.is_empty() {
+        return crate::DemStats { min: 0.0, max: 0.0, mean: 0.0, std: 0.0 };
+    }
+    let (mut qmin, mut qmax) = (u16::MAX, 0u16);
+    let (mut sum, mut sum_sq) = (0u64, 0u128);
+    for c in data.chunks(CHUNK) {
+        // Integer accumulation per chunk keeps the loop branch-free and exact.
+        let mut s = 0u64;
+        let mut s2 = 0u64;
+        for &q in c {
+            qmin = qmin.min(q);
+            qmax = qmax.max(q);
+            s += q as u64;
+            s2 += (q as u64) * (q as u64);
+        }
+        sum += s;
+        sum_sq += s2 as u128;
+    }
+    let n = data.len() as f64;
+    let mean_q = sum as f64 / n;
+    let var_q = (sum_sq as f64 / n - mean_q * mean_q).max(0.0);
+    let scale = scale as f64;
+    let offset = offset as f64;
+    crate::DemStats {
+        min: (offset + qmin as f64 * scale) as f32,
+        max: (offset + qmax as f64 * scale) as f32,
+        mean: (offset + mean_q * scale) as f32,
+        std: (var_q.sqrt() * scale.abs()) as f32,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn ramp(n: usize) -> Vec<f32> {
+        (0..n).map(|i| -10.0 + 60.0 * i as f32 / (n - 1) as f32).collect()
+    }
+
+    #[test]
+    fn u16_roundtrip_within_one_step() {
+        let src = ramp(10_000);
+        let h = HostHeights::encode(src.clone(), HeightStorage::U16).unwrap();
+        let step = 60.0 / u16::MAX as f32;
+        for (a, b) in src.iter().zip(h.decode()) {
+            assert!((a - b).abs() <= step, "{} vs {}", a, b);
+        }
+        assert_eq!(h.host_bytes(), src.len() * 2);
+    }
+
+    #[test]
+    fn compact_stats_match_f32() {
+        let src = ramp(5_000);
+        let want = crate::dem_stats_from_slice(&src);
+        for storage in [HeightStorage::F16, HeightStorage::U16] {
+            let got = HostHeights::encode(src.clone(), storage).unwrap().stats().unwrap();
+            assert!((got.min - want.min).abs() < 0.05);
+            assert!((got.max - want.max).abs() < 0.05);
+            assert!((got.mean - want.mean).abs() < 0.05);
+            assert!((got.std - want.std).abs() / want.std < 1e-3);
+        }
+    }
+
+    #[test]
+    fn u16_normalize_is_affine() {
+        let src = ramp(1_000);
+        let mut h = HostHeights::encode(src, HeightStorage::U16).unwrap();
+        let stats = h.stats().unwrap();
+        h.normalize(crate::NormalizeMode::MinMax, 1e-8, (10.0, 20.0), &stats);
+        let s = h.stats().unwrap();
+        assert!((s.min - 10.0).abs() < 1e-3 && (s.max - 20.0).abs() < 1e-3);
+    }
+
+    #[test]
+    fn u16_rejects_non_finite_heights() {
+        let mut src = ramp(100);
+        src[7] = f32::NAN;
+        src[42] = f32::INFINITY;
+        let err = HostHeights::encode(src.clone(), HeightStorage::U16).unwrap_err();
+        assert!(err.contains("2 NaN/inf"), "{err}");
+        assert!(HostHeights::encode(src, HeightStorage::F16).is_ok());
+    }
+}
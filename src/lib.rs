@@ -1,5 +1,6 @@
 //! Headless renderer for a deterministic triangle with off-screen target + readback.
-//! Rust: wgpu 0.19, PyO3 0.21 (abi3). Returns (H,W,4) u8 arrays via numpy.
+//! Rust: wgpu 0.19, PyO3 0.23 (abi3, or version-specific for free-threaded CPython).
+//! Returns (H,W,4) u8 arrays via numpy.
 
 use std::num::NonZeroU32;
 
@@ -10,6 +11,7 @@ use pyo3::prelude::*;
 use pyo3::Bound;
 use numpy::{PyArray3, IntoPyArray, PyArray2, PyReadonlyArray2, PyArray1};
 use numpy::PyUntypedArrayMethods; // needed for contiguous checks
+use numpy::PyArrayMethods;
 use ndarray::Array3;
 use wgpu::util::DeviceExt;
 use pyo3::types::{PyDict, PyList};
@@ -25,6 +27,9 @@ static WGPU_CTX: OnceCell<WgpuContext> = OnceCell::new();
 struct WgpuContext {
     device: wgpu::Device,
     queue: wgpu::Queue,
+    caps: device_caps::DeviceCaps,
+    /// Compute pipeline of `procedural_dem(device='gpu')`, built on first use.
+    procgen: OnceCell<terrain::procgen::ProcgenGpu>,
 }
 
 impl WgpuContext {
@@ -35,27 +40,14 @@ impl WgpuContext {
                 ..Default::default()
             });
 
-            let adapter = pollster::block_on(instance.request_adapter(&wgpu::RequestAdapterOptions {
-                power_preference: wgpu::PowerPreference::HighPerformance,
-                compatible_surface: None,
-                force_fallback_adapter: false,
-            }))
-            .expect("No suitable GPU adapter");
-
-            let needed_features = wgpu::Features::empty();
-            let limits = wgpu::Limits::downlevel_defaults();
-
-            let (device, queue) = pollster::block_on(adapter.request_device(
-                &wgpu::DeviceDescriptor {
-                    required_features: needed_features,
-                    required_limits: limits,
-                    label: Some("vulkan-forge-device"),
-                },
-                None,
-            ))
-            .expect("request_device failed");
+            // Fastest benchmarked adapter when a ranking is cached (see adapter_rank).
+            let adapter = adapter_rank::preferred_adapter(&instance).expect("No suitable GPU adapter");
+
+            // Best supported limits + optional fast-path features (see device_caps).
+            let (device, queue, caps) = device_caps::request_device(&adapter, "vulkan-forge-device")
+                .expect("request_device failed");
 
-            Self { device, queue }
+            Self { device, queue, caps, procgen: OnceCell::new() }
         })
     }
 }
@@ -225,7 +217,7 @@ pub struct Renderer {
     color_view: wgpu::TextureView,
     readback_buf: wgpu::Buffer,
     readback_size: u64,
-    pipeline: wgpu::RenderPipeline,
+    pipeline: &'static wgpu::RenderPipeline,
     vbuf: wgpu::Buffer,
     ibuf: wgpu::Buffer,
     icount: u32,
@@ -234,6 +226,8 @@ pub struct Renderer {
     height_tex: Option<wgpu::Texture>,
     height_view: Option<wgpu::TextureView>,
     height_sampler: Option<wgpu::Sampler>,
+    /// `(scale, offset)` for an `R16Unorm` height texture holding quantized `u16` codes.
+    height_dequant: Option<(f32, f32)>,
     // T22-BEGIN:sun-and-exposure
     #[cfg(feature = "terrain_spike")]
     globals: terrain::Globals,
@@ -249,7 +243,8 @@ impl Renderer {
     /// Create a headless renderer.
     pub fn new(width: u32, height: u32) -> Self {
         let ctx = WgpuContext::get();
-        let pipeline = create_pipeline(&ctx.device, TEXTURE_FORMAT);
+        // Compiled once per process; may already be ready if `warmup()` ran.
+        let pipeline = warmup::triangle_pipeline();
         let (vbuf, ibuf, icount) = triangle_geometry(&ctx.device);
         let (color_tex, color_view) = create_offscreen(&ctx.device, width, height, TEXTURE_FORMAT);
         let readback_buf = ctx.device.create_buffer(&wgpu::BufferDescriptor {
@@ -269,6 +264,7 @@ impl Renderer {
             height_tex: None,
             height_view: None,
             height_sampler: None,
+            height_dequant: None,
             // T22-BEGIN:sun-and-exposure
             #[cfg(feature = "terrain_spike")]
             globals: terrain::Globals::default(),
@@ -305,7 +301,7 @@ impl Renderer {
         let arr3 = Array3::from_shape_vec(
             (self.height as usize, self.width as usize, 4), pixels
         ).map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
-        Ok(arr3.into_pyarray_bound(py))
+        Ok(arr3.into_pyarray(py))
     }
 
     #[pyo3(text_signature = "($self, path)")]
@@ -333,14 +329,26 @@ impl Renderer {
         Ok(())
     }
 
-    #[pyo3(text_signature = "($self, heightmap, spacing, exaggeration=1.0, *, colormap='viridis')")]
+    /// `storage` selects the host copy: `'f32'` (default), `'f16'` or `'u16'` (quantized with
+    /// scale/offset; NaN or inf heights raise `ValueError`). `host_policy='drop_after_upload'`
+    /// frees the host copy once the height texture is uploaded; stats stay available,
+    /// normalization does not.
+    #[pyo3(signature = (heightmap, spacing, exaggeration, colormap, *, storage=None, host_policy=None))]
+    #[pyo3(text_signature = "($self, heightmap, spacing, exaggeration, colormap, *, storage='f32', host_policy='keep')")]
     pub fn add_terrain(
         &mut self,
-        heightmap: &PyAny,
+        heightmap: &Bound<'_, PyAny>,
         spacing: (f32, f32),
         exaggeration: f32,
         colormap: String,
+        storage: Option<&str>,
+        host_policy: Option<&str>,
     ) -> pyo3::PyResult<()> {
+        let storage = storage.unwrap_or("f32").parse::<heights::HeightStorage>()
+            .map_err(pyo3::exceptions::PyValueError::new_err)?;
+        let host_policy = host_policy.unwrap_or("keep").parse::<heights::HostPolicy>()
+            .map_err(pyo3::exceptions::PyValueError::new_err)?;
+
         if spacing.0 <= 0.0 || spacing.1 <= 0.0 {
             return Err(pyo3::exceptions::PyRuntimeError::new_err("spacing components must be > 0"));
         }
@@ -349,7 +357,7 @@ impl Renderer {
         }
 
         let as_f32: Result<(Vec<f32>, usize, usize), pyo3::PyErr> = (|| {
-            let arr32: &PyArray2<f32> = heightmap.downcast()?;
+            let arr32 = heightmap.downcast::<PyArray2<f32>>()?;
             let ro32: PyReadonlyArray2<f32> = arr32.readonly();
 
             if !ro32.is_c_contiguous() {
@@ -367,8 +375,8 @@ impl Renderer {
         let (heights, width, height) = match as_f32 {
             Ok(ok) => ok,
             Err(_) => {
-                let arr64: &PyArray2<f64> = heightmap
-                    .downcast()
+                let arr64 = heightmap
+                    .downcast::<PyArray2<f64>>()
                     .map_err(|_| pyo3::exceptions::PyRuntimeError::new_err(
                         "heightmap must be a 2-D NumPy array of dtype float32 or float64"
                     ))?;
@@ -408,6 +416,8 @@ impl Renderer {
         }
         // T33-END:colormap-validation
 
+        let heights = heights::HostHeights::encode(heights, storage)
+            .map_err(pyo3::exceptions::PyValueError::new_err)?;
         self.terrain = Some(TerrainData {
             width: width as u32,
             height: height as u32,
@@ -415,6 +425,8 @@ impl Renderer {
             exaggeration,
             colormap,
             heights,
+            host_policy,
+            dropped_stats: None,
         });
 
         Ok(())
@@ -424,11 +436,32 @@ impl Renderer {
     pub fn terrain_stats(&self) -> pyo3::PyResult<(f32, f32, f32, f32)> {
         let terr = self.terrain.as_ref()
             .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("no terrain uploaded; call add_terrain() first"))?;
-        let stats = dem_stats_from_slice(&terr.heights);
+        let stats = terr.heights.stats()
+            .or_else(|| terr.dropped_stats.clone())
+            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("host heights were dropped after upload"))?;
         Ok((stats.min, stats.max, stats.mean, stats.std))
     }
 
-    /// Override the height normalization range used for color & lighting.
+    /// Bytes held on the host for the terrain heights (0 after a drop-after-upload).
+    #[pyo3(text_signature = "($self)")]
+    pub fn host_height_bytes(&self) -> usize {
+        self.terrain.as_ref().map(|t| t.heights.host_bytes()).unwrap_or(0)
+    }
+
+    /// Depression filling, flow direction and flow accumulation of the uploaded terrain
+    /// heights; see the module-level `hydrology` for the arguments and result.
+    #[pyo3(signature = (method="d8", fill=true, tile=512, threads=None))]
+    #[pyo3(text_signature = "($self, method='d8', fill=True, tile=512, threads=None)")]
+    pub fn hydrology(&self, py: Python<'_>, method: &str, fill: bool, tile: usize, threads: Option<usize>) -> PyResult<PyObject> {
+        let terr = self.terrain.as_ref()
+            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("no terrain uploaded; call add_terrain() first"))?;
+        if terr.heights.stats().is_none() {
+            return Err(pyo3::exceptions::PyRuntimeError::new_err("host heights were dropped after upload"));
+        }
+        let dem = terr.heights.decode();
+        hydrology_dict(py, &dem, terr.height as usize, terr.width as usize, method, fill, tile, threads)
+    }
+
     /// Raises `ValueError` if `min >= max`.
     // T02-BEGIN:set-height-range-python
     #[pyo3(text_signature = "($self, min, max)")]
@@ -474,6 +507,7 @@ impl Renderer {
     }
     // T22-END:sun-and-exposure
 
+    #[pyo3(signature = (mode, range=None, eps=None))]
     #[pyo3(text_signature = "($self, mode, range=None, eps=1e-8)")]
     pub fn normalize_terrain(&mut self, mode: &str, range: Option<(f32, f32)>, eps: Option<f32>) -> pyo3::PyResult<()> {
         let terr = self.terrain.as_mut()
@@ -487,87 +521,30 @@ impl Renderer {
         let eps = eps.unwrap_or(1e-8_f32);
         let range = range.unwrap_or((0.0, 1.0));
 
-        let stats = dem_stats_from_slice(&terr.heights);
-        normalize_in_place(&mut terr.heights, mode, eps, range, &stats);
+        let stats = terr.heights.stats().ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err(
+            "host heights were dropped after upload; re-add the terrain to normalize"))?;
+        terr.heights.normalize(mode, eps, range, &stats);
         Ok(())
     }
 
+    /// Upload heights as `R32Float` (compact host storage is widened on the fly).
     #[pyo3(text_signature = "($self)")]
     pub fn upload_height_r32f(&mut self) -> pyo3::PyResult<()> {
-        let ctx = WgpuContext::get();
-
-        let terr = self.terrain.as_ref()
-            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("no terrain uploaded; call add_terrain() first"))?;
-
-        let width = terr.width;
-        let height = terr.height;
-        if width == 0 || height == 0 {
-            return Err(pyo3::exceptions::PyRuntimeError::new_err("terrain dimensions are zero"));
-        }
-
-        let tex = ctx.device.create_texture(&wgpu::TextureDescriptor {
-            label: Some("terrain-height-r32f"),
-            size: wgpu::Extent3d { width, height, depth_or_array_layers: 1 },
-            mip_level_count: 1,
-            sample_count: 1,
-            dimension: wgpu::TextureDimension::D2,
-            format: wgpu::TextureFormat::R32Float,
-            usage: wgpu::TextureUsages::TEXTURE_BINDING | wgpu::TextureUsages::COPY_DST | wgpu::TextureUsages::COPY_SRC,
-            view_formats: &[],
-        });
-        let view = tex.create_view(&wgpu::TextureViewDescriptor::default());
-        let samp = ctx.device.create_sampler(&wgpu::SamplerDescriptor {
-            label: Some("terrain-height-sampler"),
-            address_mode_u: wgpu::AddressMode::ClampToEdge,
-            address_mode_v: wgpu::AddressMode::ClampToEdge,
-            address_mode_w: wgpu::AddressMode::ClampToEdge,
-            mag_filter: wgpu::FilterMode::Nearest,
-            min_filter: wgpu::FilterMode::Nearest,
-            mipmap_filter: wgpu::FilterMode::Nearest,
-            ..Default::default()
-        });
-
-        // Build temporary padded upload buffer for 256-byte row alignment
-        let row_bytes = width * 4;
-        let padded_bpr = ((row_bytes + 255) / 256) * 256;
-        
-        // Create padded buffer
-        let padded_data = {
-            let mut data = vec![0u8; (padded_bpr * height) as usize];
-            let input_data = bytemuck::cast_slice::<f32, u8>(&terr.heights);
-            
-            for y in 0..height {
-                let src_offset = (y * row_bytes) as usize;
-                let dst_offset = (y * padded_bpr) as usize;
-                let src_end = src_offset + row_bytes as usize;
-                let dst_end = dst_offset + row_bytes as usize;
-                
-                data[dst_offset..dst_end].copy_from_slice(&input_data[src_offset..src_end]);
-            }
-            data
-        };
+        self.upload_height_texture(false)
+    }
 
-        ctx.queue.write_texture(
-            wgpu::ImageCopyTexture {
-                texture: &tex,
-                mip_level: 0,
-                origin: wgpu::Origin3d::ZERO,
-                aspect: wgpu::TextureAspect::All,
-            },
-            &padded_data,
-            wgpu::ImageDataLayout {
-                offset: 0,
-                bytes_per_row: Some(NonZeroU32::new(padded_bpr).unwrap().into()),
-                rows_per_image: Some(NonZeroU32::new(height).unwrap().into()),
-            },
-            wgpu::Extent3d { width, height, depth_or_array_layers: 1 },
-        );
-        ctx.device.poll(wgpu::Maintain::Wait);
+    /// Upload heights in the host storage's native format: `R32Float` for `f32`,
+    /// `R16Float` for `f16`, `R16Unorm` for `u16` (falls back to `R32Float` when the
+    /// device lacks 16-bit normalized textures).
+    #[pyo3(text_signature = "($self)")]
+    pub fn upload_height(&mut self) -> pyo3::PyResult<()> {
+        self.upload_height_texture(true)
+    }
 
-        self.height_tex = Some(tex);
-        self.height_view = Some(view);
-        self.height_sampler = Some(samp);
-        Ok(())
+    /// Format of the uploaded height texture, e.g. `"R16Float"`; `None` before upload.
+    #[pyo3(text_signature = "($self)")]
+    pub fn height_texture_format(&self) -> Option<String> {
+        self.height_tex.as_ref().map(|t| format!("{:?}", t.format()))
     }
 
     #[pyo3(text_signature = "($self, x, y, w, h)")]
@@ -583,7 +560,7 @@ impl Renderer {
                 .chunks_exact(w as usize)
                 .map(|row| row.to_vec())
                 .collect();
-            let out = numpy::PyArray2::<f32>::from_vec2_bound(py, &rows)?;
+            let out = numpy::PyArray2::<f32>::from_vec2(py, &rows)?;
             return Ok(out);
         }
 
@@ -603,7 +580,9 @@ impl Renderer {
             )));
         }
 
-        let row_bytes = (w * 4) as u32;
+        let format = tex.format();
+        let texel_bytes = if format == wgpu::TextureFormat::R32Float { 4 } else { 2 };
+        let row_bytes = (w * texel_bytes) as u32;
         let padded_bpr = ((row_bytes + 255) / 256) * 256;
         let buf_size = padded_bpr as u64 * h as u64;
         let readback = ctx.device.create_buffer(&wgpu::BufferDescriptor {
@@ -656,12 +635,18 @@ impl Renderer {
         drop(data);
         readback.unmap();
 
-        let floats: &[f32] = bytemuck::cast_slice(&out);
+        let floats: Vec<f32> = match (format, self.height_dequant) {
+            (wgpu::TextureFormat::R16Float, _) => bytemuck::cast_slice::<u8, u16>(&out)
+                .iter().map(|&b| half::f16::from_bits(b).to_f32()).collect(),
+            (wgpu::TextureFormat::R16Unorm, Some((scale, offset))) => bytemuck::cast_slice::<u8, u16>(&out)
+                .iter().map(|&q| offset + q as f32 * scale).collect(),
+            _ => bytemuck::cast_slice::<u8, f32>(&out).to_vec(),
+        };
         let rows: Vec<Vec<f32>> = floats
             .chunks_exact(w as usize)
             .map(|row| row.to_vec())
             .collect();
-        let arr = numpy::PyArray2::<f32>::from_vec2_bound(py, &rows)?;
+        let arr = numpy::PyArray2::<f32>::from_vec2(py, &rows)?;
         Ok(arr)
     }
 
@@ -682,6 +667,109 @@ impl Renderer {
 }
 
 impl Renderer {
+    fn upload_height_texture(&mut self, native: bool) -> pyo3::PyResult<()> {
+        use heights::HostHeights;
+        let ctx = WgpuContext::get();
+
+        let terr = self.terrain.as_mut()
+            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("no terrain uploaded; call add_terrain() first"))?;
+
+        let width = terr.width;
+        let height = terr.height;
+        if width == 0 || height == 0 {
+            return Err(pyo3::exceptions::PyRuntimeError::new_err("terrain dimensions are zero"));
+        }
+        if matches!(terr.heights, HostHeights::Dropped) {
+            return Err(pyo3::exceptions::PyRuntimeError::new_err(
+                "host heights were dropped after upload; re-add the terrain to upload again"));
+        }
+
+        ctx.caps.check_texture_2d(width, height).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let norm16 = ctx.caps.norm16_textures();
+        let decoded: Vec<f32>;
+        let (format, texel_bytes, input_data, dequant): (wgpu::TextureFormat, u32, &[u8], Option<(f32, f32)>) =
+            match (&terr.heights, native) {
+                (HostHeights::F32(v), _) => (wgpu::TextureFormat::R32Float, 4, bytemuck::cast_slice(v), None),
+                (HostHeights::F16(v), true) => (wgpu::TextureFormat::R16Float, 2, bytemuck::cast_slice(v), None),
+                (HostHeights::U16 { data, scale, offset }, true) if norm16 => {
+                    (wgpu::TextureFormat::R16Unorm, 2, bytemuck::cast_slice(data), Some((*scale, *offset)))
+                }
+                _ => {
+                    decoded = terr.heights.decode();
+                    (wgpu::TextureFormat::R32Float, 4, bytemuck::cast_slice(&decoded), None)
+                }
+            };
+
+        let tex = ctx.device.create_texture(&wgpu::TextureDescriptor {
+            label: Some("terrain-height"),
+            size: wgpu::Extent3d { width, height, depth_or_array_layers: 1 },
+            mip_level_count: 1,
+            sample_count: 1,
+            dimension: wgpu::TextureDimension::D2,
+            format,
+            usage: wgpu::TextureUsages::TEXTURE_BINDING | wgpu::TextureUsages::COPY_DST | wgpu::TextureUsages::COPY_SRC,
+            view_formats: &[],
+        });
+        let view = tex.create_view(&wgpu::TextureViewDescriptor::default());
+        let samp = ctx.device.create_sampler(&wgpu::SamplerDescriptor {
+            label: Some("terrain-height-sampler"),
+            address_mode_u: wgpu::AddressMode::ClampToEdge,
+            address_mode_v: wgpu::AddressMode::ClampToEdge,
+            address_mode_w: wgpu::AddressMode::ClampToEdge,
+            mag_filter: wgpu::FilterMode::Nearest,
+            min_filter: wgpu::FilterMode::Nearest,
+            mipmap_filter: wgpu::FilterMode::Nearest,
+            ..Default::default()
+        });
+
+        // Build temporary padded upload buffer for 256-byte row alignment
+        let row_bytes = width * texel_bytes;
+        let padded_bpr = ((row_bytes + 255) / 256) * 256;
+
+        // Create padded buffer
+        let padded_data = {
+            let mut data = vec![0u8; (padded_bpr * height) as usize];
+
+            for y in 0..height {
+                let src_offset = (y * row_bytes) as usize;
+                let dst_offset = (y * padded_bpr) as usize;
+                let src_end = src_offset + row_bytes as usize;
+                let dst_end = dst_offset + row_bytes as usize;
+
+                data[dst_offset..dst_end].copy_from_slice(&input_data[src_offset..src_end]);
+            }
+            data
+        };
+
+        ctx.queue.write_texture(
+            wgpu::ImageCopyTexture {
+                texture: &tex,
+                mip_level: 0,
+                origin: wgpu::Origin3d::ZERO,
+                aspect: wgpu::TextureAspect::All,
+            },
+            &padded_data,
+            wgpu::ImageDataLayout {
+                offset: 0,
+                bytes_per_row: Some(NonZeroU32::new(padded_bpr).unwrap().into()),
+                rows_per_image: Some(NonZeroU32::new(height).unwrap().into()),
+            },
+            wgpu::Extent3d { width, height, depth_or_array_layers: 1 },
+        );
+        ctx.device.poll(wgpu::Maintain::Wait);
+
+        if terr.host_policy == heights::HostPolicy::DropAfterUpload {
+            terr.dropped_stats = terr.heights.stats();
+            terr.heights = HostHeights::Dropped;
+        }
+
+        self.height_tex = Some(tex);
+        self.height_view = Some(view);
+        self.height_sampler = Some(samp);
+        self.height_dequant = dequant;
+        Ok(())
+    }
+
     fn render_into_offscreen(&mut self, ctx: &WgpuContext) -> PyResult<()> {
         let size = self.color_tex.size();
         if size.width != self.width || size.height != self.height || self.color_tex.format() != TEXTURE_FORMAT {
@@ -760,10 +848,10 @@ fn enumerate_adapters(py: Python<'_>) -> PyResult<PyObject> {
         }
     }
 
-    let out = PyList::empty_bound(py);
+    let out = PyList::empty(py);
     for ad in adapters {
         let info = ad.get_info();
-        let d = PyDict::new_bound(py);
+        let d = PyDict::new(py);
         d.set_item("name", info.name).ok();
         d.set_item("backend", backend_str(info.backend)).ok();
         d.set_item("device_type", devtype_str(info.device_type)).ok();
@@ -771,12 +859,14 @@ fn enumerate_adapters(py: Python<'_>) -> PyResult<PyObject> {
         d.set_item("device_id", info.device as u32).ok();
         d.set_item("features", format!("{:?}", ad.features())).ok();
         d.set_item("limits", format!("{:?}", ad.limits())).ok();
+        d.set_item("negotiated", device_caps::negotiate(&ad).to_pydict(py)).ok();
         out.append(d).ok();
     }
     Ok(out.into_any().unbind())
 }
 
 #[pyfunction]
+#[pyo3(signature = (backend=None))]
 #[pyo3(text_signature = "(backend=None)")]
 fn device_probe(py: Python<'_>, backend: Option<String>) -> PyResult<PyObject> {
     use std::time::Instant;
@@ -792,7 +882,7 @@ fn device_probe(py: Python<'_>, backend: Option<String>) -> PyResult<PyObject> {
 
     let inst = wgpu::Instance::new(wgpu::InstanceDescriptor { backends, ..Default::default() });
 
-    let dict = PyDict::new_bound(py);
+    let dict = PyDict::new(py);
     dict.set_item("backend_request", b.clone()).ok();
 
     let t0 = Instant::now();
@@ -820,17 +910,11 @@ fn device_probe(py: Python<'_>, backend: Option<String>) -> PyResult<PyObject> {
     dict.set_item("features", format!("{:?}", adapter.features())).ok();
     dict.set_item("limits", format!("{:?}", adapter.limits())).ok();
 
-    let needed_features = wgpu::Features::empty();
-    let limits = wgpu::Limits::downlevel_defaults();
-    let (_device, _queue) = match pollster::block_on(adapter.request_device(
-        &wgpu::DeviceDescriptor{
-            required_features: needed_features,
-            required_limits: limits,
-            label: Some("diag-device"),
-        },
-        None,
-    )) {
-        Ok(pair) => pair,
+    let (_device, _queue) = match device_caps::request_device(&adapter, "diag-device") {
+        Ok((device, queue, caps)) => {
+            dict.set_item("negotiated", caps.to_pydict(py)).ok();
+            (device, queue)
+        }
         Err(e) => {
             dict.set_item("status", "error").ok();
             dict.set_item("message", format!("request_device failed: {}", e)).ok();
@@ -866,6 +950,10 @@ pub use terrain::{TerrainUniforms, Globals};
 // mod grid; // T11: disabled - grid_generate moved to terrain::mesh
 mod terrain_stats;
 mod renderer;
+mod heights;
+mod device_caps;
+mod warmup;
+mod adapter_rank;
 
 #[derive(Clone)]
 struct TerrainData {
@@ -875,7 +963,10 @@ struct TerrainData {
     exaggeration: f32,
     colormap: String,
     /// Row-major, length = width*height, units = heightmap * exaggeration
-    heights: Vec<f32>,
+    heights: heights::HostHeights,
+    host_policy: heights::HostPolicy,
+    /// Stats captured when the host copy is dropped after upload.
+    dropped_stats: Option<DemStats>,
 }
 
 #[derive(Debug, Clone)]
@@ -951,6 +1042,7 @@ fn normalize_in_place(heights: &mut [f32], mode: NormalizeMode, eps: f32, range:
 }
 
 #[pyfunction]
+#[pyo3(signature = (nx, nz, spacing, origin=None))]
 #[pyo3(text_signature = "(nx, nz, spacing=(1.0,1.0), origin='center')")]
 fn grid_generate(py: Python<'_>, nx: u32, nz: u32, spacing: (f32, f32), origin: Option<String>)
     -> PyResult<(Bound<'_, PyArray2<f32>>, Bound<'_, PyArray2<f32>>, Bound<'_, PyArray1<u32>>)>
@@ -958,16 +1050,321 @@ fn grid_generate(py: Python<'_>, nx: u32, nz: u32, spacing: (f32, f32), origin:
     terrain::mesh::grid_generate(py, nx, nz, spacing, origin)
 }
 
-#[allow(deprecated)]
-#[pymodule]
-fn _vulkan_forge(_py: Python<'_>, m: &PyModule) -> PyResult<()> {
+/// Negotiated fast paths and key limits of the shared device (`Renderer`, `procedural_dem`).
+#[pyfunction]
+#[pyo3(text_signature = "()")]
+fn context_caps(py: Python<'_>) -> PyResult<PyObject> {
+    Ok(WgpuContext::get().caps.to_pydict(py).into_any().unbind())
+}
+
+/// Seeded procedural DEM (fBm / ridged / eroded value noise) as a `(height, width)` float32 array.
+/// `device='gpu'` runs the compute-kernel twin on the shared device (pipeline built once) and
+/// reads it back; both paths release the GIL.
+#[pyfunction]
+#[pyo3(signature = (width, height, kind="fbm", seed=0, octaves=6, frequency=4.0, lacunarity=2.0, gain=0.5, amplitude=1.0, device="cpu"))]
+#[pyo3(text_signature = "(width, height, kind='fbm', seed=0, octaves=6, frequency=4.0, lacunarity=2.0, gain=0.5, amplitude=1.0, device='cpu')")]
+fn procedural_dem<'py>(
+    py: Python<'py>,
+    width: u32,
+    height: u32,
+    kind: &str,
+    seed: u32,
+    octaves: u32,
+    frequency: f32,
+    lacunarity: f32,
+    gain: f32,
+    amplitude: f32,
+    device: &str,
+) -> PyResult<Bound<'py, PyArray2<f32>>> {
+    use terrain::procgen;
+    if width == 0 || height == 0 {
+        return Err(pyo3::exceptions::PyValueError::new_err("width and height must be > 0"));
+    }
+    let kind = kind.parse::<procgen::NoiseKind>().map_err(pyo3::exceptions::PyValueError::new_err)?;
+    let params = procgen::ProcParams::new(width, height, kind, seed, octaves, frequency, lacunarity, gain, amplitude);
+
+    let heights = match device.to_lowercase().as_str() {
+        "cpu" => py.allow_threads(|| procgen::generate_cpu(&params)),
+        "gpu" => {
+            let ctx = py.allow_threads(WgpuContext::get);
+            ctx.caps.check_texture_2d(width, height).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+            py.allow_threads(|| {
+                let gpu = ctx.procgen.get_or_init(|| procgen::ProcgenGpu::new(&ctx.device));
+                let tex = procgen::create_height_target(&ctx.device, width, height);
+                let view = tex.create_view(&wgpu::TextureViewDescriptor::default());
+                let mut encoder = ctx.device.create_command_encoder(&wgpu::CommandEncoderDescriptor {
+                    label: Some("procgen-encoder"),
+                });
+                gpu.encode(&ctx.device, &mut encoder, &view, &params);
+                ctx.queue.submit([encoder.finish()]);
+
+                // R32Float rows are 4 bytes/texel, same as RGBA8, so the RGBA unpadding path applies.
+                let readback = ctx.device.create_buffer(&wgpu::BufferDescriptor {
+                    label: Some("procgen-readback"),
+                    size: (align256(width * 4) as u64) * (height as u64),
+                    usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ,
+                    mapped_at_creation: false,
+                });
+                let bytes = copy_texture_to_rgba_unpadded(&ctx.device, &ctx.queue, &tex, &readback, width, height);
+                bytemuck::cast_slice::<u8, f32>(&bytes).to_vec()
+            })
+        }
+        _ => return Err(pyo3::exceptions::PyValueError::new_err("device must be 'cpu' or 'gpu'")),
+    };
+
+    let arr = ndarray::Array2::from_shape_vec((height as usize, width as usize), heights)
+        .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+    Ok(arr.into_pyarray(py))
+}
+
+/// CPU reference flood (priority flood, 4-connectivity, NaN = wall): water depth (0 = dry)
+/// of `heights` flooded from `seeds` ((K, 2) (col, row) cells) at `levels` (one shared level
+/// or (K,) per seed), as `Scene.flood` computes on the GPU.
+#[pyfunction]
+#[pyo3(text_signature = "(heights, seeds, levels)")]
+fn flood_depth_cpu<'py>(
+    py: Python<'py>,
+    heights: PyReadonlyArray2<'py, f32>,
+    seeds: &Bound<'py, PyAny>,
+    levels: &Bound<'py, PyAny>,
+) -> PyResult<Bound<'py, PyArray2<f32>>> {
+    let (cells, dem, h, w) = flood_inputs(py, &heights, seeds)?;
+    let levels: Vec<f32> = match levels.extract::<f32>() {
+        Ok(l) => vec![l; cells.len()],
+        Err(_) => levels.extract()?,
+    };
+    if levels.len() != cells.len() {
+        return Err(pyo3::exceptions::PyValueError::new_err(format!("{} levels for {} seeds", levels.len(), cells.len())));
+    }
+    let seeds: Vec<terrain::flood::Seed> = cells.iter().zip(&levels)
+        .map(|(&(x, y), &level)| terrain::flood::Seed { x, y, level, _p: 0.0 })
+        .collect();
+    let depth = py.allow_threads(|| terrain::flood::flood_depth_cpu(dem, w, h, &seeds));
+    let arr = ndarray::Array2::from_shape_vec((h, w), depth)
+        .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+    Ok(arr.into_pyarray(py))
+}
+
+/// CPU reference spill levels: the lowest water level at which each cell of `heights`
+/// connects to one of `seeds` ((K, 2) (col, row) cells); inf where no path exists.
+/// A cell is wet at level L exactly when its spill level is < L.
+#[pyfunction]
+#[pyo3(text_signature = "(heights, seeds)")]
+fn flood_spill_cpu<'py>(
+    py: Python<'py>,
+    heights: PyReadonlyArray2<'py, f32>,
+    seeds: &Bound<'py, PyAny>,
+) -> PyResult<Bound<'py, PyArray2<f32>>> {
+    let (cells, dem, h, w) = flood_inputs(py, &heights, seeds)?;
+    let spill = py.allow_threads(|| terrain::flood::spill_levels_cpu(dem, w, h, &cells));
+    let arr = ndarray::Array2::from_shape_vec((h, w), spill)
+        .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+    Ok(arr.into_pyarray(py))
+}
+
+/// Validated seed cells, the row-major DEM and its (H, W) for the flood references.
+fn flood_inputs<'a>(
+    py: Python<'_>,
+    heights: &'a PyReadonlyArray2<'_, f32>,
+    seeds: &Bound<'_, PyAny>,
+) -> PyResult<(Vec<(u32, u32)>, &'a [f32], usize, usize)> {
+    let (h, w) = (heights.shape()[0], heights.shape()[1]);
+    let dem = heights.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("heights must be C-contiguous float32[H,W]"))?;
+    let cells = scene::seed_cells(py, seeds)?;
+    if let Some(&(x, y)) = cells.iter().find(|&&(x, y)| x as usize >= w || y as usize >= h) {
+        return Err(pyo3::exceptions::PyValueError::new_err(format!("seed ({}, {}) is outside the {}x{} DEM", x, y, w, h)));
+    }
+    Ok((cells, dem, h, w))
+}
+
+/// Hydrology of `heights` (NaN = nodata; water leaves through the border and nodata):
+/// `{filled, direction, accumulation, ms}`. `fill` runs the tiled parallel priority-flood
+/// first (`filled` is then the filled DEM, else the input). `method='d8'` gives uint8 ESRI
+/// codes (1 = E, 2 = SE, ... 128 = NE, 0 = outlet) and tiled parallel accumulation; `'dinf'`
+/// gives float32 angles (radians CCW from east, north = row 0 side, -1 = none) and
+/// proportional accumulation. Accumulation counts cells (itself included) and feeds
+/// `Scene.set_scalar(..., log=True)`. `threads` sizes a dedicated pool (default: rayon's).
+#[pyfunction]
+#[pyo3(signature = (heights, method="d8", fill=true, tile=512, threads=None))]
+#[pyo3(text_signature = "(heights, method='d8', fill=True, tile=512, threads=None)")]
+fn hydrology<'py>(
+    py: Python<'py>,
+    heights: PyReadonlyArray2<'py, f32>,
+    method: &str,
+    fill: bool,
+    tile: usize,
+    threads: Option<usize>,
+) -> PyResult<PyObject> {
+    let (h, w) = (heights.shape()[0], heights.shape()[1]);
+    let dem = heights.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("heights must be C-contiguous float32[H,W]"))?;
+    hydrology_dict(py, dem, h, w, method, fill, tile, threads)
+}
+
+fn hydrology_dict(
+    py: Python<'_>,
+    dem: &[f32],
+    h: usize,
+    w: usize,
+    method: &str,
+    fill: bool,
+    tile: usize,
+    threads: Option<usize>,
+) -> PyResult<PyObject> {
+    use terrain::hydro;
+    let dinf = match method.to_lowercase().as_str() {
+        "d8" => false,
+        "dinf" => true,
+        _ => return Err(pyo3::exceptions::PyValueError::new_err("method must be 'd8' or 'dinf'")),
+    };
+    if w == 0 || h == 0 || tile == 0 {
+        return Err(pyo3::exceptions::PyValueError::new_err("heights must be non-empty and tile > 0"));
+    }
+    let pool = match threads {
+        Some(0) => return Err(pyo3::exceptions::PyValueError::new_err("threads must be > 0")),
+        Some(n) => Some(rayon::ThreadPoolBuilder::new().num_threads(n).build()
+            .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?),
+        None => None,
+    };
+    let g = hydro::Grid { w, h };
+    let ms = |t: std::time::Instant| t.elapsed().as_secs_f64() * 1e3;
+    let run = || {
+        let t = std::time::Instant::now();
+        let filled = if fill { hydro::fill_depressions(dem, g, tile) } else { dem.to_vec() };
+        let fill_ms = ms(t);
+        let t = std::time::Instant::now();
+        let (d8, ang) = if dinf { (Vec::new(), hydro::dinf_directions(&filled, g)) } else { (hydro::d8_directions(&filled, g), Vec::new()) };
+        let dir_ms = ms(t);
+        let t = std::time::Instant::now();
+        let acc = if dinf { hydro::accumulate_dinf(&filled, &ang, g) } else { hydro::accumulate_d8(&filled, &d8, g, tile) };
+        (filled, d8, ang, acc, [fill_ms, dir_ms, ms(t)])
+    };
+    let (filled, d8, ang, acc, times) = py.allow_threads(|| match &pool {
+        Some(p) => p.install(run),
+        None => run(),
+    });
+    let shape_err = |e: ndarray::ShapeError| pyo3::exceptions::PyRuntimeError::new_err(e.to_string());
+    let d = PyDict::new(py);
+    d.set_item("filled", ndarray::Array2::from_shape_vec((h, w), filled).map_err(shape_err)?.into_pyarray(py))?;
+    if dinf {
+        d.set_item("direction", ndarray::Array2::from_shape_vec((h, w), ang).map_err(shape_err)?.into_pyarray(py))?;
+    } else {
+        d.set_item("direction", ndarray::Array2::from_shape_vec((h, w), d8).map_err(shape_err)?.into_pyarray(py))?;
+    }
+    d.set_item("accumulation", ndarray::Array2::from_shape_vec((h, w), acc).map_err(shape_err)?.into_pyarray(py))?;
+    let t = PyDict::new(py);
+    t.set_item("fill", times[0])?;
+    t.set_item("direction", times[1])?;
+    t.set_item("accumulation", times[2])?;
+    d.set_item("ms", t)?;
+    Ok(d.into_any().unbind())
+}
+
+/// CPU reference of `Scene.erode`: `iterations` iterations of pipe-model hydraulic plus
+/// thermal erosion on `heights` (NaN = wall) with the same keyword `params`, run serially
+/// in the order of the GPU passes. Returns `{height, water, sediment}` ((H, W) float32).
+#[pyfunction]
+#[pyo3(signature = (heights, iterations, **params))]
+#[pyo3(text_signature = "(heights, iterations, **params)")]
+fn erosion_cpu<'py>(
+    py: Python<'py>,
+    heights: PyReadonlyArray2<'py, f32>,
+    iterations: u32,
+    params: Option<&Bound<'py, PyDict>>,
+) -> PyResult<PyObject> {
+    use terrain::erosion::{ErosionCpu, ErosionParams};
+    let (h, w) = (heights.shape()[0], heights.shape()[1]);
+    let dem = heights.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("heights must be C-contiguous float32[H,W]"))?;
+    if dem.is_empty() {
+        return Err(pyo3::exceptions::PyValueError::new_err("heights must be a non-empty float32[H,W]"));
+    }
+    let p = erosion_params(ErosionParams::new(w as u32, h as u32), params)?;
+    let cells = py.allow_threads(|| {
+        let mut sim = ErosionCpu::new(p, dem);
+        sim.run(iterations);
+        sim.cells
+    });
+    erosion_fields_dict(py, w, h, &cells)
+}
+
+/// `base` with the erosion keyword arguments applied, validated.
+pub(crate) fn erosion_params(mut base: terrain::erosion::ErosionParams, params: Option<&Bound<'_, PyDict>>)
+    -> PyResult<terrain::erosion::ErosionParams> {
+    for (k, v) in params.into_iter().flatten() {
+        let name: String = k.extract()?;
+        base.set(&name, v.extract()?).map_err(pyo3::exceptions::PyTypeError::new_err)?;
+    }
+    base.validate().map_err(pyo3::exceptions::PyValueError::new_err)?;
+    Ok(base)
+}
+
+/// `{height, water, sediment}` of row-major erosion `cells`.
+pub(crate) fn erosion_fields_dict(py: Python<'_>, w: usize, h: usize, cells: &[terrain::erosion::Cell]) -> PyResult<PyObject> {
+    let d = PyDict::new(py);
+    let fields: [(&str, fn(&terrain::erosion::Cell) -> f32); 3] = [("height", |c| c.h), ("water", |c| c.w), ("sediment", |c| c.s)];
+    for (name, f) in fields {
+        let arr = ndarray::Array2::from_shape_vec((h, w), cells.iter().map(f).collect())
+            .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        d.set_item(name, arr.into_pyarray(py))?;
+    }
+    Ok(d.into_any().unbind())
+}
+
+// Free-threaded CPython runs pymethods of one object on several threads at once and has no
+// GIL to serialize access to statics, so every pyclass and shared static must be Send + Sync.
+// `&mut self` methods stay exclusive through PyO3's per-object borrow flag.
+const _: () = {
+    const fn assert_send_sync<T: Send + Sync>() {}
+    assert_send_sync::<Renderer>();
+    assert_send_sync::<scene::Scene>();
+    assert_send_sync::<scene::frames::Frame>();
+    assert_send_sync::<scene::frames::FrameStream>();
+    assert_send_sync::<scene::scheduler::RenderScheduler>();
+    assert_send_sync::<scene::scheduler::RenderTicket>();
+    #[cfg(feature = "terrain_spike")]
+    assert_send_sync::<terrain::TerrainSpike>();
+    assert_send_sync::<WgpuContext>();
+    assert_send_sync::<wgpu::RenderPipeline>();
+};
+
+/// Build flavour of the extension: `{abi3, free_threaded_ready, pyo3}`. `free_threaded_ready`
+/// is true for builds against free-threaded CPython (the module is declared
+/// `gil_used = false`, so 3.13t keeps the GIL off on import); `pyo3` is the resolved PyO3
+/// version (see `build.rs`).
+#[pyfunction]
+#[pyo3(text_signature = "()")]
+fn build_info(py: Python<'_>) -> PyResult<PyObject> {
+    let d = PyDict::new(py);
+    d.set_item("abi3", cfg!(feature = "abi3"))?;
+    d.set_item("free_threaded_ready", cfg!(Py_GIL_DISABLED))?;
+    d.set_item("pyo3", env!("VF_PYO3_VERSION"))?;
+    Ok(d.into_any().unbind())
+}
+
+#[pymodule(gil_used = false)]
+fn _vulkan_forge(m: &Bound<'_, PyModule>) -> PyResult<()> {
     m.add_class::<Renderer>()?;
     #[cfg(feature = "terrain_spike")]
     { m.add_class::<terrain::TerrainSpike>()?; }
     m.add_class::<scene::Scene>()?;
+    m.add_class::<scene::frames::Frame>()?;
+    m.add_class::<scene::frames::FrameStream>()?;
+    m.add_class::<scene::progressive::ProgressiveFrame>()?;
+    m.add_class::<scene::scheduler::RenderScheduler>()?;
+    m.add_class::<scene::scheduler::RenderTicket>()?;
     m.add_function(wrap_pyfunction!(enumerate_adapters, m)?)?;
     m.add_function(wrap_pyfunction!(device_probe, m)?)?;
     m.add_function(wrap_pyfunction!(grid_generate, m)?)?;
+    m.add_function(wrap_pyfunction!(procedural_dem, m)?)?;
+    m.add_function(wrap_pyfunction!(flood_depth_cpu, m)?)?;
+    m.add_function(wrap_pyfunction!(flood_spill_cpu, m)?)?;
+    m.add_function(wrap_pyfunction!(hydrology, m)?)?;
+    m.add_function(wrap_pyfunction!(erosion_cpu, m)?)?;
+    m.add_function(wrap_pyfunction!(context_caps, m)?)?;
+    m.add_function(wrap_pyfunction!(build_info, m)?)?;
+    m.add_function(wrap_pyfunction!(warmup::warmup, m)?)?;
+    m.add_function(wrap_pyfunction!(warmup::warmup_status, m)?)?;
+    m.add_function(wrap_pyfunction!(adapter_rank::rank_adapters, m)?)?;
+    m.add_function(wrap_pyfunction!(adapter_rank::adapter_cache_path, m)?)?;
     m.add_function(wrap_pyfunction!(colormap::colormap_supported, m)?)?;
     m.add_function(wrap_pyfunction!(camera::camera_look_at, m)?)?;
     m.add_function(wrap_pyfunction!(camera::camera_perspective, m)?)?;
@@ -0,0 +1,595 @@
+//! Manifest-driven batch rendering for the `vf-render` binary (feature `cli`).
+//!
+//! A manifest (JSON, or TOML by extension) lists jobs; each job builds a `Scene` (devices are
+//! shared per adapter), loads its DEM from `.npy` or generates it on the GPU, and renders
+//! every camera through the same `submit_frames`/`read_frames` path as the Python API, so
+//! the pixels are byte-identical to `Scene.render_views_rgba`. Up to `depth` frames are in
+//! flight on the Scene's render-slot ring while `encoders` threads write PNG/NPY/raw files.
+//! Outputs larger than one render target are rendered as tiles with off-axis projections.
+//!
+//! ```json
+//! { "depth": 3, "encoders": 4,
+//!   "defaults": { "size": [512, 512], "grid": 256, "colormap": "viridis" },
+//!   "jobs": [ { "name": "orbit", "dem": "dem.npy",
+//!               "sun": { "elevation_deg": 35, "azimuth_deg": 300 }, "exposure": 1.2,
+//!               "camera": { "fovy_deg": 45, "znear": 0.1, "zfar": 100 },
+//!               "cameras": [ { "eye": [3, 2, 3], "target": [0, 0, 0], "up": [0, 1, 0] } ],
+//!               "output": { "dir": "out/orbit", "format": "png", "tile": [256, 256] } } ] }
+//! ```
+//!
+//! `cameras` may also be a path to an (N, 4, 4) float32 `.npy` of row-major view matrices,
+//! and `dem` may be `{ "procedural": { "size": [512, 512], "kind": "fbm", "seed": 1 } }`.
+//! Relative paths resolve against the manifest directory. Errors are plain strings: the
+//! binary never starts an interpreter, so it calls the `String`-error forms of the Scene
+//! methods (`Scene::open`, `apply_features`, `apply_sun`, `apply_exposure`,
+//! `apply_camera_look_at`, `write_procedural_height`) and never formats a `PyErr`.
+
+use std::collections::VecDeque;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{mpsc, Arc, Mutex};
+use std::time::Instant;
+
+use serde_json::{json, Map, Value};
+
+use super::{FrameDraws, Scene};
+
+/// Command-line overrides of the manifest's top-level settings.
+#[derive(Debug, Clone, Default)]
+pub struct Overrides {
+    pub depth: Option<usize>,
+    pub encoders: Option<usize>,
+    /// Only run jobs with these names (all jobs when empty).
+    pub only: Vec<String>,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq)]
+enum Format {
+    Png,
+    Npy,
+    Raw,
+}
+
+enum Dem {
+    Placeholder,
+    Npy(PathBuf),
+    Procedural { width: u32, height: u32, kind: String, seed: u32, octaves: u32, frequency: f32, lacunarity: f32, gain: f32, amplitude: f32 },
+}
+
+struct Job {
+    name: String,
+    width: u32,
+    height: u32,
+    grid: u32,
+    colormap: String,
+    features: Option<Vec<String>>,
+    dem: Dem,
+    sun: Option<(f32, f32)>,
+    exposure: Option<f32>,
+    fovy_deg: f32,
+    znear: f32,
+    zfar: f32,
+    views: Vec<glam::Mat4>,
+    out_dir: PathBuf,
+    format: Format,
+    tile: Option<(u32, u32)>,
+}
+
+// ---------- manifest ----------
+
+/// Parse a JSON or TOML (`.toml`) manifest into a JSON value.
+pub fn load_manifest(path: &Path) -> Result<Value, String> {
+    let text = std::fs::read_to_string(path).map_err(|e| format!("{}: {}", path.display(), e))?;
+    let is_toml = path.extension().map_or(false, |e| e.eq_ignore_ascii_case("toml"));
+    if is_toml {
+        let v: toml::Value = toml::from_str(&text).map_err(|e| format!("{}: {}", path.display(), e))?;
+        serde_json::to_value(v).map_err(|e| format!("{}: {}", path.display(), e))
+    } else {
+        serde_json::from_str(&text).map_err(|e| format!("{}: {}", path.display(), e))
+    }
+}
+
+fn f32_of(v: &Value, what: &str) -> Result<f32, String> {
+    v.as_f64().map(|x| x as f32).ok_or_else(|| format!("{} must be a number", what))
+}
+
+fn u32_of(v: &Value, what: &str) -> Result<u32, String> {
+    v.as_u64().filter(|x| *x <= u32::MAX as u64).map(|x| x as u32).ok_or_else(|| format!("{} must be a non-negative integer", what))
+}
+
+fn vec3_of(v: &Value, what: &str) -> Result<glam::Vec3, String> {
+    match v.as_array().map(|a| a.as_slice()) {
+        Some([x, y, z]) => Ok(glam::Vec3::new(f32_of(x, what)?, f32_of(y, what)?, f32_of(z, what)?)),
+        _ => Err(format!("{} must be [x, y, z]", what)),
+    }
+}
+
+fn pair_of(v: &Value, what: &str) -> Result<(u32, u32), String> {
+    match v.as_array().map(|a| a.as_slice()) {
+        Some([a, b]) => Ok((u32_of(a, what)?, u32_of(b, what)?)),
+        _ => Err(format!("{} must be [width, height]", what)),
+    }
+}
+
+/// `defaults` overlaid with the job's own keys (one level deep for object values).
+fn merged(defaults: Option<&Value>, job: &Value) -> Map<String, Value> {
+    let mut out = defaults.and_then(Value::as_object).cloned().unwrap_or_default();
+    for (k, v) in job.as_object().into_iter().flatten() {
+        match (out.get_mut(k), v) {
+            (Some(Value::Object(base)), Value::Object(over)) => {
+                for (kk, vv) in over {
+                    base.insert(kk.clone(), vv.clone());
+                }
+            }
+            _ => {
+                out.insert(k.clone(), v.clone());
+            }
+        }
+    }
+    out
+}
+
+fn parse_job(base: &Path, index: usize, m: &Map<String, Value>) -> Result<Job, String> {
+    let name = m.get("name").and_then(Value::as_str).map(str::to_string).unwrap_or_else(|| format!("job{}", index));
+    let ctx = |e: String| format!("job '{}': {}", name, e);
+    let (width, height) = m.get("size").map(|v| pair_of(v, "size")).transpose().map_err(ctx)?.unwrap_or((512, 512));
+    if width == 0 || height == 0 {
+        return Err(ctx("size must be > 0".into()));
+    }
+    let grid = m.get("grid").map(|v| u32_of(v, "grid")).transpose().map_err(ctx)?.unwrap_or(128);
+    let colormap = m.get("colormap").and_then(Value::as_str).unwrap_or("viridis").to_string();
+    if !crate::colormap::SUPPORTED.contains(&colormap.as_str()) {
+        return Err(ctx(format!("unknown colormap '{}'. Supported: {}", colormap, crate::colormap::SUPPORTED.join(", "))));
+    }
+    let features = match m.get("features") {
+        None => None,
+        Some(Value::Array(a)) => Some(a.iter().map(|f| f.as_str().map(str::to_string).ok_or_else(|| ctx("features must be strings".into()))).collect::<Result<_, _>>()?),
+        Some(_) => return Err(ctx("features must be a list of names".into())),
+    };
+    if let Some(f) = &features {
+        crate::terrain::variants::ShaderFeatures::from_names(f).map_err(ctx)?;
+    }
+
+    let dem = match m.get("dem") {
+        None => Dem::Placeholder,
+        Some(Value::String(p)) => Dem::Npy(base.join(p)),
+        Some(Value::Object(o)) if o.contains_key("procedural") => {
+            let p = &o["procedural"];
+            let (w, h) = p.get("size").map(|v| pair_of(v, "dem.procedural.size")).transpose().map_err(ctx)?.unwrap_or((512, 512));
+            let num = |k: &str, d: f32| p.get(k).map(|v| f32_of(v, k)).transpose().map(|x| x.unwrap_or(d));
+            let int = |k: &str, d: u32| p.get(k).map(|v| u32_of(v, k)).transpose().map(|x| x.unwrap_or(d));
+            Dem::Procedural {
+                width: w, height: h,
+                kind: p.get("kind").and_then(Value::as_str).unwrap_or("fbm").to_string(),
+                seed: int("seed", 0).map_err(ctx)?,
+                octaves: int("octaves", 6).map_err(ctx)?,
+                frequency: num("frequency", 4.0).map_err(ctx)?,
+                lacunarity: num("lacunarity", 2.0).map_err(ctx)?,
+                gain: num("gain", 0.5).map_err(ctx)?,
+                amplitude: num("amplitude", 0.25).map_err(ctx)?,
+            }
+        }
+        Some(_) => return Err(ctx("dem must be a .npy path or {\"procedural\": {...}}".into())),
+    };
+
+    let sun = match m.get("sun") {
+        None => None,
+        Some(s) => Some((
+            f32_of(s.get("elevation_deg").unwrap_or(&Value::Null), "sun.elevation_deg").map_err(ctx)?,
+            f32_of(s.get("azimuth_deg").unwrap_or(&Value::Null), "sun.azimuth_deg").map_err(ctx)?,
+        )),
+    };
+    let exposure = m.get("exposure").map(|v| f32_of(v, "exposure")).transpose().map_err(ctx)?;
+    if exposure.map_or(false, |e| !(e > 0.0) || !e.is_finite()) {
+        return Err(ctx("exposure must be > 0".into()));
+    }
+
+    let cam = m.get("camera").cloned().unwrap_or(Value::Null);
+    let cam_num = |k: &str, d: f32| cam.get(k).map(|v| f32_of(v, k)).transpose().map(|x| x.unwrap_or(d));
+    let fovy_deg = cam_num("fovy_deg", 45.0).map_err(ctx)?;
+    let znear = cam_num("znear", 0.1).map_err(ctx)?;
+    let zfar = cam_num("zfar", 100.0).map_err(ctx)?;
+    if !(fovy_deg > 0.0 && fovy_deg < 180.0) || !(znear > 0.0) || !(zfar > znear) {
+        return Err(ctx("camera needs 0 < fovy_deg < 180 and 0 < znear < zfar".into()));
+    }
+
+    let views = match m.get("cameras") {
+        Some(Value::String(p)) => {
+            let (shape, data) = read_npy_f32(&base.join(p)).map_err(ctx)?;
+            if shape.len() != 3 || shape[0] == 0 || shape[1] != 4 || shape[2] != 4 {
+                return Err(ctx("cameras .npy must have shape (N, 4, 4)".into()));
+            }
+            // Row-major numpy matrices, as `Scene.render_views_rgba` takes them.
+            data.chunks_exact(16).map(|m| glam::Mat4::from_cols_array(m.try_into().unwrap()).transpose()).collect()
+        }
+        Some(Value::Array(list)) if !list.is_empty() => {
+            let mut out = Vec::with_capacity(list.len());
+            for (i, c) in list.iter().enumerate() {
+                let field = |k: &str| c.get(k).map(|v| vec3_of(v, &format!("cameras[{}].{}", i, k)));
+                let eye = field("eye").ok_or_else(|| ctx(format!("cameras[{}].eye is required", i)))?.map_err(ctx)?;
+                let target = field("target").transpose().map_err(ctx)?.unwrap_or(glam::Vec3::ZERO);
+                let up = field("up").transpose().map_err(ctx)?.unwrap_or(glam::Vec3::Y);
+                if !(eye - target).is_finite() || (eye - target).length_squared() == 0.0 || up.cross(target - eye).length_squared() == 0.0 {
+                    return Err(ctx(format!("cameras[{}]: eye, target and up must be finite, distinct and not collinear", i)));
+                }
+                out.push(glam::Mat4::look_at_rh(eye, target, up));
+            }
+            out
+        }
+        _ => return Err(ctx("cameras must be a non-empty list or a .npy path".into())),
+    };
+
+    let out = m.get("output").cloned().unwrap_or(Value::Null);
+    let out_dir = base.join(out.get("dir").and_then(Value::as_str).unwrap_or(&name));
+    let format = match out.get("format").and_then(Value::as_str).unwrap_or("png") {
+        "png" => Format::Png,
+        "npy" => Format::Npy,
+        "raw" => Format::Raw,
+        other => return Err(ctx(format!("output.format '{}' (expected png, npy or raw)", other))),
+    };
+    let tile = out.get("tile").map(|v| pair_of(v, "output.tile")).transpose().map_err(ctx)?;
+    if let Some((tw, th)) = tile {
+        if tw == 0 || th == 0 || width % tw != 0 || height % th != 0 {
+            return Err(ctx(format!("output.tile {}x{} must evenly divide size {}x{}", tw, th, width, height)));
+        }
+    }
+
+    Ok(Job { name, width, height, grid, colormap, features, dem, sun, exposure, fovy_deg, znear, zfar, views, out_dir, format, tile })
+}
+
+// ---------- .npy ----------
+
+/// Minimal `.npy` reader: little-endian `f4`/`f8`, C order, format versions 1–3.
+pub fn read_npy_f32(path: &Path) -> Result<(Vec<usize>, Vec<f32>), String> {
+    let bytes = std::fs::read(path).map_err(|e| format!("{}: {}", path.display(), e))?;
+    let bad = |why: &str| format!("{}: not a supported .npy file ({})", path.display(), why);
+    if bytes.len() < 10 || &bytes[..6] != b"\x93NUMPY" {
+        return Err(bad("bad magic"));
+    }
+    let (hlen, hstart) = match bytes[6] {
+        1 => (u16::from_le_bytes([bytes[8], bytes[9]]) as usize, 10),
+        2 | 3 if bytes.len() >= 12 => (u32::from_le_bytes([bytes[8], bytes[9], bytes[10], bytes[11]]) as usize, 12),
+        _ => return Err(bad("unknown version")),
+    };
+    let header = std::str::from_utf8(bytes.get(hstart..hstart + hlen).ok_or_else(|| bad("truncated header"))?)
+        .map_err(|_| bad("header is not text"))?;
+    let value_of = |key: &str| -> Option<&str> {
+        let at = header.find(&format!("'{}'", key))? + key.len() + 2;
+        Some(header[at..].trim_start().strip_prefix(':')?.trim_start())
+    };
+    let descr = value_of("descr").and_then(|v| v.get(1..4)).ok_or_else(|| bad("no descr"))?;
+    if value_of("fortran_order").map_or(true, |v| !v.starts_with("False")) {
+        return Err(bad("fortran_order arrays are not supported"));
+    }
+    let shape_txt = value_of("shape").and_then(|v| v.strip_prefix('(')).and_then(|v| v.split(')').next()).ok_or_else(|| bad("no shape"))?;
+    let shape: Vec<usize> = shape_txt
+        .split(',')
+        .map(str::trim)
+        .filter(|s| !s.is_empty())
+        .map(|s| s.parse::<usize>().map_err(|_| bad("bad shape")))
+        .collect::<Result<_, _>>()?;
+    let count: usize = shape.iter().product();
+    let data = &bytes[hstart + hlen..];
+    let values: Vec<f32> = match descr {
+        "<f4" if data.len() >= count * 4 => data[..count * 4].chunks_exact(4).map(|c| f32::from_le_bytes(c.try_into().unwrap())).collect(),
+        "<f8" if data.len() >= count * 8 => data[..count * 8].chunks_exact(8).map(|c| f64::from_le_bytes(c.try_into().unwrap()) as f32).collect(),
+        "<f4" | "<f8" => return Err(bad("truncated data")),
+        _ => return Err(bad("dtype must be float32 or float64")),
+    };
+    Ok((shape, values))
+}
+
+fn npy_u8_bytes(shape: &[usize], data: &[u8]) -> Vec<u8> {
+    let dims: Vec<String> = shape.iter().map(|d| d.to_string()).collect();
+    let mut header = format!("{{'descr': '|u1', 'fortran_order': False, 'shape': ({},), }}", dims.join(", "));
+    // Pad so the data starts on a 64-byte boundary (10-byte preamble + header + '\n').
+    while (10 + header.len() + 1) % 64 != 0 {
+        header.push(' ');
+    }
+    header.push('\n');
+    let mut out = Vec::with_capacity(10 + header.len() + data.len());
+    out.extend_from_slice(b"\x93NUMPY\x01\x00");
+    out.extend_from_slice(&(header.len() as u16).to_le_bytes());
+    out.extend_from_slice(header.as_bytes());
+    out.extend_from_slice(data);
+    out
+}
+
+// ---------- rendering ----------
+
+fn write_frame(job: &Job, index: usize, pixels: Vec<u8>) -> Result<(), String> {
+    let (ext, bytes) = match job.format {
+        Format::Png => {
+            let path = job.out_dir.join(format!("frame_{:05}.png", index));
+            let img = image::RgbaImage::from_raw(job.width, job.height, pixels).ok_or("invalid image buffer")?;
+            return img.save(&path).map_err(|e| format!("{}: {}", path.display(), e));
+        }
+        Format::Npy => ("npy", npy_u8_bytes(&[job.height as usize, job.width as usize, 4], &pixels)),
+        Format::Raw => ("rgba", pixels),
+    };
+    let path = job.out_dir.join(format!("frame_{:05}.{}", index, ext));
+    std::fs::write(&path, bytes).map_err(|e| format!("{}: {}", path.display(), e))
+}
+
+/// One draw per output tile: each tile view folds the clip-space scale/offset of its window
+/// into the view matrix, `P_tile⁻¹ · (T·S) · P_full · view`, so the Scene's own (tile-aspect)
+/// projection reproduces the full-image projection restricted to that tile.
+fn tile_frames(job: &Job, view: glam::Mat4, tile_proj: glam::Mat4, full_proj: glam::Mat4) -> Vec<FrameDraws> {
+    let (tw, th) = job.tile.unwrap();
+    let (cols, rows) = (job.width / tw, job.height / th);
+    let (sx, sy) = (job.width as f32 / tw as f32, job.height as f32 / th as f32);
+    let inv = tile_proj.inverse();
+    let mut out = Vec::with_capacity((cols * rows) as usize);
+    for r in 0..rows {
+        for c in 0..cols {
+            let cx = -1.0 + (2 * c + 1) as f32 * tw as f32 / job.width as f32;
+            let cy = 1.0 - (2 * r + 1) as f32 * th as f32 / job.height as f32;
+            let window = glam::Mat4::from_cols(
+                glam::Vec4::new(sx, 0.0, 0.0, 0.0),
+                glam::Vec4::new(0.0, sy, 0.0, 0.0),
+                glam::Vec4::new(0.0, 0.0, 1.0, 0.0),
+                glam::Vec4::new(-cx * sx, -cy * sy, 0.0, 1.0),
+            );
+            out.push(FrameDraws::single(inv * window * full_proj * view));
+        }
+    }
+    out
+}
+
+/// Tiles (row-major, back to back) → one `width × height` RGBA image.
+fn assemble_tiles(job: &Job, tiles: &[u8]) -> Vec<u8> {
+    let (tw, th) = job.tile.unwrap();
+    let cols = (job.width / tw) as usize;
+    let (tw, th, w) = (tw as usize, th as usize, job.width as usize);
+    let mut out = vec![0u8; w * job.height as usize * 4];
+    for (t, tile) in tiles.chunks_exact(tw * th * 4).enumerate() {
+        let (r, c) = (t / cols, t % cols);
+        for y in 0..th {
+            let dst = ((r * th + y) * w + c * tw) * 4;
+            out[dst..dst + tw * 4].copy_from_slice(&tile[y * tw * 4..(y + 1) * tw * 4]);
+        }
+    }
+    out
+}
+
+fn percentile(sorted: &[f64], p: f64) -> f64 {
+    if sorted.is_empty() {
+        return f64::NAN;
+    }
+    let k = (sorted.len() - 1) as f64 * p / 100.0;
+    let (f, c) = (k.floor() as usize, k.ceil() as usize);
+    if f == c { sorted[f] } else { sorted[f] * (c as f64 - k) + sorted[c] * (k - f as f64) }
+}
+
+/// `perf_sanity.py`-style `steady` block.
+fn steady(samples: &[f64]) -> Value {
+    let mut sorted = samples.to_vec();
+    sorted.sort_by(|a, b| a.total_cmp(b));
+    let n = samples.len() as f64;
+    let mean = if samples.is_empty() { f64::NAN } else { samples.iter().sum::<f64>() / n };
+    let stdev = if samples.len() > 1 { (samples.iter().map(|x| (x - mean).powi(2)).sum::<f64>() / n).sqrt() } else { 0.0 };
+    json!({
+        "samples_ms": samples,
+        "mean_ms": mean,
+        "median_ms": percentile(&sorted, 50.0),
+        "p95_ms": percentile(&sorted, 95.0),
+        "stdev_ms": stdev,
+        "min_ms": sorted.first().copied().unwrap_or(f64::NAN),
+        "max_ms": sorted.last().copied().unwrap_or(f64::NAN),
+    })
+}
+
+fn render_job(job: &Job, depth: usize, encoders: usize, t_process: Instant) -> Result<Value, String> {
+    let t0 = Instant::now();
+    let (sw, sh) = job.tile.unwrap_or((job.width, job.height));
+    let scene = Scene::open(sw, sh, Some(job.grid), Some(job.colormap.clone()), true)
+        .map_err(|e| format!("scene setup failed: {e}"))?;
+    match &job.dem {
+        Dem::Placeholder => {}
+        Dem::Npy(path) => {
+            let (shape, data) = read_npy_f32(path)?;
+            if shape.len() != 2 {
+                return Err(format!("{}: DEM must be 2-D", path.display()));
+            }
+            scene.upload_height(shape[1] as u32, shape[0] as u32, &data)?;
+        }
+        Dem::Procedural { width, height, kind, seed, octaves, frequency, lacunarity, gain, amplitude } => {
+            use crate::terrain::procgen;
+            if *width == 0 || *height == 0 {
+                return Err(format!("procedural DEM {}x{}: width and height must be > 0", width, height));
+            }
+            scene.caps.check_texture_2d(*width, *height).map_err(|e| format!("procedural DEM {}x{}: {e}", width, height))?;
+            let kind = kind.parse::<procgen::NoiseKind>()?;
+            scene.write_procedural_height(&procgen::ProcParams::new(
+                *width, *height, kind, *seed, *octaves, *frequency, *lacunarity, *gain, *amplitude,
+            ));
+        }
+    }
+    if let Some(features) = &job.features {
+        scene.apply_features(features).map_err(|e| format!("shader features rejected: {e}"))?;
+    }
+    if let Some((el, az)) = job.sun {
+        scene.apply_sun(el, az).map_err(|e| format!("sun: {e}"))?;
+    }
+    if let Some(e) = job.exposure {
+        scene.apply_exposure(e).map_err(|e| format!("exposure: {e}"))?;
+    }
+    // Only the projection matters here; every frame brings its own view.
+    scene
+        .apply_camera_look_at((0.0, 0.0, 1.0), (0.0, 0.0, 0.0), (0.0, 1.0, 0.0), job.fovy_deg, job.znear, job.zfar)
+        .map_err(|e| format!("invalid camera parameters: {e}"))?;
+    std::fs::create_dir_all(&job.out_dir).map_err(|e| format!("{}: {}", job.out_dir.display(), e))?;
+    let tile_proj = scene.state.read().unwrap().scene.proj;
+    let full_proj = crate::camera::perspective_wgpu(job.fovy_deg.to_radians(), job.width as f32 / job.height as f32, job.znear, job.zfar);
+    let setup_ms = t0.elapsed().as_secs_f64() * 1000.0;
+
+    let encode_us = AtomicU64::new(0);
+    let encode_err: Mutex<Option<String>> = Mutex::new(None);
+    let (tx, rx) = mpsc::sync_channel::<(usize, Vec<u8>)>(encoders * 2);
+    let rx = Arc::new(Mutex::new(rx));
+    let mut first_ms = 0.0;
+    let mut ttff_ms = 0.0;
+    let mut samples = Vec::with_capacity(job.views.len());
+    let result = std::thread::scope(|s| -> Result<(), String> {
+        for _ in 0..encoders {
+            let rx = rx.clone();
+            let (encode_us, encode_err) = (&encode_us, &encode_err);
+            s.spawn(move || loop {
+                let next = rx.lock().unwrap().recv();
+                let Ok((i, pixels)) = next else { break };
+                let t = Instant::now();
+                if let Err(e) = write_frame(job, i, pixels) {
+                    encode_err.lock().unwrap().get_or_insert(e);
+                }
+                encode_us.fetch_add(t.elapsed().as_micros() as u64, Ordering::Relaxed);
+            });
+        }
+        let frames_for = |view: glam::Mat4| match job.tile {
+            Some(_) => tile_frames(job, view, tile_proj, full_proj),
+            None => vec![FrameDraws::single(view)],
+        };
+        let t_render = Instant::now();
+        let mut last = t_render;
+        let mut ring = VecDeque::with_capacity(depth);
+        let mut next = 0;
+        let mut done = 0;
+        let mut read_err = None;
+        while done < job.views.len() {
+            while ring.len() < depth && next < job.views.len() {
+                ring.push_back(scene.submit_frames(&frames_for(job.views[next])));
+                next += 1;
+            }
+            let pixels = match scene.read_frames(ring.pop_front().unwrap()) {
+                Ok(pixels) => pixels,
+                Err(e) => {
+                    read_err = Some(e);
+                    break;
+                }
+            };
+            let now = Instant::now();
+            if done == 0 {
+                first_ms = (now - t_render).as_secs_f64() * 1000.0;
+                ttff_ms = (now - t_process).as_secs_f64() * 1000.0;
+            } else {
+                samples.push((now - last).as_secs_f64() * 1000.0);
+            }
+            last = now;
+            let pixels = if job.tile.is_some() { assemble_tiles(job, &pixels) } else { pixels };
+            if tx.send((done, pixels)).is_err() {
+                break;
+            }
+            done += 1;
+            if encode_err.lock().unwrap().is_some() {
+                break;
+            }
+        }
+        drop(tx);
+        // Slots of frames still in flight after an early exit.
+        for pending in ring {
+            scene.discard_frames(pending);
+        }
+        read_err.map_or(Ok(()), Err)
+    });
+    result?;
+    if let Some(e) = encode_err.into_inner().unwrap() {
+        return Err(e);
+    }
+    let total_ms = t0.elapsed().as_secs_f64() * 1000.0;
+    let frames = job.views.len();
+    Ok(json!({
+        "job": job.name,
+        "width": job.width,
+        "height": job.height,
+        "tile": job.tile.map(|(w, h)| vec![w, h]),
+        "frames": frames,
+        "runs": samples.len(),
+        "warmups": 0,
+        "setup_ms": setup_ms,
+        "init_ms": setup_ms + first_ms,
+        "ttff_ms": ttff_ms,
+        "steady": steady(&samples),
+        "encode_ms": encode_us.load(Ordering::Relaxed) as f64 / 1000.0,
+        "total_ms": total_ms,
+        "fps": frames as f64 / (total_ms / 1000.0),
+        "output_dir": job.out_dir.display().to_string(),
+    }))
+}
+
+/// Run every job of `manifest` and return the timing report (`{"manifest", "depth",
+/// "encoders", "jobs": [...]}`; each job entry carries the `perf_sanity.py` keys).
+pub fn run_manifest(manifest: &Path, overrides: &Overrides) -> Result<Value, String> {
+    let t_process = Instant::now();
+    let doc = load_manifest(manifest)?;
+    let base = manifest.parent().map(Path::to_path_buf).unwrap_or_default();
+    let depth = overrides.depth.or_else(|| doc.get("depth").and_then(Value::as_u64).map(|d| d as usize)).unwrap_or(3).max(1);
+    let default_encoders = std::thread::available_parallelism().map(|n| n.get()).unwrap_or(2).min(8);
+    let encoders = overrides.encoders.or_else(|| doc.get("encoders").and_then(Value::as_u64).map(|d| d as usize)).unwrap_or(default_encoders).max(1);
+    let jobs = doc.get("jobs").and_then(Value::as_array).filter(|j| !j.is_empty()).ok_or("manifest needs a non-empty \"jobs\" list")?;
+
+    // Validate everything before rendering anything.
+    let mut parsed = Vec::with_capacity(jobs.len());
+    for (i, j) in jobs.iter().enumerate() {
+        let job = parse_job(&base, i, &merged(doc.get("defaults"), j))?;
+        if overrides.only.is_empty() || overrides.only.contains(&job.name) {
+            parsed.push(job);
+        }
+    }
+    let mut reports = Vec::with_capacity(parsed.len());
+    for job in &parsed {
+        reports.push(render_job(job, depth, encoders, t_process)?);
+    }
+    Ok(json!({
+        "manifest": manifest.display().to_string(),
+        "depth": depth,
+        "encoders": encoders,
+        "total_ms": t_process.elapsed().as_secs_f64() * 1000.0,
+        "jobs": reports,
+    }))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn npy_roundtrip_header() {
+        let bytes = npy_u8_bytes(&[2, 3, 4], &[7u8; 24]);
+        assert_eq!(&bytes[..6], b"\x93NUMPY");
+        let hlen = u16::from_le_bytes([bytes[8], bytes[9]]) as usize;
+        assert_eq!((10 + hlen) % 64, 0);
+        assert_eq!(bytes.len(), 10 + hlen + 24);
+    }
+
+    #[test]
+    fn npy_reads_f4() {
+        let dir = std::env::temp_dir().join(format!("vf-npy-{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("a.npy");
+        let mut header = "{'descr': '<f4', 'fortran_order': False, 'shape': (2, 2), }".to_string();
+        while (10 + header.len() + 1) % 64 != 0 {
+            header.push(' ');
+        }
+        header.push('\n');
+        let mut bytes = b"\x93NUMPY\x01\x00".to_vec();
+        bytes.extend_from_slice(&(header.len() as u16).to_le_bytes());
+        bytes.extend_from_slice(header.as_bytes());
+        for v in [0.0f32, 0.25, 0.5, 0.75] {
+            bytes.extend_from_slice(&v.to_le_bytes());
+        }
+        std::fs::write(&path, bytes).unwrap();
+        let (shape, data) = read_npy_f32(&path).unwrap();
+        assert_eq!(shape, vec![2, 2]);
+        assert_eq!(data, vec![0.0, 0.25, 0.5, 0.75]);
+        std::fs::remove_dir_all(dir).ok();
+    }
+
+    #[test]
+    fn defaults_merge_one_level() {
+        let d = json!({ "size": [64, 64], "camera": { "fovy_deg": 30, "znear": 0.5 } });
+        let j = json!({ "camera": { "znear": 0.2 } });
+        let m = merged(Some(&d), &j);
+        assert_eq!(m["camera"]["fovy_deg"], json!(30));
+        assert_eq!(m["camera"]["znear"], json!(0.2));
+        assert_eq!(m["size"], json!([64, 64]));
+    }
+}
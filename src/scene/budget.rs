@@ -0,0 +1,495 @@
+//! Frame-budget quality control (`Scene.set_frame_budget` / `Scene.render_budgeted`).
+//!
+//! `set_frame_budget` builds a quality ladder from the Scene grid and the effects the
+//! controller may toggle: coarser meshes first, then the Scene grid without effects, then
+//! each effect, then supersampling (`aa` 2..=max_aa, resolved by `terrain::resolve`). Every
+//! `render_budgeted` call renders the current level, times it (CPU encode, GPU passes from
+//! timestamp queries when the device has them, readback wait, host copy) and feeds the
+//! total to `Controller`, which picks the level for the next call:
+//!
+//! - a frame over target: drop straight to the best level predicted to fit with 10% margin
+//!   (the raw frame time decides, so a single overrun is enough);
+//! - the EWMA under `up_headroom × target` for `up_after` frames in a row: step up one
+//!   level, unless that level is predicted not to fit;
+//! - otherwise hold.
+//!
+//! Predictions use the level's own EWMA while it is fresh (measured in the last
+//! `STALE_AFTER` frames), so a level that just overran is not retried until conditions may
+//! have changed; otherwise the current level's cost is scaled by the ratio of `Level::units`.
+//!
+//! Budgeted renders keep their own meshes, targets and pipelines (cached per level) and
+//! serialise on `Scene::budget`; other render calls are unaffected.
+
+use std::collections::HashMap;
+use std::sync::atomic::Ordering;
+use std::sync::Arc;
+use std::time::Instant;
+
+use crate::terrain::pipeline::TerrainPipeline;
+use crate::terrain::variants::ShaderFeatures;
+
+use super::progressive::{copy_target, unpad, Refine};
+use super::{Scene, TEXTURE_FORMAT};
+
+/// EWMA weight of the newest frame time.
+const ALPHA: f64 = 0.5;
+/// A level is only moved to when predicted to take at most this share of the target.
+const FIT: f64 = 0.9;
+/// Frames after which a level's own measurement no longer predicts its cost.
+const STALE_AFTER: u64 = 120;
+
+/// One rung of the quality ladder.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(super) struct Level {
+    pub grid: u32,
+    pub aa: u32,
+    pub shadows: bool,
+    pub ao: bool,
+}
+
+impl Level {
+    /// Relative cost for `pixels` output pixels: vertices plus shaded samples, with each
+    /// effect weighted at half the base fragment cost.
+    fn units(&self, pixels: f64) -> f64 {
+        let effects = 1.0 + 0.5 * (self.shadows as u32 + self.ao as u32) as f64;
+        (self.grid as f64).powi(2) + pixels * (self.aa * self.aa) as f64 * effects
+    }
+}
+
+/// Levels from cheapest to best for a Scene of `grid`², toggling the given effects.
+pub(super) fn ladder(grid: u32, max_aa: u32, shadows: bool, ao: bool, min_grid: u32) -> Vec<Level> {
+    let base = Level { grid, aa: 1, shadows: false, ao: false };
+    let mut levels: Vec<Level> = [grid / 4, grid / 2]
+        .into_iter()
+        .filter(|&g| g >= min_grid.max(2) && g < grid)
+        .map(|g| Level { grid: g, ..base })
+        .collect();
+    levels.dedup();
+    levels.push(base);
+    if shadows {
+        levels.push(Level { shadows: true, ..*levels.last().unwrap() });
+    }
+    if ao {
+        levels.push(Level { ao: true, ..*levels.last().unwrap() });
+    }
+    let top = *levels.last().unwrap();
+    levels.extend((2..=max_aa).map(|aa| Level { aa, ..top }));
+    levels
+}
+
+/// Smoothed frame time of one level and the frame it was last measured on.
+#[derive(Debug, Clone, Copy)]
+struct Cost {
+    ms: f64,
+    frame: u64,
+}
+
+/// Level change decided after one frame.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(super) struct Decision {
+    pub from: usize,
+    pub to: usize,
+    pub reason: &'static str,
+}
+
+/// Hysteresis controller over a quality ladder (see the module docs).
+pub(super) struct Controller {
+    pub target_ms: f64,
+    pub levels: Vec<Level>,
+    pub current: usize,
+    pub up_headroom: f64,
+    pub up_after: u32,
+    pixels: f64,
+    cost: Vec<Option<Cost>>,
+    under: u32,
+    frame: u64,
+}
+
+impl Controller {
+    /// Starts at the cheapest level and climbs as measurements allow.
+    pub fn new(target_ms: f64, levels: Vec<Level>, pixels: f64, up_headroom: f64, up_after: u32) -> Self {
+        let cost = vec![None; levels.len()];
+        Self { target_ms, levels, current: 0, up_headroom, up_after, pixels, cost, under: 0, frame: 0 }
+    }
+
+    /// Smoothed frame time of level `i` (`None` until it has been rendered).
+    pub fn ewma_ms(&self, i: usize) -> Option<f64> {
+        self.cost[i].map(|c| c.ms)
+    }
+
+    /// Expected frame time of level `i`.
+    pub fn predict(&self, i: usize) -> Option<f64> {
+        if let Some(c) = self.cost[i].filter(|c| self.frame - c.frame <= STALE_AFTER) {
+            return Some(c.ms);
+        }
+        let cur = self.cost[self.current]?;
+        let (levels, px) = (&self.levels, self.pixels);
+        Some(cur.ms * levels[i].units(px) / levels[self.current].units(px))
+    }
+
+    fn fits(&self, i: usize) -> bool {
+        self.predict(i).map_or(false, |p| p <= FIT * self.target_ms)
+    }
+
+    /// Record the frame time of the current level and choose the next one.
+    pub fn observe(&mut self, frame_ms: f64) -> Decision {
+        self.frame += 1;
+        let from = self.current;
+        let ms = match self.cost[from] {
+            Some(c) if self.frame - c.frame <= STALE_AFTER => ALPHA * frame_ms + (1.0 - ALPHA) * c.ms,
+            _ => frame_ms,
+        };
+        self.cost[from] = Some(Cost { ms, frame: self.frame });
+
+        // Down on the frame just measured, up only on the smoothed cost.
+        let (to, reason) = if frame_ms > self.target_ms {
+            self.under = 0;
+            match (0..from).rev().find(|&i| self.fits(i)) {
+                Some(i) => (i, "over_budget"),
+                None if from > 0 => (0, "over_budget"),
+                None => (0, "min_quality"),
+            }
+        } else if ms < self.up_headroom * self.target_ms {
+            self.under += 1;
+            if from + 1 == self.levels.len() {
+                (from, "max_quality")
+            } else if self.under < self.up_after {
+                (from, "hold")
+            } else if self.fits(from + 1) {
+                self.under = 0;
+                (from + 1, "headroom")
+            } else {
+                (from, "next_over_budget")
+            }
+        } else {
+            self.under = 0;
+            (from, "within_budget")
+        };
+        self.current = to;
+        Decision { from, to, reason }
+    }
+}
+
+/// Per-stage times of one budgeted frame, in milliseconds.
+#[derive(Debug, Default, Clone, Copy)]
+pub(super) struct BudgetTimings {
+    /// Resource setup and command encoding on the calling thread.
+    pub encode_ms: f64,
+    /// Terrain pass and supersample resolve on the GPU (`None` without timestamp queries).
+    pub gpu_terrain_ms: Option<f64>,
+    pub gpu_resolve_ms: Option<f64>,
+    /// Submit until the readback buffer is mapped.
+    pub wait_ms: f64,
+    /// Unpadding the mapped rows into host memory.
+    pub copy_ms: f64,
+    pub total_ms: f64,
+}
+
+/// Outcome of one `render_budgeted` call.
+pub(super) struct BudgetFrame {
+    pub pixels: Vec<u8>,
+    pub level_index: usize,
+    pub level: Level,
+    pub features: ShaderFeatures,
+    pub timings: BudgetTimings,
+    pub target_ms: f64,
+    pub ewma_ms: f64,
+    pub decision: Decision,
+}
+
+/// Pipeline and groups 1 and 2 for one level permutation and content generation.
+struct BudgetDraw {
+    generation: u64,
+    tp: Arc<TerrainPipeline>,
+    bg1: wgpu::BindGroup,
+    bg2: wgpu::BindGroup,
+}
+
+/// Timestamp queries around the terrain pass (0, 1) and the resolve pass (2, 3).
+struct GpuTimer {
+    queries: wgpu::QuerySet,
+    resolved: wgpu::Buffer,
+    readback: wgpu::Buffer,
+    /// Nanoseconds per timestamp tick.
+    period: f64,
+}
+
+/// Controller and cached per-level resources of `set_frame_budget`.
+pub(super) struct BudgetState {
+    pub(super) controller: Controller,
+    /// Effects the controller toggles; the others follow the Scene features.
+    effects: ShaderFeatures,
+    meshes: HashMap<u32, (wgpu::Buffer, wgpu::Buffer, u32)>,
+    draws: HashMap<ShaderFeatures, BudgetDraw>,
+    targets: HashMap<u32, Refine>,
+    timer: Option<GpuTimer>,
+}
+
+impl Scene {
+    /// Enable (or reconfigure) the controller, or drop it with `target_ms = None`. Returns
+    /// the ladder; the controller restarts at its cheapest level.
+    pub(super) fn set_budget_state(&self, target_ms: Option<f64>, effects: &[String], max_aa: u32, min_grid: u32,
+                                   up_headroom: f64, up_after: u32) -> Result<Vec<Level>, String> {
+        let mut b = self.budget.lock().unwrap();
+        let Some(target_ms) = target_ms else {
+            *b = None;
+            return Ok(Vec::new());
+        };
+        if !(target_ms > 0.0) {
+            return Err("target_ms must be > 0".to_string());
+        }
+        if !(1..=4).contains(&max_aa) {
+            return Err("max_aa must be in 1..=4".to_string());
+        }
+        if !(up_headroom > 0.0 && up_headroom <= FIT) {
+            return Err(format!("up_headroom must be in (0, {FIT}]"));
+        }
+        self.caps.check_texture_2d(self.width * max_aa, self.height * max_aa)?;
+        let mut controlled = ShaderFeatures::empty();
+        for e in effects {
+            controlled = controlled.union(match e.to_ascii_lowercase().as_str() {
+                "shadows" => ShaderFeatures::SHADOWS,
+                "ao" => ShaderFeatures::AO,
+                other => return Err(format!("unknown effect '{other}' (expected 'shadows' or 'ao')")),
+            });
+        }
+        let levels = ladder(self.grid, max_aa, controlled.contains(ShaderFeatures::SHADOWS),
+                            controlled.contains(ShaderFeatures::AO), min_grid);
+        let pixels = self.width as f64 * self.height as f64;
+        let controller = Controller::new(target_ms, levels.clone(), pixels, up_headroom, up_after.max(1));
+        match b.as_mut() {
+            // Meshes, targets and pipelines stay valid across reconfiguration.
+            Some(state) => {
+                state.controller = controller;
+                state.effects = controlled;
+            }
+            None => {
+                *b = Some(BudgetState {
+                    controller, effects: controlled, meshes: HashMap::new(), draws: HashMap::new(),
+                    targets: HashMap::new(), timer: self.caps.timestamp_query().then(|| self.gpu_timer()),
+                });
+            }
+        }
+        Ok(levels)
+    }
+
+    fn gpu_timer(&self) -> GpuTimer {
+        let queries = self.device.create_query_set(&wgpu::QuerySetDescriptor {
+            label: Some("scene-budget-timestamps"), ty: wgpu::QueryType::Timestamp, count: 4,
+        });
+        let buffer = |label, usage| self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some(label), size: 4 * 8, usage, mapped_at_creation: false,
+        });
+        GpuTimer {
+            queries,
+            resolved: buffer("scene-budget-timestamps-resolved", wgpu::BufferUsages::QUERY_RESOLVE | wgpu::BufferUsages::COPY_SRC),
+            readback: buffer("scene-budget-timestamps-readback", wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ),
+            period: self.queue.get_timestamp_period() as f64,
+        }
+    }
+
+    /// Render the Scene camera at the controller's level, or `None` when it is disabled.
+    pub(super) fn render_budgeted_frame(&self) -> Result<Option<BudgetFrame>, String> {
+        let t0 = Instant::now();
+        let mut guard = self.budget.lock().unwrap();
+        let Some(b) = guard.as_mut() else { return Ok(None) };
+        let level_index = b.controller.current;
+        let level = b.controller.levels[level_index];
+
+        let mut features = self.state.read().unwrap().features;
+        for (flag, on) in [(ShaderFeatures::SHADOWS, level.shadows), (ShaderFeatures::AO, level.ao)] {
+            if b.effects.contains(flag) {
+                features = features.with(flag, on);
+            }
+        }
+        let features = features.resolve();
+        self.update_budget_draw(b, features);
+        if level.grid != self.grid && !b.meshes.contains_key(&level.grid) {
+            b.meshes.insert(level.grid, super::xyuv_grid(&self.device, level.grid));
+        }
+
+        let u = {
+            let st = self.state.read().unwrap();
+            let mut u = st.last_uniforms;
+            u.view = st.scene.view.to_cols_array_2d();
+            u
+        };
+        let d = &b.draws[&features];
+        if !b.targets.contains_key(&level.aa) {
+            let r = self.supersample_targets(&d.tp, level.aa);
+            b.targets.insert(level.aa, r);
+        }
+        let r = b.targets.get_mut(&level.aa).unwrap();
+        let mesh = match b.meshes.get(&level.grid) {
+            Some(m) => (&m.0, &m.1, m.2),
+            None => (&self.vbuf, &self.ibuf, self.nidx),
+        };
+        let timer = b.timer.as_ref();
+        let writes = |begin: u32| timer.map(|t| wgpu::RenderPassTimestampWrites {
+            query_set: &t.queries, beginning_of_pass_write_index: Some(begin), end_of_pass_write_index: Some(begin + 1),
+        });
+        let stamps = if level.aa > 1 { 4 } else { 2 };
+
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-budget") });
+        self.encode_supersampled((&*d.tp, &d.bg1, &d.bg2), r, mesh, &u, &mut encoder, [writes(0), writes(2)]);
+        let out = r.output();
+        copy_target(out, &mut encoder, &out.readback);
+        if let Some(t) = timer {
+            encoder.resolve_query_set(&t.queries, 0..stamps, &t.resolved, 0);
+            encoder.copy_buffer_to_buffer(&t.resolved, 0, &t.readback, 0, stamps as u64 * 8);
+        }
+        let mut timings = BudgetTimings { encode_ms: ms_since(t0), ..Default::default() };
+
+        let t1 = Instant::now();
+        let submission = self.queue.submit(Some(encoder.finish()));
+        let bytes = self.map_staging(&out.readback, submission.clone())?;
+        timings.wait_ms = ms_since(t1);
+        if let Some(t) = timer {
+            let ticks: Vec<u64> = self.map_staging(&t.readback, submission)?
+                .chunks_exact(8).map(bytemuck::pod_read_unaligned).collect();
+            let span = |i: usize| ticks[i + 1].checked_sub(ticks[i]).map(|n| n as f64 * t.period / 1e6);
+            timings.gpu_terrain_ms = span(0);
+            timings.gpu_resolve_ms = if level.aa > 1 { span(2) } else { None };
+        }
+        let t2 = Instant::now();
+        let pixels = unpad(&bytes, out.width, out.height);
+        timings.copy_ms = ms_since(t2);
+        timings.total_ms = ms_since(t0);
+
+        let decision = b.controller.observe(timings.total_ms);
+        Ok(Some(BudgetFrame {
+            pixels, level_index, level, features, timings,
+            target_ms: b.controller.target_ms,
+            ewma_ms: b.controller.ewma_ms(level_index).unwrap_or(timings.total_ms),
+            decision,
+        }))
+    }
+
+    /// Build (or rebuild after a content change) the pipeline and groups of `features`.
+    fn update_budget_draw(&self, b: &mut BudgetState, features: ShaderFeatures) {
+        let generation = self.generation.load(Ordering::Acquire);
+        if b.draws.get(&features).map_or(false, |d| d.generation == generation) {
+            return;
+        }
+        let tp = self.state.write().unwrap().pipelines.get_or_create(&self.device, TEXTURE_FORMAT, features);
+        let st = self.state.read().unwrap();
+        let (bg1, bg2) = self.height_lut_groups(&st, &tp);
+        b.draws.insert(features, BudgetDraw { generation, tp, bg1, bg2 });
+    }
+}
+
+fn ms_since(t: Instant) -> f64 {
+    t.elapsed().as_secs_f64() * 1000.0
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const PIXELS: f64 = 640.0 * 480.0;
+
+    /// Frame time proportional to `Level::units`, `ms_per_unit` per unit.
+    fn frame_ms(c: &Controller, ms_per_unit: f64) -> f64 {
+        c.levels[c.current].units(PIXELS) * ms_per_unit
+    }
+
+    #[test]
+    fn ladder_orders_grid_effects_then_aa() {
+        let l = ladder(256, 2, true, true, 16);
+        let summary: Vec<_> = l.iter().map(|l| (l.grid, l.aa, l.shadows, l.ao)).collect();
+        assert_eq!(summary, vec![
+            (64, 1, false, false), (128, 1, false, false), (256, 1, false, false),
+            (256, 1, true, false), (256, 1, true, true), (256, 2, true, true),
+        ]);
+        // Coarse levels below `min_grid` are dropped; no effects and no AA leaves the grid alone.
+        assert_eq!(ladder(32, 1, false, false, 16), vec![
+            Level { grid: 16, aa: 1, shadows: false, ao: false },
+            Level { grid: 32, aa: 1, shadows: false, ao: false },
+        ]);
+        assert!(l.windows(2).all(|w| w[0].units(PIXELS) < w[1].units(PIXELS)));
+    }
+
+    #[test]
+    fn climbs_then_settles_without_oscillating() {
+        let levels = ladder(256, 4, true, true, 16);
+        // 1 ms per million units: (256, aa 2, effects) fits a 3 ms budget, aa 3 does not.
+        let mut c = Controller::new(3.0, levels, PIXELS, 0.75, 3);
+        let mut path = Vec::new();
+        for _ in 0..200 {
+            let ms = frame_ms(&c, 1e-6);
+            path.push(c.observe(ms).to);
+        }
+        let settled = path[path.len() - 1];
+        assert_eq!(c.levels[settled], Level { grid: 256, aa: 2, shadows: true, ao: true });
+        assert!(path[40..].iter().all(|&l| l == settled), "{path:?}");
+        // Climbed one level at a time.
+        assert!(path.windows(2).all(|w| w[1] <= w[0] + 1));
+    }
+
+    #[test]
+    fn overload_drops_immediately() {
+        let levels = ladder(256, 2, true, true, 16);
+        let top = levels.len() - 1;
+        let mut c = Controller::new(10.0, levels, PIXELS, 0.75, 1);
+        for _ in 0..50 {
+            let ms = frame_ms(&c, 1e-6);
+            c.observe(ms);
+        }
+        assert_eq!(c.current, top);
+        // Ten times slower: one frame is enough to leave the top level for one that fits.
+        let ms = frame_ms(&c, 1e-5);
+        let d = c.observe(ms);
+        assert_eq!((d.from, d.reason), (top, "over_budget"));
+        assert!(d.to < top && c.predict(d.to).unwrap() <= FIT * 10.0);
+    }
+
+    #[test]
+    fn expensive_level_is_not_retried_until_stale() {
+        let levels = ladder(256, 2, false, false, 16);
+        let mut c = Controller::new(10.0, levels, PIXELS, 0.75, 1);
+        // The cost model says aa 2 fits; measured it takes twice the budget.
+        let measured = |c: &Controller| if c.levels[c.current].aa == 2 { 20.0 } else { 2.0 };
+        let mut visits = Vec::new();
+        for frame in 0..(2 * STALE_AFTER) {
+            if c.levels[c.current].aa == 2 {
+                visits.push(frame);
+            }
+            let ms = measured(&c);
+            c.observe(ms);
+        }
+        assert!(visits.len() >= 2, "{visits:?}");
+        assert!(visits.windows(2).all(|w| w[1] - w[0] > STALE_AFTER), "{visits:?}");
+    }
+
+    #[test]
+    fn holds_in_the_hysteresis_band() {
+        let levels = ladder(128, 2, true, false, 16);
+        let mut c = Controller::new(10.0, levels, PIXELS, 0.75, 3);
+        c.current = 2;
+        // Between headroom and target: neither up nor down.
+        for _ in 0..20 {
+            assert_eq!(c.observe(8.0).reason, "within_budget");
+        }
+        assert_eq!(c.current, 2);
+        // Under headroom, but only after `up_after` frames.
+        assert_eq!(c.observe(1.0).to, 2);
+        assert_eq!(c.observe(1.0).to, 2);
+        assert_eq!(c.observe(1.0).reason, "headroom");
+        assert_eq!(c.current, 3);
+    }
+
+    #[test]
+    fn one_frame_over_target_drops_even_when_the_ewma_fits() {
+        let levels = ladder(128, 2, true, false, 16);
+        let mut c = Controller::new(10.0, levels, PIXELS, 0.75, 3);
+        c.current = 2;
+        for _ in 0..20 {
+            c.observe(8.0);
+        }
+        // The EWMA only reaches 9.5 ms, but the frame itself ran over.
+        let d = c.observe(11.0);
+        assert!(c.ewma_ms(2).unwrap() < 10.0);
+        assert_eq!((d.from, d.reason), (2, "over_budget"));
+        assert!(d.to < 2);
+    }
+}
@@ -0,0 +1,311 @@
+//! Dataset renders: colour, linear depth, view-space normals and class IDs from one pass.
+//!
+//! `Scene.render_dataset` draws with the DATASET shader permutation into four render targets
+//! plus a depth buffer, copies every target into the slot's readback buffer and unpads them
+//! into one record per frame:
+//!
+//! | field    | dtype / shape      | content                                              |
+//! |----------|--------------------|------------------------------------------------------|
+//! | `rgba`   | `u1 (H, W, 4)`     | shaded colour (depth-tested)                         |
+//! | `depth`  | `<f4 (H, W)`       | linear view depth (0 where no terrain)               |
+//! | `normal` | `<f2 (H, W, 2)`    | view-space normal x, y (z = sqrt(1 - x² - y²))       |
+//! | `class`  | `u1 (H, W)`        | class raster value (`CLASS_NONE` where no terrain)   |
+//!
+//! Planes are stored back to back inside a record, so unpadding is a row `memcpy` and each
+//! field is a contiguous (N, H, W, ...) view in numpy.
+
+use pyo3::prelude::*;
+
+use crate::terrain::pipeline::{
+    TerrainPipeline, DATASET_CLASS_FORMAT, DATASET_DEPTH_FORMAT, DATASET_NORMAL_FORMAT, DATASET_ZBUFFER_FORMAT,
+};
+use crate::terrain::variants::ShaderFeatures;
+
+use super::{FrameDraws, RenderSlot, Scene, TEXTURE_FORMAT};
+
+/// Class value of pixels the terrain does not cover.
+pub const CLASS_NONE: u8 = 255;
+
+/// (field, numpy element format, bytes per pixel, texture format) in record order.
+const PLANES: [(&str, &str, u32, wgpu::TextureFormat); 4] = [
+    ("rgba", "u1", 4, TEXTURE_FORMAT),
+    ("depth", "<f4", 4, DATASET_DEPTH_FORMAT),
+    ("normal", "<f2", 4, DATASET_NORMAL_FORMAT),
+    ("class", "u1", 1, DATASET_CLASS_FORMAT),
+];
+
+/// Aux targets of one render slot, created on its first dataset render.
+pub(super) struct DatasetTargets {
+    depth: wgpu::Texture,
+    normal: wgpu::Texture,
+    class: wgpu::Texture,
+    depth_view: wgpu::TextureView,
+    normal_view: wgpu::TextureView,
+    class_view: wgpu::TextureView,
+    zbuffer: wgpu::TextureView,
+    /// One view matrix per frame at `view_stride` offsets (group 3, dynamic offset).
+    view_ubo: Option<wgpu::Buffer>,
+}
+
+/// Submitted dataset frames whose readback has not been consumed yet.
+pub(super) struct PendingDataset {
+    slot: RenderSlot,
+    count: usize,
+    /// Readback offset and padded row pitch of each plane within one frame.
+    planes: [(u64, u32); 4],
+    frame_bytes: u64,
+    submission: Option<wgpu::SubmissionIndex>,
+    mapped: super::MapState,
+}
+
+impl Scene {
+    /// Bytes of one dataset record (all planes, unpadded).
+    pub(super) fn dataset_record_len(&self) -> usize {
+        let px = self.width as usize * self.height as usize;
+        PLANES.iter().map(|p| p.2 as usize * px).sum()
+    }
+
+    /// numpy dtype of one record: planar fields `rgba`, `depth`, `normal`, `class`.
+    pub(super) fn dataset_dtype<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyAny>> {
+        let (h, w) = (self.height as usize, self.width as usize);
+        let (mut names, mut formats, mut offsets) = (Vec::new(), Vec::new(), Vec::new());
+        let mut offset = 0usize;
+        for (name, fmt, bpp, _) in PLANES {
+            let shape = match name {
+                "rgba" => format!("({},{},4)", h, w),
+                "normal" => format!("({},{},2)", h, w),
+                _ => format!("({},{})", h, w),
+            };
+            names.push(name);
+            formats.push(format!("{}{}", shape, fmt));
+            offsets.push(offset);
+            offset += bpp as usize * h * w;
+        }
+        let spec = pyo3::types::PyDict::new(py);
+        spec.set_item("names", names)?;
+        spec.set_item("formats", formats)?;
+        spec.set_item("offsets", offsets)?;
+        spec.set_item("itemsize", offset)?;
+        py.import("numpy")?.getattr("dtype")?.call1((spec,))
+    }
+
+    /// Upload the categorical raster sampled (nearest, by terrain UV) into the class target.
+    pub(super) fn upload_classes(&self, w: u32, h: u32, data: &[u8]) -> Result<(), String> {
+        if w == 0 || h == 0 || data.len() != (w * h) as usize {
+            return Err("classes must be a non-empty uint8[H,W]".to_string());
+        }
+        self.caps.check_texture_2d(w, h)?;
+        let view = class_texture(&self.device, &self.queue, w, h, data);
+        self.state.write().unwrap().class_view = view;
+        Ok(())
+    }
+
+    fn dataset_targets(&self) -> DatasetTargets {
+        let size = wgpu::Extent3d { width: self.width, height: self.height, depth_or_array_layers: 1 };
+        let target = |label, format, usage| {
+            self.device.create_texture(&wgpu::TextureDescriptor {
+                label: Some(label), size, mip_level_count: 1, sample_count: 1,
+                dimension: wgpu::TextureDimension::D2, format, usage, view_formats: &[],
+            })
+        };
+        let aux = wgpu::TextureUsages::RENDER_ATTACHMENT | wgpu::TextureUsages::COPY_SRC;
+        let depth = target("scene-dataset-depth", DATASET_DEPTH_FORMAT, aux);
+        let normal = target("scene-dataset-normal", DATASET_NORMAL_FORMAT, aux);
+        let class = target("scene-dataset-class", DATASET_CLASS_FORMAT, aux);
+        let zbuffer = target("scene-dataset-zbuffer", DATASET_ZBUFFER_FORMAT, wgpu::TextureUsages::RENDER_ATTACHMENT)
+            .create_view(&Default::default());
+        DatasetTargets {
+            depth_view: depth.create_view(&Default::default()),
+            normal_view: normal.create_view(&Default::default()),
+            class_view: class.create_view(&Default::default()),
+            depth, normal, class, zbuffer, view_ubo: None,
+        }
+    }
+
+    /// Render `frames` (one draw each) with the DATASET permutation and request the readback.
+    pub(super) fn submit_dataset(&self, frames: &[FrameDraws]) -> PendingDataset {
+        let align = wgpu::COPY_BYTES_PER_ROW_ALIGNMENT;
+        let mut planes = [(0u64, 0u32); 4];
+        let mut frame_bytes = 0u64;
+        for (i, (_, _, bpp, _)) in PLANES.iter().enumerate() {
+            let padded = (self.width * bpp + align - 1) / align * align;
+            planes[i] = (frame_bytes, padded);
+            frame_bytes += padded as u64 * self.height as u64;
+        }
+        let total = frame_bytes * frames.len() as u64;
+        let view_stride = (64u64).max(self.device.limits().min_uniform_buffer_offset_alignment as u64);
+
+        let tp = self.dataset_pipeline();
+        let st = self.state.read().unwrap();
+        let mut slot = self.acquire_slot(&st, &st.tp);
+        let mut targets = slot.dataset.take().unwrap_or_else(|| self.dataset_targets());
+        let ubo_bytes = view_stride * frames.len() as u64;
+        if targets.view_ubo.as_ref().map_or(true, |b| b.size() < ubo_bytes) {
+            targets.view_ubo = Some(self.device.create_buffer(&wgpu::BufferDescriptor {
+                label: Some("scene-dataset-views"), size: ubo_bytes,
+                usage: wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST, mapped_at_creation: false,
+            }));
+        }
+        if slot.readback.as_ref().map_or(true, |b| b.size() < total) {
+            slot.readback = Some(self.device.create_buffer(&wgpu::BufferDescriptor {
+                label: Some("scene-readback"), size: total,
+                usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ, mapped_at_creation: false,
+            }));
+        }
+        let view_ubo = targets.view_ubo.as_ref().unwrap();
+        let mut view_data = vec![0u8; ubo_bytes as usize];
+        for (i, f) in frames.iter().enumerate() {
+            let at = i * view_stride as usize;
+            view_data[at..at + 64].copy_from_slice(bytemuck::cast_slice(&f.view.to_cols_array()));
+        }
+        self.queue.write_buffer(view_ubo, 0, &view_data);
+
+        // Group 0 and groups 1/2 must come from this permutation's layouts.
+        let bg0 = tp.make_bg_globals(&self.device, &slot.ubo);
+        let (bg1, bg2) = self.height_lut_groups(&st, &tp);
+        let bg3 = tp.make_bg_dataset(&self.device, &st.class_view, view_ubo);
+        let readback = slot.readback.as_ref().unwrap();
+        let textures = [&slot.color, &targets.depth, &targets.normal, &targets.class];
+
+        let mut last = None;
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-dataset") });
+        for (i, f) in frames.iter().enumerate() {
+            let mut u = st.last_uniforms;
+            u.view = f.view.to_cols_array_2d();
+            if !self.caps.push_constants() {
+                // UBO path: queue writes are ordered between submissions only.
+                self.queue.write_buffer(&slot.ubo, 0, bytemuck::bytes_of(&u));
+            }
+            self.encode_dataset_pass(&tp, &slot, &targets, &mut encoder, [&bg0, &bg1, &bg2, &bg3], (i as u64 * view_stride) as u32, &u);
+            for (k, tex) in textures.iter().enumerate() {
+                let (offset, padded) = planes[k];
+                encoder.copy_texture_to_buffer(
+                    wgpu::ImageCopyTexture { texture: tex, mip_level: 0, origin: wgpu::Origin3d::ZERO, aspect: wgpu::TextureAspect::All },
+                    wgpu::ImageCopyBuffer { buffer: readback, layout: wgpu::ImageDataLayout {
+                        offset: frame_bytes * i as u64 + offset,
+                        bytes_per_row: Some(padded),
+                        rows_per_image: Some(self.height),
+                    }},
+                    wgpu::Extent3d { width: self.width, height: self.height, depth_or_array_layers: 1 },
+                );
+            }
+            if !self.caps.push_constants() {
+                let done = std::mem::replace(
+                    &mut encoder,
+                    self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-dataset") }),
+                );
+                last = Some(self.queue.submit(Some(done.finish())));
+            }
+        }
+        if self.caps.push_constants() {
+            last = Some(self.queue.submit(Some(encoder.finish())));
+        }
+        drop(st);
+        slot.dataset = Some(targets);
+
+        let mapped = super::MapState::default();
+        let result = mapped.clone();
+        slot.readback.as_ref().unwrap().slice(..total).map_async(wgpu::MapMode::Read, move |r| {
+            let _ = result.set(r);
+        });
+        PendingDataset { slot, count: frames.len(), planes, frame_bytes, submission: last, mapped }
+    }
+
+    #[allow(clippy::too_many_arguments)]
+    fn encode_dataset_pass(&self, tp: &TerrainPipeline, slot: &RenderSlot, targets: &DatasetTargets,
+                           encoder: &mut wgpu::CommandEncoder, groups: [&wgpu::BindGroup; 4], view_offset: u32,
+                           u: &crate::terrain::TerrainUniforms) {
+        let clear = |c: wgpu::Color| wgpu::Operations { load: wgpu::LoadOp::Clear(c), store: wgpu::StoreOp::Store };
+        let attachment = |view, c| Some(wgpu::RenderPassColorAttachment { view, resolve_target: None, ops: clear(c) });
+        let none = CLASS_NONE as f64;
+        let mut rp = encoder.begin_render_pass(&wgpu::RenderPassDescriptor {
+            label: Some("scene-dataset-rp"),
+            color_attachments: &[
+                attachment(&slot.color_view, wgpu::Color { r: 0.02, g: 0.02, b: 0.03, a: 1.0 }),
+                attachment(&targets.depth_view, wgpu::Color::TRANSPARENT),
+                attachment(&targets.normal_view, wgpu::Color::TRANSPARENT),
+                attachment(&targets.class_view, wgpu::Color { r: none, g: none, b: none, a: none }),
+            ],
+            depth_stencil_attachment: Some(wgpu::RenderPassDepthStencilAttachment {
+                view: &targets.zbuffer,
+                depth_ops: Some(wgpu::Operations { load: wgpu::LoadOp::Clear(1.0), store: wgpu::StoreOp::Discard }),
+                stencil_ops: None,
+            }),
+            ..Default::default()
+        });
+        rp.set_pipeline(&tp.pipeline);
+        rp.set_bind_group(0, groups[0], &[]);
+        rp.set_bind_group(1, groups[1], &[]);
+        rp.set_bind_group(2, groups[2], &[]);
+        rp.set_bind_group(3, groups[3], &[view_offset]);
+        rp.set_vertex_buffer(0, self.vbuf.slice(..));
+        rp.set_index_buffer(self.ibuf.slice(..), wgpu::IndexFormat::Uint32);
+        if self.caps.push_constants() {
+            let p = crate::terrain::DrawPush::from_uniforms(u, [0.0; 3]);
+            rp.set_push_constants(wgpu::ShaderStages::VERTEX_FRAGMENT, 0, bytemuck::bytes_of(&p));
+        }
+        rp.draw_indexed(0..self.nidx, 0, 0..1);
+    }
+
+    /// DATASET variant of the Scene's current permutation (compiled once, then cached).
+    fn dataset_pipeline(&self) -> std::sync::Arc<TerrainPipeline> {
+        let mut st = self.state.write().unwrap();
+        let features = st.features.union(ShaderFeatures::DATASET);
+        st.pipelines.get_or_create(&self.device, TEXTURE_FORMAT, features)
+    }
+
+    /// Wait for `pending` and unpad every plane into `out` (`count` records back to back). A
+    /// failed map is returned and the slot is discarded.
+    pub(super) fn read_dataset_into(&self, mut pending: PendingDataset, out: &mut [u8]) -> Result<(), String> {
+        if let Err(e) = self.wait_mapped(&pending.mapped, pending.submission.take(), "dataset readback") {
+            self.discard_dataset(pending);
+            return Err(e);
+        }
+        let record = self.dataset_record_len();
+        assert_eq!(out.len(), record * pending.count, "dataset destination size");
+        let total = pending.frame_bytes * pending.count as u64;
+        let readback = pending.slot.readback.as_ref().unwrap();
+        let data = readback.slice(..total).get_mapped_range();
+        for (i, dst) in out.chunks_exact_mut(record).enumerate() {
+            let base = pending.frame_bytes as usize * i;
+            let mut at = 0;
+            for (k, (_, _, bpp, _)) in PLANES.iter().enumerate() {
+                let (offset, padded) = pending.planes[k];
+                let row = (self.width * bpp) as usize;
+                for y in 0..self.height as usize {
+                    let s = base + offset as usize + y * padded as usize;
+                    dst[at..at + row].copy_from_slice(&data[s..s + row]);
+                    at += row;
+                }
+            }
+        }
+        drop(data);
+        readback.unmap();
+        self.release_slot(pending.slot);
+        Ok(())
+    }
+
+    /// Drop a never-read dataset submission (see `discard_frames`).
+    pub(super) fn discard_dataset(&self, pending: PendingDataset) {
+        drop(pending);
+        self.slots_created.fetch_sub(1, std::sync::atomic::Ordering::Relaxed);
+    }
+}
+
+/// R8Uint class texture (rows written unpadded; `write_texture` has no row alignment).
+pub(super) fn class_texture(device: &wgpu::Device, queue: &wgpu::Queue, w: u32, h: u32, data: &[u8]) -> wgpu::TextureView {
+    let tex = device.create_texture(&wgpu::TextureDescriptor {
+        label: Some("scene-class-r8u"),
+        size: wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
+        mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
+        format: DATASET_CLASS_FORMAT,
+        usage: wgpu::TextureUsages::TEXTURE_BINDING | wgpu::TextureUsages::COPY_DST, view_formats: &[],
+    });
+    queue.write_texture(
+        wgpu::ImageCopyTexture { texture: &tex, mip_level: 0, origin: wgpu::Origin3d::ZERO, aspect: wgpu::TextureAspect::All },
+        data,
+        wgpu::ImageDataLayout { offset: 0, bytes_per_row: Some(w), rows_per_image: Some(h) },
+        wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
+    );
+    tex.create_view(&Default::default())
+}
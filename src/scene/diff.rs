@@ -0,0 +1,244 @@
+//! DEM differencing / change detection.
+//!
+//! `Scene.set_diff` uploads two epochs into their own R32F textures and switches to the DIFF
+//! permutation: geometry comes from one epoch, both are shaded with epoch a's normals, and
+//! colour is `a - b` through a diverging LUT. `update_epoch` rewrites a window of one epoch
+//! in place (the other is not touched), and `diff_stats` reduces the difference on the GPU
+//! (`terrain::diff`) so only the histogram and per-workgroup partials are read back.
+
+use crate::terrain::diff::{DiffStatsGpu, DiffSummary, Partial, StatsParams, MAX_BINS};
+use crate::terrain::pipeline::TerrainPipeline;
+use crate::terrain::variants::ShaderFeatures;
+
+use super::Scene;
+
+/// Group-1 `DiffParams` block (16 bytes, must match `terrain.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, bytemuck::Pod, bytemuck::Zeroable)]
+struct DiffParams {
+    range: f32,
+    surface: f32,
+    _pad: [f32; 2],
+}
+
+/// The two epochs, their shading parameters and the stats kernel.
+pub(super) struct DiffEpochs {
+    a: wgpu::Texture,
+    a_view: wgpu::TextureView,
+    b: wgpu::Texture,
+    b_view: wgpu::TextureView,
+    width: u32,
+    height: u32,
+    params: wgpu::Buffer,
+    lut_view: wgpu::TextureView,
+    stats: DiffStatsGpu,
+    /// Permutation `clear_diff` returns to (DIFF and its implied NORMAL_MAP removed).
+    base: ShaderFeatures,
+}
+
+impl DiffEpochs {
+    pub(super) fn make_bg_height(&self, device: &wgpu::Device, tp: &TerrainPipeline, samp: &wgpu::Sampler) -> wgpu::BindGroup {
+        tp.make_bg_height_diff(device, &self.a_view, &self.b_view, samp, &self.params)
+    }
+
+    pub(super) fn lut_view(&self) -> &wgpu::TextureView {
+        &self.lut_view
+    }
+
+    pub(super) fn texels(&self) -> u64 {
+        self.width as u64 * self.height as u64
+    }
+
+    /// `set_features` while bound: remember the new selection and return it plus DIFF.
+    pub(super) fn rebase(&mut self, features: ShaderFeatures) -> ShaderFeatures {
+        self.base = features;
+        features.union(ShaderFeatures::DIFF).resolve()
+    }
+}
+
+/// `'a'` → 0, `'b'` → 1.
+pub(super) fn parse_epoch(name: &str) -> Result<u32, String> {
+    match name.to_lowercase().as_str() {
+        "a" => Ok(0),
+        "b" => Ok(1),
+        _ => Err(format!("epoch must be 'a' or 'b' (got '{}')", name)),
+    }
+}
+
+impl Scene {
+    fn epoch_texture(&self, label: &str, w: u32, h: u32) -> wgpu::Texture {
+        self.device.create_texture(&wgpu::TextureDescriptor {
+            label: Some(label),
+            size: wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
+            mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
+            format: wgpu::TextureFormat::R32Float,
+            usage: wgpu::TextureUsages::TEXTURE_BINDING | wgpu::TextureUsages::COPY_DST, view_formats: &[],
+        })
+    }
+
+    /// `w × h` row-major `data` into `tex` at (x, y); queue writes need no row padding.
+    fn write_epoch(&self, tex: &wgpu::Texture, x: u32, y: u32, w: u32, h: u32, data: &[f32]) {
+        self.queue.write_texture(
+            wgpu::ImageCopyTexture { texture: tex, mip_level: 0, origin: wgpu::Origin3d { x, y, z: 0 }, aspect: wgpu::TextureAspect::All },
+            bytemuck::cast_slice(data),
+            wgpu::ImageDataLayout { offset: 0, bytes_per_row: Some(w * 4), rows_per_image: Some(h) },
+            wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
+        );
+    }
+
+    /// Upload both epochs (`w × h` each) and bind the DIFF permutation.
+    pub(super) fn set_diff_epochs(&self, w: u32, h: u32, a: &[f32], b: &[f32]) -> Result<(), String> {
+        if w == 0 || h == 0 || a.len() != (w * h) as usize || b.len() != a.len() {
+            return Err("a and b must be non-empty float32[H,W] of the same shape".to_string());
+        }
+        self.caps.check_texture_2d(w, h)?;
+        let (ta, tb) = (self.epoch_texture("scene-diff-a", w, h), self.epoch_texture("scene-diff-b", w, h));
+        self.write_epoch(&ta, 0, 0, w, h, a);
+        self.write_epoch(&tb, 0, 0, w, h, b);
+
+        let mut st = self.state.write().unwrap();
+        // A flood extent of the Scene height does not apply to the epochs.
+        if st.water.take().is_some() {
+            st.features = st.features.without(ShaderFeatures::WATER);
+        }
+        let (params, lut_view, stats, base) = match st.diff.take() {
+            Some(d) => (d.params, d.lut_view, d.stats, d.base),
+            None => {
+                let params = self.device.create_buffer(&wgpu::BufferDescriptor {
+                    label: Some("scene-diff-params"), size: std::mem::size_of::<DiffParams>() as u64,
+                    usage: wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST, mapped_at_creation: false,
+                });
+                (params, self.diverging_lut(), DiffStatsGpu::new(&self.device), st.features)
+            }
+        };
+        st.diff = Some(DiffEpochs {
+            a_view: ta.create_view(&Default::default()), a: ta,
+            b_view: tb.create_view(&Default::default()), b: tb,
+            width: w, height: h, params, lut_view, stats, base,
+        });
+        let features = st.features.union(ShaderFeatures::DIFF);
+        self.rebind(&mut st, features);
+        Ok(())
+    }
+
+    /// Diverging LUT in the Scene colormap's format (sRGB bytes, or linearized for UNORM).
+    fn diverging_lut(&self) -> wgpu::TextureView {
+        let srgb = crate::colormap::diverging_rgba8();
+        let palette = match self.colormap.format {
+            wgpu::TextureFormat::Rgba8UnormSrgb => srgb,
+            _ => crate::colormap::to_linear_u8_rgba(&srgb),
+        };
+        let tex = self.device.create_texture(&wgpu::TextureDescriptor {
+            label: Some("scene-diff-lut"),
+            size: wgpu::Extent3d { width: 256, height: 1, depth_or_array_layers: 1 },
+            mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
+            format: self.colormap.format,
+            usage: wgpu::TextureUsages::TEXTURE_BINDING | wgpu::TextureUsages::COPY_DST, view_formats: &[],
+        });
+        self.queue.write_texture(
+            wgpu::ImageCopyTexture { texture: &tex, mip_level: 0, origin: wgpu::Origin3d::ZERO, aspect: wgpu::TextureAspect::All },
+            &palette,
+            wgpu::ImageDataLayout { offset: 0, bytes_per_row: Some(256 * 4), rows_per_image: Some(1) },
+            wgpu::Extent3d { width: 256, height: 1, depth_or_array_layers: 1 },
+        );
+        tex.create_view(&Default::default())
+    }
+
+    /// Overwrite the `w × h` window at (x, y) of epoch 0 (a) or 1 (b).
+    pub(super) fn update_epoch_region(&self, epoch: u32, x: u32, y: u32, w: u32, h: u32, data: &[f32]) -> Result<(), String> {
+        let st = self.state.read().unwrap();
+        let d = st.diff.as_ref().ok_or("no difference bound; call set_diff(a, b) first")?;
+        if w == 0 || h == 0 || data.len() != (w * h) as usize {
+            return Err("patch must be a non-empty float32[h,w]".to_string());
+        }
+        if x.checked_add(w).map_or(true, |e| e > d.width) || y.checked_add(h).map_or(true, |e| e > d.height) {
+            return Err(format!("patch {}x{} at ({}, {}) exceeds the {}x{} epoch", w, h, x, y, d.width, d.height));
+        }
+        self.write_epoch(if epoch == 0 { &d.a } else { &d.b }, x, y, w, h, data);
+        self.touch_content();
+        Ok(())
+    }
+
+    /// Colour saturation (`range`; `None`: max |a - b|) and displaced epoch (0 = a, 1 = b).
+    pub(super) fn apply_diff_style(&self, range: Option<f32>, surface: u32) -> Result<f32, String> {
+        let range = match range {
+            Some(r) if r > 0.0 && r.is_finite() => r,
+            Some(_) => return Err("range must be a positive finite number".to_string()),
+            None => {
+                let s = self.diff_summary(1, Some((0.0, 1.0)))?;
+                let r = s.min.abs().max(s.max.abs());
+                if r > 0.0 && r.is_finite() { r } else { 1.0 }
+            }
+        };
+        let st = self.state.read().unwrap();
+        let d = st.diff.as_ref().ok_or("no difference bound; call set_diff(a, b) first")?;
+        let p = DiffParams { range, surface: surface as f32, _pad: [0.0; 2] };
+        self.queue.write_buffer(&d.params, 0, bytemuck::bytes_of(&p));
+        self.touch_content();
+        Ok(range)
+    }
+
+    /// Drop the epochs and return to the Scene height and colormap.
+    pub(super) fn clear_diff_epochs(&self) {
+        let mut st = self.state.write().unwrap();
+        if let Some(d) = st.diff.take() {
+            // The colormap source may have been set or cleared while the difference was shown.
+            let base = d.base.with(ShaderFeatures::SCALAR, st.scalar.is_some());
+            self.rebind(&mut st, base);
+        }
+    }
+
+    /// Reduce `a - b` on the GPU into `bins` bins over `range` (`None`: [min, max] from a
+    /// first pass, widened by 0.5 when flat, as numpy.histogram).
+    pub(super) fn diff_summary(&self, bins: u32, range: Option<(f32, f32)>) -> Result<DiffSummary, String> {
+        if bins == 0 || bins > MAX_BINS {
+            return Err(format!("bins must be in [1, {}]", MAX_BINS));
+        }
+        let (lo, hi) = match range {
+            Some((lo, hi)) if lo < hi && lo.is_finite() && hi.is_finite() => (lo, hi),
+            Some(_) => return Err("range must be finite (lo, hi) with lo < hi".to_string()),
+            None => {
+                let s = self.diff_pass(1, 0.0, 1.0)?;
+                match (s.min, s.max) {
+                    _ if s.valid == 0 => (0.0, 1.0),
+                    (lo, hi) if lo == hi => (lo - 0.5, hi + 0.5),
+                    (lo, hi) => (lo, hi),
+                }
+            }
+        };
+        self.diff_pass(bins, lo, hi)
+    }
+
+    fn diff_pass(&self, bins: u32, lo: f32, hi: f32) -> Result<DiffSummary, String> {
+        let hist_bytes = (bins as u64 + 2) * 4;
+        let (submission, staging, part_bytes) = {
+            let st = self.state.read().unwrap();
+            let d = st.diff.as_ref().ok_or("no difference bound; call set_diff(a, b) first")?;
+            let (gx, gy) = DiffStatsGpu::workgroups(d.width, d.height);
+            let part_bytes = (gx * gy) as u64 * std::mem::size_of::<Partial>() as u64;
+            let storage = |label, size| self.device.create_buffer(&wgpu::BufferDescriptor {
+                label: Some(label), size,
+                usage: wgpu::BufferUsages::STORAGE | wgpu::BufferUsages::COPY_SRC, mapped_at_creation: false,
+            });
+            // New buffers are zero-initialized, which the histogram relies on.
+            let (hist, partials) = (storage("scene-diff-hist", hist_bytes), storage("scene-diff-partials", part_bytes));
+            let staging = self.device.create_buffer(&wgpu::BufferDescriptor {
+                label: Some("scene-diff-readback"), size: hist_bytes + part_bytes,
+                usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ, mapped_at_creation: false,
+            });
+            let params = StatsParams { size: [d.width, d.height], bins, _p0: 0, lo, hi, _p1: [0.0; 2] };
+            let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-diff-stats") });
+            d.stats.encode(&self.device, &mut encoder, &d.a_view, &d.b_view, &params, &hist, &partials);
+            encoder.copy_buffer_to_buffer(&hist, 0, &staging, 0, hist_bytes);
+            encoder.copy_buffer_to_buffer(&partials, 0, &staging, hist_bytes, part_bytes);
+            (self.queue.submit(Some(encoder.finish())), staging, part_bytes)
+        };
+        let data = self.map_staging(&staging, submission)?;
+        let hist: Vec<u32> = data[..hist_bytes as usize].chunks_exact(4).map(bytemuck::pod_read_unaligned).collect();
+        let partials: Vec<Partial> = data[hist_bytes as usize..(hist_bytes + part_bytes) as usize]
+            .chunks_exact(std::mem::size_of::<Partial>())
+            .map(bytemuck::pod_read_unaligned)
+            .collect();
+        Ok(DiffSummary::from_partials(hist, &partials))
+    }
+}
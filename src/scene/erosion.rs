@@ -0,0 +1,153 @@
+//! Hydraulic and thermal erosion of the Scene height texture.
+//!
+//! The first `Scene.erode` loads the bound height texture into the `terrain::erosion`
+//! state buffers (`cs_init`), and every later call advances the same state. Iterations are
+//! submitted in batches, and each batch ends with `cs_store`, which writes the terrain into
+//! an erosion-owned `R32Float` texture that stands in for the Scene height. A render between
+//! two batches therefore shows the intermediate terrain without any readback; only
+//! `erosion_fields` copies state to the host. The uploaded texture is only sampled and has
+//! no storage usage, so it is kept unchanged and `reset_erosion` binds it again.
+
+use crate::terrain::erosion::{Cell, ErosionGpu, ErosionParams};
+use crate::terrain::procgen;
+
+use super::{Scene, SceneState};
+
+/// Erosion kernels, the ping-pong state and the height texture they write.
+pub(super) struct ErosionState {
+    gpu: ErosionGpu,
+    params: wgpu::Buffer,
+    /// Ping-pong state; `bgs[i]` reads `cells[i]` and writes the other buffer.
+    cells: [wgpu::Buffer; 2],
+    bgs: [wgpu::BindGroup; 2],
+    /// Index of the buffer holding the current state.
+    cur: usize,
+    /// Written by `cs_store`, bound as the Scene height while the erosion is live.
+    target: wgpu::Texture,
+    /// Height view bound before the first `erode` (restored by `reset_erosion`).
+    source: wgpu::TextureView,
+    pub(super) p: ErosionParams,
+    /// Iterations run since the state was loaded.
+    pub(super) iterations: u64,
+}
+
+impl Scene {
+    /// Parameters of the live erosion, or the defaults for the bound height texture.
+    pub(super) fn erosion_base(&self) -> Result<ErosionParams, String> {
+        let st = self.state.read().unwrap();
+        match (&st.erosion, &st.height_view) {
+            (Some(e), _) => Ok(e.p),
+            (None, Some(_)) => Ok(ErosionParams::new(st.height_size.0, st.height_size.1)),
+            (None, None) => Err("no height texture bound; call set_height_from_r32f or generate_height first".to_string()),
+        }
+    }
+
+    /// Run `iterations` iterations with `p`, `batch` per submission, storing the terrain
+    /// after every batch. With `record_every > 0` a frame is rendered after every
+    /// `record_every` iterations. Returns the total iterations and the frames.
+    pub(super) fn erode_batches(&self, p: ErosionParams, iterations: u32, batch: u32, record_every: u32)
+        -> Result<(u64, Vec<u8>), String> {
+        let mut frames = Vec::new();
+        let mut total = {
+            let mut st = self.state.write().unwrap();
+            self.bind_erosion(&mut st, p)?;
+            st.erosion.as_ref().unwrap().iterations
+        };
+        let mut done = 0;
+        while done < iterations {
+            let until_frame = if record_every > 0 { record_every - done % record_every } else { u32::MAX };
+            let n = batch.min(until_frame).min(iterations - done);
+            {
+                let mut st = self.state.write().unwrap();
+                let e = st.erosion.as_mut().ok_or("erosion was reset while running")?;
+                let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-erosion") });
+                e.cur = e.gpu.encode_iterations(&mut encoder, &e.bgs, e.cur, &e.p, n);
+                e.gpu.encode_store(&mut encoder, &e.bgs[e.cur], &e.p);
+                self.queue.submit(Some(encoder.finish()));
+                self.touch_content();
+                e.iterations += n as u64;
+                total = e.iterations;
+            }
+            done += n;
+            // The lock is released: the render queues behind the batch on the same queue.
+            if record_every > 0 && done % record_every == 0 {
+                frames.extend(self.render_pixels()?);
+            }
+        }
+        Ok((total, frames))
+    }
+
+    /// Update the parameters of the live erosion, or load the bound height texture into new
+    /// state buffers and bind their height target in its place.
+    fn bind_erosion(&self, st: &mut SceneState, p: ErosionParams) -> Result<(), String> {
+        use wgpu::util::DeviceExt;
+        if let Some(e) = st.erosion.as_mut() {
+            e.p = p;
+            self.queue.write_buffer(&e.params, 0, bytemuck::bytes_of(&p));
+            return Ok(());
+        }
+        if st.diff.is_some() {
+            return Err("a difference is bound; call clear_diff() before eroding".to_string());
+        }
+        let [w, h] = p.size;
+        let bytes = w as u64 * h as u64 * std::mem::size_of::<Cell>() as u64;
+        let limit = self.device.limits().max_storage_buffer_binding_size as u64;
+        if bytes > limit {
+            return Err(format!("{}x{} cells need {} bytes of erosion state per buffer; the device allows {}", w, h, bytes, limit));
+        }
+        let source = st.height_view.take().ok_or("no height texture bound")?;
+        let gpu = ErosionGpu::new(&self.device);
+        let params = self.device.create_buffer_init(&wgpu::util::BufferInitDescriptor {
+            label: Some("scene-erosion-params"), contents: bytemuck::bytes_of(&p),
+            usage: wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST,
+        });
+        let cells = [0, 1].map(|_| self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-erosion-cells"), size: bytes,
+            usage: wgpu::BufferUsages::STORAGE | wgpu::BufferUsages::COPY_SRC, mapped_at_creation: false,
+        }));
+        let target = procgen::create_height_target(&self.device, w, h);
+        let target_view = target.create_view(&Default::default());
+        let bgs = [
+            gpu.bind(&self.device, &params, &cells[0], &cells[1], &source, &target_view),
+            gpu.bind(&self.device, &params, &cells[1], &cells[0], &source, &target_view),
+        ];
+        // Load into cells[0] (`bgs[1]` writes it) and store the unchanged terrain once.
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-erosion-init") });
+        gpu.encode_init(&mut encoder, &bgs[1], &p);
+        gpu.encode_store(&mut encoder, &bgs[0], &p);
+        self.queue.submit(Some(encoder.finish()));
+
+        st.height_view = Some(target.create_view(&Default::default()));
+        st.erosion = Some(ErosionState { gpu, params, cells, bgs, cur: 0, target, source, p, iterations: 0 });
+        // A flood extent of the uneroded terrain no longer matches.
+        self.drop_water(st);
+        Ok(())
+    }
+
+    /// Copy the current state to the host: `(width, height, cells)`.
+    pub(super) fn erosion_cells(&self) -> Result<Option<(u32, u32, Vec<Cell>)>, String> {
+        let st = self.state.read().unwrap();
+        let Some(e) = st.erosion.as_ref() else { return Ok(None) };
+        let [w, h] = e.p.size;
+        let size = e.cells[e.cur].size();
+        let staging = self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-erosion-readback"), size,
+            usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ, mapped_at_creation: false,
+        });
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-erosion-copy") });
+        encoder.copy_buffer_to_buffer(&e.cells[e.cur], 0, &staging, 0, size);
+        let submission = self.queue.submit(Some(encoder.finish()));
+        let bytes = self.map_staging(&staging, submission)?;
+        let cells = bytes.chunks_exact(std::mem::size_of::<Cell>()).map(bytemuck::pod_read_unaligned).collect();
+        Ok(Some((w, h, cells)))
+    }
+
+    /// Free the erosion state and bind the height texture it started from again.
+    pub(super) fn reset_erosion_state(&self) {
+        let mut st = self.state.write().unwrap();
+        if let Some(e) = st.erosion.take() {
+            st.height_view = Some(e.source);
+            self.drop_water(&mut st);
+        }
+    }
+}
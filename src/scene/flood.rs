@@ -0,0 +1,274 @@
+//! Flood inundation on the Scene height texture.
+//!
+//! `Scene.flood` runs the `terrain::flood` kernels over the height texture that is already
+//! bound for rendering and writes water depth into an `R32Float` texture that the WATER
+//! permutation blends over the terrain. Relaxation is submitted in batches of
+//! `RELAX_BATCH` dispatches; after each batch only the 8-byte counter block is read back
+//! to test convergence. Level sweeps compute the spill-level field once and then run one
+//! depth pass per level in a single submission, so neither the DEM nor the field is
+//! uploaded again.
+
+use crate::terrain::flood::{FloodGpu, FloodParams, Mode, Seed};
+use crate::terrain::variants::ShaderFeatures;
+
+use super::{Scene, SceneState};
+
+/// Relaxation dispatches per convergence check.
+const RELAX_BATCH: u32 = 8;
+
+/// Result of one flood or water-level change.
+#[derive(Debug, Clone, Copy, Default)]
+pub(super) struct FloodRun {
+    pub wet: u64,
+    /// Relaxation dispatches until nothing changed (0 when the field was reused).
+    pub passes: u32,
+}
+
+/// Flood kernels, their buffers and the depth texture sampled by the WATER permutation.
+pub(super) struct WaterState {
+    gpu: FloodGpu,
+    params: wgpu::Buffer,
+    /// One order-preserving key per texel (surface or spill level, per `p.mode`).
+    field: wgpu::Buffer,
+    /// `[changed, wet cells]`.
+    counters: wgpu::Buffer,
+    seeds: wgpu::Buffer,
+    bg: wgpu::BindGroup,
+    tex: wgpu::Texture,
+    view: wgpu::TextureView,
+    p: FloodParams,
+}
+
+impl WaterState {
+    pub(super) fn view(&self) -> &wgpu::TextureView {
+        &self.view
+    }
+}
+
+impl Scene {
+    /// (Re)build the water state for the current height texture and `seeds`. Buffers and
+    /// the depth texture are kept when the height size has not changed.
+    fn prepare_water(&self, st: &mut SceneState, seeds: &[Seed], mode: Mode) -> Result<(), String> {
+        if st.diff.is_some() {
+            return Err("a difference is bound; call clear_diff() before flooding".to_string());
+        }
+        let (w, h) = st.height_size;
+        if seeds.is_empty() {
+            return Err("at least one seed is required".to_string());
+        }
+        if let Some(s) = seeds.iter().find(|s| s.x >= w || s.y >= h) {
+            return Err(format!("seed ({}, {}) is outside the {}x{} height texture", s.x, s.y, w, h));
+        }
+        use wgpu::util::DeviceExt;
+        let seeds_buf = self.device.create_buffer_init(&wgpu::util::BufferInitDescriptor {
+            label: Some("scene-flood-seeds"), contents: bytemuck::cast_slice(seeds), usage: wgpu::BufferUsages::STORAGE,
+        });
+        let p = FloodParams { size: [w, h], mode: mode as u32, seeds: seeds.len() as u32, level: 0.0, _p: [0.0; 3] };
+        let reuse = st.water.take().filter(|old| old.p.size == p.size);
+        let (gpu, params, field, counters, tex) = match reuse {
+            Some(old) => (old.gpu, old.params, old.field, old.counters, old.tex),
+            None => {
+                let buffer = |label, size, usage| self.device.create_buffer(&wgpu::BufferDescriptor {
+                    label: Some(label), size, usage, mapped_at_creation: false,
+                });
+                let tex = self.device.create_texture(&wgpu::TextureDescriptor {
+                    label: Some("scene-flood-depth"),
+                    size: wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
+                    mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
+                    format: wgpu::TextureFormat::R32Float,
+                    usage: wgpu::TextureUsages::STORAGE_BINDING | wgpu::TextureUsages::TEXTURE_BINDING | wgpu::TextureUsages::COPY_SRC,
+                    view_formats: &[],
+                });
+                (
+                    FloodGpu::new(&self.device),
+                    buffer("scene-flood-params", std::mem::size_of::<FloodParams>() as u64, wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST),
+                    buffer("scene-flood-field", w as u64 * h as u64 * 4, wgpu::BufferUsages::STORAGE),
+                    buffer("scene-flood-counters", 8, wgpu::BufferUsages::STORAGE | wgpu::BufferUsages::COPY_SRC | wgpu::BufferUsages::COPY_DST),
+                    tex,
+                )
+            }
+        };
+        self.queue.write_buffer(&params, 0, bytemuck::bytes_of(&p));
+        let view = tex.create_view(&Default::default());
+        let bg = gpu.bind(&self.device, st.height_view.as_ref().unwrap(), &params, &field, &seeds_buf, &counters, &view);
+        st.water = Some(WaterState { gpu, params, field, counters, seeds: seeds_buf, bg, tex, view, p });
+        Ok(())
+    }
+
+    /// Seed the field and relax until a batch changes nothing; returns the dispatches run.
+    fn converge(&self, water: &WaterState) -> Result<u32, String> {
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-flood") });
+        water.gpu.encode_start(&mut encoder, &water.bg, &water.p);
+        let mut passes = 0;
+        loop {
+            encoder.clear_buffer(&water.counters, 0, Some(4));
+            water.gpu.encode_relax(&mut encoder, &water.bg, &water.p, RELAX_BATCH);
+            passes += RELAX_BATCH;
+            if self.read_u32s(encoder, &water.counters, 1)?[0] == 0 {
+                return Ok(passes);
+            }
+            encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-flood") });
+        }
+    }
+
+    /// Depth pass for the current params; returns the wet cell count.
+    fn depth_pass(&self, water: &WaterState) -> Result<u64, String> {
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-flood-depth") });
+        encoder.clear_buffer(&water.counters, 4, Some(4));
+        water.gpu.encode_depth(&mut encoder, &water.bg, &water.p);
+        Ok(self.read_u32s(encoder, &water.counters, 2)?[1] as u64)
+    }
+
+    /// Bind the WATER permutation if it is not active yet.
+    fn show_water(&self, st: &mut SceneState) {
+        if !st.features.contains(ShaderFeatures::WATER) {
+            let features = st.features.union(ShaderFeatures::WATER);
+            self.rebind(st, features);
+        } else {
+            self.rebind_groups(st);
+        }
+    }
+
+    /// Flood from `seeds` (each with its own level) and bind the depth overlay.
+    pub(super) fn flood_surface(&self, seeds: &[Seed]) -> Result<FloodRun, String> {
+        if let Some(s) = seeds.iter().find(|s| !s.level.is_finite()) {
+            return Err(format!("water level {} is not finite", s.level));
+        }
+        let mut st = self.state.write().unwrap();
+        self.prepare_water(&mut st, seeds, Mode::Surface)?;
+        let water = st.water.as_ref().unwrap();
+        let passes = self.converge(water)?;
+        let wet = self.depth_pass(water)?;
+        self.show_water(&mut st);
+        Ok(FloodRun { wet, passes })
+    }
+
+    /// Spill levels from the `(x, y)` cells, kept for `water_level` / `sweep_levels`.
+    pub(super) fn flood_spill(&self, cells: &[(u32, u32)]) -> Result<u32, String> {
+        let seeds: Vec<Seed> = cells.iter().map(|&(x, y)| Seed { x, y, level: 0.0, _p: 0.0 }).collect();
+        let mut st = self.state.write().unwrap();
+        self.prepare_water(&mut st, &seeds, Mode::Spill)?;
+        self.converge(st.water.as_ref().unwrap())
+    }
+
+    /// Depth for one level from the spill field of the last `flood_spill` (no relaxation).
+    pub(super) fn water_level(&self, level: f32) -> Result<FloodRun, String> {
+        if !level.is_finite() {
+            return Err(format!("water level {} is not finite", level));
+        }
+        let mut st = self.state.write().unwrap();
+        let water = st.water.as_mut().filter(|w| w.p.mode == Mode::Spill as u32)
+            .ok_or("no spill field; call flood(seeds, level) with one shared level or flood_sweep first")?;
+        water.p.level = level;
+        self.queue.write_buffer(&water.params, 0, bytemuck::bytes_of(&water.p));
+        let wet = self.depth_pass(water)?;
+        self.show_water(&mut st);
+        Ok(FloodRun { wet, passes: 0 })
+    }
+
+    /// Wet cell count per level from the spill field, in one submission (one depth pass per
+    /// level; each pass's params are copied in from a level table). The overlay is left at
+    /// the last level.
+    pub(super) fn sweep_levels(&self, levels: &[f32]) -> Result<Vec<u32>, String> {
+        use wgpu::util::DeviceExt;
+        if levels.is_empty() {
+            return Err("levels must not be empty".to_string());
+        }
+        if let Some(l) = levels.iter().find(|l| !l.is_finite()) {
+            return Err(format!("water level {} is not finite", l));
+        }
+        let mut st = self.state.write().unwrap();
+        let water = st.water.as_mut().filter(|w| w.p.mode == Mode::Spill as u32)
+            .ok_or("no spill field; call flood(seeds, level) with one shared level first")?;
+        let table: Vec<FloodParams> = levels.iter().map(|&level| FloodParams { level, ..water.p }).collect();
+        let table = self.device.create_buffer_init(&wgpu::util::BufferInitDescriptor {
+            label: Some("scene-flood-levels"), contents: bytemuck::cast_slice(&table), usage: wgpu::BufferUsages::COPY_SRC,
+        });
+        let counts = self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-flood-counts"), size: levels.len() as u64 * 4,
+            usage: wgpu::BufferUsages::COPY_SRC | wgpu::BufferUsages::COPY_DST, mapped_at_creation: false,
+        });
+        let block = std::mem::size_of::<FloodParams>() as u64;
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-flood-sweep") });
+        for i in 0..levels.len() as u64 {
+            encoder.copy_buffer_to_buffer(&table, i * block, &water.params, 0, block);
+            encoder.clear_buffer(&water.counters, 4, Some(4));
+            water.gpu.encode_depth(&mut encoder, &water.bg, &water.p);
+            encoder.copy_buffer_to_buffer(&water.counters, 4, &counts, i * 4, 4);
+        }
+        water.p.level = *levels.last().unwrap();
+        let wet = self.read_u32s(encoder, &counts, levels.len())?;
+        self.show_water(&mut st);
+        Ok(wet)
+    }
+
+    /// Water depth texels (row-major `height_size`), or `None` when no flood is bound.
+    pub(super) fn water_depth_texels(&self) -> Result<Option<(u32, u32, Vec<f32>)>, String> {
+        let st = self.state.read().unwrap();
+        let Some(water) = st.water.as_ref() else { return Ok(None) };
+        let [w, h] = water.p.size;
+        let align = wgpu::COPY_BYTES_PER_ROW_ALIGNMENT;
+        let padded = (w * 4 + align - 1) / align * align;
+        let staging = self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-flood-depth-readback"), size: padded as u64 * h as u64,
+            usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ, mapped_at_creation: false,
+        });
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-flood-depth-copy") });
+        encoder.copy_texture_to_buffer(
+            wgpu::ImageCopyTexture { texture: &water.tex, mip_level: 0, origin: wgpu::Origin3d::ZERO, aspect: wgpu::TextureAspect::All },
+            wgpu::ImageCopyBuffer { buffer: &staging, layout: wgpu::ImageDataLayout { offset: 0, bytes_per_row: Some(padded), rows_per_image: Some(h) } },
+            wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
+        );
+        let submission = self.queue.submit(Some(encoder.finish()));
+        let data = self.map_staging(&staging, submission)?;
+        let mut out = Vec::with_capacity((w * h) as usize);
+        for row in data.chunks_exact(padded as usize) {
+            out.extend(row[..(w * 4) as usize].chunks_exact(4).map(|b| f32::from_le_bytes([b[0], b[1], b[2], b[3]])));
+        }
+        Ok(Some((w, h, out)))
+    }
+
+    /// Unbind the overlay and free the flood buffers.
+    pub(super) fn clear_water_state(&self) {
+        let mut st = self.state.write().unwrap();
+        if st.water.is_some() {
+            self.drop_water(&mut st);
+        }
+    }
+
+    /// Drop any flood state and rebuild the bind groups without WATER (the height source
+    /// changed or the flood was cleared).
+    pub(super) fn drop_water(&self, st: &mut SceneState) {
+        st.water = None;
+        if st.features.contains(ShaderFeatures::WATER) {
+            let features = st.features.without(ShaderFeatures::WATER);
+            self.rebind(st, features);
+        } else {
+            self.rebind_groups(st);
+        }
+    }
+
+    /// Submit `encoder` with a copy of the first `n` u32 of `src` and wait for them.
+    fn read_u32s(&self, mut encoder: wgpu::CommandEncoder, src: &wgpu::Buffer, n: usize) -> Result<Vec<u32>, String> {
+        let staging = self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-flood-readback"), size: n as u64 * 4,
+            usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ, mapped_at_creation: false,
+        });
+        encoder.copy_buffer_to_buffer(src, 0, &staging, 0, n as u64 * 4);
+        let submission = self.queue.submit(Some(encoder.finish()));
+        Ok(self.map_staging(&staging, submission)?.chunks_exact(4).map(bytemuck::pod_read_unaligned).collect())
+    }
+
+    /// Wait for `submission`, map `staging` and copy its bytes out.
+    pub(super) fn map_staging(&self, staging: &wgpu::Buffer, submission: wgpu::SubmissionIndex) -> Result<Vec<u8>, String> {
+        let mapped = super::MapState::default();
+        let result = mapped.clone();
+        staging.slice(..).map_async(wgpu::MapMode::Read, move |r| {
+            let _ = result.set(r);
+        });
+        self.wait_mapped(&mapped, Some(submission), "staging readback")?;
+        let bytes = staging.slice(..).get_mapped_range().to_vec();
+        staging.unmap();
+        Ok(bytes)
+    }
+}
@@ -0,0 +1,291 @@
+//! Awaitable frames.
+//!
+//! `Scene.submit()` encodes and submits a render, requests the readback map and returns a
+//! `Frame` right away. `await frame.readback_async()` (or `await scene.render_async()`)
+//! hands the pending readback to a single Rust poller thread, which waits on the device
+//! without the GIL and completes the asyncio future through `loop.call_soon_threadsafe`.
+//! Hundreds of renders can be in flight on one event loop with one extra thread in total.
+//! A readback that fails (a map error, a map still pending after `READBACK_TIMEOUT`, or a
+//! panic in the copy) fails its own future with `RuntimeError`; the poller carries on with
+//! the next job, and is respawned by the next `enqueue` should it ever exit.
+//!
+//! `FrameStream` (from `Scene.render_stream`) is the synchronous counterpart: it keeps
+//! `depth` frames submitted ahead of the consumer, so Python-side work on frame `k`
+//! overlaps GPU work on frames `k+1..=k+depth`. The in-flight frames use the Scene's
+//! render-slot pool as a staging ring (`depth + 1` slots once warm).
+
+use std::collections::VecDeque;
+use std::sync::{Condvar, Mutex};
+use std::thread::JoinHandle;
+use std::time::Instant;
+
+use once_cell::sync::Lazy;
+use pyo3::prelude::*;
+use pyo3::sync::GILOnceCell;
+
+use super::{FrameDraws, PendingFrames, Scene};
+
+/// A submitted render whose pixels have not been read back yet.
+#[pyclass(module = "_vulkan_forge", name = "Frame", frozen)]
+pub struct Frame {
+    scene: Py<Scene>,
+    pending: Mutex<Option<PendingFrames>>,
+    shape: Vec<usize>,
+}
+
+struct Job {
+    scene: Py<Scene>,
+    pending: PendingFrames,
+    shape: Vec<usize>,
+    future: PyObject,
+    event_loop: PyObject,
+}
+
+static QUEUE: Lazy<(Mutex<VecDeque<Job>>, Condvar)> = Lazy::new(|| (Mutex::new(VecDeque::new()), Condvar::new()));
+static POLLER: Mutex<Option<JoinHandle<()>>> = Mutex::new(None);
+static COMPLETERS: GILOnceCell<(PyObject, PyObject)> = GILOnceCell::new();
+
+/// `resolve(fut, value)` / `reject(fut, exc)`: `set_result` / `set_exception` unless the
+/// awaiting task was cancelled meanwhile.
+fn completers(py: Python<'_>) -> PyResult<&(PyObject, PyObject)> {
+    COMPLETERS.get_or_try_init(py, || {
+        let m = PyModule::from_code(
+            py,
+            c"def resolve(fut, value):\n    if not fut.done():\n        fut.set_result(value)\n\n\
+              def reject(fut, exc):\n    if not fut.done():\n        fut.set_exception(exc)\n",
+            c"vulkan_forge_frames.py",
+            c"vulkan_forge_frames",
+        )?;
+        Ok((m.getattr("resolve")?.unbind(), m.getattr("reject")?.unbind()))
+    })
+}
+
+/// Complete `future` on `event_loop` with `outcome` (result or exception). A closed loop
+/// means nobody is awaiting the future any more, so failing to schedule is not an error.
+pub(super) fn deliver(py: Python<'_>, future: &PyObject, event_loop: &PyObject, outcome: PyResult<PyObject>) {
+    let scheduled = completers(py).and_then(|(resolve, reject)| {
+        let (complete, arg) = match outcome {
+            Ok(value) => (resolve, value),
+            Err(e) => (reject, e.into_value(py).into_any()),
+        };
+        event_loop.bind(py).call_method1("call_soon_threadsafe", (complete.bind(py), future.bind(py), arg))
+    });
+    drop(scheduled);
+}
+
+/// Text of a caught panic payload.
+pub(super) fn panic_message(e: Box<dyn std::any::Any + Send>) -> String {
+    e.downcast_ref::<&str>().map(|s| s.to_string())
+        .or_else(|| e.downcast_ref::<String>().cloned())
+        .unwrap_or_else(|| "panic".to_string())
+}
+
+pub(super) fn to_array(py: Python<'_>, pixels: Vec<u8>, shape: &[usize]) -> PyResult<PyObject> {
+    use numpy::IntoPyArray;
+    let arr = ndarray::ArrayD::from_shape_vec(ndarray::IxDyn(shape), pixels)
+        .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+    Ok(arr.into_pyarray(py).into_any().unbind())
+}
+
+fn enqueue(job: Job) -> PyResult<()> {
+    {
+        let mut poller = POLLER.lock().unwrap();
+        if poller.as_ref().map_or(true, |h| h.is_finished()) {
+            let handle = std::thread::Builder::new()
+                .name("vf-frame-poller".into())
+                .spawn(poller_main)
+                .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(format!("spawn frame poller thread: {}", e)))?;
+            *poller = Some(handle);
+        }
+    }
+    let (queue, cv) = &*QUEUE;
+    queue.lock().unwrap().push_back(job);
+    cv.notify_one();
+    Ok(())
+}
+
+/// Jobs complete in submission order, which is also the GPU's completion order per device.
+fn poller_main() {
+    let (queue, cv) = &*QUEUE;
+    loop {
+        let Job { scene, pending, shape, future, event_loop } = {
+            let mut q = queue.lock().unwrap();
+            loop {
+                if let Some(job) = q.pop_front() {
+                    break job;
+                }
+                q = cv.wait(q).unwrap();
+            }
+        };
+        let pixels = std::panic::catch_unwind(std::panic::AssertUnwindSafe(|| scene.get().read_frames(pending)))
+            .unwrap_or_else(|e| Err(format!("frame readback failed: {}", panic_message(e))))
+            .map_err(pyo3::exceptions::PyRuntimeError::new_err);
+        Python::with_gil(|py| {
+            let outcome = pixels.and_then(|p| to_array(py, p, &shape));
+            deliver(py, &future, &event_loop, outcome);
+            drop(scene);
+            drop(future);
+            drop(event_loop);
+        });
+    }
+}
+
+impl Frame {
+    pub(crate) fn new(scene: Py<Scene>, pending: PendingFrames, shape: Vec<usize>) -> Self {
+        Self { scene, pending: Mutex::new(Some(pending)), shape }
+    }
+
+    fn take(&self) -> PyResult<PendingFrames> {
+        self.pending
+            .lock()
+            .unwrap()
+            .take()
+            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("frame was already read back"))
+    }
+
+    /// Future on the running event loop, completed by the poller thread.
+    pub(crate) fn readback_future<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyAny>> {
+        let event_loop = py.import("asyncio")?.call_method0("get_running_loop")?;
+        let future = event_loop.call_method0("create_future")?;
+        enqueue(Job {
+            scene: self.scene.clone_ref(py),
+            pending: self.take()?,
+            shape: self.shape.clone(),
+            future: future.clone().unbind(),
+            event_loop: event_loop.unbind(),
+        })?;
+        Ok(future)
+    }
+}
+
+#[pymethods]
+impl Frame {
+    /// Output shape: `(H, W, 4)` for the Scene camera, `(N, H, W, 4)` for N views.
+    #[getter]
+    fn shape(&self) -> Vec<usize> {
+        self.shape.clone()
+    }
+
+    /// True once the GPU has finished and the pixels can be read without waiting
+    /// (also true after the frame was read back).
+    #[pyo3(text_signature = "($self)")]
+    fn ready(&self) -> bool {
+        let scene = self.scene.get();
+        scene.device.poll(wgpu::Maintain::Poll);
+        self.pending.lock().unwrap().as_ref().map_or(true, |p| p.is_mapped())
+    }
+
+    /// Wait (GIL released) and return the pixels as uint8 numpy.
+    #[pyo3(text_signature = "($self)")]
+    fn readback(&self, py: Python<'_>) -> PyResult<PyObject> {
+        let pending = self.take()?;
+        let scene = self.scene.get();
+        let pixels = py.allow_threads(|| scene.read_frames(pending)).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        to_array(py, pixels, &self.shape)
+    }
+
+    /// `await frame.readback_async()`: the event loop never blocks on the GPU.
+    #[pyo3(text_signature = "($self)")]
+    fn readback_async<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyAny>> {
+        self.readback_future(py)
+    }
+}
+
+impl Drop for Frame {
+    fn drop(&mut self) {
+        if let Some(pending) = self.pending.get_mut().ok().and_then(|p| p.take()) {
+            self.scene.get().discard_frames(pending);
+        }
+    }
+}
+
+/// Iterator over rendered frames with `depth` frames in flight ahead of the consumer.
+#[pyclass(module = "_vulkan_forge", name = "FrameStream", frozen)]
+pub struct FrameStream {
+    scene: Py<Scene>,
+    views: Vec<glam::Mat4>,
+    depth: usize,
+    inner: Mutex<StreamState>,
+}
+
+#[derive(Default)]
+struct StreamState {
+    next: usize,
+    in_flight: VecDeque<PendingFrames>,
+    yielded: usize,
+    wait_ms: f64,
+}
+
+impl FrameStream {
+    pub(crate) fn new(scene: Py<Scene>, views: Vec<glam::Mat4>, depth: usize) -> Self {
+        Self { scene, views, depth: depth.max(1), inner: Mutex::new(StreamState::default()) }
+    }
+
+    /// Submit until `depth` frames are in flight (or the cameras run out).
+    fn top_up(&self, scene: &Scene, st: &mut StreamState) {
+        while st.in_flight.len() < self.depth && st.next < self.views.len() {
+            let frame = FrameDraws::single(self.views[st.next]);
+            st.in_flight.push_back(scene.submit_frames(&[frame]));
+            st.next += 1;
+        }
+    }
+}
+
+#[pymethods]
+impl FrameStream {
+    fn __iter__(slf: PyRef<'_, Self>) -> PyRef<'_, Self> {
+        slf
+    }
+
+    fn __len__(&self) -> usize {
+        self.views.len()
+    }
+
+    fn __next__(&self, py: Python<'_>) -> PyResult<Option<PyObject>> {
+        let scene = self.scene.get();
+        let pixels = py.allow_threads(|| {
+            let mut st = self.inner.lock().unwrap();
+            self.top_up(scene, &mut st);
+            let pending = st.in_flight.pop_front()?;
+            let t0 = Instant::now();
+            let pixels = scene.read_frames(pending);
+            st.wait_ms += t0.elapsed().as_secs_f64() * 1000.0;
+            st.yielded += 1;
+            // Keep the ring full while the consumer works on this frame.
+            self.top_up(scene, &mut st);
+            Some(pixels)
+        });
+        match pixels {
+            Some(p) => {
+                let p = p.map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+                Ok(Some(to_array(py, p, &[scene.height as usize, scene.width as usize, 4])?))
+            }
+            None => Ok(None),
+        }
+    }
+
+    /// `{frames, yielded, in_flight, depth, wait_ms}`; `wait_ms` is time the consumer spent
+    /// blocked on the GPU (near zero when consumption is the bottleneck).
+    #[pyo3(text_signature = "($self)")]
+    fn stats(&self, py: Python<'_>) -> PyResult<PyObject> {
+        let st = self.inner.lock().unwrap();
+        let d = pyo3::types::PyDict::new(py);
+        d.set_item("frames", self.views.len())?;
+        d.set_item("yielded", st.yielded)?;
+        d.set_item("in_flight", st.in_flight.len())?;
+        d.set_item("depth", self.depth)?;
+        d.set_item("wait_ms", st.wait_ms)?;
+        Ok(d.into_any().unbind())
+    }
+}
+
+impl Drop for FrameStream {
+    fn drop(&mut self) {
+        if let Ok(st) = self.inner.get_mut() {
+            let scene = self.scene.get();
+            for pending in st.in_flight.drain(..) {
+                scene.discard_frames(pending);
+            }
+        }
+    }
+}
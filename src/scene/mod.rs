@@ -4,6 +4,21 @@ use pyo3::prelude::*;
 use wgpu::util::DeviceExt;
 use numpy::PyUntypedArrayMethods;
 
+pub mod frames;
+pub mod scheduler;
+pub mod budget;
+pub mod dataset;
+pub mod diff;
+pub mod erosion;
+pub mod flood;
+pub mod progressive;
+pub mod projected;
+pub mod scalar;
+pub mod sequence;
+pub mod temporal;
+#[cfg(feature = "cli")]
+pub mod batch;
+
 const TEXTURE_FORMAT: wgpu::TextureFormat = wgpu::TextureFormat::Rgba8UnormSrgb;
 
 #[derive(Debug, Clone)]
@@ -21,121 +36,1229 @@ impl Default for SceneGlobals {
     }
 }
 
-#[pyclass(module = "_vulkan_forge", name = "Scene")]
+/// Thread-safe terrain scene.
+///
+/// Shared, immutable-after-construction resources (device, mesh, LUT) sit directly in the
+/// struct; everything the setters change (pipeline permutation, height, camera) lives in
+/// `state` behind an `RwLock`; each render call borrows a `RenderSlot` (UBO, colour target,
+/// readback buffer) from `slots`, so several Python threads can render on one Scene at once
+/// with the GIL released. All methods take `&self` (the class is frozen).
+#[pyclass(module = "_vulkan_forge", name = "Scene", frozen)]
 pub struct Scene {
     width: u32,
     height: u32,
     grid: u32,
 
-    device: wgpu::Device,
-    queue: wgpu::Queue,
-
-    tp: crate::terrain::pipeline::TerrainPipeline,
-    bg0_globals: wgpu::BindGroup,
-    bg1_height: wgpu::BindGroup,
-    bg2_lut: wgpu::BindGroup,
+    /// Shared with every other Scene on the same adapter (see `scene_device`).
+    device: std::sync::Arc<wgpu::Device>,
+    queue: std::sync::Arc<wgpu::Queue>,
+    caps: crate::device_caps::DeviceCaps,
 
     vbuf: wgpu::Buffer,
     ibuf: wgpu::Buffer,
     nidx: u32,
 
-    ubo: wgpu::Buffer,
     colormap: crate::terrain::ColormapLUT,
     lut_format: &'static str,
 
-    color: wgpu::Texture,
-    color_view: wgpu::TextureView,
+    state: std::sync::RwLock<SceneState>,
+    slots: std::sync::Mutex<Vec<RenderSlot>>,
+    slots_created: std::sync::atomic::AtomicUsize,
+    sequence_stats: std::sync::Mutex<sequence::SequenceStats>,
+    /// Texture-array ring of the last `render_sequence`, taken by the next call that fits it.
+    height_ring: std::sync::Mutex<Option<sequence::HeightRing>>,
+    /// Bumped whenever what the terrain shows changes other than through the camera or
+    /// uniforms (bind groups rebuilt, bound textures written in place).
+    generation: std::sync::atomic::AtomicU64,
+    /// History targets of `set_temporal` (`None` while disabled).
+    temporal: std::sync::Mutex<Option<temporal::TemporalState>>,
+    /// Screen-space grid of `set_projected_grid` (`None` while disabled).
+    projected: std::sync::Mutex<Option<projected::ProjectedGrid>>,
+    /// Bumped by every camera change; stale `render_progressive` refinements are dropped.
+    camera_epoch: std::sync::atomic::AtomicU64,
+    progressive: progressive::Progressive,
+    /// Quality controller of `set_frame_budget` (`None` while disabled).
+    budget: std::sync::Mutex<Option<budget::BudgetState>>,
+}
+
+/// Scene state changed by the setters (write lock) and read while encoding (read lock).
+struct SceneState {
+    tp: std::sync::Arc<crate::terrain::pipeline::TerrainPipeline>,
+    pipelines: crate::terrain::variants::PipelineCache,
+    features: crate::terrain::variants::ShaderFeatures,
+    bg1_height: wgpu::BindGroup,
+    bg2_lut: wgpu::BindGroup,
 
     height_view: Option<wgpu::TextureView>,
     height_sampler: Option<wgpu::Sampler>,
+    /// `(width, height)` of `height_view` in texels.
+    height_size: (u32, u32),
+    procgen: Option<crate::terrain::procgen::ProcgenGpu>,
+    /// Categorical raster for the dataset class target (1×1 of class 0 until set).
+    class_view: wgpu::TextureView,
+    /// Height epochs of `set_diff` (bound while the DIFF permutation is active).
+    diff: Option<diff::DiffEpochs>,
+    /// Flood field and depth texture of `flood` (bound while the WATER permutation is active).
+    water: Option<flood::WaterState>,
+    /// Erosion state of `erode`; its height target is bound as `height_view` while live.
+    erosion: Option<erosion::ErosionState>,
+    /// Normalised colormap source of `set_scalar` (bound while the SCALAR permutation is active).
+    scalar: Option<wgpu::TextureView>,
 
     scene: SceneGlobals,
     last_uniforms: crate::terrain::TerrainUniforms,
 }
 
+/// Per-call transient resources, pooled so concurrent renders never share a UBO or target.
+struct RenderSlot {
+    ubo: wgpu::Buffer,
+    bg0_globals: wgpu::BindGroup,
+    /// Permutation `bg0_globals` was built for (group 0 layout differs per permutation).
+    bg0_features: crate::terrain::variants::ShaderFeatures,
+    color: wgpu::Texture,
+    color_view: wgpu::TextureView,
+    readback: Option<wgpu::Buffer>,
+    /// Depth/normal/class targets, created on the slot's first `render_dataset`.
+    dataset: Option<dataset::DatasetTargets>,
+}
+
 #[pymethods]
 impl Scene {
     #[new]
-    #[pyo3(text_signature="(width, height, grid=128, colormap='viridis')")]
-    pub fn new(width: u32, height: u32, grid: Option<u32>, colormap: Option<String>) -> PyResult<Self> {
-        let grid = grid.unwrap_or(128).max(2);
-        // Device
-        let instance = wgpu::Instance::new(wgpu::InstanceDescriptor { backends: wgpu::Backends::all(), ..Default::default() });
-        let adapter = pollster::block_on(instance.request_adapter(&wgpu::RequestAdapterOptions {
-            power_preference: wgpu::PowerPreference::HighPerformance,
-            compatible_surface: None, force_fallback_adapter: false,
-        })).ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("No suitable GPU adapter"))?;
-        let (device, queue) = pollster::block_on(adapter.request_device(
-            &wgpu::DeviceDescriptor { label: Some("scene-device"), required_features: wgpu::Features::empty(), required_limits: wgpu::Limits::downlevel_defaults() }, None
-        )).map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
-
-        // Target
-        let color = device.create_texture(&wgpu::TextureDescriptor{
-            label: Some("scene-color"),
-            size: wgpu::Extent3d{ width, height, depth_or_array_layers: 1 },
-            mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
-            format: TEXTURE_FORMAT, usage: wgpu::TextureUsages::RENDER_ATTACHMENT | wgpu::TextureUsages::COPY_SRC, view_formats: &[],
-        });
-        let color_view = color.create_view(&Default::default());
+    #[pyo3(signature = (width, height, grid=None, colormap=None, *, shared_device=false))]
+    #[pyo3(text_signature="(width, height, grid=128, colormap='viridis', *, shared_device=False)")]
+    pub fn new(width: u32, height: u32, grid: Option<u32>, colormap: Option<String>, shared_device: bool) -> PyResult<Self> {
+        Self::open(width, height, grid, colormap, shared_device).map_err(pyo3::exceptions::PyRuntimeError::new_err)
+    }
 
-        // Pipeline
-        let tp = crate::terrain::pipeline::TerrainPipeline::create(&device, TEXTURE_FORMAT);
+    #[pyo3(text_signature="($self, eye, target, up, fovy_deg, znear, zfar)")]
+    pub fn set_camera_look_at(&self,
+        eye:(f32,f32,f32), target:(f32,f32,f32), up:(f32,f32,f32),
+        fovy_deg:f32, znear:f32, zfar:f32) -> PyResult<()> {
+        self.apply_camera_look_at(eye, target, up, fovy_deg, znear, zfar).map_err(pyo3::exceptions::PyRuntimeError::new_err)
+    }
 
-        // Mesh
-        let (vbuf, ibuf, nidx) = {
-            // Same as terrain::build_grid_xyuv (private) — inline minimal copy to avoid re-export churn.
-            // Minimal grid that matches T3.1/T3.3 vertex layout: interleaved [x, z, u, v] (Float32x4) => 16-byte stride.
-            let n = grid.max(2) as usize;
-            let (w, h) = (n, n);
-            let scale = 1.5f32;
-            let step_x = (2.0 * scale) / (w as f32 - 1.0);
-            let step_z = (2.0 * scale) / (h as f32 - 1.0);
-            let mut verts = Vec::<f32>::with_capacity(w*h*4);
-            for j in 0..h {
-                for i in 0..w {
-                    let x = -scale + i as f32 * step_x;
-                    let z = -scale + j as f32 * step_z;
-                    let u = i as f32 / (w as f32 - 1.0);
-                    let v = j as f32 / (h as f32 - 1.0);
-                    verts.extend_from_slice(&[x, z, u, v]);
+    #[pyo3(text_signature="($self, height_r32f)")]
+    pub fn set_height_from_r32f(&self, height_r32f: &pyo3::Bound<'_, pyo3::types::PyAny>) -> PyResult<()> {
+        // Accept numpy array float32 (H,W)
+        let arr: numpy::PyReadonlyArray2<f32> = height_r32f.extract()?;
+        let (h, w) = (arr.shape()[0] as u32, arr.shape()[1] as u32);
+        let data = arr.as_slice().map_err(|_| pyo3::exceptions::PyRuntimeError::new_err("height must be C-contiguous float32[H,W]"))?;
+        self.upload_height(w, h, data).map_err(pyo3::exceptions::PyRuntimeError::new_err)
+    }
+
+    /// Sun direction from spherical angles (degrees), as `Renderer.set_sun`: Y-up,
+    /// azimuth 0° along +X turning toward +Z, elevation 0° on the horizon.
+    #[pyo3(text_signature="($self, elevation_deg, azimuth_deg)")]
+    pub fn set_sun(&self, elevation_deg: f32, azimuth_deg: f32) -> PyResult<()> {
+        self.apply_sun(elevation_deg, azimuth_deg).map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Tonemapping exposure (> 0).
+    #[pyo3(text_signature="($self, exposure)")]
+    pub fn set_exposure(&self, exposure: f32) -> PyResult<()> {
+        self.apply_exposure(exposure).map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Generate a procedural DEM on the GPU straight into the height texture (no host upload).
+    #[pyo3(signature = (width, height, kind="fbm", seed=0, octaves=6, frequency=4.0, lacunarity=2.0, gain=0.5, amplitude=0.25))]
+    #[pyo3(text_signature="($self, width, height, kind='fbm', seed=0, octaves=6, frequency=4.0, lacunarity=2.0, gain=0.5, amplitude=0.25)")]
+    pub fn generate_height(&self, width: u32, height: u32, kind: &str, seed: u32, octaves: u32,
+                           frequency: f32, lacunarity: f32, gain: f32, amplitude: f32) -> PyResult<()> {
+        use crate::terrain::procgen;
+        if width == 0 || height == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("width and height must be > 0"));
+        }
+        self.caps.check_texture_2d(width, height).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let kind = kind.parse::<procgen::NoiseKind>().map_err(pyo3::exceptions::PyValueError::new_err)?;
+        let params = procgen::ProcParams::new(width, height, kind, seed, octaves, frequency, lacunarity, gain, amplitude);
+        self.write_procedural_height(&params);
+        Ok(())
+    }
+
+    /// Select shader features (e.g. `["height_tex", "lut", "shadows"]`). Each distinct set is
+    /// compiled once per Scene and reused; unused features cost no ALU and no bindings.
+    #[pyo3(text_signature="($self, features)")]
+    pub fn set_features(&self, features: Vec<String>) -> PyResult<()> {
+        self.apply_features(&features).map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Active shader features (implied features included).
+    #[pyo3(text_signature="($self)")]
+    pub fn features(&self) -> Vec<&'static str> {
+        self.state.read().unwrap().features.names()
+    }
+
+    /// `(compiled_pipelines, hits, misses)` for this Scene's permutation cache.
+    #[pyo3(text_signature="($self)")]
+    pub fn pipeline_cache_stats(&self) -> (usize, u64, u64) {
+        let st = self.state.read().unwrap();
+        (st.pipelines.len(), st.pipelines.hits, st.pipelines.misses)
+    }
+
+    /// Render and return the frame as (H, W, 4) uint8 without PNG encoding.
+    #[pyo3(text_signature="($self)")]
+    pub fn render_rgba<'py>(&self, py: pyo3::Python<'py>) -> PyResult<pyo3::Bound<'py, numpy::PyArray3<u8>>> {
+        use numpy::IntoPyArray;
+        let pixels = py.allow_threads(|| self.render_pixels()).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let arr = ndarray::Array3::from_shape_vec((self.height as usize, self.width as usize, 4), pixels)
+            .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        Ok(arr.into_pyarray(py))
+    }
+
+    /// Render one frame per view matrix (numpy (N, 4, 4) float32, row-major, e.g. from
+    /// `camera_look_at`) with the Scene projection. Returns (N, H, W, 4) uint8.
+    /// Releases the GIL; safe to call from several threads on one Scene.
+    #[pyo3(text_signature="($self, views)")]
+    pub fn render_views_rgba<'py>(&self, py: pyo3::Python<'py>, views: numpy::PyReadonlyArray3<'py, f32>)
+        -> PyResult<pyo3::Bound<'py, numpy::PyArray4<u8>>> {
+        use numpy::IntoPyArray;
+        let frames: Vec<FrameDraws> = views_from_numpy(&views)?
+            .into_iter()
+            .map(FrameDraws::single)
+            .collect();
+        let n = frames.len();
+        let pixels = py.allow_threads(|| self.render_frames(&frames)).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let arr = ndarray::Array4::from_shape_vec((n, self.height as usize, self.width as usize, 4), pixels)
+            .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        Ok(arr.into_pyarray(py))
+    }
+
+    /// Render one frame per view (as `render_views_rgba`) straight into `out`: a writable,
+    /// C-contiguous uint8 buffer of N*H*W*4 bytes, e.g. a `numpy.memmap` of shape (N, H, W, 4),
+    /// a numpy view of `SharedMemory.buf`, or a `SharedMemory`/`mmap` itself. Views are
+    /// rendered `chunk` at a time with the next chunk in flight, and rows are unpadded from the
+    /// staging buffer directly into `out`, so no (N, H, W, 4) array is allocated. Returns N.
+    #[pyo3(signature = (views, out, chunk=16))]
+    #[pyo3(text_signature="($self, views, out, chunk=16)")]
+    pub fn render_views_into<'py>(&self, py: pyo3::Python<'py>, views: numpy::PyReadonlyArray3<'py, f32>,
+                                  out: &pyo3::Bound<'py, pyo3::PyAny>, chunk: usize) -> PyResult<usize> {
+        if chunk == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("chunk must be >= 1"));
+        }
+        let views = views_from_numpy(&views)?;
+        let (n, frame) = (views.len(), self.frame_len());
+        let buffer = writable_buffer(out, &[n, self.height as usize, self.width as usize, 4])?;
+        let ptr = buffer.buf_ptr() as usize;
+        py.allow_threads(|| {
+            // SAFETY: `buffer` keeps the exporter alive and its memory in place for this call,
+            // and was checked to be writable, contiguous and exactly n * frame bytes long.
+            let out = unsafe { std::slice::from_raw_parts_mut(ptr as *mut u8, n * frame) };
+            let mut in_flight: Option<(PendingFrames, &mut [u8])> = None;
+            for (vs, dst) in views.chunks(chunk).zip(out.chunks_mut(chunk * frame)) {
+                let frames: Vec<FrameDraws> = vs.iter().map(|v| FrameDraws::single(*v)).collect();
+                let pending = self.submit_frames(&frames);
+                if let Some((p, d)) = in_flight.replace((pending, dst)) {
+                    if let Err(e) = self.read_frames_into(p, d) {
+                        self.discard_frames(in_flight.take().unwrap().0);
+                        return Err(e);
+                    }
+                }
+            }
+            match in_flight {
+                Some((p, d)) => self.read_frames_into(p, d),
+                None => Ok(()),
+            }
+        }).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        Ok(n)
+    }
+
+    /// Categorical raster (uint8 (H, W), e.g. land cover) for the `class` field of
+    /// `render_dataset`, sampled nearest by terrain UV like the height texture.
+    #[pyo3(text_signature="($self, classes)")]
+    pub fn set_class_raster(&self, classes: numpy::PyReadonlyArray2<'_, u8>) -> PyResult<()> {
+        let (h, w) = (classes.shape()[0] as u32, classes.shape()[1] as u32);
+        let data = classes.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("classes must be C-contiguous uint8[H,W]"))?;
+        self.upload_classes(w, h, data).map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Render colour, linear depth, view-space normals and class IDs for each view in one
+    /// geometry pass (multiple render targets + depth buffer). Returns (N,) records of
+    /// `dataset_dtype()`: `out["rgba"]` (N, H, W, 4) u1, `out["depth"]` (N, H, W) f4,
+    /// `out["normal"]` (N, H, W, 2) f2, `out["class"]` (N, H, W) u1 (255 = no terrain).
+    /// `out` may be a preallocated array/memmap of that dtype or a uint8 buffer of
+    /// N * record bytes, filled in `chunk`-view passes as in `render_views_into`.
+    #[pyo3(signature = (views, out=None, chunk=8))]
+    #[pyo3(text_signature="($self, views, out=None, chunk=8)")]
+    pub fn render_dataset<'py>(&self, py: pyo3::Python<'py>, views: numpy::PyReadonlyArray3<'py, f32>,
+                               out: Option<pyo3::Bound<'py, pyo3::PyAny>>, chunk: usize) -> PyResult<pyo3::Bound<'py, pyo3::PyAny>> {
+        if chunk == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("chunk must be >= 1"));
+        }
+        let views = views_from_numpy(&views)?;
+        let (n, record) = (views.len(), self.dataset_record_len());
+        let dtype = self.dataset_dtype(py)?;
+        let out = match out {
+            Some(o) => o,
+            None => py.import("numpy")?.getattr("empty")?.call1((n, &dtype))?,
+        };
+        // Structured arrays are written through their bytes; plain buffers must be uint8.
+        let bytes = match out.getattr("dtype") {
+            Ok(dt) if dt.getattr("names")?.is_none() => out.clone(),
+            Ok(dt) if dt.eq(&dtype)? => out.call_method1("view", ("u1",))?,
+            Ok(_) => return Err(pyo3::exceptions::PyValueError::new_err("out must have Scene.dataset_dtype() or be uint8")),
+            Err(_) => out.clone(),
+        };
+        let buffer = writable_buffer(&bytes, &[n, record])?;
+        let ptr = buffer.buf_ptr() as usize;
+        py.allow_threads(|| {
+            // SAFETY: as in `render_views_into`.
+            let dst = unsafe { std::slice::from_raw_parts_mut(ptr as *mut u8, n * record) };
+            let mut in_flight: Option<(dataset::PendingDataset, &mut [u8])> = None;
+            for (vs, d) in views.chunks(chunk).zip(dst.chunks_mut(chunk * record)) {
+                let frames: Vec<FrameDraws> = vs.iter().map(|v| FrameDraws::single(*v)).collect();
+                let pending = self.submit_dataset(&frames);
+                if let Some((p, d)) = in_flight.replace((pending, d)) {
+                    if let Err(e) = self.read_dataset_into(p, d) {
+                        self.discard_dataset(in_flight.take().unwrap().0);
+                        return Err(e);
+                    }
                 }
             }
-            let mut idx = Vec::<u32>::with_capacity((w-1)*(h-1)*6);
-            for j in 0..h-1 {
-                for i in 0..w-1 {
-                    let a = (j*w + i) as u32;
-                    let b = (j*w + i + 1) as u32;
-                    let c = ((j+1)*w + i) as u32;
-                    let d = ((j+1)*w + i + 1) as u32;
-                    idx.extend_from_slice(&[a,c,b, b,c,d]);
+            match in_flight {
+                Some((p, d)) => self.read_dataset_into(p, d),
+                None => Ok(()),
+            }
+        }).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        Ok(out)
+    }
+
+    /// numpy dtype of one `render_dataset` record for this Scene's size.
+    #[pyo3(name = "dataset_dtype", text_signature="($self)")]
+    pub fn dataset_dtype_py<'py>(&self, py: pyo3::Python<'py>) -> PyResult<pyo3::Bound<'py, pyo3::PyAny>> {
+        self.dataset_dtype(py)
+    }
+
+    /// Play a DEM time series: one frame per entry of `times` (non-decreasing, in
+    /// [0, T-1]; default one frame per step), heights blended on the GPU between the two
+    /// nearest steps. `heights` is float32 (T, H, W) or a list of T float32 (H, W) arrays,
+    /// typically `np.load(path, mmap_mode="r")`: steps are streamed from them into a `ring`
+    /// of texture-array layers ahead of playback while up to `depth` frames render. `views`
+    /// is (N, 4, 4) (one per time) or None for the Scene camera. Returns (N, H, W, 4) uint8,
+    /// or fills `out` as `render_views_into` does and returns it.
+    #[pyo3(signature = (heights, times=None, views=None, ring=8, depth=3, out=None))]
+    #[pyo3(text_signature="($self, heights, times=None, views=None, ring=8, depth=3, out=None)")]
+    #[allow(clippy::too_many_arguments)]
+    pub fn render_sequence<'py>(&self, py: pyo3::Python<'py>, heights: &pyo3::Bound<'py, pyo3::PyAny>,
+                                times: Option<Vec<f64>>, views: Option<numpy::PyReadonlyArray3<'py, f32>>,
+                                ring: u32, depth: usize, out: Option<pyo3::Bound<'py, pyo3::PyAny>>)
+        -> PyResult<pyo3::Bound<'py, pyo3::PyAny>> {
+        // Keep the arrays borrowed for the whole call; steps are sliced out of them.
+        let (stack, list): (Option<numpy::PyReadonlyArray3<'py, f32>>, Vec<numpy::PyReadonlyArray2<'py, f32>>) =
+            match heights.extract::<numpy::PyReadonlyArray3<'py, f32>>() {
+                Ok(a) => (Some(a), Vec::new()),
+                Err(_) => (None, heights.extract().map_err(|_| pyo3::exceptions::PyTypeError::new_err(
+                    "heights must be float32 (T, H, W) or a list of float32 (H, W) arrays"))?),
+            };
+        let (steps, h, w): (Vec<&[f32]>, usize, usize) = match &stack {
+            Some(a) => {
+                let (t, h, w) = (a.shape()[0], a.shape()[1], a.shape()[2]);
+                let all = a.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("heights must be C-contiguous"))?;
+                (if h * w == 0 { Vec::new() } else { all.chunks_exact(h * w).take(t).collect() }, h, w)
+            }
+            None => {
+                let (h, w) = list.first().map_or((0, 0), |a| (a.shape()[0], a.shape()[1]));
+                let mut steps = Vec::with_capacity(list.len());
+                for a in &list {
+                    if a.shape() != [h, w] {
+                        return Err(pyo3::exceptions::PyValueError::new_err("all height steps must have the same shape"));
+                    }
+                    steps.push(a.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("height steps must be C-contiguous"))?);
+                }
+                (steps, h, w)
+            }
+        };
+        if steps.is_empty() || h == 0 || w == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("heights must hold at least one non-empty (H, W) step"));
+        }
+        self.caps.check_texture_2d(w as u32, h as u32).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        if ring < 2 || ring > self.device.limits().max_texture_array_layers {
+            return Err(pyo3::exceptions::PyValueError::new_err(format!("ring must be in [2, {}]", self.device.limits().max_texture_array_layers)));
+        }
+        if depth == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("depth must be >= 1"));
+        }
+        if self.state.read().unwrap().diff.is_some() {
+            return Err(pyo3::exceptions::PyRuntimeError::new_err("a difference is bound; call clear_diff() before render_sequence"));
+        }
+        let times = times.unwrap_or_else(|| (0..steps.len()).map(|k| k as f64).collect());
+        let plan = sequence::plan(&times, steps.len()).map_err(pyo3::exceptions::PyValueError::new_err)?;
+        if plan.is_empty() {
+            return Err(pyo3::exceptions::PyValueError::new_err("times must not be empty"));
+        }
+        let views = match views {
+            Some(v) => views_from_numpy(&v)?,
+            None => vec![self.state.read().unwrap().scene.view; plan.len()],
+        };
+        if views.len() != plan.len() {
+            return Err(pyo3::exceptions::PyValueError::new_err(format!("views has {} matrices for {} times", views.len(), plan.len())));
+        }
+        let n = plan.len();
+        let out = match out {
+            Some(o) => o,
+            None => py.import("numpy")?.getattr("empty")?.call1(((n, self.height, self.width, 4), "u1"))?,
+        };
+        let buffer = writable_buffer(&out, &[n, self.height as usize, self.width as usize, 4])?;
+        let ptr = buffer.buf_ptr() as usize;
+        let stats = py.allow_threads(|| {
+            // SAFETY: as in `render_views_into`.
+            let dst = unsafe { std::slice::from_raw_parts_mut(ptr as *mut u8, n * self.frame_len()) };
+            self.render_sequence_into(&steps, w as u32, h as u32, &plan, &views, ring, depth, dst)
+        }).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        *self.sequence_stats.lock().unwrap() = stats;
+        Ok(out)
+    }
+
+    /// Timings of the last `render_sequence`: `{steps_uploaded, upload_mb, upload_ms,
+    /// upload_mb_s, render_wait_ms, total_ms}`. `upload_ms` is time spent reading and queueing
+    /// steps on the uploader thread; `render_wait_ms` is time frames waited for their steps.
+    #[pyo3(text_signature="($self)")]
+    pub fn sequence_stats(&self, py: pyo3::Python<'_>) -> PyResult<pyo3::PyObject> {
+        let s = *self.sequence_stats.lock().unwrap();
+        let d = pyo3::types::PyDict::new(py);
+        let mb = s.upload_bytes as f64 / (1024.0 * 1024.0);
+        d.set_item("steps_uploaded", s.steps_uploaded)?;
+        d.set_item("upload_mb", mb)?;
+        d.set_item("upload_ms", s.upload_ms)?;
+        d.set_item("upload_mb_s", if s.total_ms > 0.0 { mb / (s.total_ms / 1000.0) } else { 0.0 })?;
+        d.set_item("render_wait_ms", s.render_wait_ms)?;
+        d.set_item("total_ms", s.total_ms)?;
+        Ok(d.into_any().unbind())
+    }
+
+    /// Bind two DEM epochs (float32 (H, W), same shape; NaN = nodata) and render their
+    /// difference: geometry from `surface` ('a' or 'b'), both shaded with epoch a's normals,
+    /// colour = a - b through a diverging red-white-blue LUT saturating at ±`range`
+    /// (default: max |a - b|, reduced on the GPU). Returns the range used.
+    #[pyo3(signature = (a, b, range=None, surface="a"))]
+    #[pyo3(text_signature="($self, a, b, range=None, surface='a')")]
+    pub fn set_diff(&self, py: pyo3::Python<'_>, a: numpy::PyReadonlyArray2<'_, f32>, b: numpy::PyReadonlyArray2<'_, f32>,
+                    range: Option<f32>, surface: &str) -> PyResult<f32> {
+        let surface = diff::parse_epoch(surface).map_err(pyo3::exceptions::PyValueError::new_err)?;
+        if a.shape() != b.shape() {
+            return Err(pyo3::exceptions::PyValueError::new_err(format!("a {:?} and b {:?} must have the same shape", a.shape(), b.shape())));
+        }
+        let (h, w) = (a.shape()[0] as u32, a.shape()[1] as u32);
+        let sa = a.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("a must be C-contiguous float32[H,W]"))?;
+        let sb = b.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("b must be C-contiguous float32[H,W]"))?;
+        py.allow_threads(|| {
+            self.set_diff_epochs(w, h, sa, sb)?;
+            self.apply_diff_style(range, surface)
+        }).map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Overwrite the (h, w) window of epoch 'a' or 'b' whose top-left texel is column `x`,
+    /// row `y`; the other epoch is not re-uploaded. The colour range is left as is.
+    #[pyo3(signature = (epoch, patch, x=0, y=0))]
+    #[pyo3(text_signature="($self, epoch, patch, x=0, y=0)")]
+    pub fn update_epoch(&self, epoch: &str, patch: numpy::PyReadonlyArray2<'_, f32>, x: u32, y: u32) -> PyResult<()> {
+        let epoch = diff::parse_epoch(epoch).map_err(pyo3::exceptions::PyValueError::new_err)?;
+        let (h, w) = (patch.shape()[0] as u32, patch.shape()[1] as u32);
+        let data = patch.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("patch must be C-contiguous float32[h,w]"))?;
+        self.update_epoch_region(epoch, x, y, w, h, data).map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Change the colour range (None: max |a - b| of the current epochs) and the displaced
+    /// epoch without re-uploading. Returns the range used.
+    #[pyo3(signature = (range=None, surface="a"))]
+    #[pyo3(text_signature="($self, range=None, surface='a')")]
+    pub fn set_diff_style(&self, py: pyo3::Python<'_>, range: Option<f32>, surface: &str) -> PyResult<f32> {
+        let surface = diff::parse_epoch(surface).map_err(pyo3::exceptions::PyValueError::new_err)?;
+        py.allow_threads(|| self.apply_diff_style(range, surface)).map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Unbind the epochs; renders use the Scene height and colormap again.
+    #[pyo3(text_signature="($self)")]
+    pub fn clear_diff(&self) {
+        self.clear_diff_epochs();
+    }
+
+    /// Statistics of a - b from a GPU reduction (only the histogram and per-workgroup sums
+    /// are read back): `hist` (bins,) uint32 over `edges` (bins + 1,) as numpy.histogram
+    /// (`range` default: [min, max]), `below`/`above` counts outside the range, `fill_volume`
+    /// / `cut_volume` / `net_volume` (sums of positive / negative differences × `cell_area`),
+    /// `fill_cells`, `cut_cells`, `valid_cells`, `nodata_cells`, `min`, `max` and `mean`.
+    #[pyo3(signature = (bins=64, range=None, cell_area=1.0))]
+    #[pyo3(text_signature="($self, bins=64, range=None, cell_area=1.0)")]
+    pub fn diff_stats(&self, py: pyo3::Python<'_>, bins: u32, range: Option<(f32, f32)>, cell_area: f64) -> PyResult<pyo3::PyObject> {
+        use numpy::IntoPyArray;
+        let s = py.allow_threads(|| self.diff_summary(bins, range)).map_err(pyo3::exceptions::PyValueError::new_err)?;
+        let (lo, hi) = match range {
+            Some(r) => r,
+            None if s.valid == 0 => (0.0, 1.0),
+            None if s.min == s.max => (s.min - 0.5, s.max + 0.5),
+            None => (s.min, s.max),
+        };
+        let total = {
+            let st = self.state.read().unwrap();
+            st.diff.as_ref().map_or(0, |d| d.texels())
+        };
+        let edges: Vec<f64> = (0..=bins).map(|i| lo as f64 + (hi as f64 - lo as f64) * i as f64 / bins as f64).collect();
+        let nan_if_empty = |v: f64| if s.valid == 0 { f64::NAN } else { v };
+        let d = pyo3::types::PyDict::new(py);
+        d.set_item("hist", s.hist[1..=bins as usize].to_vec().into_pyarray(py))?;
+        d.set_item("edges", edges.into_pyarray(py))?;
+        d.set_item("below", s.hist[0])?;
+        d.set_item("above", s.hist[bins as usize + 1])?;
+        d.set_item("fill_volume", s.fill * cell_area)?;
+        d.set_item("cut_volume", s.cut * cell_area)?;
+        d.set_item("net_volume", (s.fill - s.cut) * cell_area)?;
+        d.set_item("fill_cells", s.fill_cells)?;
+        d.set_item("cut_cells", s.cut_cells)?;
+        d.set_item("valid_cells", s.valid)?;
+        d.set_item("nodata_cells", total - s.valid)?;
+        d.set_item("min", nan_if_empty(s.min as f64))?;
+        d.set_item("max", nan_if_empty(s.max as f64))?;
+        d.set_item("mean", nan_if_empty((s.fill - s.cut) / s.valid.max(1) as f64))?;
+        Ok(d.into_any().unbind())
+    }
+
+    /// Flood from `seeds` ((K, 2) integer (col, row) cells of the height texture) at
+    /// `levels` (one shared level, or (K,) per seed): every cell connected to a seed through
+    /// 4-neighbours whose ground is below the water surface is wet (NaN heights are walls).
+    /// Propagation runs on the GPU over the bound height texture until it converges and the
+    /// depth is drawn as a water overlay. With one shared level the spill-level field is
+    /// kept, so `set_water_level` only re-runs the depth pass. Returns `{wet_cells, passes,
+    /// ms}` (`passes` = relaxation dispatches).
+    #[pyo3(text_signature="($self, seeds, levels)")]
+    pub fn flood(&self, py: pyo3::Python<'_>, seeds: &pyo3::Bound<'_, pyo3::PyAny>, levels: &pyo3::Bound<'_, pyo3::PyAny>) -> PyResult<pyo3::PyObject> {
+        let cells = seed_cells(py, seeds)?;
+        let t0 = std::time::Instant::now();
+        let run = match levels.extract::<f32>() {
+            Ok(level) if !level.is_finite() => Err(format!("water level {} is not finite", level)),
+            Ok(level) => py.allow_threads(|| {
+                let passes = self.flood_spill(&cells)?;
+                self.water_level(level).map(|r| flood::FloodRun { passes, ..r })
+            }),
+            Err(_) => {
+                let levels: Vec<f32> = levels.extract()
+                    .map_err(|_| pyo3::exceptions::PyTypeError::new_err("levels must be a float or a sequence of floats"))?;
+                if levels.len() != cells.len() {
+                    return Err(pyo3::exceptions::PyValueError::new_err(format!("{} levels for {} seeds", levels.len(), cells.len())));
                 }
+                let seeds: Vec<_> = cells.iter().zip(&levels)
+                    .map(|(&(x, y), &level)| crate::terrain::flood::Seed { x, y, level, _p: 0.0 })
+                    .collect();
+                py.allow_threads(|| self.flood_surface(&seeds))
+            }
+        }.map_err(pyo3::exceptions::PyValueError::new_err)?;
+        let d = pyo3::types::PyDict::new(py);
+        d.set_item("wet_cells", run.wet)?;
+        d.set_item("passes", run.passes)?;
+        d.set_item("ms", t0.elapsed().as_secs_f64() * 1000.0)?;
+        Ok(d.into_any().unbind())
+    }
+
+    /// Wet cell count for each of `levels` ((N,) float) flooding from `seeds` as `flood`:
+    /// the spill-level field is propagated once and each level costs one depth pass, all in
+    /// one submission. Returns (N,) uint32; the overlay shows the last level.
+    #[pyo3(text_signature="($self, seeds, levels)")]
+    pub fn flood_sweep<'py>(&self, py: pyo3::Python<'py>, seeds: &pyo3::Bound<'py, pyo3::PyAny>, levels: Vec<f32>)
+        -> PyResult<pyo3::Bound<'py, numpy::PyArray1<u32>>> {
+        use numpy::IntoPyArray;
+        let cells = seed_cells(py, seeds)?;
+        if levels.is_empty() {
+            return Err(pyo3::exceptions::PyValueError::new_err("levels must not be empty"));
+        }
+        let wet = py.allow_threads(|| {
+            self.flood_spill(&cells)?;
+            self.sweep_levels(&levels)
+        }).map_err(pyo3::exceptions::PyValueError::new_err)?;
+        Ok(wet.into_pyarray(py))
+    }
+
+    /// Move the water surface of the last single-level `flood` / `flood_sweep` to `level`
+    /// without propagating again. Returns the wet cell count.
+    #[pyo3(text_signature="($self, level)")]
+    pub fn set_water_level(&self, py: pyo3::Python<'_>, level: f32) -> PyResult<u64> {
+        py.allow_threads(|| self.water_level(level))
+            .map(|r| r.wet)
+            .map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Water depth above ground of the current flood as (H, W) float32 (0 = dry).
+    #[pyo3(text_signature="($self)")]
+    pub fn water_depth<'py>(&self, py: pyo3::Python<'py>) -> PyResult<pyo3::Bound<'py, numpy::PyArray2<f32>>> {
+        use numpy::IntoPyArray;
+        let (w, h, data) = py.allow_threads(|| self.water_depth_texels())
+            .map_err(pyo3::exceptions::PyRuntimeError::new_err)?
+            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("no flood bound; call flood(seeds, levels) first"))?;
+        let arr = ndarray::Array2::from_shape_vec((h as usize, w as usize), data)
+            .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        Ok(arr.into_pyarray(py))
+    }
+
+    /// Remove the water overlay and free the flood buffers.
+    #[pyo3(text_signature="($self)")]
+    pub fn clear_water(&self) {
+        self.clear_water_state();
+    }
+
+    /// Colour the terrain by `values` ((H, W) float32, e.g. `hydrology(...)["accumulation"]`)
+    /// through the colormap instead of by height. `range` (default: finite min / max) maps
+    /// to the ends of the LUT; `log` maps `ln(1 + v)` instead, which suits flow accumulation.
+    /// NaN takes the low end. The grid is stretched over the terrain like the height texture.
+    #[pyo3(signature = (values, range=None, log=false))]
+    #[pyo3(text_signature="($self, values, range=None, log=False)")]
+    pub fn set_scalar(&self, py: pyo3::Python<'_>, values: numpy::PyReadonlyArray2<'_, f32>, range: Option<(f32, f32)>, log: bool) -> PyResult<()> {
+        let (h, w) = (values.shape()[0] as u32, values.shape()[1] as u32);
+        let data = values.as_slice().map_err(|_| pyo3::exceptions::PyValueError::new_err("values must be C-contiguous float32[H,W]"))?;
+        if data.is_empty() {
+            return Err(pyo3::exceptions::PyValueError::new_err("values must be a non-empty float32[H,W]"));
+        }
+        let t = py.allow_threads(|| scalar::normalize(data, range, log)).map_err(pyo3::exceptions::PyValueError::new_err)?;
+        py.allow_threads(|| self.bind_scalar(w, h, &t)).map_err(pyo3::exceptions::PyRuntimeError::new_err)
+    }
+
+    /// Go back to colouring by height after `set_scalar`.
+    #[pyo3(text_signature="($self)")]
+    pub fn clear_scalar(&self) {
+        let mut st = self.state.write().unwrap();
+        self.drop_scalar(&mut st);
+    }
+
+    /// Run `iterations` of pipe-model hydraulic plus thermal erosion on the GPU over the
+    /// bound height texture (NaN heights are walls). State persists across calls, so
+    /// repeated calls continue one simulation; `params` (`dt`, `cell`, `rain`,
+    /// `evaporation`, `capacity`, `dissolve`, `deposit`, `talus`, `thermal`, `gravity`)
+    /// override the previous values (defaults on the first call). Iterations are submitted
+    /// `batch` at a time and the eroded terrain is rendered without any host readback. With
+    /// `record_every > 0` a frame is rendered every `record_every` iterations. Returns
+    /// `{iterations, total_iterations, ms}`, plus `frames` ((K, H, W, 4) uint8) when recording.
+    #[pyo3(signature = (iterations, batch=32, record_every=0, **params))]
+    #[pyo3(text_signature="($self, iterations, batch=32, record_every=0, **params)")]
+    pub fn erode(&self, py: pyo3::Python<'_>, iterations: u32, batch: u32, record_every: u32,
+                 params: Option<&pyo3::Bound<'_, pyo3::types::PyDict>>) -> PyResult<pyo3::PyObject> {
+        use numpy::IntoPyArray;
+        if batch == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("batch must be > 0"));
+        }
+        let base = self.erosion_base().map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let p = crate::erosion_params(base, params)?;
+        let t0 = std::time::Instant::now();
+        let (total, pixels) = py.allow_threads(|| self.erode_batches(p, iterations, batch, record_every))
+            .map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let d = pyo3::types::PyDict::new(py);
+        d.set_item("iterations", iterations)?;
+        d.set_item("total_iterations", total)?;
+        d.set_item("ms", t0.elapsed().as_secs_f64() * 1000.0)?;
+        if record_every > 0 {
+            let n = pixels.len() / (self.width as usize * self.height as usize * 4);
+            let arr = ndarray::Array4::from_shape_vec((n, self.height as usize, self.width as usize, 4), pixels)
+                .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+            d.set_item("frames", arr.into_pyarray(py))?;
+        }
+        Ok(d.into_any().unbind())
+    }
+
+    /// Current erosion state as `{height, water, sediment}` ((H, W) float32 each).
+    #[pyo3(text_signature="($self)")]
+    pub fn erosion_fields(&self, py: pyo3::Python<'_>) -> PyResult<pyo3::PyObject> {
+        let (w, h, cells) = py.allow_threads(|| self.erosion_cells())
+            .map_err(pyo3::exceptions::PyRuntimeError::new_err)?
+            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("no erosion running; call erode(iterations) first"))?;
+        crate::erosion_fields_dict(py, w as usize, h as usize, &cells)
+    }
+
+    /// Discard the erosion state and render the height texture it started from again.
+    #[pyo3(text_signature="($self)")]
+    pub fn reset_erosion(&self) {
+        self.reset_erosion_state();
+    }
+
+    /// Reuse the last full frame in `render_rgba` / `render_png` while only the camera moved,
+    /// by at most `max_motion` of the viewport since: its pixels are reprojected into the new
+    /// view and only disoccluded or newly visible terrain is shaded again. Beyond that the
+    /// frame is rendered in full and becomes the new reference. A carried-over pixel is
+    /// dropped when a neighbour is nearer by more than `depth_tolerance` (relative). Frames
+    /// on this path are depth-tested. `enabled=False` frees the history targets.
+    #[pyo3(signature = (enabled=true, max_motion=0.1, depth_tolerance=0.02))]
+    #[pyo3(text_signature="($self, enabled=True, max_motion=0.1, depth_tolerance=0.02)")]
+    pub fn set_temporal(&self, enabled: bool, max_motion: f32, depth_tolerance: f32) -> PyResult<()> {
+        self.set_temporal_state(enabled, max_motion, depth_tolerance)
+            .map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Temporal reuse since the last `set_temporal`: `{enabled, frames, full_frames,
+    /// reused_fraction, mean_reused_fraction, motion, history_age}`. `reused_fraction` is the
+    /// share of pixels carried over in the last frame, `motion` its camera motion since the
+    /// last full frame (fraction of the viewport; `None` when it had no comparable history)
+    /// and `history_age` the frames since that full frame.
+    #[pyo3(text_signature="($self)")]
+    pub fn temporal_stats(&self, py: pyo3::Python<'_>) -> PyResult<pyo3::PyObject> {
+        let (enabled, s) = {
+            let t = self.temporal.lock().unwrap();
+            (t.is_some(), t.as_ref().map(|t| t.stats).unwrap_or_default())
+        };
+        let d = pyo3::types::PyDict::new(py);
+        d.set_item("enabled", enabled)?;
+        d.set_item("frames", s.frames)?;
+        d.set_item("full_frames", s.full_frames)?;
+        d.set_item("reused_fraction", s.reused_fraction)?;
+        d.set_item("mean_reused_fraction", if s.frames > 0 { s.reused_sum / s.frames as f64 } else { 0.0 })?;
+        d.set_item("motion", s.motion)?;
+        d.set_item("history_age", s.history_age)?;
+        Ok(d.into_any().unbind())
+    }
+
+    /// Draw `render_rgba` / `render_png` frames on a screen-space grid instead of the Scene
+    /// mesh: one vertex every `cell` pixels, projected onto the terrain plane per frame, with
+    /// `margin` of overscan (NDC units) for relief entering from beyond the screen edges.
+    /// Vertex count follows the output size, not the DEM or the zoom. Temporal reprojection
+    /// takes precedence when both are enabled. `enabled=False` returns to the Scene mesh.
+    #[pyo3(signature = (enabled=true, cell=2, margin=0.05))]
+    #[pyo3(text_signature="($self, enabled=True, cell=2, margin=0.05)")]
+    pub fn set_projected_grid(&self, enabled: bool, cell: u32, margin: f32) -> PyResult<()> {
+        self.set_projected_state(enabled, cell, margin)
+            .map_err(pyo3::exceptions::PyValueError::new_err)
+    }
+
+    /// Geometry of the projected grid next to the Scene mesh: `{enabled, cell, margin,
+    /// grid, vertices, triangles, frames, mesh_vertices, mesh_triangles}` (`grid` is
+    /// (columns, rows); `cell`, `margin` and `grid` are `None` while disabled).
+    #[pyo3(text_signature="($self)")]
+    pub fn projected_grid_stats(&self, py: pyo3::Python<'_>) -> PyResult<pyo3::PyObject> {
+        let g = self.projected.lock().unwrap();
+        let d = pyo3::types::PyDict::new(py);
+        d.set_item("enabled", g.is_some())?;
+        d.set_item("cell", g.as_ref().map(|g| g.cell))?;
+        d.set_item("margin", g.as_ref().map(|g| g.margin))?;
+        d.set_item("grid", g.as_ref().map(|g| (g.dims[0], g.dims[1])))?;
+        d.set_item("vertices", g.as_ref().map_or(0, |g| g.dims[0] * g.dims[1]))?;
+        d.set_item("triangles", g.as_ref().map_or(0, |g| g.nidx / 3))?;
+        d.set_item("frames", g.as_ref().map_or(0, |g| g.frames))?;
+        d.set_item("mesh_vertices", self.grid * self.grid)?;
+        d.set_item("mesh_triangles", self.nidx / 3)?;
+        Ok(d.into_any().unbind())
+    }
+
+    /// Submit a render without waiting and return a `Frame` (`readback()`, `ready()`,
+    /// `await readback_async()`). `views` as in `render_views_rgba`; `None` renders the
+    /// Scene camera and reads back as (H, W, 4).
+    #[pyo3(signature = (views=None))]
+    #[pyo3(text_signature="($self, views=None)")]
+    pub fn submit<'py>(slf: &pyo3::Bound<'py, Self>, py: pyo3::Python<'py>, views: Option<numpy::PyReadonlyArray3<'py, f32>>)
+        -> PyResult<frames::Frame> {
+        let scene = slf.get();
+        let (frames, shape) = scene.frames_for(views.as_ref())?;
+        let pending = py.allow_threads(|| scene.submit_frames(&frames));
+        Ok(frames::Frame::new(slf.clone().unbind(), pending, shape))
+    }
+
+    /// `await scene.render_async(views=None)`: submit now, resolve with the pixels once the
+    /// GPU is done. Completion is driven by a Rust poller thread, not the event loop.
+    #[pyo3(signature = (views=None))]
+    #[pyo3(text_signature="($self, views=None)")]
+    pub fn render_async<'py>(slf: &pyo3::Bound<'py, Self>, py: pyo3::Python<'py>, views: Option<numpy::PyReadonlyArray3<'py, f32>>)
+        -> PyResult<pyo3::Bound<'py, pyo3::PyAny>> {
+        let frame = Self::submit(slf, py, views)?;
+        frame.readback_future(py)
+    }
+
+    /// Iterate over one (H, W, 4) frame per camera (numpy (N, 4, 4) float32 views) while up
+    /// to `depth` later frames are already submitted, overlapping GPU work with consumption.
+    #[pyo3(signature = (cameras, depth=3))]
+    #[pyo3(text_signature="($self, cameras, depth=3)")]
+    pub fn render_stream<'py>(slf: &pyo3::Bound<'py, Self>, cameras: numpy::PyReadonlyArray3<'py, f32>, depth: usize)
+        -> PyResult<frames::FrameStream> {
+        if depth == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("depth must be >= 1"));
+        }
+        let views = views_from_numpy(&cameras)?;
+        Ok(frames::FrameStream::new(slf.clone().unbind(), views, depth))
+    }
+
+    /// Render a quick preview, then refine in the background. The preview is
+    /// (H / `preview_scale`, W / `preview_scale`, 4) uint8 drawn on a `preview_grid`² mesh
+    /// (default `grid / preview_scale`) and is ready when this returns. The refinement uses
+    /// the Scene grid at full size, supersampled `aa`× per axis, and is delivered through
+    /// the returned `ProgressiveFrame` (`result()`, `await result_async()`) and
+    /// `callback(stage, rgba)` with stage `"preview"` (before returning), then `"final"`,
+    /// `"cancelled"` or `"failed"` (rgba `None`) from a background thread. Moving the camera
+    /// or changing what the terrain shows cancels it.
+    #[pyo3(signature = (callback=None, preview_scale=4, preview_grid=None, aa=2))]
+    #[pyo3(text_signature="($self, callback=None, preview_scale=4, preview_grid=None, aa=2)")]
+    pub fn render_progressive(slf: &pyo3::Bound<'_, Self>, py: pyo3::Python<'_>, callback: Option<pyo3::PyObject>,
+                              preview_scale: u32, preview_grid: Option<u32>, aa: u32) -> PyResult<progressive::ProgressiveFrame> {
+        if preview_scale == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("preview_scale must be >= 1"));
+        }
+        if !(1..=4).contains(&aa) {
+            return Err(pyo3::exceptions::PyValueError::new_err("aa must be 1, 2, 3 or 4"));
+        }
+        let grid = slf.get().grid;
+        let preview_grid = preview_grid.unwrap_or(grid / preview_scale).max(2);
+        Self::start_progressive(slf, py, callback, preview_scale, preview_grid, aa)
+    }
+
+    /// Hold `render_budgeted` frames to `target_ms` by trading quality: mesh resolution
+    /// (down to `min_grid`), the listed `effects` ("shadows", "ao") and supersampling up to
+    /// `max_aa`. Quality drops as soon as a frame runs over and rises one level after
+    /// `up_after` frames in a row whose smoothed time is under `up_headroom × target_ms`.
+    /// Returns the quality ladder, cheapest first (`[{grid, aa, shadows, ao}]`);
+    /// `target_ms=None` disables it.
+    #[pyo3(signature = (target_ms=None, effects=None, max_aa=2, min_grid=16, up_headroom=0.75, up_after=3))]
+    #[pyo3(text_signature="($self, target_ms=None, effects=['shadows', 'ao'], max_aa=2, min_grid=16, up_headroom=0.75, up_after=3)")]
+    pub fn set_frame_budget(&self, py: pyo3::Python<'_>, target_ms: Option<f64>, effects: Option<Vec<String>>, max_aa: u32,
+                            min_grid: u32, up_headroom: f64, up_after: u32) -> PyResult<Vec<pyo3::PyObject>> {
+        let effects = effects.unwrap_or_else(|| vec!["shadows".into(), "ao".into()]);
+        let levels = self.set_budget_state(target_ms, &effects, max_aa, min_grid, up_headroom, up_after)
+            .map_err(pyo3::exceptions::PyValueError::new_err)?;
+        levels.iter().map(|l| {
+            let d = pyo3::types::PyDict::new(py);
+            d.set_item("grid", l.grid)?;
+            d.set_item("aa", l.aa)?;
+            d.set_item("shadows", l.shadows)?;
+            d.set_item("ao", l.ao)?;
+            Ok(d.into_any().unbind())
+        }).collect()
+    }
+
+    /// Render the Scene camera at the quality chosen by `set_frame_budget`. Returns
+    /// `{rgba, quality: {level, grid, aa, shadows, ao, features}, timings: {encode_ms,
+    /// gpu_terrain_ms, gpu_resolve_ms, wait_ms, copy_ms, total_ms}, budget: {target_ms,
+    /// ewma_ms, next_level, reason}}`; the GPU times are `None` without timestamp queries.
+    #[pyo3(text_signature="($self)")]
+    pub fn render_budgeted(&self, py: pyo3::Python<'_>) -> PyResult<pyo3::PyObject> {
+        use pyo3::types::PyDict;
+        let f = py.allow_threads(|| self.render_budgeted_frame())
+            .map_err(pyo3::exceptions::PyRuntimeError::new_err)?
+            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("no frame budget set; call set_frame_budget first"))?;
+        let quality = PyDict::new(py);
+        quality.set_item("level", f.level_index)?;
+        quality.set_item("grid", f.level.grid)?;
+        quality.set_item("aa", f.level.aa)?;
+        quality.set_item("shadows", f.features.contains(crate::terrain::variants::ShaderFeatures::SHADOWS))?;
+        quality.set_item("ao", f.features.contains(crate::terrain::variants::ShaderFeatures::AO))?;
+        quality.set_item("features", f.features.names())?;
+        let t = f.timings;
+        let timings = PyDict::new(py);
+        timings.set_item("encode_ms", t.encode_ms)?;
+        timings.set_item("gpu_terrain_ms", t.gpu_terrain_ms)?;
+        timings.set_item("gpu_resolve_ms", t.gpu_resolve_ms)?;
+        timings.set_item("wait_ms", t.wait_ms)?;
+        timings.set_item("copy_ms", t.copy_ms)?;
+        timings.set_item("total_ms", t.total_ms)?;
+        let budget = PyDict::new(py);
+        budget.set_item("target_ms", f.target_ms)?;
+        budget.set_item("ewma_ms", f.ewma_ms)?;
+        budget.set_item("next_level", f.decision.to)?;
+        budget.set_item("reason", f.decision.reason)?;
+        let d = PyDict::new(py);
+        d.set_item("rgba", frames::to_array(py, f.pixels, &[self.height as usize, self.width as usize, 4])?)?;
+        d.set_item("quality", quality)?;
+        d.set_item("timings", timings)?;
+        d.set_item("budget", budget)?;
+        Ok(d.into_any().unbind())
+    }
+
+    /// Draw the terrain once per world offset (numpy (M, 3) float32) into a single frame.
+    #[pyo3(text_signature="($self, offsets)")]
+    pub fn render_instances_rgba<'py>(&self, py: pyo3::Python<'py>, offsets: numpy::PyReadonlyArray2<'py, f32>)
+        -> PyResult<pyo3::Bound<'py, numpy::PyArray3<u8>>> {
+        use numpy::IntoPyArray;
+        let a = offsets.as_array();
+        if a.ncols() != 3 || a.nrows() == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("offsets must be float32 with shape (M, 3), M >= 1"));
+        }
+        let offsets: Vec<[f32; 3]> = a.rows().into_iter().map(|r| [r[0], r[1], r[2]]).collect();
+        let frame = FrameDraws { view: self.state.read().unwrap().scene.view, offsets, layer: 0.0 };
+        let pixels = py.allow_threads(|| self.render_frames(&[frame])).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let arr = ndarray::Array3::from_shape_vec((self.height as usize, self.width as usize, 4), pixels)
+            .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        Ok(arr.into_pyarray(py))
+    }
+
+    /// True when camera/per-draw data is passed as push constants (UBO fallback otherwise).
+    #[pyo3(text_signature="($self)")]
+    pub fn push_constants_enabled(&self) -> bool {
+        self.caps.push_constants()
+    }
+
+    /// Negotiated fast paths and key limits of this Scene's device.
+    #[pyo3(text_signature="($self)")]
+    pub fn device_caps(&self, py: pyo3::Python<'_>) -> pyo3::PyObject {
+        self.caps.to_pydict(py).into_any().unbind()
+    }
+
+    #[pyo3(text_signature="($self, path)")]
+    pub fn render_png(&self, py: pyo3::Python<'_>, path: String) -> PyResult<()> {
+        let pixels = py.allow_threads(|| self.render_pixels()).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let img = image::RgbaImage::from_raw(self.width, self.height, pixels)
+            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("Invalid image buffer"))?;
+        py.allow_threads(|| img.save(path)).map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        Ok(())
+    }
+
+    /// `(slots, in_use)`: pooled per-call render slots and how many are borrowed right now.
+    /// The pool grows to the peak number of concurrent render calls.
+    #[pyo3(text_signature="($self)")]
+    pub fn render_slot_stats(&self) -> (usize, usize) {
+        let free = self.slots.lock().unwrap().len();
+        let created = self.slots_created.load(std::sync::atomic::Ordering::Relaxed);
+        (created, created - free)
+    }
+
+    #[pyo3(text_signature="($self)")]
+    pub fn debug_uniforms_f32<'py>(&self, py: pyo3::Python<'py>) -> pyo3::PyResult<pyo3::Bound<'py, numpy::PyArray1<f32>>> {
+        let u = self.state.read().unwrap().last_uniforms;
+        let fl: &[f32] = bytemuck::cast_slice(bytemuck::bytes_of(&u));
+        Ok(numpy::PyArray1::from_vec(py, fl.to_vec()))
+    }
+
+    #[pyo3(text_signature="($self)")]
+    pub fn debug_lut_format(&self) -> &'static str {
+        self.lut_format
+    }
+}
+
+/// (N, 4, 4) row-major numpy view matrices → glam (column-major).
+fn views_from_numpy(views: &numpy::PyReadonlyArray3<'_, f32>) -> PyResult<Vec<glam::Mat4>> {
+    let a = views.as_array();
+    let (n, r, c) = a.dim();
+    if n == 0 || r != 4 || c != 4 {
+        return Err(pyo3::exceptions::PyValueError::new_err("views must be float32 with shape (N, 4, 4), N >= 1"));
+    }
+    Ok(a.outer_iter()
+        .map(|m| glam::Mat4::from_cols_array_2d(&[
+            [m[[0, 0]], m[[1, 0]], m[[2, 0]], m[[3, 0]]],
+            [m[[0, 1]], m[[1, 1]], m[[2, 1]], m[[3, 1]]],
+            [m[[0, 2]], m[[1, 2]], m[[2, 2]], m[[3, 2]]],
+            [m[[0, 3]], m[[1, 3]], m[[2, 3]], m[[3, 3]]],
+        ]))
+        .collect())
+}
+
+/// (K, 2) integer (col, row) cells from any array-like; one `(col, row)` pair is accepted too.
+pub(crate) fn seed_cells(py: pyo3::Python<'_>, seeds: &pyo3::Bound<'_, pyo3::PyAny>) -> PyResult<Vec<(u32, u32)>> {
+    let np = py.import("numpy")?;
+    let arr = np.getattr("atleast_2d")?.call1((np.getattr("asarray")?.call1((seeds, "i8"))?,))?;
+    let arr: numpy::PyReadonlyArray2<'_, i64> = arr.extract()?;
+    let a = arr.as_array();
+    if a.ncols() != 2 || a.nrows() == 0 {
+        return Err(pyo3::exceptions::PyValueError::new_err("seeds must be integer (col, row) cells with shape (K, 2), K >= 1"));
+    }
+    a.rows()
+        .into_iter()
+        .map(|r| match (u32::try_from(r[0]), u32::try_from(r[1])) {
+            (Ok(x), Ok(y)) => Ok((x, y)),
+            _ => Err(pyo3::exceptions::PyValueError::new_err(format!("seed ({}, {}) is negative", r[0], r[1]))),
+        })
+        .collect()
+}
+
+/// Writable, C-contiguous byte buffer of exactly `shape.product()` bytes behind `out`
+/// (numpy array/memmap, memoryview, mmap, or `SharedMemory` via its `buf`). A 4-D buffer
+/// must also match `shape`; flat buffers only need the right size.
+fn writable_buffer(out: &pyo3::Bound<'_, pyo3::PyAny>, shape: &[usize]) -> PyResult<pyo3::buffer::PyBuffer<u8>> {
+    let obj = if out.hasattr("buf")? { out.getattr("buf")? } else { out.clone() };
+    let buffer: pyo3::buffer::PyBuffer<u8> = obj.extract()
+        .map_err(|_| pyo3::exceptions::PyTypeError::new_err("out must be a uint8 buffer (numpy array, memmap, memoryview or SharedMemory)"))?;
+    if buffer.readonly() {
+        return Err(pyo3::exceptions::PyValueError::new_err("out is read-only"));
+    }
+    if !buffer.is_c_contiguous() {
+        return Err(pyo3::exceptions::PyValueError::new_err("out must be C-contiguous"));
+    }
+    let want: usize = shape.iter().product();
+    if buffer.len_bytes() != want || (buffer.dimensions() == shape.len() && buffer.shape() != shape) {
+        return Err(pyo3::exceptions::PyValueError::new_err(format!(
+            "out must be uint8 with shape {:?} ({} bytes), got shape {:?}", shape, want, buffer.shape())));
+    }
+    Ok(buffer)
+}
+
+type SharedDevice = (std::sync::Weak<wgpu::Device>, std::sync::Weak<wgpu::Queue>, crate::device_caps::DeviceCaps);
+
+/// Live shared Scene devices by `device_key`; entries die with their last Scene.
+static SCENE_DEVICES: once_cell::sync::Lazy<std::sync::Mutex<std::collections::HashMap<String, SharedDevice>>> =
+    once_cell::sync::Lazy::new(Default::default);
+
+/// Scenes on the same adapter with the same negotiated features can share a device.
+fn device_key(adapter: &wgpu::Adapter) -> String {
+    format!("{}|{:?}", crate::adapter_rank::adapter_key(&adapter.get_info()),
+            crate::device_caps::negotiate(adapter).features)
+}
+
+/// Device, queue and caps of a new Scene, plus the default pipeline when it adopts the warm
+/// device. `shared` Scenes on the same adapter share one device (one set of driver queues,
+/// so the scheduler can submit their work together); other Scenes get a private device.
+fn scene_device(adapter: &wgpu::Adapter, shared: bool)
+    -> Result<(std::sync::Arc<wgpu::Device>, std::sync::Arc<wgpu::Queue>, crate::device_caps::DeviceCaps, Option<WarmPipeline>), wgpu::RequestDeviceError> {
+    use std::sync::Arc;
+    let key = device_key(adapter);
+    let mut devices = if shared {
+        let devices = SCENE_DEVICES.lock().unwrap();
+        if let Some((d, q, caps)) = devices.get(&key) {
+            if let (Some(d), Some(q)) = (d.upgrade(), q.upgrade()) {
+                return Ok((d, q, caps.clone(), None));
             }
-            let vbuf = device.create_buffer_init(&wgpu::util::BufferInitDescriptor{ label: Some("scene-xyuv-vbuf"), contents: bytemuck::cast_slice(&verts), usage: wgpu::BufferUsages::VERTEX });
-            let ibuf = device.create_buffer_init(&wgpu::util::BufferInitDescriptor{ label: Some("scene-xyuv-ibuf"), contents: bytemuck::cast_slice(&idx), usage: wgpu::BufferUsages::INDEX });
-            (vbuf, ibuf, idx.len() as u32)
+        }
+        Some(devices)
+    } else {
+        None
+    };
+    let (device, queue, caps, pipeline) = match adopt_warm_scene(&key) {
+        Some(w) => (w.device, w.queue, w.caps, Some(w.pipeline)),
+        None => {
+            let (device, queue, caps) = crate::device_caps::request_device(adapter, "scene-device")?;
+            (Arc::new(device), Arc::new(queue), caps, None)
+        }
+    };
+    if let Some(devices) = devices.as_mut() {
+        devices.insert(key, (Arc::downgrade(&device), Arc::downgrade(&queue), caps.clone()));
+    }
+    Ok((device, queue, caps, pipeline))
+}
+
+/// Default permutation of a new Scene on a device with `caps`.
+fn default_features(caps: &crate::device_caps::DeviceCaps) -> crate::terrain::variants::ShaderFeatures {
+    crate::terrain::variants::ShaderFeatures::DEFAULT
+        .with(crate::terrain::variants::ShaderFeatures::PUSH_CONSTANTS, caps.push_constants())
+}
+
+type WarmPipeline = (crate::terrain::variants::ShaderFeatures, std::sync::Arc<crate::terrain::pipeline::TerrainPipeline>);
+
+/// Scene device and default terrain pipeline built ahead of time by `warmup`, adopted by
+/// the next Scene created on the preferred adapter (shared or not) instead of building
+/// its own.
+struct WarmScene {
+    key: String,
+    device: std::sync::Arc<wgpu::Device>,
+    queue: std::sync::Arc<wgpu::Queue>,
+    caps: crate::device_caps::DeviceCaps,
+    pipeline: WarmPipeline,
+}
+
+#[derive(Default)]
+struct WarmSlot {
+    scene: Option<WarmScene>,
+    /// Device keys a Scene has already been created for without a warm device: one
+    /// finishing later for them would never be adopted.
+    served: std::collections::HashSet<String>,
+}
+
+/// Only held to take or store an entry, never while a device is built.
+static WARM_SCENE: once_cell::sync::Lazy<std::sync::Mutex<WarmSlot>> = once_cell::sync::Lazy::new(Default::default);
+
+/// The slot even if a holder panicked (every update leaves it consistent).
+fn warm_slot() -> std::sync::MutexGuard<'static, WarmSlot> {
+    WARM_SCENE.lock().unwrap_or_else(|e| e.into_inner())
+}
+
+/// The warm device for `key`, if it is ready; otherwise `key` is marked served so a warm
+/// device still being built for it is dropped instead of kept for the process lifetime.
+fn adopt_warm_scene(key: &str) -> Option<WarmScene> {
+    let mut warm = warm_slot();
+    if warm.scene.as_ref().is_some_and(|w| w.key == key) {
+        return warm.scene.take();
+    }
+    warm.served.insert(key.to_string());
+    None
+}
+
+/// Build a Scene device and its default pipeline for the next Scene to adopt (called once,
+/// by the warmup thread). Built without holding `WARM_SCENE`; a Scene created meanwhile
+/// gets its own device and the warm one is discarded.
+pub(crate) fn warm_scene_device() -> Result<(), String> {
+    let instance = wgpu::Instance::new(wgpu::InstanceDescriptor { backends: wgpu::Backends::all(), ..Default::default() });
+    let adapter = crate::adapter_rank::preferred_adapter(&instance).ok_or("No suitable GPU adapter")?;
+    let key = device_key(&adapter);
+    let (device, queue, caps) = crate::device_caps::request_device(&adapter, "scene-device").map_err(|e| e.to_string())?;
+    let features = default_features(&caps);
+    let pipeline = std::sync::Arc::new(crate::terrain::pipeline::TerrainPipeline::create_with(&device, TEXTURE_FORMAT, features));
+    let mut warm = warm_slot();
+    if !warm.served.contains(&key) {
+        warm.scene = Some(WarmScene {
+            key,
+            device: std::sync::Arc::new(device),
+            queue: std::sync::Arc::new(queue),
+            caps,
+            pipeline: (features, pipeline),
+        });
+    }
+    Ok(())
+}
+
+/// Vertex buffer, index buffer and index count of the `grid × grid` plane over [-1.5, 1.5]²
+/// (the Scene mesh, and the coarse preview mesh of `render_progressive`).
+fn xyuv_grid(device: &wgpu::Device, grid: u32) -> (wgpu::Buffer, wgpu::Buffer, u32) {
+    // Same as terrain::build_grid_xyuv (private) — inline minimal copy to avoid re-export churn.
+    // Minimal grid that matches T3.1/T3.3 vertex layout: interleaved [x, z, u, v] (Float32x4) => 16-byte stride.
+    let n = grid.max(2) as usize;
+    let (w, h) = (n, n);
+    let scale = 1.5f32;
+    let step_x = (2.0 * scale) / (w as f32 - 1.0);
+    let step_z = (2.0 * scale) / (h as f32 - 1.0);
+    let mut verts = Vec::<f32>::with_capacity(w*h*4);
+    for j in 0..h {
+        for i in 0..w {
+            let x = -scale + i as f32 * step_x;
+            let z = -scale + j as f32 * step_z;
+            let u = i as f32 / (w as f32 - 1.0);
+            let v = j as f32 / (h as f32 - 1.0);
+            verts.extend_from_slice(&[x, z, u, v]);
+        }
+    }
+    let mut idx = Vec::<u32>::with_capacity((w-1)*(h-1)*6);
+    for j in 0..h-1 {
+        for i in 0..w-1 {
+            let a = (j*w + i) as u32;
+            let b = (j*w + i + 1) as u32;
+            let c = ((j+1)*w + i) as u32;
+            let d = ((j+1)*w + i + 1) as u32;
+            idx.extend_from_slice(&[a,c,b, b,c,d]);
+        }
+    }
+    let vbuf = device.create_buffer_init(&wgpu::util::BufferInitDescriptor{ label: Some("scene-xyuv-vbuf"), contents: bytemuck::cast_slice(&verts), usage: wgpu::BufferUsages::VERTEX });
+    let ibuf = device.create_buffer_init(&wgpu::util::BufferInitDescriptor{ label: Some("scene-xyuv-ibuf"), contents: bytemuck::cast_slice(&idx), usage: wgpu::BufferUsages::INDEX });
+    (vbuf, ibuf, idx.len() as u32)
+}
+
+/// One output image: a view matrix plus the world offsets of the draws composited into it.
+struct FrameDraws {
+    view: glam::Mat4,
+    offsets: Vec<[f32; 3]>,
+    /// Height-sequence position (`_pad_tail.w` / `DrawPush.offset.w`); unused otherwise.
+    layer: f32,
+}
+
+impl FrameDraws {
+    /// One draw at the origin.
+    fn single(view: glam::Mat4) -> Self {
+        Self { view, offsets: vec![[0.0; 3]], layer: 0.0 }
+    }
+}
+
+impl Scene {
+    /// `Scene(...)` on the preferred adapter. Errors are plain strings, so the `vf-render`
+    /// CLI, which never starts an interpreter, can report them.
+    pub(crate) fn open(width: u32, height: u32, grid: Option<u32>, colormap: Option<String>, shared: bool) -> Result<Self, String> {
+        let grid = grid.unwrap_or(128).max(2);
+        let instance = wgpu::Instance::new(wgpu::InstanceDescriptor { backends: wgpu::Backends::all(), ..Default::default() });
+        let adapter = crate::adapter_rank::preferred_adapter(&instance).ok_or("No suitable GPU adapter")?;
+        Self::with_adapter(&adapter, width, height, grid, colormap, shared)
+    }
+
+    /// `set_camera_look_at` without the GIL-bound error type (also used by the `vf-render` CLI).
+    pub(crate) fn apply_camera_look_at(&self, eye: (f32, f32, f32), target: (f32, f32, f32), up: (f32, f32, f32),
+                                       fovy_deg: f32, znear: f32, zfar: f32) -> Result<(), String> {
+        use crate::camera;
+        let aspect = self.width as f32 / self.height as f32;
+        let eye_v = glam::Vec3::new(eye.0,eye.1,eye.2);
+        let target_v = glam::Vec3::new(target.0,target.1,target.2);
+        let up_v = glam::Vec3::new(up.0,up.1,up.2);
+        camera::check_camera_params(eye_v, target_v, up_v, fovy_deg, znear, zfar)?;
+        // The UBO itself is written per render call (per slot), not here.
+        let mut st = self.state.write().unwrap();
+        st.scene.view = glam::Mat4::look_at_rh(eye_v, target_v, up_v);
+        st.scene.proj = camera::perspective_wgpu(fovy_deg.to_radians(), aspect, znear, zfar);
+        st.last_uniforms = st.scene.globals.to_uniforms(st.scene.view, st.scene.proj);
+        self.camera_epoch.fetch_add(1, std::sync::atomic::Ordering::Release);
+        Ok(())
+    }
+
+    /// `set_sun` without the GIL-bound error type.
+    pub(crate) fn apply_sun(&self, elevation_deg: f32, azimuth_deg: f32) -> Result<(), String> {
+        if !elevation_deg.is_finite() || !azimuth_deg.is_finite() {
+            return Err("angles must be finite".into());
+        }
+        let (el, az) = (elevation_deg.to_radians(), azimuth_deg.to_radians());
+        let dir = glam::Vec3::new(el.cos() * az.cos(), el.sin(), el.cos() * az.sin()).normalize_or_zero();
+        let mut st = self.state.write().unwrap();
+        st.scene.globals.sun_dir = dir;
+        st.last_uniforms = st.scene.globals.to_uniforms(st.scene.view, st.scene.proj);
+        Ok(())
+    }
+
+    /// `set_exposure` without the GIL-bound error type.
+    pub(crate) fn apply_exposure(&self, exposure: f32) -> Result<(), String> {
+        if !exposure.is_finite() || exposure <= 0.0 {
+            return Err("exposure must be > 0".into());
+        }
+        let mut st = self.state.write().unwrap();
+        st.scene.globals.exposure = exposure;
+        st.last_uniforms = st.scene.globals.to_uniforms(st.scene.view, st.scene.proj);
+        Ok(())
+    }
+
+    /// Encode `params` into a new height texture and bind it; the caller has checked the size
+    /// against the device limits.
+    pub(crate) fn write_procedural_height(&self, params: &crate::terrain::procgen::ProcParams) {
+        use crate::terrain::procgen;
+        let [width, height] = params.size;
+        let mut st = self.state.write().unwrap();
+        if st.procgen.is_none() {
+            st.procgen = Some(procgen::ProcgenGpu::new(&self.device));
+        }
+        let tex = procgen::create_height_target(&self.device, width, height);
+        let view = tex.create_view(&Default::default());
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor{ label: Some("scene-procgen") });
+        st.procgen.as_ref().unwrap().encode(&self.device, &mut encoder, &view, params);
+        self.queue.submit(Some(encoder.finish()));
+
+        st.height_view = Some(view);
+        st.height_size = (width, height);
+        st.erosion = None;
+        self.drop_water(&mut st);
+    }
+
+    /// `set_features` without the GIL-bound error type (also used by the `vf-render` CLI).
+    pub(crate) fn apply_features<S: AsRef<str>>(&self, features: &[S]) -> Result<(), String> {
+        use crate::terrain::variants::ShaderFeatures;
+        let features = ShaderFeatures::from_names(features)?
+            .without(ShaderFeatures::DATASET)
+            .without(ShaderFeatures::TEMPORAL)
+            .without(ShaderFeatures::HEIGHT_SEQ)
+            .without(ShaderFeatures::DIFF)
+            .with(ShaderFeatures::PUSH_CONSTANTS, self.caps.push_constants());
+        let mut st = self.state.write().unwrap();
+        let features = features
+            .with(ShaderFeatures::WATER, st.water.is_some())
+            .with(ShaderFeatures::SCALAR, st.scalar.is_some())
+            .resolve();
+        // A bound difference stays bound across feature changes; `clear_diff` returns to them.
+        let features = match st.diff.as_mut() {
+            Some(d) => d.rebase(features),
+            None => features,
         };
+        if features == st.features {
+            return Ok(());
+        }
+        // Slot group-0 bind groups are rebuilt lazily when a slot sees the new mask.
+        self.rebind(&mut st, features);
+        Ok(())
+    }
+
+    /// Build a Scene on a specific adapter (used by `open` and the adapter benchmark).
+    pub(crate) fn with_adapter(adapter: &wgpu::Adapter, width: u32, height: u32, grid: u32, colormap: Option<String>, shared: bool) -> Result<Self, String> {
+        let (device, queue, caps, warm) = scene_device(adapter, shared).map_err(|e| e.to_string())?;
 
-        // Globals/UBO
+        // Pipeline (default permutation; `set_features` switches via the cache)
+        let features = default_features(&caps);
+        let mut pipelines = crate::terrain::variants::PipelineCache::new();
+        if let Some((warm_features, pipeline)) = warm {
+            pipelines.insert(TEXTURE_FORMAT, warm_features, pipeline);
+        }
+        let tp = pipelines.get_or_create(&device, TEXTURE_FORMAT, features);
+
+        // Mesh
+        let (vbuf, ibuf, nidx) = xyuv_grid(&device, grid);
+
+        // Globals (the UBOs and colour targets live in per-call render slots)
         let mut scene = SceneGlobals::default();
         // set correct aspect
         scene.proj = crate::camera::perspective_wgpu(45f32.to_radians(), width as f32 / height as f32, 0.1, 100.0);
         let uniforms = scene.globals.to_uniforms(scene.view, scene.proj);
-        let ubo = device.create_buffer_init(&wgpu::util::BufferInitDescriptor{
-            label: Some("scene-ubo"), contents: bytemuck::cast_slice(&[uniforms]),
-            usage: wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST,
-        });
 
         // LUT (+ friendly validation against SUPPORTED)
         let cmap_name = colormap.as_deref().unwrap_or("viridis");
         if !crate::colormap::SUPPORTED.contains(&cmap_name) {
-            return Err(pyo3::exceptions::PyRuntimeError::new_err(
-                format!("Unknown colormap '{}'. Supported: {}", cmap_name, crate::colormap::SUPPORTED.join(", "))
-            ));
+            return Err(format!("Unknown colormap '{}'. Supported: {}", cmap_name, crate::colormap::SUPPORTED.join(", ")));
         }
-        let which = crate::colormap::map_name_to_type(cmap_name)
-            .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        let which = crate::colormap::map_name_to_type(cmap_name).map_err(|e| e.to_string())?;
         let (lut, lut_format) = crate::terrain::ColormapLUT::new(&device, &queue, &adapter, which)
-            .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+            .map_err(|e| e.to_string())?;
 
         // Dummy height (non-trivial): upload a tiny 2×2 gradient with proper 256-byte row padding.
         // This guarantees the first frame has variance, so the PNG won't compress to a tiny file.
@@ -188,50 +1311,76 @@ impl Scene {
             (view, samp)
         };
 
-        // Bind groups (cached)
-        let bg0_globals = tp.make_bg_globals(&device, &ubo);
+        // Bind groups (cached; group 0 is per render slot)
         let bg1_height  = tp.make_bg_height(&device, &hview, &hsamp);
         let bg2_lut     = tp.make_bg_lut(&device, &lut.view, &lut.sampler);
 
-        Ok(Self{
+        let state = SceneState {
+            tp, pipelines, features, bg1_height, bg2_lut,
+            height_view: Some(hview), height_sampler: Some(hsamp), height_size: (2, 2),
+            procgen: None,
+            class_view: dataset::class_texture(&device, &queue, 1, 1, &[0]),
+            diff: None,
+            water: None,
+            erosion: None,
+            scalar: None,
+            scene, last_uniforms: uniforms,
+        };
+        let scn = Self{
             width, height, grid,
-            device, queue,
-            tp, bg0_globals, bg1_height, bg2_lut,
+            device, queue, caps,
             vbuf, ibuf, nidx,
-            ubo, colormap: lut, lut_format,
-            color, color_view,
-            height_view: Some(hview), height_sampler: Some(hsamp),
-            scene, last_uniforms: uniforms
-        })
+            colormap: lut, lut_format,
+            state: std::sync::RwLock::new(state),
+            slots: std::sync::Mutex::new(Vec::new()),
+            slots_created: std::sync::atomic::AtomicUsize::new(0),
+            sequence_stats: Default::default(),
+            generation: std::sync::atomic::AtomicU64::new(0),
+            temporal: std::sync::Mutex::new(None),
+            projected: std::sync::Mutex::new(None),
+            camera_epoch: std::sync::atomic::AtomicU64::new(0),
+            progressive: Default::default(),
+            budget: std::sync::Mutex::new(None),
+            height_ring: std::sync::Mutex::new(None),
+        };
+        // One slot up front: the single-threaded case never allocates on the render path.
+        let slot = {
+            let st = scn.state.read().unwrap();
+            scn.new_slot(&st, &st.tp)
+        };
+        scn.release_slot(slot);
+        Ok(scn)
     }
 
-    #[pyo3(text_signature="($self, eye, target, up, fovy_deg, znear, zfar)")]
-    pub fn set_camera_look_at(&mut self,
-        eye:(f32,f32,f32), target:(f32,f32,f32), up:(f32,f32,f32),
-        fovy_deg:f32, znear:f32, zfar:f32) -> PyResult<()> {
-        use crate::camera;
-        let aspect = self.width as f32 / self.height as f32;
-        let eye_v = glam::Vec3::new(eye.0,eye.1,eye.2);
-        let target_v = glam::Vec3::new(target.0,target.1,target.2);
-        let up_v = glam::Vec3::new(up.0,up.1,up.2);
-        camera::validate_camera_params(eye_v, target_v, up_v, fovy_deg, znear, zfar)?;
-        self.scene.view = glam::Mat4::look_at_rh(eye_v, target_v, up_v);
-        self.scene.proj = camera::perspective_wgpu(fovy_deg.to_radians(), aspect, znear, zfar);
-        let uniforms = self.scene.globals.to_uniforms(self.scene.view, self.scene.proj);
-        self.queue.write_buffer(&self.ubo, 0, bytemuck::bytes_of(&uniforms));
-        self.last_uniforms = uniforms;
+    /// Upload a C-order `w × h` float32 DEM into a new height texture (shared by the Python
+    /// setter and the batch renderer).
+    pub(crate) fn upload_height(&self, w: u32, h: u32, data: &[f32]) -> Result<(), String> {
+        if w == 0 || h == 0 || data.len() != (w * h) as usize {
+            return Err("height must be a non-empty float32[H,W]".to_string());
+        }
+        let tex = self.r32f_texture("scene-height-r32f", w, h, data)?;
+        let view = tex.create_view(&Default::default());
+        let samp = self.device.create_sampler(&wgpu::SamplerDescriptor{
+            label: Some("scene-height-sampler"),
+            address_mode_u: wgpu::AddressMode::ClampToEdge, address_mode_v: wgpu::AddressMode::ClampToEdge, address_mode_w: wgpu::AddressMode::ClampToEdge,
+            mag_filter: wgpu::FilterMode::Nearest, min_filter: wgpu::FilterMode::Nearest, mipmap_filter: wgpu::FilterMode::Nearest,
+            ..Default::default()
+        });
+        let mut st = self.state.write().unwrap();
+        st.height_view = Some(view);
+        st.height_sampler = Some(samp);
+        st.height_size = (w, h);
+        st.erosion = None;
+        // Rebuild only BG1 using cached layout (and drop a flood extent of the old DEM)
+        self.drop_water(&mut st);
         Ok(())
     }
 
-    #[pyo3(text_signature="($self, height_r32f)")]
-    pub fn set_height_from_r32f(&mut self, height_r32f: &pyo3::types::PyAny) -> PyResult<()> {
-        // Accept numpy array float32 (H,W)
-        let arr: numpy::PyReadonlyArray2<f32> = height_r32f.extract()?;
-        let (h, w) = (arr.shape()[0] as u32, arr.shape()[1] as u32);
-        let data = arr.as_slice().map_err(|_| pyo3::exceptions::PyRuntimeError::new_err("height must be C-contiguous float32[H,W]"))?;
-
+    /// Sampled `R32Float` texture holding a C-order `w × h` float32 grid.
+    pub(crate) fn r32f_texture(&self, label: &str, w: u32, h: u32, data: &[f32]) -> Result<wgpu::Texture, String> {
+        self.caps.check_texture_2d(w, h)?;
         let tex = self.device.create_texture(&wgpu::TextureDescriptor{
-            label: Some("scene-height-r32f"),
+            label: Some(label),
             size: wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
             mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
             format: wgpu::TextureFormat::R32Float,
@@ -259,91 +1408,377 @@ impl Scene {
             },
             wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 }
         );
-        let view = tex.create_view(&Default::default());
-        let samp = self.device.create_sampler(&wgpu::SamplerDescriptor{
-            label: Some("scene-height-sampler"),
-            address_mode_u: wgpu::AddressMode::ClampToEdge, address_mode_v: wgpu::AddressMode::ClampToEdge, address_mode_w: wgpu::AddressMode::ClampToEdge,
-            mag_filter: wgpu::FilterMode::Nearest, min_filter: wgpu::FilterMode::Nearest, mipmap_filter: wgpu::FilterMode::Nearest,
-            ..Default::default()
+        Ok(tex)
+    }
+
+    /// Switch to the `features` permutation and rebuild groups 1 and 2 for it.
+    fn rebind(&self, st: &mut SceneState, features: crate::terrain::variants::ShaderFeatures) {
+        st.tp = st.pipelines.get_or_create(&self.device, TEXTURE_FORMAT, features);
+        st.features = st.tp.features;
+        self.rebind_groups(st);
+    }
+
+    /// Groups 1 and 2 for the bound height source: the two epochs and diverging LUT (DIFF),
+    /// or the Scene height and colormap; plus the flood depth texture under WATER and the
+    /// colormap source under SCALAR.
+    fn rebind_groups(&self, st: &mut SceneState) {
+        let (bg1, bg2) = self.height_lut_groups(st, &st.tp);
+        st.bg1_height = bg1;
+        st.bg2_lut = bg2;
+        self.touch_content();
+    }
+
+    /// Invalidate frame history after a change to the rendered content.
+    pub(super) fn touch_content(&self) {
+        self.generation.fetch_add(1, std::sync::atomic::Ordering::Release);
+    }
+
+    /// Groups 1 and 2 of `st` built for `tp`'s layouts (the Scene permutation, or one derived
+    /// from it such as the dataset pass).
+    fn height_lut_groups(&self, st: &SceneState, tp: &crate::terrain::pipeline::TerrainPipeline) -> (wgpu::BindGroup, wgpu::BindGroup) {
+        use crate::terrain::variants::ShaderFeatures;
+        let samp = st.height_sampler.as_ref().unwrap();
+        let bg1 = match &st.diff {
+            Some(d) if tp.features.contains(ShaderFeatures::DIFF) => d.make_bg_height(&self.device, tp, samp),
+            _ => tp.make_bg_height(&self.device, st.height_view.as_ref().unwrap(), samp),
+        };
+        (bg1, self.lut_group(st, tp))
+    }
+
+    /// Group 2 of `st` built for `tp`'s layout (colormap, or the diverging LUT under DIFF,
+    /// plus the overlays `tp` enables).
+    fn lut_group(&self, st: &SceneState, tp: &crate::terrain::pipeline::TerrainPipeline) -> wgpu::BindGroup {
+        use crate::terrain::variants::ShaderFeatures;
+        let lut = match &st.diff {
+            Some(d) if tp.features.contains(ShaderFeatures::DIFF) => d.lut_view(),
+            _ => &self.colormap.view,
+        };
+        let water = st.water.as_ref().map(|w| w.view());
+        tp.make_bg_lut_overlays(&self.device, lut, &self.colormap.sampler, water, st.scalar.as_ref())
+    }
+
+    /// Frames and output shape for optional (N, 4, 4) views (`None`: the Scene camera).
+    fn frames_for(&self, views: Option<&numpy::PyReadonlyArray3<'_, f32>>) -> PyResult<(Vec<FrameDraws>, Vec<usize>)> {
+        let (h, w) = (self.height as usize, self.width as usize);
+        Ok(match views {
+            Some(v) => {
+                let frames: Vec<FrameDraws> = views_from_numpy(v)?
+                    .into_iter()
+                    .map(FrameDraws::single)
+                    .collect();
+                let n = frames.len();
+                (frames, vec![n, h, w, 4])
+            }
+            None => {
+                let view = self.state.read().unwrap().scene.view;
+                (vec![FrameDraws::single(view)], vec![h, w, 4])
+            }
+        })
+    }
+
+    pub(crate) fn render_pixels(&self) -> Result<Vec<u8>, String> {
+        if let Some(pixels) = self.render_temporal()? {
+            return Ok(pixels);
+        }
+        if let Some(pixels) = self.render_projected()? {
+            return Ok(pixels);
+        }
+        let frame = FrameDraws::single(self.state.read().unwrap().scene.view);
+        self.render_frames(&[frame])
+    }
+
+    /// A new slot whose group 0 is made for `tp`.
+    fn new_slot(&self, st: &SceneState, tp: &crate::terrain::pipeline::TerrainPipeline) -> RenderSlot {
+        let ubo = self.device.create_buffer_init(&wgpu::util::BufferInitDescriptor{
+            label: Some("scene-ubo"), contents: bytemuck::bytes_of(&st.last_uniforms),
+            usage: wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST,
         });
-        self.height_view = Some(view);
-        self.height_sampler = Some(samp);
+        let color = self.device.create_texture(&wgpu::TextureDescriptor{
+            label: Some("scene-color"),
+            size: wgpu::Extent3d{ width: self.width, height: self.height, depth_or_array_layers: 1 },
+            mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
+            format: TEXTURE_FORMAT, usage: wgpu::TextureUsages::RENDER_ATTACHMENT | wgpu::TextureUsages::COPY_SRC, view_formats: &[],
+        });
+        let color_view = color.create_view(&Default::default());
+        let bg0_globals = tp.make_bg_globals(&self.device, &ubo);
+        self.slots_created.fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+        RenderSlot { ubo, bg0_globals, bg0_features: tp.features, color, color_view, readback: None, dataset: None }
+    }
 
-        // Rebuild only BG1 using cached layout
-        let bg1 = self.tp.make_bg_height(&self.device, self.height_view.as_ref().unwrap(), self.height_sampler.as_ref().unwrap());
-        self.bg1_height = bg1;
-        Ok(())
+    /// Borrow a free slot (or create one) and make its group-0 bind group match `tp`.
+    fn acquire_slot(&self, st: &SceneState, tp: &crate::terrain::pipeline::TerrainPipeline) -> RenderSlot {
+        let free = self.slots.lock().unwrap().pop();
+        match free {
+            Some(mut slot) => {
+                if slot.bg0_features != tp.features {
+                    slot.bg0_globals = tp.make_bg_globals(&self.device, &slot.ubo);
+                    slot.bg0_features = tp.features;
+                }
+                slot
+            }
+            None => self.new_slot(st, tp),
+        }
     }
 
-    #[pyo3(text_signature="($self, path)")]
-    pub fn render_png(&mut self, path: String) -> PyResult<()> {
-        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor{ label: Some("scene-encoder") });
-        {
-            let mut rp = encoder.begin_render_pass(&wgpu::RenderPassDescriptor{
-                label: Some("scene-rp"),
-                color_attachments: &[Some(wgpu::RenderPassColorAttachment{
-                    view: &self.color_view, resolve_target: None,
-                    ops: wgpu::Operations{ load: wgpu::LoadOp::Clear(wgpu::Color{ r:0.02, g:0.02, b:0.03, a:1.0 }), store: wgpu::StoreOp::Store }
-                })],
-                depth_stencil_attachment: None, ..Default::default()
-            });
-            rp.set_pipeline(&self.tp.pipeline);
-            rp.set_bind_group(0, &self.bg0_globals, &[]);
-            rp.set_bind_group(1, &self.bg1_height, &[]);
-            rp.set_bind_group(2, &self.bg2_lut, &[]);
-            rp.set_vertex_buffer(0, self.vbuf.slice(..));
-            rp.set_index_buffer(self.ibuf.slice(..), wgpu::IndexFormat::Uint32);
+    fn release_slot(&self, slot: RenderSlot) {
+        self.slots.lock().unwrap().push(slot);
+    }
+
+    /// Record one render pass of `draw` (pipeline, groups 1 and 2) into the slot's colour
+    /// target. With push constants, each entry of `pushes` is one draw; on the UBO path
+    /// `pushes` is empty and the slot UBO is used.
+    fn encode_draws(&self, draw: SlotDraw<'_>, slot: &RenderSlot, encoder: &mut wgpu::CommandEncoder, clear: bool, pushes: &[crate::terrain::DrawPush]) {
+        let (tp, bg1, bg2) = draw;
+        let load = if clear {
+            wgpu::LoadOp::Clear(wgpu::Color{ r:0.02, g:0.02, b:0.03, a:1.0 })
+        } else {
+            wgpu::LoadOp::Load
+        };
+        let mut rp = encoder.begin_render_pass(&wgpu::RenderPassDescriptor{
+            label: Some("scene-rp"),
+            color_attachments: &[Some(wgpu::RenderPassColorAttachment{
+                view: &slot.color_view, resolve_target: None,
+                ops: wgpu::Operations{ load, store: wgpu::StoreOp::Store }
+            })],
+            depth_stencil_attachment: None, ..Default::default()
+        });
+        rp.set_pipeline(&tp.pipeline);
+        rp.set_bind_group(0, &slot.bg0_globals, &[]);
+        rp.set_bind_group(1, bg1, &[]);
+        rp.set_bind_group(2, bg2, &[]);
+        rp.set_vertex_buffer(0, self.vbuf.slice(..));
+        rp.set_index_buffer(self.ibuf.slice(..), wgpu::IndexFormat::Uint32);
+        if pushes.is_empty() {
             rp.draw_indexed(0..self.nidx, 0, 0..1);
         }
-        self.queue.submit(Some(encoder.finish()));
+        for p in pushes {
+            rp.set_push_constants(wgpu::ShaderStages::VERTEX_FRAGMENT, 0, bytemuck::bytes_of(p));
+            rp.draw_indexed(0..self.nidx, 0, 0..1);
+        }
+    }
+
+    /// Render `frames` and return their RGBA8 pixels back to back.
+    fn render_frames(&self, frames: &[FrameDraws]) -> Result<Vec<u8>, String> {
+        let pending = self.submit_frames(frames);
+        self.read_frames(pending)
+    }
 
-        // Readback -> PNG (same as TerrainSpike)
+    /// Encode and submit `frames` into a borrowed render slot and request the readback map.
+    fn submit_frames(&self, frames: &[FrameDraws]) -> PendingFrames {
+        self.submit_frames_with(frames, None)
+    }
+
+    /// `submit_frames` drawing with `draw` instead of the Scene pipeline and groups.
+    fn submit_frames_with(&self, frames: &[FrameDraws], draw: Option<SlotDraw<'_>>) -> PendingFrames {
+        let mut encoded = self.encode_frames_with(frames, draw);
+        let submission = match encoded.commands.take() {
+            Some(cb) => Some(self.queue.submit(Some(cb))),
+            None => encoded.submission.take(),
+        };
+        self.map_frames(encoded, submission)
+    }
+
+    /// Encode `frames` into a borrowed render slot.
+    ///
+    /// Push-constant path: every frame and draw goes into one command buffer, returned
+    /// unsubmitted so callers (the scheduler) can submit it together with other Scenes' work;
+    /// there are no UBO writes and bind groups are set once per pass. UBO fallback: each draw
+    /// needs its own `write_buffer` + submit, because queue writes are only ordered between
+    /// submissions, so this path submits as it goes and returns no command buffer.
+    ///
+    /// Thread safety: the state read lock is held only while encoding; the render slot is
+    /// private to this call until `read_frames` returns it to the pool.
+    fn encode_frames(&self, frames: &[FrameDraws]) -> EncodedFrames {
+        self.encode_frames_with(frames, None)
+    }
+
+    /// `encode_frames` with `draw` (a call-local permutation and its groups 1 and 2) in
+    /// place of the Scene's; `None` draws with the Scene's.
+    fn encode_frames_with(&self, frames: &[FrameDraws], draw: Option<SlotDraw<'_>>) -> EncodedFrames {
         let bpp = 4u32;
         let unpadded = self.width * bpp;
         let align = wgpu::COPY_BYTES_PER_ROW_ALIGNMENT;
         let padded = ((unpadded + align - 1) / align) * align;
-        let size = (padded * self.height) as wgpu::BufferAddress;
-        let readback = self.device.create_buffer(&wgpu::BufferDescriptor{
-            label: Some("scene-readback"), size, usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ, mapped_at_creation: false
+        let frame_bytes = (padded * self.height) as wgpu::BufferAddress;
+        let total = frame_bytes * frames.len() as u64;
+
+        let st = self.state.read().unwrap();
+        let draw = draw.unwrap_or((&*st.tp, &st.bg1_height, &st.bg2_lut));
+        let mut slot = self.acquire_slot(&st, draw.0);
+        if slot.readback.as_ref().map_or(true, |b| b.size() < total) {
+            slot.readback = Some(self.device.create_buffer(&wgpu::BufferDescriptor{
+                label: Some("scene-readback"), size: total,
+                usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ, mapped_at_creation: false
+            }));
+        }
+        let readback = slot.readback.as_ref().unwrap();
+        let copy_frame = |enc: &mut wgpu::CommandEncoder, i: usize| {
+            enc.copy_texture_to_buffer(
+                wgpu::ImageCopyTexture{ texture:&slot.color, mip_level:0, origin: wgpu::Origin3d::ZERO, aspect: wgpu::TextureAspect::All },
+                wgpu::ImageCopyBuffer{ buffer:readback, layout: wgpu::ImageDataLayout{
+                    offset: frame_bytes * i as u64,
+                    bytes_per_row: Some(std::num::NonZeroU32::new(padded).unwrap().into()),
+                    rows_per_image: Some(std::num::NonZeroU32::new(self.height).unwrap().into())
+                }},
+                wgpu::Extent3d{ width:self.width, height:self.height, depth_or_array_layers:1 }
+            );
+        };
+
+        let (commands, submission) = if self.caps.push_constants() {
+            let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor{ label: Some("scene-encoder") });
+            for (i, f) in frames.iter().enumerate() {
+                let mut u = st.last_uniforms;
+                u.view = f.view.to_cols_array_2d();
+                let pushes: Vec<_> = f.offsets.iter().map(|o| {
+                    let mut p = crate::terrain::DrawPush::from_uniforms(&u, *o);
+                    p.offset[3] = f.layer;
+                    p
+                }).collect();
+                self.encode_draws(draw, &slot, &mut encoder, true, &pushes);
+                copy_frame(&mut encoder, i);
+            }
+            (Some(encoder.finish()), None)
+        } else {
+            let mut last = None;
+            for (i, f) in frames.iter().enumerate() {
+                for (j, o) in f.offsets.iter().enumerate() {
+                    let mut u = st.last_uniforms;
+                    u.view = f.view.to_cols_array_2d();
+                    u._pad_tail = [o[0], o[1], o[2], f.layer];
+                    self.queue.write_buffer(&slot.ubo, 0, bytemuck::bytes_of(&u));
+                    let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor{ label: Some("scene-encoder") });
+                    self.encode_draws(draw, &slot, &mut encoder, j == 0, &[]);
+                    if j + 1 == f.offsets.len() {
+                        copy_frame(&mut encoder, i);
+                    }
+                    last = Some(self.queue.submit(Some(encoder.finish())));
+                }
+            }
+            (None, last)
+        };
+        drop(st);
+        EncodedFrames { slot, count: frames.len(), frame_bytes, padded, commands, submission }
+    }
+
+    /// Request the readback map of encoded frames once their work is submitted.
+    fn map_frames(&self, encoded: EncodedFrames, submission: Option<wgpu::SubmissionIndex>) -> PendingFrames {
+        let EncodedFrames { slot, count, frame_bytes, padded, .. } = encoded;
+        let total = frame_bytes * count as u64;
+        let mapped = MapState::default();
+        let result = mapped.clone();
+        slot.readback.as_ref().unwrap().slice(..total).map_async(wgpu::MapMode::Read, move |r| {
+            let _ = result.set(r);
         });
-        let mut enc = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor{ label: Some("copy-encoder") });
-        enc.copy_texture_to_buffer(
-            wgpu::ImageCopyTexture{ texture:&self.color, mip_level:0, origin: wgpu::Origin3d::ZERO, aspect: wgpu::TextureAspect::All },
-            wgpu::ImageCopyBuffer{ buffer:&readback, layout: wgpu::ImageDataLayout{
-                offset:0, bytes_per_row: Some(std::num::NonZeroU32::new(padded).unwrap().into()), rows_per_image: Some(std::num::NonZeroU32::new(self.height).unwrap().into())
-            }},
-            wgpu::Extent3d{ width:self.width, height:self.height, depth_or_array_layers:1 }
-        );
-        self.queue.submit(Some(enc.finish()));
-
-        let slice = readback.slice(..);
-        slice.map_async(wgpu::MapMode::Read, |_|{});
-        self.device.poll(wgpu::Maintain::Wait);
-        let data = slice.get_mapped_range();
-        let mut pixels = Vec::with_capacity((unpadded * self.height) as usize);
-        for row in 0..self.height {
-            let s = (row * padded) as usize;
-            let e = s + unpadded as usize;
-            pixels.extend_from_slice(&data[s..e]);
+        PendingFrames { slot, count, frame_bytes, padded, submission, mapped }
+    }
+
+    /// Wait for `pending` (its own submission only), copy the pixels out and recycle the slot.
+    fn read_frames(&self, pending: PendingFrames) -> Result<Vec<u8>, String> {
+        let mut pixels = vec![0u8; self.frame_len() * pending.count];
+        self.read_frames_into(pending, &mut pixels)?;
+        Ok(pixels)
+    }
+
+    /// `read_frames` into caller memory (`out.len() == count * H * W * 4`): rows are unpadded
+    /// straight from the mapped staging buffer, with no intermediate allocation. A map that
+    /// fails, or does not finish within `READBACK_TIMEOUT`, is an error and its slot leaves
+    /// the pool.
+    fn read_frames_into(&self, mut pending: PendingFrames, out: &mut [u8]) -> Result<(), String> {
+        if let Err(e) = self.wait_mapped(&pending.mapped, pending.submission.take(), "frame readback") {
+            self.discard_frames(pending);
+            return Err(e);
+        }
+        let unpadded = (self.width * 4) as usize;
+        assert_eq!(out.len(), self.frame_len() * pending.count, "readback destination size");
+        let total = pending.frame_bytes * pending.count as u64;
+        let readback = pending.slot.readback.as_ref().unwrap();
+        let data = readback.slice(..total).get_mapped_range();
+        for (i, dst) in out.chunks_exact_mut(self.frame_len()).enumerate() {
+            let base = pending.frame_bytes as usize * i;
+            for (row, dst_row) in dst.chunks_exact_mut(unpadded).enumerate() {
+                let s = base + row * pending.padded as usize;
+                dst_row.copy_from_slice(&data[s..s + unpadded]);
+            }
         }
         drop(data);
         readback.unmap();
-        let img = image::RgbaImage::from_raw(self.width, self.height, pixels)
-            .ok_or_else(|| pyo3::exceptions::PyRuntimeError::new_err("Invalid image buffer"))?;
-        img.save(path).map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        self.release_slot(pending.slot);
         Ok(())
     }
 
-    #[pyo3(text_signature="($self)")]
-    pub fn debug_uniforms_f32<'py>(&self, py: pyo3::Python<'py>) -> pyo3::PyResult<pyo3::Bound<'py, numpy::PyArray1<f32>>> {
-        let bytes = bytemuck::bytes_of(&self.last_uniforms);
-        let fl: &[f32] = bytemuck::cast_slice(bytes);
-        Ok(numpy::PyArray1::from_vec_bound(py, fl.to_vec()))
+    /// Bytes of one unpadded RGBA8 frame.
+    fn frame_len(&self) -> usize {
+        self.width as usize * self.height as usize * 4
     }
+}
 
-    #[pyo3(text_signature="($self)")]
-    pub fn debug_lut_format(&self) -> &'static str {
-        self.lut_format
+impl Scene {
+    /// Drop a never-read submission; its slot leaves the pool (the map may still be pending).
+    /// Wait for `submission` and then for the `map_async` that reports into `mapped`; a map
+    /// error or a map still pending after `READBACK_TIMEOUT` is returned as `"{what} …"`.
+    pub(super) fn wait_mapped(&self, mapped: &MapState, submission: Option<wgpu::SubmissionIndex>, what: &str) -> Result<(), String> {
+        if let Some(idx) = submission {
+            self.device.poll(wgpu::Maintain::WaitForSubmissionIndex(idx));
+        }
+        let deadline = std::time::Instant::now() + READBACK_TIMEOUT;
+        loop {
+            match mapped.get() {
+                Some(Ok(())) => return Ok(()),
+                Some(Err(e)) => return Err(format!("{what} map failed: {e}")),
+                None if std::time::Instant::now() >= deadline => {
+                    return Err(format!("{what} was not mapped within {} s", READBACK_TIMEOUT.as_secs()));
+                }
+                None => {
+                    self.device.poll(wgpu::Maintain::Wait);
+                    if mapped.get().is_none() {
+                        std::thread::sleep(std::time::Duration::from_millis(1));
+                    }
+                }
+            }
+        }
+    }
+
+    fn discard_frames(&self, pending: PendingFrames) {
+        drop(pending);
+        self.slots_created.fetch_sub(1, std::sync::atomic::Ordering::Relaxed);
+    }
+}
+
+/// Pipeline and groups 1 and 2 of a slot render pass.
+type SlotDraw<'a> = (&'a crate::terrain::pipeline::TerrainPipeline, &'a wgpu::BindGroup, &'a wgpu::BindGroup);
+
+/// Frames recorded by `encode_frames`. `commands` is the unsubmitted command buffer (push
+/// constant path); on the UBO path the draws are already submitted and `submission` is set.
+pub(crate) struct EncodedFrames {
+    slot: RenderSlot,
+    count: usize,
+    frame_bytes: wgpu::BufferAddress,
+    padded: u32,
+    commands: Option<wgpu::CommandBuffer>,
+    submission: Option<wgpu::SubmissionIndex>,
+}
+
+/// Frames submitted by `submit_frames` whose readback has not been consumed yet.
+pub(crate) struct PendingFrames {
+    slot: RenderSlot,
+    count: usize,
+    frame_bytes: wgpu::BufferAddress,
+    padded: u32,
+    submission: Option<wgpu::SubmissionIndex>,
+    /// Set by the `map_async` callback (fired from whichever thread polls the device).
+    mapped: MapState,
+}
+
+/// Result of a readback's `map_async`, once its callback has run.
+pub(super) type MapState = std::sync::Arc<std::sync::OnceLock<Result<(), wgpu::BufferAsyncError>>>;
+
+/// Longest `read_frames` waits for a readback map before failing it.
+const READBACK_TIMEOUT: std::time::Duration = std::time::Duration::from_secs(30);
+
+impl PendingFrames {
+    /// True once the map finished, successfully or not.
+    pub(crate) fn is_mapped(&self) -> bool {
+        self.mapped.get().is_some()
     }
 }
 // T41-END:scene-module
\ No newline at end of file
@@ -0,0 +1,522 @@
+//! Progressive refinement (`Scene.render_progressive`).
+//!
+//! The call renders a preview at `1 / preview_scale` of the output size on a coarse grid,
+//! reads it back and returns a `ProgressiveFrame` straight away. The refinement (the Scene
+//! grid at full size with `aa`× supersampling, resolved by `terrain::resolve`) runs on one
+//! refiner thread shared by all Scenes and is delivered through the callback, `result()` or
+//! `await result_async()`. `set_camera_look_at` bumps `Scene::camera_epoch` and content
+//! changes bump `Scene::generation`: a refinement whose camera or content is stale is
+//! skipped before it is encoded, and dropped before delivery if either changed while it
+//! rendered. Both stages render the camera of the call. A refinement that panics fails its
+//! frame (`result()` and `result_async()` raise) and the refiner moves on to the next.
+//!
+//! Preview and refinement keep their own targets and UBOs (cached per Scene), so neither
+//! competes with the render-slot pool. `stats()` reports the preview latency (call to host
+//! pixels) apart from the refinement's queueing delay and render time.
+
+use std::collections::VecDeque;
+use std::panic::{catch_unwind, AssertUnwindSafe};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Condvar, Mutex};
+use std::time::{Duration, Instant};
+
+use once_cell::sync::{Lazy, OnceCell};
+use pyo3::prelude::*;
+
+use crate::terrain::pipeline::TerrainPipeline;
+use crate::terrain::resolve::{ResolveParams, SupersampleResolve};
+use crate::terrain::variants::ShaderFeatures;
+use crate::terrain::TerrainUniforms;
+
+use super::frames::{self, panic_message};
+use super::{Scene, TEXTURE_FORMAT};
+
+/// Colour target with its own UBO and readback buffer.
+pub(super) struct PassTarget {
+    pub(super) width: u32,
+    pub(super) height: u32,
+    color: wgpu::Texture,
+    view: wgpu::TextureView,
+    ubo: wgpu::Buffer,
+    bg0: wgpu::BindGroup,
+    bg0_features: ShaderFeatures,
+    pub(super) readback: wgpu::Buffer,
+}
+
+/// Preview mesh (`grid`²) and target.
+struct Preview {
+    grid: u32,
+    mesh: (wgpu::Buffer, wgpu::Buffer, u32),
+    target: PassTarget,
+}
+
+/// Supersampled target and, for `aa > 1`, the resolve into an output-size target.
+pub(super) struct Refine {
+    aa: u32,
+    target: PassTarget,
+    resolve: Option<Resolve>,
+}
+
+struct Resolve {
+    pass: SupersampleResolve,
+    bg: wgpu::BindGroup,
+    output: PassTarget,
+}
+
+impl Refine {
+    /// Target holding the output-size frame after `Scene::encode_supersampled`.
+    pub(super) fn output(&self) -> &PassTarget {
+        self.resolve.as_ref().map_or(&self.target, |r| &r.output)
+    }
+}
+
+/// Cached preview and refinement resources of one Scene.
+#[derive(Default)]
+pub(super) struct Progressive {
+    preview: Mutex<Option<Preview>>,
+    refine: Mutex<Option<Refine>>,
+}
+
+impl Scene {
+    /// Output target of `width × height` with its own UBO (used by `budget` and `projected` too).
+    pub(super) fn pass_target(&self, tp: &TerrainPipeline, label: &str, width: u32, height: u32, sampled: bool) -> PassTarget {
+        let mut usage = wgpu::TextureUsages::RENDER_ATTACHMENT | wgpu::TextureUsages::COPY_SRC;
+        if sampled {
+            usage |= wgpu::TextureUsages::TEXTURE_BINDING;
+        }
+        let color = self.device.create_texture(&wgpu::TextureDescriptor {
+            label: Some(label),
+            size: wgpu::Extent3d { width, height, depth_or_array_layers: 1 },
+            mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
+            format: TEXTURE_FORMAT, usage, view_formats: &[],
+        });
+        let view = color.create_view(&Default::default());
+        let ubo = self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-pass-ubo"), size: std::mem::size_of::<TerrainUniforms>() as u64,
+            usage: wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST, mapped_at_creation: false,
+        });
+        let readback = self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-pass-readback"), size: padded_row(width) as u64 * height as u64,
+            usage: wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ, mapped_at_creation: false,
+        });
+        let bg0 = tp.make_bg_globals(&self.device, &ubo);
+        PassTarget { width, height, color, view, ubo, bg0, bg0_features: tp.features, readback }
+    }
+
+    /// Supersampled (`aa`× per axis) target plus its resolve, or the plain target for `aa == 1`.
+    pub(super) fn supersample_targets(&self, tp: &TerrainPipeline, aa: u32) -> Refine {
+        let target = self.pass_target(tp, "scene-supersample", self.width * aa, self.height * aa, aa > 1);
+        let resolve = (aa > 1).then(|| {
+            use wgpu::util::DeviceExt;
+            let pass = SupersampleResolve::new(&self.device, TEXTURE_FORMAT);
+            let params = self.device.create_buffer_init(&wgpu::util::BufferInitDescriptor {
+                label: Some("scene-supersample-resolve"),
+                contents: bytemuck::bytes_of(&ResolveParams { factor: aa, _p: [0; 3] }),
+                usage: wgpu::BufferUsages::UNIFORM,
+            });
+            let bg = pass.bind(&self.device, &params, &target.view);
+            let output = self.pass_target(tp, "scene-supersample-output", self.width, self.height, false);
+            Resolve { pass, bg, output }
+        });
+        Refine { aa, target, resolve }
+    }
+
+    /// Draw `mesh` with `draw` (pipeline, groups 1 and 2) into `r` and resolve it. The
+    /// timestamp writes, if any, go to the terrain pass and the resolve pass.
+    pub(super) fn encode_supersampled(&self, draw: (&TerrainPipeline, &wgpu::BindGroup, &wgpu::BindGroup), r: &mut Refine,
+                                      mesh: (&wgpu::Buffer, &wgpu::Buffer, u32), u: &TerrainUniforms,
+                                      encoder: &mut wgpu::CommandEncoder,
+                                      timestamps: [Option<wgpu::RenderPassTimestampWrites>; 2]) {
+        let [ts_draw, ts_resolve] = timestamps;
+        self.encode_pass(draw, &mut r.target, mesh, u, encoder, ts_draw);
+        if let Some(res) = &r.resolve {
+            res.pass.encode(encoder, &res.bg, &res.output.view, ts_resolve);
+        }
+    }
+
+    /// One terrain pass of `mesh` into `t` with uniforms `u`.
+    pub(super) fn encode_pass(&self, draw: (&TerrainPipeline, &wgpu::BindGroup, &wgpu::BindGroup), t: &mut PassTarget,
+                   mesh: (&wgpu::Buffer, &wgpu::Buffer, u32), u: &TerrainUniforms, encoder: &mut wgpu::CommandEncoder,
+                   timestamps: Option<wgpu::RenderPassTimestampWrites>) {
+        let (tp, bg1, bg2) = draw;
+        if t.bg0_features != tp.features {
+            t.bg0 = tp.make_bg_globals(&self.device, &t.ubo);
+            t.bg0_features = tp.features;
+        }
+        self.queue.write_buffer(&t.ubo, 0, bytemuck::bytes_of(u));
+        let mut rp = encoder.begin_render_pass(&wgpu::RenderPassDescriptor {
+            label: Some("scene-pass-rp"),
+            color_attachments: &[Some(wgpu::RenderPassColorAttachment {
+                view: &t.view, resolve_target: None,
+                ops: wgpu::Operations { load: wgpu::LoadOp::Clear(wgpu::Color { r: 0.02, g: 0.02, b: 0.03, a: 1.0 }), store: wgpu::StoreOp::Store },
+            })],
+            depth_stencil_attachment: None, timestamp_writes: timestamps, ..Default::default()
+        });
+        rp.set_pipeline(&tp.pipeline);
+        rp.set_bind_group(0, &t.bg0, &[]);
+        rp.set_bind_group(1, bg1, &[]);
+        rp.set_bind_group(2, bg2, &[]);
+        rp.set_vertex_buffer(0, mesh.0.slice(..));
+        rp.set_index_buffer(mesh.1.slice(..), wgpu::IndexFormat::Uint32);
+        if self.caps.push_constants() {
+            let p = crate::terrain::DrawPush::from_uniforms(u, [0.0; 3]);
+            rp.set_push_constants(wgpu::ShaderStages::VERTEX_FRAGMENT, 0, bytemuck::bytes_of(&p));
+        }
+        rp.draw_indexed(0..mesh.2, 0, 0..1);
+    }
+
+    /// Copy `t` to its readback buffer, submit `encoder` and return the unpadded pixels.
+    pub(super) fn read_target(&self, t: &PassTarget, mut encoder: wgpu::CommandEncoder) -> Result<Vec<u8>, String> {
+        copy_target(t, &mut encoder, &t.readback);
+        let submission = self.queue.submit(Some(encoder.finish()));
+        Ok(unpad(&self.map_staging(&t.readback, submission)?, t.width, t.height))
+    }
+
+    /// Preview of `u` at `width × height` on a `grid`² mesh.
+    pub(super) fn render_preview(&self, width: u32, height: u32, grid: u32, u: &TerrainUniforms) -> Result<Vec<u8>, String> {
+        let mut cache = self.progressive.preview.lock().unwrap();
+        let st = self.state.read().unwrap();
+        if cache.as_ref().map_or(true, |p| p.grid != grid || p.target.width != width || p.target.height != height) {
+            let mesh = super::xyuv_grid(&self.device, grid);
+            let target = self.pass_target(&st.tp, "scene-progressive-preview", width, height, false);
+            *cache = Some(Preview { grid, mesh, target });
+        }
+        let p = cache.as_mut().unwrap();
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-progressive-preview") });
+        let draw = (&*st.tp, &st.bg1_height, &st.bg2_lut);
+        self.encode_pass(draw, &mut p.target, (&p.mesh.0, &p.mesh.1, p.mesh.2), u, &mut encoder, None);
+        drop(st);
+        self.read_target(&p.target, encoder)
+    }
+
+    /// Full-size render of `u` on the Scene mesh, supersampled `aa`× per axis.
+    pub(super) fn render_refined(&self, aa: u32, u: &TerrainUniforms) -> Result<Vec<u8>, String> {
+        let mut cache = self.progressive.refine.lock().unwrap_or_else(|e| {
+            // A refinement panicked mid-encode: start over with fresh targets.
+            self.progressive.refine.clear_poison();
+            let mut cache = e.into_inner();
+            *cache = None;
+            cache
+        });
+        let st = self.state.read().unwrap();
+        if cache.as_ref().map_or(true, |r| r.aa != aa) {
+            *cache = Some(self.supersample_targets(&st.tp, aa));
+        }
+        let r = cache.as_mut().unwrap();
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-progressive-refine") });
+        let draw = (&*st.tp, &st.bg1_height, &st.bg2_lut);
+        self.encode_supersampled(draw, r, (&self.vbuf, &self.ibuf, self.nidx), u, &mut encoder, [None, None]);
+        drop(st);
+        self.read_target(r.output(), encoder)
+    }
+}
+
+/// Bytes per row of a `width`-texel RGBA8 readback, padded for `copy_texture_to_buffer`.
+pub(super) fn padded_row(width: u32) -> u32 {
+    let align = wgpu::COPY_BYTES_PER_ROW_ALIGNMENT;
+    (width * 4 + align - 1) / align * align
+}
+
+/// Record a copy of `t` into `buffer` at offset 0 with `padded_row` rows.
+pub(super) fn copy_target(t: &PassTarget, encoder: &mut wgpu::CommandEncoder, buffer: &wgpu::Buffer) {
+    encoder.copy_texture_to_buffer(
+        wgpu::ImageCopyTexture { texture: &t.color, mip_level: 0, origin: wgpu::Origin3d::ZERO, aspect: wgpu::TextureAspect::All },
+        wgpu::ImageCopyBuffer { buffer, layout: wgpu::ImageDataLayout {
+            offset: 0, bytes_per_row: Some(padded_row(t.width)), rows_per_image: Some(t.height),
+        }},
+        wgpu::Extent3d { width: t.width, height: t.height, depth_or_array_layers: 1 },
+    );
+}
+
+/// Tightly packed RGBA8 rows from a `padded_row` readback.
+pub(super) fn unpad(bytes: &[u8], width: u32, height: u32) -> Vec<u8> {
+    let (row, padded) = (width as usize * 4, padded_row(width) as usize);
+    let mut pixels = Vec::with_capacity(row * height as usize);
+    for y in 0..height as usize {
+        pixels.extend_from_slice(&bytes[y * padded..][..row]);
+    }
+    pixels
+}
+
+// ---------- Refiner thread ----------
+
+#[derive(Debug, Default, Clone, Copy)]
+struct Timings {
+    preview_ms: f64,
+    /// `render_progressive` returned → refiner picked the job up.
+    queue_ms: f64,
+    /// Refinement render, resolve and readback.
+    refine_ms: f64,
+}
+
+enum Outcome {
+    Pending,
+    Done(PyObject),
+    Cancelled,
+    Failed(String),
+}
+
+struct JobState {
+    outcome: Outcome,
+    /// `(future, event loop)` of pending `result_async` calls.
+    futures: Vec<(PyObject, PyObject)>,
+    timings: Timings,
+}
+
+struct Shared {
+    cancelled: AtomicBool,
+    state: Mutex<JobState>,
+    cv: Condvar,
+}
+
+struct Job {
+    scene: Py<Scene>,
+    shared: Arc<Shared>,
+    callback: Option<PyObject>,
+    uniforms: TerrainUniforms,
+    epoch: u64,
+    generation: u64,
+    aa: u32,
+    queued: Instant,
+}
+
+static QUEUE: Lazy<(Mutex<VecDeque<Job>>, Condvar)> = Lazy::new(|| (Mutex::new(VecDeque::new()), Condvar::new()));
+static REFINER: OnceCell<()> = OnceCell::new();
+
+fn enqueue(job: Job) {
+    REFINER.get_or_init(|| {
+        std::thread::Builder::new()
+            .name("vf-progressive-refiner".into())
+            .spawn(refiner_main)
+            .expect("spawn progressive refiner thread");
+    });
+    let (queue, cv) = &*QUEUE;
+    queue.lock().unwrap().push_back(job);
+    cv.notify_one();
+}
+
+fn refiner_main() {
+    let (queue, cv) = &*QUEUE;
+    loop {
+        let job = {
+            let mut q = queue.lock().unwrap();
+            loop {
+                if let Some(job) = q.pop_front() {
+                    break job;
+                }
+                q = cv.wait(q).unwrap();
+            }
+        };
+        let scene = job.scene.get();
+        let live = || !job.shared.cancelled.load(Ordering::Acquire)
+            && scene.camera_epoch.load(Ordering::Acquire) == job.epoch
+            && scene.generation.load(Ordering::Acquire) == job.generation;
+        let t0 = Instant::now();
+        let queue_ms = t0.duration_since(job.queued).as_secs_f64() * 1000.0;
+        let (pixels, refine_ms) = if live() {
+            let pixels = catch_unwind(AssertUnwindSafe(|| scene.render_refined(job.aa, &job.uniforms)))
+                .unwrap_or_else(|e| Err(format!("refinement failed: {}", panic_message(e))))
+                .map(Some);
+            (pixels, t0.elapsed().as_secs_f64() * 1000.0)
+        } else {
+            (Ok(None), 0.0)
+        };
+        // The camera or content may have changed while the refinement rendered.
+        let pixels = pixels.map(|p| p.filter(|_| live()));
+        let shape = [scene.height as usize, scene.width as usize, 4];
+        Python::with_gil(|py| {
+            let outcome = match pixels {
+                Ok(Some(p)) => frames::to_array(py, p, &shape).map_or_else(|e| Outcome::Failed(e.to_string()), Outcome::Done),
+                Ok(None) => Outcome::Cancelled,
+                Err(msg) => Outcome::Failed(msg),
+            };
+            let (stage, result) = match &outcome {
+                Outcome::Done(v) => ("final", Ok(v.clone_ref(py))),
+                Outcome::Failed(msg) => ("failed", Err(msg.clone())),
+                _ => ("cancelled", Ok(py.None())),
+            };
+            let futures = {
+                let mut s = job.shared.state.lock().unwrap();
+                s.timings.queue_ms = queue_ms;
+                s.timings.refine_ms = refine_ms;
+                s.outcome = outcome;
+                std::mem::take(&mut s.futures)
+            };
+            job.shared.cv.notify_all();
+            for (future, event_loop) in futures {
+                let value = match &result {
+                    Ok(v) => Ok(v.clone_ref(py)),
+                    Err(msg) => Err(pyo3::exceptions::PyRuntimeError::new_err(msg.clone())),
+                };
+                frames::deliver(py, &future, &event_loop, value);
+            }
+            if let Some(cb) = &job.callback {
+                if let Err(e) = cb.call1(py, (stage, result.unwrap_or_else(|_| py.None()))) {
+                    e.print(py);
+                }
+            }
+            drop(job);
+        });
+    }
+}
+
+
+/// Preview pixels plus the pending refinement of one `render_progressive` call.
+#[pyclass(module = "_vulkan_forge", name = "ProgressiveFrame", frozen)]
+pub struct ProgressiveFrame {
+    preview: PyObject,
+    preview_size: (u32, u32),
+    preview_grid: u32,
+    grid: u32,
+    aa: u32,
+    shared: Arc<Shared>,
+}
+
+impl Scene {
+    /// Render the preview now and queue the refinement (see the module docs).
+    pub(super) fn start_progressive(slf: &Bound<'_, Scene>, py: Python<'_>, callback: Option<PyObject>,
+                                    preview_scale: u32, preview_grid: u32, aa: u32) -> PyResult<ProgressiveFrame> {
+        let scene = slf.get();
+        scene.caps.check_texture_2d(scene.width * aa, scene.height * aa)
+            .map_err(pyo3::exceptions::PyValueError::new_err)?;
+        let t0 = Instant::now();
+        let (u, epoch, generation) = {
+            let st = scene.state.read().unwrap();
+            let mut u = st.last_uniforms;
+            u.view = st.scene.view.to_cols_array_2d();
+            (u, scene.camera_epoch.load(Ordering::Acquire), scene.generation.load(Ordering::Acquire))
+        };
+        let (pw, ph) = ((scene.width / preview_scale).max(1), (scene.height / preview_scale).max(1));
+        let pixels = py.allow_threads(|| scene.render_preview(pw, ph, preview_grid, &u))
+            .map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+        let preview = frames::to_array(py, pixels, &[ph as usize, pw as usize, 4])?;
+        let shared = Arc::new(Shared {
+            cancelled: AtomicBool::new(false),
+            state: Mutex::new(JobState {
+                outcome: Outcome::Pending,
+                futures: Vec::new(),
+                timings: Timings { preview_ms: t0.elapsed().as_secs_f64() * 1000.0, ..Default::default() },
+            }),
+            cv: Condvar::new(),
+        });
+        if let Some(cb) = &callback {
+            cb.call1(py, ("preview", preview.clone_ref(py)))?;
+        }
+        enqueue(Job {
+            scene: slf.clone().unbind(), shared: shared.clone(), callback, uniforms: u, epoch, generation, aa,
+            queued: Instant::now(),
+        });
+        Ok(ProgressiveFrame { preview, preview_size: (pw, ph), preview_grid, grid: scene.grid, aa, shared })
+    }
+}
+
+#[pymethods]
+impl ProgressiveFrame {
+    /// Preview pixels, (H / preview_scale, W / preview_scale, 4) uint8.
+    #[getter]
+    fn preview(&self, py: Python<'_>) -> PyObject {
+        self.preview.clone_ref(py)
+    }
+
+    /// Wait (GIL released) for the refinement: (H, W, 4) uint8, or `None` if it was
+    /// cancelled. Raises `TimeoutError` after `timeout` seconds and `RuntimeError` if the
+    /// refinement failed.
+    #[pyo3(signature = (timeout=None))]
+    #[pyo3(text_signature = "($self, timeout=None)")]
+    fn result(&self, py: Python<'_>, timeout: Option<f64>) -> PyResult<Option<PyObject>> {
+        let deadline = timeout.map(|t| Instant::now() + Duration::from_secs_f64(t.max(0.0)));
+        let finished = py.allow_threads(|| {
+            let mut s = self.shared.state.lock().unwrap();
+            while matches!(s.outcome, Outcome::Pending) {
+                match deadline {
+                    Some(d) => {
+                        let left = d.saturating_duration_since(Instant::now());
+                        if left.is_zero() {
+                            return false;
+                        }
+                        s = self.shared.cv.wait_timeout(s, left).unwrap().0;
+                    }
+                    None => s = self.shared.cv.wait(s).unwrap(),
+                }
+            }
+            true
+        });
+        if !finished {
+            return Err(pyo3::exceptions::PyTimeoutError::new_err("refinement is still running"));
+        }
+        match &self.shared.state.lock().unwrap().outcome {
+            Outcome::Done(v) => Ok(Some(v.clone_ref(py))),
+            Outcome::Failed(msg) => Err(pyo3::exceptions::PyRuntimeError::new_err(msg.clone())),
+            _ => Ok(None),
+        }
+    }
+
+    /// `await frame.result_async()`: the refinement, or `None` if it was cancelled; raises
+    /// `RuntimeError` if it failed.
+    #[pyo3(text_signature = "($self)")]
+    fn result_async<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyAny>> {
+        let event_loop = py.import("asyncio")?.call_method0("get_running_loop")?;
+        let future = event_loop.call_method0("create_future")?;
+        let mut s = self.shared.state.lock().unwrap();
+        match &s.outcome {
+            Outcome::Pending => s.futures.push((future.clone().unbind(), event_loop.unbind())),
+            Outcome::Done(v) => { future.call_method1("set_result", (v.clone_ref(py),))?; }
+            Outcome::Cancelled => { future.call_method1("set_result", (py.None(),))?; }
+            Outcome::Failed(msg) => {
+                let err = pyo3::exceptions::PyRuntimeError::new_err(msg.clone());
+                future.call_method1("set_exception", (err.into_value(py),))?;
+            }
+        }
+        Ok(future)
+    }
+
+    /// Cancel the refinement unless it already finished; returns whether it was pending.
+    /// A refinement that is already rendering is dropped instead of delivered.
+    #[pyo3(text_signature = "($self)")]
+    fn cancel(&self) -> bool {
+        self.shared.cancelled.store(true, Ordering::Release);
+        matches!(self.shared.state.lock().unwrap().outcome, Outcome::Pending)
+    }
+
+    /// True once the refinement was delivered, cancelled or failed.
+    #[pyo3(text_signature = "($self)")]
+    fn done(&self) -> bool {
+        !matches!(self.shared.state.lock().unwrap().outcome, Outcome::Pending)
+    }
+
+    /// True if the refinement was cancelled (explicitly, or by a camera or content change).
+    #[pyo3(text_signature = "($self)")]
+    fn cancelled(&self) -> bool {
+        matches!(self.shared.state.lock().unwrap().outcome, Outcome::Cancelled)
+    }
+
+    /// `{state, preview_ms, preview_size, preview_grid, refine_queue_ms, refine_ms, grid, aa,
+    /// error}`. `state` is "pending", "done", "cancelled" or "failed" (`error` holds the
+    /// message, else `None`). `preview_ms` runs from the call to the preview pixels on the
+    /// host; `refine_queue_ms` from the call's return until the refiner started, and
+    /// `refine_ms` covers the refinement's render, resolve and readback (0 when it was skipped).
+    #[pyo3(text_signature = "($self)")]
+    fn stats(&self, py: Python<'_>) -> PyResult<PyObject> {
+        let (state, error, t) = {
+            let s = self.shared.state.lock().unwrap();
+            let (state, error) = match &s.outcome {
+                Outcome::Pending => ("pending", None),
+                Outcome::Done(_) => ("done", None),
+                Outcome::Cancelled => ("cancelled", None),
+                Outcome::Failed(msg) => ("failed", Some(msg.clone())),
+            };
+            (state, error, s.timings)
+        };
+        let d = pyo3::types::PyDict::new(py);
+        d.set_item("state", state)?;
+        d.set_item("preview_ms", t.preview_ms)?;
+        d.set_item("preview_size", self.preview_size)?;
+        d.set_item("preview_grid", self.preview_grid)?;
+        d.set_item("refine_queue_ms", t.queue_ms)?;
+        d.set_item("refine_ms", t.refine_ms)?;
+        d.set_item("grid", self.grid)?;
+        d.set_item("aa", self.aa)?;
+        d.set_item("error", error)?;
+        Ok(d.into_any().unbind())
+    }
+}
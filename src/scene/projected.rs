@@ -0,0 +1,94 @@
+//! Projected-grid geometry for Scene-camera renders (`Scene.set_projected_grid`).
+//!
+//! While enabled, `render_rgba` / `render_png` draw the terrain on a screen-space grid of
+//! one vertex every `cell` pixels, projected onto the terrain plane each frame by
+//! `terrain::projected` in the same submission as the draw. The draw uses the Scene
+//! pipeline and groups 1 and 2 unchanged; only the vertex and index buffers differ from the
+//! Scene mesh. Temporal reprojection, when also enabled, takes precedence (it keeps the
+//! Scene mesh); other render calls are unaffected.
+//!
+//! Projected renders serialise on `Scene::projected`.
+
+use crate::terrain::projected::{grid_indices, ProjectedGridGpu, ProjectedGridParams};
+
+use super::progressive::PassTarget;
+use super::Scene;
+
+/// Grid buffers, projection pipeline and output target of the projected path.
+pub(super) struct ProjectedGrid {
+    gpu: ProjectedGridGpu,
+    pub(super) cell: u32,
+    pub(super) margin: f32,
+    pub(super) dims: [u32; 2],
+    params: wgpu::Buffer,
+    /// `[x, z, u, v]` per grid vertex, rewritten by every frame's projection.
+    verts: wgpu::Buffer,
+    ibuf: wgpu::Buffer,
+    pub(super) nidx: u32,
+    bg: wgpu::BindGroup,
+    target: PassTarget,
+    pub(super) frames: u64,
+}
+
+impl Scene {
+    /// Enable (or reconfigure) the projected path, or drop it.
+    pub(super) fn set_projected_state(&self, enabled: bool, cell: u32, margin: f32) -> Result<(), String> {
+        if cell == 0 {
+            return Err("cell must be >= 1".to_string());
+        }
+        if !(0.0..1.0).contains(&margin) {
+            return Err("margin must be in [0, 1)".to_string());
+        }
+        let mut g = self.projected.lock().unwrap();
+        if !enabled {
+            *g = None;
+            return Ok(());
+        }
+        let dims = ProjectedGridParams::dims_for(self.width, self.height, cell);
+        let bytes = dims[0] as u64 * dims[1] as u64 * 16;
+        if bytes > self.caps.limits.max_storage_buffer_binding_size as u64 {
+            return Err(format!("a {}x{} grid ({} bytes of vertices) exceeds this device's max_storage_buffer_binding_size; \
+                                use a larger cell", dims[0], dims[1], bytes));
+        }
+        *g = Some(self.new_projected_grid(cell, margin, dims));
+        Ok(())
+    }
+
+    fn new_projected_grid(&self, cell: u32, margin: f32, dims: [u32; 2]) -> ProjectedGrid {
+        use wgpu::util::DeviceExt;
+        let gpu = ProjectedGridGpu::new(&self.device);
+        let params = self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-projected-params"), size: std::mem::size_of::<ProjectedGridParams>() as u64,
+            usage: wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST, mapped_at_creation: false,
+        });
+        let verts = self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some("scene-projected-vbuf"), size: dims[0] as u64 * dims[1] as u64 * 16,
+            usage: wgpu::BufferUsages::STORAGE | wgpu::BufferUsages::VERTEX, mapped_at_creation: false,
+        });
+        let idx = grid_indices(dims[0], dims[1]);
+        let ibuf = self.device.create_buffer_init(&wgpu::util::BufferInitDescriptor {
+            label: Some("scene-projected-ibuf"), contents: bytemuck::cast_slice(&idx), usage: wgpu::BufferUsages::INDEX,
+        });
+        let bg = gpu.bind(&self.device, &params, &verts);
+        let target = self.pass_target(&self.state.read().unwrap().tp, "scene-projected", self.width, self.height, false);
+        ProjectedGrid { gpu, cell, margin, dims, params, verts, ibuf, nidx: idx.len() as u32, bg, target, frames: 0 }
+    }
+
+    /// Render the Scene camera on the projected grid, or `None` when it is disabled.
+    pub(super) fn render_projected(&self) -> Result<Option<Vec<u8>>, String> {
+        let mut guard = self.projected.lock().unwrap();
+        let Some(g) = guard.as_mut() else { return Ok(None) };
+        let st = self.state.read().unwrap();
+        let mut u = st.last_uniforms;
+        u.view = st.scene.view.to_cols_array_2d();
+        let p = ProjectedGridParams::new(st.scene.view, st.scene.proj, g.dims, g.margin, u.spacing_h_exag_pad[0]);
+        self.queue.write_buffer(&g.params, 0, bytemuck::bytes_of(&p));
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-projected") });
+        g.gpu.encode(&mut encoder, &g.bg, &p);
+        let draw = (&*st.tp, &st.bg1_height, &st.bg2_lut);
+        self.encode_pass(draw, &mut g.target, (&g.verts, &g.ibuf, g.nidx), &u, &mut encoder, None);
+        drop(st);
+        g.frames += 1;
+        self.read_target(&g.target, encoder).map(Some)
+    }
+}
@@ -0,0 +1,67 @@
+//! Scalar colormap source.
+//!
+//! `Scene.set_scalar` normalises a float32 grid (e.g. flow accumulation from `hydrology`)
+//! into [0, 1] on the host, uploads it as an `R32Float` texture and switches to the SCALAR
+//! permutation, which takes the colormap coordinate from that texture instead of height.
+//! The grid is sampled by the terrain UV, so it need not match the height texture's size.
+
+use crate::terrain::variants::ShaderFeatures;
+
+use super::{Scene, SceneState};
+
+/// `values` mapped linearly (or through `ln(1 + v)` with `log`, negatives clamped to 0) so
+/// `range` (default: finite min / max) spans [0, 1]. NaN maps to 0.
+pub(super) fn normalize(values: &[f32], range: Option<(f32, f32)>, log: bool) -> Result<Vec<f32>, String> {
+    let f = |v: f32| if log { v.max(0.0).ln_1p() } else { v };
+    let (lo, hi) = match range {
+        Some((lo, hi)) if !(lo < hi) => return Err(format!("range ({}, {}) must have min < max", lo, hi)),
+        Some((lo, hi)) => (f(lo), f(hi)),
+        None => values.iter().filter(|v| v.is_finite()).fold((f32::INFINITY, f32::NEG_INFINITY), |(lo, hi), &v| (lo.min(f(v)), hi.max(f(v)))),
+    };
+    if !(lo <= hi) {
+        return Err("values have no finite entries".to_string());
+    }
+    let scale = if hi > lo { 1.0 / (hi - lo) } else { 0.0 };
+    Ok(values.iter().map(|&v| if v.is_nan() { 0.0 } else { (f(v) - lo) * scale }).collect())
+}
+
+impl Scene {
+    /// Upload the normalised `w × h` grid and bind the SCALAR permutation.
+    pub(super) fn bind_scalar(&self, w: u32, h: u32, t: &[f32]) -> Result<(), String> {
+        let tex = self.r32f_texture("scene-scalar-r32f", w, h, t)?;
+        let mut st = self.state.write().unwrap();
+        st.scalar = Some(tex.create_view(&Default::default()));
+        if st.features.contains(ShaderFeatures::SCALAR) {
+            self.rebind_groups(&mut st);
+        } else {
+            let features = st.features.union(ShaderFeatures::SCALAR);
+            self.rebind(&mut st, features);
+        }
+        Ok(())
+    }
+
+    /// Drop the scalar source and go back to colouring by height.
+    pub(super) fn drop_scalar(&self, st: &mut SceneState) {
+        st.scalar = None;
+        if st.features.contains(ShaderFeatures::SCALAR) {
+            let features = st.features.without(ShaderFeatures::SCALAR);
+            self.rebind(st, features);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::normalize;
+
+    #[test]
+    fn linear_and_log_ranges() {
+        assert_eq!(normalize(&[2.0, 4.0, f32::NAN, 3.0], None, false).unwrap(), [0.0, 1.0, 0.0, 0.5]);
+        assert_eq!(normalize(&[0.0, 10.0], Some((0.0, 5.0)), false).unwrap(), [0.0, 2.0]);
+        let t = normalize(&[0.0, 9.0, 99.0], None, true).unwrap();
+        assert!((t[1] - 10f32.ln() / 100f32.ln()).abs() < 1e-6 && t[2] == 1.0);
+        assert_eq!(normalize(&[7.0, 7.0], None, false).unwrap(), [0.0, 0.0]);
+        assert!(normalize(&[f32::NAN], None, false).is_err());
+        assert!(normalize(&[1.0], Some((1.0, 1.0)), false).is_err());
+    }
+}
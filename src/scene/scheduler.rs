@@ -0,0 +1,546 @@
+//! Priority render scheduler with cross-Scene submission batching.
+//!
+//! `RenderScheduler.submit(scene, views, priority, deadline_ms)` queues a job and returns a
+//! `RenderTicket`. A dispatcher thread picks the most urgent job (highest priority, then
+//! earliest deadline, then FIFO), gathers queued jobs that are compatible with it (same
+//! device, target size and pipeline permutation), encodes each into its Scene's render slot
+//! and hands all command buffers to a single `queue.submit`. A completer thread reads the
+//! results back in submission order.
+//!
+//! Merging needs the push-constant path. On the UBO fallback each draw's uniforms are a
+//! queue write, which is ordered only between submissions, so `encode_frames` submits every
+//! draw itself: a scheduler submission is then one scheduling unit of several
+//! `queue.submit` calls, and batching only saves dispatcher round trips.
+//!
+//! At most `max_in_flight` submissions are outstanding per device, and bulk jobs are cut
+//! into `max_frames_per_submit` chunks that go back into the queue between submissions, so
+//! an interactive job waits for at most `max_in_flight` submissions on its own device, never
+//! for a whole batch or for another device's work.
+//! Each ticket reports its queueing delay (submit → first GPU submission) separately from
+//! its execution time (first GPU submission → pixels ready).
+//!
+//! Only Scenes created with `shared_device=True` on one adapter share a device, so only
+//! their jobs can be merged; jobs of other Scenes are scheduled the same way but submitted
+//! one Scene at a time. A job whose encode, submission or readback fails completes its
+//! ticket with the error (`result()` raises `RuntimeError`); the threads keep serving the
+//! other jobs.
+
+use std::collections::{BTreeMap, HashMap, VecDeque};
+use std::panic::{catch_unwind, AssertUnwindSafe};
+use std::sync::{Arc, Condvar, Mutex};
+use std::time::{Duration, Instant};
+
+use pyo3::prelude::*;
+use pyo3::types::PyDict;
+
+use super::frames::{panic_message, to_array};
+use super::{FrameDraws, PendingFrames, Scene};
+
+/// Submit a render job; `views` as in `Scene.render_views_rgba` (`None`: the Scene camera).
+#[pyclass(module = "_vulkan_forge", name = "RenderScheduler", frozen)]
+pub struct RenderScheduler {
+    shared: Arc<Shared>,
+}
+
+/// Result handle for one scheduled job.
+#[pyclass(module = "_vulkan_forge", name = "RenderTicket", frozen)]
+pub struct RenderTicket {
+    state: Arc<TicketState>,
+}
+
+struct Shared {
+    max_in_flight: usize,
+    max_frames: usize,
+    sched: Mutex<SchedState>,
+    /// Dispatcher wakeup: a job arrived, a submission completed, or shutdown.
+    dispatch_cv: Condvar,
+    done: Mutex<VecDeque<Submission>>,
+    done_cv: Condvar,
+}
+
+#[derive(Default)]
+struct SchedState {
+    pending: Vec<Job>,
+    in_flight: usize,
+    /// Outstanding submissions per device (`Scene::device_id`).
+    busy: HashMap<usize, usize>,
+    next_id: u64,
+    shutdown: bool,
+    stats: Stats,
+}
+
+#[derive(Default)]
+struct Stats {
+    jobs: u64,
+    completed: u64,
+    failed: u64,
+    submissions: u64,
+    chunks: u64,
+    deadline_misses: u64,
+    /// priority → (jobs, queue_ms total, exec_ms total)
+    by_priority: BTreeMap<i32, (u64, f64, f64)>,
+}
+
+/// Scenes are held as `Arc<Py<Scene>>` so the dispatcher can share them between chunks
+/// without taking the GIL while it holds the scheduler lock.
+struct Job {
+    id: u64,
+    scene: Arc<Py<Scene>>,
+    frames: VecDeque<FrameDraws>,
+    priority: i32,
+    deadline: Option<Instant>,
+    ticket: Arc<TicketState>,
+}
+
+/// One GPU submission: the chunks it contains, read back in order by the completer.
+struct Submission {
+    device: usize,
+    parts: Vec<(Arc<Py<Scene>>, PendingFrames, Arc<TicketState>, bool)>,
+}
+
+struct TicketState {
+    shape: Vec<usize>,
+    priority: i32,
+    deadline: Option<Instant>,
+    enqueued: Instant,
+    inner: Mutex<TicketInner>,
+    cv: Condvar,
+}
+
+#[derive(Default)]
+struct TicketInner {
+    pixels: Vec<u8>,
+    started: Option<Instant>,
+    finished: Option<Instant>,
+    /// Jobs merged into this ticket's submissions (its own chunk included), summed per chunk.
+    batched_with: usize,
+    chunks: usize,
+    taken: bool,
+    /// Why the job failed; set together with `finished`, and its later chunks are dropped.
+    error: Option<String>,
+}
+
+impl Job {
+    /// (priority desc, deadline asc with none last, FIFO) — smaller is more urgent.
+    fn urgency(&self) -> (i32, bool, Option<Instant>, u64) {
+        (-self.priority, self.deadline.is_none(), self.deadline, self.id)
+    }
+}
+
+impl Shared {
+    fn dispatcher(self: Arc<Self>) {
+        loop {
+            let batch = {
+                let mut st = self.sched.lock().unwrap();
+                loop {
+                    if st.shutdown && st.pending.is_empty() {
+                        return;
+                    }
+                    let busy = &st.busy;
+                    if st.pending.iter().any(|job| self.has_room(busy, job)) {
+                        break;
+                    }
+                    st = self.dispatch_cv.wait(st).unwrap();
+                }
+                // Remaining chunks of failed jobs are dropped (with the GIL, outside the lock).
+                let (failed, live): (Vec<Job>, Vec<Job>) =
+                    std::mem::take(&mut st.pending).into_iter().partition(|job| job.ticket.failed());
+                st.pending = live;
+                if !failed.is_empty() {
+                    drop(st);
+                    Python::with_gil(|_| drop(failed));
+                    continue;
+                }
+                // A job whose device is at `max_in_flight` waits without holding up other devices.
+                let head = (0..st.pending.len())
+                    .filter(|&i| self.has_room(&st.busy, &st.pending[i]))
+                    .min_by_key(|&i| st.pending[i].urgency())
+                    .unwrap();
+                let key = st.pending[head].scene.get().batch_key();
+                // Most urgent first, then every compatible job (in urgency order) that fits.
+                let mut order: Vec<usize> = (0..st.pending.len())
+                    .filter(|&i| i == head || st.pending[i].scene.get().batch_key() == key)
+                    .collect();
+                order.sort_by_key(|&i| st.pending[i].urgency());
+                let mut budget = self.max_frames;
+                let mut chunks = Vec::new();
+                for i in order {
+                    if budget == 0 {
+                        break;
+                    }
+                    let job = &mut st.pending[i];
+                    let n = job.frames.len().min(budget);
+                    budget -= n;
+                    let frames: Vec<FrameDraws> = job.frames.drain(..n).collect();
+                    let last = job.frames.is_empty();
+                    chunks.push((i, frames, last));
+                }
+                // Pull finished jobs out (highest index first so indices stay valid).
+                let mut parts = Vec::new();
+                chunks.sort_by_key(|c| std::cmp::Reverse(c.0));
+                for (i, frames, last) in chunks {
+                    let (scene, ticket) = if last {
+                        let job = st.pending.swap_remove(i);
+                        (job.scene, job.ticket)
+                    } else {
+                        let job = &st.pending[i];
+                        (job.scene.clone(), job.ticket.clone())
+                    };
+                    parts.push((scene, frames, ticket, last));
+                }
+                parts.reverse();
+                st.in_flight += 1;
+                *st.busy.entry(key.0).or_default() += 1;
+                st.stats.submissions += 1;
+                st.stats.chunks += parts.len() as u64;
+                (key.0, parts)
+            };
+            let submission = self.submit(batch.0, batch.1);
+            self.done.lock().unwrap().push_back(submission);
+            self.done_cv.notify_one();
+        }
+    }
+
+    /// Encode every chunk and submit all command buffers at once on the shared queue.
+    /// Chunks that fail to encode, and all of them if the submission fails, fail their
+    /// tickets and are left out of the returned `Submission`.
+    fn submit(&self, device: usize, batch: Vec<(Arc<Py<Scene>>, Vec<FrameDraws>, Arc<TicketState>, bool)>) -> Submission {
+        let n = batch.len();
+        let now = Instant::now();
+        let mut encoded = Vec::with_capacity(n);
+        let mut commands = Vec::new();
+        for (scene, frames, ticket, last) in batch {
+            {
+                let mut t = ticket.inner.lock().unwrap();
+                t.started.get_or_insert(now);
+                t.batched_with += n;
+                t.chunks += 1;
+            }
+            match catch_unwind(AssertUnwindSafe(|| scene.get().encode_frames(&frames))) {
+                Ok(mut e) => {
+                    commands.extend(e.commands.take());
+                    encoded.push((scene, e, ticket, last));
+                }
+                Err(e) => self.fail(scene, &ticket, format!("render encode failed: {}", panic_message(e))),
+            }
+        }
+        let submission = if commands.is_empty() {
+            None
+        } else {
+            match catch_unwind(AssertUnwindSafe(|| encoded[0].0.get().queue.submit(commands))) {
+                Ok(index) => Some(index),
+                Err(e) => {
+                    let msg = format!("queue submission failed: {}", panic_message(e));
+                    for (scene, _, ticket, _) in encoded.drain(..) {
+                        self.fail(scene, &ticket, msg.clone());
+                    }
+                    None
+                }
+            }
+        };
+        let mut parts = Vec::with_capacity(encoded.len());
+        for (scene, mut e, ticket, last) in encoded {
+            let own = e.submission.take().or_else(|| submission.clone());
+            match catch_unwind(AssertUnwindSafe(|| scene.get().map_frames(e, own))) {
+                Ok(pending) => parts.push((scene, pending, ticket, last)),
+                Err(e) => self.fail(scene, &ticket, format!("frame readback failed: {}", panic_message(e))),
+            }
+        }
+        Submission { device, parts }
+    }
+
+    /// `job`'s device has fewer than `max_in_flight` submissions outstanding.
+    fn has_room(&self, busy: &HashMap<usize, usize>, job: &Job) -> bool {
+        busy.get(&job.scene.get().device_id()).map_or(true, |&n| n < self.max_in_flight)
+    }
+
+    /// Complete `ticket` with an error (once) and release this chunk's Scene reference.
+    fn fail(&self, scene: Arc<Py<Scene>>, ticket: &TicketState, msg: String) {
+        let first = {
+            let mut t = ticket.inner.lock().unwrap();
+            let first = t.error.is_none();
+            if first {
+                t.error = Some(msg);
+                t.pixels = Vec::new();
+                t.finished = Some(Instant::now());
+            }
+            first
+        };
+        ticket.cv.notify_all();
+        if first {
+            self.sched.lock().unwrap().stats.failed += 1;
+        }
+        Python::with_gil(|_| drop(scene));
+    }
+
+    fn completer(self: Arc<Self>) {
+        loop {
+            let submission = {
+                let mut q = self.done.lock().unwrap();
+                loop {
+                    if let Some(s) = q.pop_front() {
+                        break s;
+                    }
+                    let idle = {
+                        let st = self.sched.lock().unwrap();
+                        st.shutdown && st.pending.is_empty() && st.in_flight == 0
+                    };
+                    if idle {
+                        return;
+                    }
+                    q = self.done_cv.wait_timeout(q, Duration::from_millis(50)).unwrap().0;
+                }
+            };
+            let mut finished = Vec::new();
+            let device = submission.device;
+            for (scene, pending, ticket, last) in submission.parts {
+                let pixels = match catch_unwind(AssertUnwindSafe(|| scene.get().read_frames(pending))) {
+                    Ok(Ok(pixels)) => pixels,
+                    Ok(Err(e)) => {
+                        self.fail(scene, &ticket, e);
+                        continue;
+                    }
+                    Err(e) => {
+                        self.fail(scene, &ticket, format!("frame readback failed: {}", panic_message(e)));
+                        continue;
+                    }
+                };
+                let mut t = ticket.inner.lock().unwrap();
+                if t.error.is_none() {
+                    t.pixels.extend_from_slice(&pixels);
+                    if last {
+                        t.finished = Some(Instant::now());
+                        finished.push(ticket.clone());
+                    }
+                }
+                drop(t);
+                ticket.cv.notify_all();
+                Python::with_gil(|_| drop(scene));
+            }
+            let mut st = self.sched.lock().unwrap();
+            st.in_flight -= 1;
+            if let Some(n) = st.busy.get_mut(&device) {
+                *n -= 1;
+                if *n == 0 {
+                    st.busy.remove(&device);
+                }
+            }
+            for ticket in finished {
+                let t = ticket.inner.lock().unwrap();
+                let (queue_ms, exec_ms) = ticket.timings(&t);
+                st.stats.completed += 1;
+                if let (Some(deadline), Some(end)) = (ticket.deadline, t.finished) {
+                    if end > deadline {
+                        st.stats.deadline_misses += 1;
+                    }
+                }
+                let e = st.stats.by_priority.entry(ticket.priority).or_default();
+                e.0 += 1;
+                e.1 += queue_ms;
+                e.2 += exec_ms;
+            }
+            drop(st);
+            self.dispatch_cv.notify_one();
+        }
+    }
+}
+
+impl TicketState {
+    fn failed(&self) -> bool {
+        self.inner.lock().unwrap().error.is_some()
+    }
+    fn timings(&self, t: &TicketInner) -> (f64, f64) {
+        let ms = |d: Duration| d.as_secs_f64() * 1000.0;
+        match (t.started, t.finished) {
+            (Some(s), Some(f)) => (ms(s - self.enqueued), ms(f - s)),
+            (Some(s), None) => (ms(s - self.enqueued), ms(s.elapsed())),
+            _ => (ms(self.enqueued.elapsed()), 0.0),
+        }
+    }
+}
+
+impl Scene {
+    /// Jobs with equal keys can share one queue submission: same device, same target size,
+    /// same pipeline permutation.
+    fn batch_key(&self) -> (usize, u32, u32, u32) {
+        // Read through a poisoned lock: the dispatcher holds the scheduler lock here, and a
+        // broken Scene fails its own job when it is encoded.
+        let features = self.state.read().unwrap_or_else(|e| e.into_inner()).features;
+        (self.device_id(), self.width, self.height, features.0)
+    }
+
+    /// Identity of this Scene's device (shared by `shared_device=True` Scenes on one adapter).
+    fn device_id(&self) -> usize {
+        Arc::as_ptr(&self.device) as usize
+    }
+}
+
+#[pymethods]
+impl RenderScheduler {
+    #[new]
+    #[pyo3(signature = (max_in_flight=2, max_frames_per_submit=8))]
+    #[pyo3(text_signature = "(max_in_flight=2, max_frames_per_submit=8)")]
+    fn new(max_in_flight: usize, max_frames_per_submit: usize) -> PyResult<Self> {
+        if max_in_flight == 0 || max_frames_per_submit == 0 {
+            return Err(pyo3::exceptions::PyValueError::new_err("max_in_flight and max_frames_per_submit must be >= 1"));
+        }
+        let shared = Arc::new(Shared {
+            max_in_flight,
+            max_frames: max_frames_per_submit,
+            sched: Mutex::new(SchedState::default()),
+            dispatch_cv: Condvar::new(),
+            done: Mutex::new(VecDeque::new()),
+            done_cv: Condvar::new(),
+        });
+        for (name, f) in [("vf-sched-dispatch", Shared::dispatcher as fn(Arc<Shared>)), ("vf-sched-complete", Shared::completer)] {
+            let s = shared.clone();
+            std::thread::Builder::new()
+                .name(name.into())
+                .spawn(move || f(s))
+                .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+        }
+        Ok(Self { shared })
+    }
+
+    /// Queue a render. Higher `priority` runs first (e.g. 10 for interactive, 0 for bulk);
+    /// within a priority the earliest `deadline_ms` (relative to now) runs first.
+    #[pyo3(signature = (scene, views=None, priority=0, deadline_ms=None))]
+    #[pyo3(text_signature = "($self, scene, views=None, priority=0, deadline_ms=None)")]
+    fn submit(&self, scene: Bound<'_, Scene>, views: Option<numpy::PyReadonlyArray3<'_, f32>>, priority: i32, deadline_ms: Option<f64>)
+        -> PyResult<RenderTicket> {
+        let (frames, shape) = scene.get().frames_for(views.as_ref())?;
+        let enqueued = Instant::now();
+        let deadline = match deadline_ms {
+            Some(ms) if !(ms >= 0.0) || !ms.is_finite() => {
+                return Err(pyo3::exceptions::PyValueError::new_err("deadline_ms must be a finite value >= 0"));
+            }
+            Some(ms) => Some(enqueued + Duration::from_secs_f64(ms / 1000.0)),
+            None => None,
+        };
+        let ticket = Arc::new(TicketState {
+            shape, priority, deadline, enqueued,
+            inner: Mutex::new(TicketInner::default()),
+            cv: Condvar::new(),
+        });
+        {
+            let mut st = self.shared.sched.lock().unwrap();
+            if st.shutdown {
+                return Err(pyo3::exceptions::PyRuntimeError::new_err("scheduler is closed"));
+            }
+            let id = st.next_id;
+            st.next_id += 1;
+            st.stats.jobs += 1;
+            st.pending.push(Job { id, scene: Arc::new(scene.unbind()), frames: frames.into(), priority, deadline, ticket: ticket.clone() });
+        }
+        self.shared.dispatch_cv.notify_one();
+        Ok(RenderTicket { state: ticket })
+    }
+
+    /// `{jobs, completed, failed, pending, in_flight, submissions, jobs_per_submission,
+    /// deadline_misses, by_priority: {p: {jobs, queue_ms, exec_ms}}}` (ms are averages).
+    #[pyo3(text_signature = "($self)")]
+    fn stats(&self, py: Python<'_>) -> PyResult<PyObject> {
+        let st = self.shared.sched.lock().unwrap();
+        let d = PyDict::new(py);
+        d.set_item("jobs", st.stats.jobs)?;
+        d.set_item("completed", st.stats.completed)?;
+        d.set_item("failed", st.stats.failed)?;
+        d.set_item("pending", st.pending.len())?;
+        d.set_item("in_flight", st.in_flight)?;
+        d.set_item("submissions", st.stats.submissions)?;
+        d.set_item("jobs_per_submission",
+                   if st.stats.submissions > 0 { st.stats.chunks as f64 / st.stats.submissions as f64 } else { 0.0 })?;
+        d.set_item("deadline_misses", st.stats.deadline_misses)?;
+        let by = PyDict::new(py);
+        for (p, (n, q, e)) in &st.stats.by_priority {
+            let row = PyDict::new(py);
+            row.set_item("jobs", n)?;
+            row.set_item("queue_ms", q / *n as f64)?;
+            row.set_item("exec_ms", e / *n as f64)?;
+            by.set_item(p, row)?;
+        }
+        d.set_item("by_priority", by)?;
+        Ok(d.into_any().unbind())
+    }
+
+    /// Stop accepting jobs; queued and in-flight jobs still complete.
+    #[pyo3(text_signature = "($self)")]
+    fn close(&self) {
+        self.shared.sched.lock().unwrap().shutdown = true;
+        self.shared.dispatch_cv.notify_all();
+        self.shared.done_cv.notify_all();
+    }
+}
+
+impl Drop for RenderScheduler {
+    fn drop(&mut self) {
+        self.close();
+    }
+}
+
+#[pymethods]
+impl RenderTicket {
+    /// True once all frames of the job were read back, or the job failed.
+    #[pyo3(text_signature = "($self)")]
+    fn done(&self) -> bool {
+        self.state.inner.lock().unwrap().finished.is_some()
+    }
+
+    /// Wait (GIL released) and return the pixels: (H, W, 4), or (N, H, W, 4) for N views.
+    /// Raises `TimeoutError` if `timeout` seconds pass first, `RuntimeError` if the job failed.
+    #[pyo3(signature = (timeout=None))]
+    #[pyo3(text_signature = "($self, timeout=None)")]
+    fn result(&self, py: Python<'_>, timeout: Option<f64>) -> PyResult<PyObject> {
+        let st = &self.state;
+        let pixels = py.allow_threads(|| {
+            let until = timeout.map(|s| Instant::now() + Duration::from_secs_f64(s.max(0.0)));
+            let mut t = st.inner.lock().unwrap();
+            while t.finished.is_none() {
+                t = match until {
+                    Some(u) => {
+                        let now = Instant::now();
+                        if now >= u {
+                            return Err(());
+                        }
+                        st.cv.wait_timeout(t, u - now).unwrap().0
+                    }
+                    None => st.cv.wait(t).unwrap(),
+                };
+            }
+            if let Some(e) = &t.error {
+                return Ok(Err(e.clone()));
+            }
+            if t.taken {
+                return Ok(Err("ticket result was already taken".to_string()));
+            }
+            t.taken = true;
+            Ok(Ok(std::mem::take(&mut t.pixels)))
+        });
+        match pixels {
+            Err(()) => Err(pyo3::exceptions::PyTimeoutError::new_err("render job not finished")),
+            Ok(Err(msg)) => Err(pyo3::exceptions::PyRuntimeError::new_err(msg)),
+            Ok(Ok(p)) => to_array(py, p, &st.shape),
+        }
+    }
+
+    /// `{priority, queue_ms, exec_ms, chunks, batched_with, deadline_missed}`: queueing delay
+    /// vs GPU execution so far; `batched_with` is the average number of jobs per submission.
+    #[pyo3(text_signature = "($self)")]
+    fn timings(&self, py: Python<'_>) -> PyResult<PyObject> {
+        let t = self.state.inner.lock().unwrap();
+        let (queue_ms, exec_ms) = self.state.timings(&t);
+        let d = PyDict::new(py);
+        d.set_item("priority", self.state.priority)?;
+        d.set_item("queue_ms", queue_ms)?;
+        d.set_item("exec_ms", exec_ms)?;
+        d.set_item("chunks", t.chunks)?;
+        d.set_item("batched_with", if t.chunks > 0 { t.batched_with as f64 / t.chunks as f64 } else { 0.0 })?;
+        let missed = match (self.state.deadline, t.finished) {
+            (Some(dl), Some(end)) => Some(end > dl),
+            (Some(dl), None) if Instant::now() > dl => Some(true),
+            _ => None,
+        };
+        d.set_item("deadline_missed", missed)?;
+        Ok(d.into_any().unbind())
+    }
+}
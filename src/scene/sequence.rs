@@ -0,0 +1,247 @@
+//! Temporal DEM playback.
+//!
+//! `Scene.render_sequence` draws with a ring of R32F texture-array layers (HEIGHT_SEQ
+//! permutation) and plays a list of times over a DEM series. An uploader thread streams
+//! step `k` into layer `k % ring` as soon as no unsubmitted frame still needs the step it
+//! evicts, reading straight from the caller's (typically memmapped) arrays, while the render
+//! thread keeps `depth` frames in flight. Each frame carries `ring layer + blend` in the
+//! per-draw sequence slot (`_pad_tail.w` / `DrawPush.offset.w`), so fractional times are
+//! interpolated on the GPU between adjacent layers and the bind group is created once per call.
+//!
+//! The ring, its pipeline and groups 1 and 2 belong to the call: the Scene permutation and
+//! bind groups are never switched, so other renders on the Scene (from threads running while
+//! this one has the GIL released) keep drawing the Scene height. A finished call leaves its
+//! ring on the Scene for the next call of the same size.
+
+use std::collections::VecDeque;
+use std::sync::{Arc, Condvar, Mutex};
+use std::time::Instant;
+
+use crate::terrain::pipeline::TerrainPipeline;
+use crate::terrain::variants::ShaderFeatures;
+
+use super::{FrameDraws, Scene, TEXTURE_FORMAT};
+
+/// Texture-array ring of one `render_sequence` call, kept on the Scene between calls
+/// (reused while (w, h, layers) match).
+pub(super) struct HeightRing {
+    tex: wgpu::Texture,
+    view: wgpu::TextureView,
+    width: u32,
+    height: u32,
+    layers: u32,
+}
+
+/// HEIGHT_SEQ pipeline and groups 1 (the ring) and 2 of one call.
+struct SequenceDraw {
+    tp: Arc<TerrainPipeline>,
+    bg1: wgpu::BindGroup,
+    bg2: wgpu::BindGroup,
+}
+
+/// Timings of the last `render_sequence` call.
+#[derive(Debug, Clone, Copy, Default)]
+pub(super) struct SequenceStats {
+    pub steps_uploaded: usize,
+    pub upload_bytes: u64,
+    pub upload_ms: f64,
+    pub render_wait_ms: f64,
+    pub total_ms: f64,
+}
+
+#[derive(Default)]
+struct Progress {
+    /// Every needed step below `uploaded` has been written to its ring layer.
+    uploaded: usize,
+    /// Lowest step any unsubmitted frame still samples.
+    needed_from: usize,
+    /// One side has stopped (finished, failed or panicked): the other no longer waits for it.
+    stopped: bool,
+}
+
+/// Sets `Progress::stopped` and wakes the other side when dropped, unwinding included, so a
+/// panic on one side cannot leave the other waiting and the thread scope unjoined.
+struct StopOnDrop<'a>(&'a (Mutex<Progress>, Condvar));
+
+impl Drop for StopOnDrop<'_> {
+    fn drop(&mut self) {
+        let (lock, cv) = self.0;
+        lock.lock().unwrap_or_else(|e| e.into_inner()).stopped = true;
+        cv.notify_all();
+    }
+}
+
+/// (step a, step b, blend) per output time; `times` must be sorted and within `[0, steps - 1]`.
+pub(super) fn plan(times: &[f64], steps: usize) -> Result<Vec<(usize, usize, f32)>, String> {
+    let mut out = Vec::with_capacity(times.len());
+    let mut prev = f64::NEG_INFINITY;
+    for &t in times {
+        if !t.is_finite() || t < 0.0 || t > (steps - 1) as f64 {
+            return Err(format!("times must lie in [0, {}]", steps - 1));
+        }
+        if t < prev {
+            return Err("times must be non-decreasing (the ring streams forward)".to_string());
+        }
+        prev = t;
+        let a = (t.floor() as usize).min(steps - 1);
+        let b = (a + 1).min(steps - 1);
+        out.push((a, b, if b == a { 0.0 } else { (t - a as f64) as f32 }));
+    }
+    Ok(out)
+}
+
+impl Scene {
+    /// The spare ring if it is `w`×`h`×`layers`, else a new one.
+    fn take_height_ring(&self, w: u32, h: u32, layers: u32) -> HeightRing {
+        let spare = self.height_ring.lock().unwrap().take();
+        if let Some(ring) = spare.filter(|r| (r.width, r.height, r.layers) == (w, h, layers)) {
+            return ring;
+        }
+        let tex = self.device.create_texture(&wgpu::TextureDescriptor {
+            label: Some("scene-height-ring"),
+            size: wgpu::Extent3d { width: w, height: h, depth_or_array_layers: layers },
+            mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
+            format: wgpu::TextureFormat::R32Float,
+            usage: wgpu::TextureUsages::TEXTURE_BINDING | wgpu::TextureUsages::COPY_DST, view_formats: &[],
+        });
+        let view = tex.create_view(&wgpu::TextureViewDescriptor {
+            label: Some("scene-height-ring-view"),
+            dimension: Some(wgpu::TextureViewDimension::D2Array),
+            ..Default::default()
+        });
+        HeightRing { tex, view, width: w, height: h, layers }
+    }
+
+    /// The Scene permutation plus HEIGHT_SEQ, with the ring as group 1.
+    fn sequence_draw(&self, ring: &HeightRing) -> SequenceDraw {
+        // The flood overlay is sized for the Scene height, not the ring, so it is left out.
+        let tp = {
+            let mut st = self.state.write().unwrap();
+            let features = st.features.union(ShaderFeatures::HEIGHT_SEQ).without(ShaderFeatures::WATER);
+            st.pipelines.get_or_create(&self.device, TEXTURE_FORMAT, features)
+        };
+        let st = self.state.read().unwrap();
+        let bg1 = tp.make_bg_height(&self.device, &ring.view, st.height_sampler.as_ref().unwrap());
+        let bg2 = self.lut_group(&st, &tp);
+        drop(st);
+        SequenceDraw { tp, bg1, bg2 }
+    }
+
+    /// Render one frame per `plan` entry into `out` (N frames back to back), streaming the
+    /// `steps` (each `w`×`h` float32, row-major) through a `ring`-layer texture array. A failed
+    /// readback stops both the render loop and the uploader and is returned.
+    pub(super) fn render_sequence_into(&self, steps: &[&[f32]], w: u32, h: u32, plan: &[(usize, usize, f32)],
+                                       views: &[glam::Mat4], ring: u32, depth: usize, out: &mut [u8]) -> Result<SequenceStats, String> {
+        let t0 = Instant::now();
+        let height_ring = self.take_height_ring(w, h, ring);
+        let seq = self.sequence_draw(&height_ring);
+        let tex = &height_ring.tex;
+        // Only steps some frame samples are streamed, in increasing order.
+        let mut needed: Vec<usize> = plan.iter().flat_map(|p| [p.0, p.1]).collect();
+        needed.sort_unstable();
+        needed.dedup();
+        let progress = (Mutex::new(Progress::default()), Condvar::new());
+        let mut stats = SequenceStats::default();
+        let mut result = Ok(());
+        let frame = self.frame_len();
+
+        std::thread::scope(|s| {
+            let uploader = s.spawn(|| {
+                let _stop = StopOnDrop(&progress);
+                let (lock, cv) = &progress;
+                let (mut bytes, mut busy) = (0u64, 0.0f64);
+                for &k in &needed {
+                    {
+                        let mut p = lock.lock().unwrap();
+                        while k >= p.needed_from + ring as usize && !p.stopped {
+                            p = cv.wait(p).unwrap();
+                        }
+                        if p.stopped {
+                            break;
+                        }
+                    }
+                    let t = Instant::now();
+                    // Reading the step faults the caller's memmap in here, overlapped with rendering.
+                    let data: &[u8] = bytemuck::cast_slice(steps[k]);
+                    self.queue.write_texture(
+                        wgpu::ImageCopyTexture {
+                            texture: tex, mip_level: 0, aspect: wgpu::TextureAspect::All,
+                            origin: wgpu::Origin3d { x: 0, y: 0, z: k as u32 % ring },
+                        },
+                        data,
+                        wgpu::ImageDataLayout { offset: 0, bytes_per_row: Some(w * 4), rows_per_image: Some(h) },
+                        wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
+                    );
+                    busy += t.elapsed().as_secs_f64() * 1000.0;
+                    bytes += data.len() as u64;
+                    lock.lock().unwrap().uploaded = k + 1;
+                    cv.notify_all();
+                }
+                (bytes, busy)
+            });
+
+            let stop = StopOnDrop(&progress);
+            let (lock, cv) = &progress;
+            let mut in_flight: VecDeque<(super::PendingFrames, usize)> = VecDeque::with_capacity(depth);
+            let mut outs = out.chunks_exact_mut(frame).collect::<Vec<_>>().into_iter();
+            for (i, &(a, b, t)) in plan.iter().enumerate() {
+                let wait = Instant::now();
+                {
+                    let mut p = lock.lock().unwrap();
+                    p.needed_from = a;
+                    cv.notify_all();
+                    while p.uploaded <= b && !p.stopped {
+                        p = cv.wait(p).unwrap();
+                    }
+                    if p.uploaded <= b {
+                        result = Err("the height uploader stopped early".to_string());
+                        break;
+                    }
+                }
+                stats.render_wait_ms += wait.elapsed().as_secs_f64() * 1000.0;
+                let draw = FrameDraws { view: views[i], offsets: vec![[0.0; 3]], layer: (a as u32 % ring) as f32 + t };
+                in_flight.push_back((self.submit_frames_with(&[draw], Some((&*seq.tp, &seq.bg1, &seq.bg2))), i));
+                if in_flight.len() >= depth {
+                    let (pending, _) = in_flight.pop_front().unwrap();
+                    if let Err(e) = self.read_frames_into(pending, outs.next().unwrap()) {
+                        result = Err(e);
+                        break;
+                    }
+                }
+            }
+            while let Some((pending, _)) = in_flight.pop_front() {
+                if result.is_err() {
+                    self.discard_frames(pending);
+                } else if let Err(e) = self.read_frames_into(pending, outs.next().unwrap()) {
+                    result = Err(e);
+                }
+            }
+            drop(stop);
+            let (bytes, busy) = uploader.join().expect("height uploader panicked");
+            stats.upload_bytes = bytes;
+            stats.upload_ms = busy;
+        });
+        stats.steps_uploaded = needed.len();
+        *self.height_ring.lock().unwrap() = Some(height_ring);
+        stats.total_ms = t0.elapsed().as_secs_f64() * 1000.0;
+        result.map(|()| stats)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::plan;
+
+    #[test]
+    fn plan_blends_between_steps() {
+        let p = plan(&[0.0, 0.25, 1.0, 2.0], 3).unwrap();
+        assert_eq!(p, vec![(0, 1, 0.0), (0, 1, 0.25), (1, 2, 0.0), (2, 2, 0.0)]);
+    }
+
+    #[test]
+    fn plan_rejects_backwards_or_out_of_range() {
+        assert!(plan(&[1.0, 0.5], 3).is_err());
+        assert!(plan(&[3.5], 3).is_err());
+        assert!(plan(&[f64::NAN], 3).is_err());
+    }
+}
@@ -0,0 +1,287 @@
+//! Temporal reprojection of `render_rgba` / `render_png` frames (`Scene.set_temporal`).
+//!
+//! While enabled, Scene-camera renders draw with the TEMPORAL permutation into a ping-pong
+//! pair of colour + linear-depth targets owned by this module. The history is the last
+//! frame rendered in full (the key frame), never a frame that itself reused pixels: each
+//! carried-over pixel is one whole-pixel reprojection away from a shaded one, so rounding
+//! does not accumulate and a slow pan cannot freeze the image. When the key frame was
+//! rendered with the same permutation, bound content and uniforms (camera aside) and the
+//! camera moved by at most `max_motion` of the viewport since, `terrain::temporal` carries
+//! its pixels over and the terrain draw only shades what was disoccluded or newly in view;
+//! otherwise the frame is rendered in full and becomes the next key frame. Reused frames
+//! are drawn into the other target, which the next frame overwrites. Content changes are tracked by
+//! `Scene::generation`, bumped whenever the bind groups are rebuilt or a bound texture is
+//! written in place. Temporal frames are depth-tested, which the plain render path is not.
+//!
+//! Temporal renders serialise on `Scene::temporal`; other render calls are unaffected.
+
+use std::sync::atomic::Ordering;
+use std::sync::Arc;
+
+use crate::terrain::pipeline::{TerrainPipeline, DATASET_ZBUFFER_FORMAT, TEMPORAL_DEPTH_FORMAT};
+use crate::terrain::temporal::{screen_motion, TemporalGpu, TemporalParams};
+use crate::terrain::variants::ShaderFeatures;
+
+use super::{Scene, TEXTURE_FORMAT};
+
+/// Counters since the last `set_temporal`.
+#[derive(Debug, Default, Clone, Copy)]
+pub(super) struct TemporalStats {
+    pub frames: u64,
+    /// Frames rendered without reuse (no history, content change or too much motion).
+    pub full_frames: u64,
+    /// Fraction of pixels carried over in the last frame.
+    pub reused_fraction: f64,
+    pub reused_sum: f64,
+    /// Screen motion of the last frame against the key frame (`None`: no comparable history).
+    pub motion: Option<f32>,
+    /// Frames since the key frame (0 when the last frame was rendered in full).
+    pub history_age: u64,
+}
+
+/// TEMPORAL pipeline and its bind groups for one Scene permutation and content generation.
+struct TemporalDraw {
+    features: ShaderFeatures,
+    generation: u64,
+    tp: Arc<TerrainPipeline>,
+    bg0: wgpu::BindGroup,
+    bg1: wgpu::BindGroup,
+    bg2: wgpu::BindGroup,
+}
+
+/// What the key frame (the last full frame) was rendered with.
+struct History {
+    features: ShaderFeatures,
+    generation: u64,
+    /// Uniform bytes with the view zeroed (sun, exposure, projection, spacing).
+    uniforms: Vec<u8>,
+    view: glam::Mat4,
+}
+
+/// Ping-pong targets, reprojection buffers and history of the temporal path.
+pub(super) struct TemporalState {
+    gpu: TemporalGpu,
+    pub(super) max_motion: f32,
+    pub(super) depth_tolerance: f32,
+    color: [wgpu::Texture; 2],
+    color_views: [wgpu::TextureView; 2],
+    depth_views: [wgpu::TextureView; 2],
+    zbuffer: wgpu::TextureView,
+    /// Per-pixel nearest key and winning source (+1) of the reprojection, and the reuse count.
+    keys: wgpu::Buffer,
+    src: wgpu::Buffer,
+    counter: wgpu::Buffer,
+    params: wgpu::Buffer,
+    ubo: wgpu::Buffer,
+    /// Padded colour frame followed by the counter.
+    readback: wgpu::Buffer,
+    /// `bgs[i]` / `prime_bgs[i]` read history index `i`.
+    bgs: [wgpu::BindGroup; 2],
+    prime_bgs: [wgpu::BindGroup; 2],
+    empty: wgpu::BindGroup,
+    /// Target index of the next frame (the key frame is the other one).
+    cur: usize,
+    draw: Option<TemporalDraw>,
+    history: Option<History>,
+    pub(super) stats: TemporalStats,
+}
+
+impl Scene {
+    /// Enable (or reconfigure) the temporal path, or drop it. Stats are reset either way.
+    pub(super) fn set_temporal_state(&self, enabled: bool, max_motion: f32, depth_tolerance: f32) -> Result<(), String> {
+        if !(max_motion >= 0.0) {
+            return Err("max_motion must be >= 0".to_string());
+        }
+        if !(depth_tolerance > 0.0 && depth_tolerance < 1.0) {
+            return Err("depth_tolerance must be in (0, 1)".to_string());
+        }
+        let mut t = self.temporal.lock().unwrap();
+        if !enabled {
+            *t = None;
+            return Ok(());
+        }
+        let state = t.get_or_insert_with(|| self.new_temporal_state());
+        state.max_motion = max_motion;
+        state.depth_tolerance = depth_tolerance;
+        state.stats = TemporalStats::default();
+        Ok(())
+    }
+
+    fn new_temporal_state(&self) -> TemporalState {
+        let (w, h) = (self.width, self.height);
+        let target = |label, format, usage| self.device.create_texture(&wgpu::TextureDescriptor {
+            label: Some(label),
+            size: wgpu::Extent3d { width: w, height: h, depth_or_array_layers: 1 },
+            mip_level_count: 1, sample_count: 1, dimension: wgpu::TextureDimension::D2,
+            format, usage, view_formats: &[],
+        });
+        let attach = wgpu::TextureUsages::RENDER_ATTACHMENT | wgpu::TextureUsages::TEXTURE_BINDING;
+        let color = [0, 1].map(|_| target("scene-temporal-color", TEXTURE_FORMAT, attach | wgpu::TextureUsages::COPY_SRC));
+        let color_views = [0, 1].map(|i| color[i].create_view(&Default::default()));
+        let depth_views = [0, 1].map(|_| target("scene-temporal-depth", TEMPORAL_DEPTH_FORMAT, attach).create_view(&Default::default()));
+        let zbuffer = target("scene-temporal-zbuffer", DATASET_ZBUFFER_FORMAT, wgpu::TextureUsages::RENDER_ATTACHMENT)
+            .create_view(&Default::default());
+        let buffer = |label, size, usage| self.device.create_buffer(&wgpu::BufferDescriptor {
+            label: Some(label), size, usage, mapped_at_creation: false,
+        });
+        let px = w as u64 * h as u64 * 4;
+        let storage = wgpu::BufferUsages::STORAGE | wgpu::BufferUsages::COPY_DST;
+        let keys = buffer("scene-temporal-keys", px, storage);
+        let src = buffer("scene-temporal-src", px, storage);
+        let counter = buffer("scene-temporal-counter", 4, storage | wgpu::BufferUsages::COPY_SRC);
+        let uniform = wgpu::BufferUsages::UNIFORM | wgpu::BufferUsages::COPY_DST;
+        let params = buffer("scene-temporal-params", std::mem::size_of::<TemporalParams>() as u64, uniform);
+        let ubo = buffer("scene-temporal-ubo", std::mem::size_of::<crate::terrain::TerrainUniforms>() as u64, uniform);
+        let readback = buffer("scene-temporal-readback", self.temporal_frame_bytes() + 4,
+                              wgpu::BufferUsages::COPY_DST | wgpu::BufferUsages::MAP_READ);
+        let gpu = TemporalGpu::new(&self.device, TEXTURE_FORMAT);
+        let bgs = [0, 1].map(|i| gpu.bind(&self.device, &params, &depth_views[i], &keys, &src, &counter));
+        let prime_bgs = [0, 1].map(|i| gpu.bind_prime(&self.device, &color_views[i], &keys, &src));
+        let empty = gpu.bind_empty(&self.device);
+        TemporalState {
+            gpu, max_motion: 0.1, depth_tolerance: 0.02,
+            color, color_views, depth_views, zbuffer,
+            keys, src, counter, params, ubo, readback, bgs, prime_bgs, empty,
+            cur: 0, draw: None, history: None, stats: TemporalStats::default(),
+        }
+    }
+
+    /// Padded bytes per row and per frame of the colour readback.
+    fn temporal_frame_bytes(&self) -> u64 {
+        let align = wgpu::COPY_BYTES_PER_ROW_ALIGNMENT;
+        let padded = (self.width * 4 + align - 1) / align * align;
+        padded as u64 * self.height as u64
+    }
+
+    /// Render the Scene camera through the temporal path, or `None` when it is disabled.
+    pub(super) fn render_temporal(&self) -> Result<Option<Vec<u8>>, String> {
+        let mut guard = self.temporal.lock().unwrap();
+        let Some(t) = guard.as_mut() else { return Ok(None) };
+        let generation = self.generation.load(Ordering::Acquire);
+        self.update_temporal_draw(t, generation);
+
+        let st = self.state.read().unwrap();
+        let mut u = st.last_uniforms;
+        u.view = st.scene.view.to_cols_array_2d();
+        let (view, proj) = (st.scene.view, st.scene.proj);
+        drop(st);
+        let mut keyed = u;
+        keyed.view = [[0.0; 4]; 4];
+        let uniforms = bytemuck::bytes_of(&keyed).to_vec();
+        let d = t.draw.as_ref().unwrap();
+
+        // Reuse only when nothing but the camera changed since the key frame.
+        let samples = motion_samples(u.spacing_h_exag_pad[0]);
+        let motion = t.history.as_ref()
+            .filter(|h| h.features == d.features && h.generation == generation && h.uniforms == uniforms)
+            .map(|h| (h.view, screen_motion(proj * h.view, proj * view, &samples)));
+        let reuse = motion.filter(|&(_, m)| m <= t.max_motion).map(|(v, _)| v);
+
+        let (cur, hist) = (t.cur, 1 - t.cur);
+        self.queue.write_buffer(&t.ubo, 0, bytemuck::bytes_of(&u));
+        let mut encoder = self.device.create_command_encoder(&wgpu::CommandEncoderDescriptor { label: Some("scene-temporal") });
+        encoder.clear_buffer(&t.counter, 0, None);
+        if let Some(v0) = reuse {
+            let p = TemporalParams::new(v0, view, proj, self.width, self.height, t.depth_tolerance);
+            self.queue.write_buffer(&t.params, 0, bytemuck::bytes_of(&p));
+            encoder.clear_buffer(&t.keys, 0, None);
+            encoder.clear_buffer(&t.src, 0, None);
+            t.gpu.encode_reproject(&mut encoder, &t.bgs[hist], &p);
+        }
+        {
+            let mut rp = encoder.begin_render_pass(&wgpu::RenderPassDescriptor {
+                label: Some("scene-temporal-rp"),
+                color_attachments: &[
+                    Some(wgpu::RenderPassColorAttachment {
+                        view: &t.color_views[cur], resolve_target: None,
+                        ops: wgpu::Operations { load: wgpu::LoadOp::Clear(wgpu::Color { r: 0.02, g: 0.02, b: 0.03, a: 1.0 }), store: wgpu::StoreOp::Store },
+                    }),
+                    Some(wgpu::RenderPassColorAttachment {
+                        view: &t.depth_views[cur], resolve_target: None,
+                        ops: wgpu::Operations { load: wgpu::LoadOp::Clear(wgpu::Color::TRANSPARENT), store: wgpu::StoreOp::Store },
+                    }),
+                ],
+                depth_stencil_attachment: Some(wgpu::RenderPassDepthStencilAttachment {
+                    view: &t.zbuffer,
+                    depth_ops: Some(wgpu::Operations { load: wgpu::LoadOp::Clear(1.0), store: wgpu::StoreOp::Discard }),
+                    stencil_ops: None,
+                }),
+                ..Default::default()
+            });
+            if reuse.is_some() {
+                // z = 0 on every carried-over pixel: the terrain draw below skips them.
+                t.gpu.draw_prime(&mut rp, &t.empty, &t.prime_bgs[hist]);
+            }
+            rp.set_pipeline(&d.tp.pipeline);
+            rp.set_bind_group(0, &d.bg0, &[]);
+            rp.set_bind_group(1, &d.bg1, &[]);
+            rp.set_bind_group(2, &d.bg2, &[]);
+            rp.set_vertex_buffer(0, self.vbuf.slice(..));
+            rp.set_index_buffer(self.ibuf.slice(..), wgpu::IndexFormat::Uint32);
+            if self.caps.push_constants() {
+                let p = crate::terrain::DrawPush::from_uniforms(&u, [0.0; 3]);
+                rp.set_push_constants(wgpu::ShaderStages::VERTEX_FRAGMENT, 0, bytemuck::bytes_of(&p));
+            }
+            rp.draw_indexed(0..self.nidx, 0, 0..1);
+        }
+        let frame_bytes = self.temporal_frame_bytes();
+        let padded = (frame_bytes / self.height as u64) as u32;
+        encoder.copy_texture_to_buffer(
+            wgpu::ImageCopyTexture { texture: &t.color[cur], mip_level: 0, origin: wgpu::Origin3d::ZERO, aspect: wgpu::TextureAspect::All },
+            wgpu::ImageCopyBuffer { buffer: &t.readback, layout: wgpu::ImageDataLayout {
+                offset: 0, bytes_per_row: Some(padded), rows_per_image: Some(self.height),
+            }},
+            wgpu::Extent3d { width: self.width, height: self.height, depth_or_array_layers: 1 },
+        );
+        encoder.copy_buffer_to_buffer(&t.counter, 0, &t.readback, frame_bytes, 4);
+        let submission = self.queue.submit(Some(encoder.finish()));
+        let bytes = self.map_staging(&t.readback, submission)?;
+
+        let row = self.width as usize * 4;
+        let mut pixels = Vec::with_capacity(self.frame_len());
+        for y in 0..self.height as usize {
+            let s = y * padded as usize;
+            pixels.extend_from_slice(&bytes[s..s + row]);
+        }
+        let reused = bytemuck::pod_read_unaligned::<u32>(&bytes[frame_bytes as usize..frame_bytes as usize + 4]);
+        let fraction = reused as f64 / (self.width as f64 * self.height as f64);
+        let s = &mut t.stats;
+        s.frames += 1;
+        s.full_frames += reuse.is_none() as u64;
+        s.reused_fraction = fraction;
+        s.reused_sum += fraction;
+        s.motion = motion.map(|(_, m)| m);
+        if reuse.is_some() {
+            // Keep reprojecting from the key frame; the next frame overwrites this target.
+            s.history_age += 1;
+        } else {
+            s.history_age = 0;
+            t.history = Some(History { features: d.features, generation, uniforms, view });
+            t.cur = hist;
+        }
+        Ok(Some(pixels))
+    }
+
+    /// Rebuild the TEMPORAL pipeline and groups when the Scene permutation or content changed.
+    fn update_temporal_draw(&self, t: &mut TemporalState, generation: u64) {
+        let features = self.state.read().unwrap().features;
+        if t.draw.as_ref().map_or(false, |d| d.features == features && d.generation == generation) {
+            return;
+        }
+        let (features, tp) = {
+            let mut st = self.state.write().unwrap();
+            let features = st.features;
+            (features, st.pipelines.get_or_create(&self.device, TEXTURE_FORMAT, features.union(ShaderFeatures::TEMPORAL)))
+        };
+        let st = self.state.read().unwrap();
+        let (bg1, bg2) = self.height_lut_groups(&st, &tp);
+        let bg0 = tp.make_bg_globals(&self.device, &t.ubo);
+        t.draw = Some(TemporalDraw { features, generation, tp, bg0, bg1, bg2 });
+    }
+}
+
+/// World points spread over the terrain plane for the motion estimate (5 × 5 at height 0).
+fn motion_samples(spacing: f32) -> Vec<glam::Vec3> {
+    let s = 1.5 * spacing;
+    (0..25).map(|i| glam::Vec3::new(-s + (i % 5) as f32 * s * 0.5, 0.0, -s + (i / 5) as f32 * s * 0.5)).collect()
+}
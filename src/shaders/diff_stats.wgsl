@@ -0,0 +1,112 @@
+// DEM difference statistics — GPU twin of src/terrain/diff.rs::stats_cpu (keep the binning in sync).
+// One invocation per texel of d = a - b. Each 16×16 workgroup accumulates a shared-memory
+// histogram and tree-reduces fill/cut/min/max into one `Partial`; the host sums the partials.
+
+struct Params {
+  size : vec2<u32>,
+  bins : u32,        // <= 256
+  _p0  : u32,
+  lo   : f32,        // histogram range; the last bin includes hi (as numpy.histogram)
+  hi   : f32,
+  _p1 : f32, _p2 : f32,   // pad to 32 B
+};
+
+struct Partial {
+  fill       : f32,   // sum of d > 0
+  cut        : f32,   // sum of -d for d < 0
+  lo         : f32,
+  hi         : f32,
+  fill_cells : u32,
+  cut_cells  : u32,
+  valid      : u32,   // texels where neither epoch is NaN
+  _p         : u32,
+};
+
+@group(0) @binding(0) var a_tex : texture_2d<f32>;
+@group(0) @binding(1) var b_tex : texture_2d<f32>;
+@group(0) @binding(2) var<uniform> P : Params;
+@group(0) @binding(3) var<storage, read_write> hist : array<atomic<u32>>;    // [below lo, bins..., above hi]
+@group(0) @binding(4) var<storage, read_write> partials : array<Partial>;   // one per workgroup
+
+const WG : u32 = 256u;
+
+var<workgroup> wg_hist : array<atomic<u32>, 258>;
+var<workgroup> s_fill : array<f32, 256>;
+var<workgroup> s_cut : array<f32, 256>;
+var<workgroup> s_lo : array<f32, 256>;
+var<workgroup> s_hi : array<f32, 256>;
+var<workgroup> n_fill : atomic<u32>;
+var<workgroup> n_cut : atomic<u32>;
+var<workgroup> n_valid : atomic<u32>;
+
+fn bin_index(d: f32) -> u32 {
+  if (d < P.lo) { return 0u; }
+  if (d > P.hi) { return P.bins + 1u; }
+  let k = u32(max((d - P.lo) / max(P.hi - P.lo, 1e-30) * f32(P.bins), 0.0));
+  return 1u + min(k, P.bins - 1u);
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_main(@builtin(global_invocation_id) gid : vec3<u32>,
+           @builtin(local_invocation_index) li : u32,
+           @builtin(workgroup_id) wid : vec3<u32>,
+           @builtin(num_workgroups) nwg : vec3<u32>) {
+  for (var i = li; i < P.bins + 2u; i = i + WG) {
+    atomicStore(&wg_hist[i], 0u);
+  }
+  if (li == 0u) {
+    atomicStore(&n_fill, 0u);
+    atomicStore(&n_cut, 0u);
+    atomicStore(&n_valid, 0u);
+  }
+  workgroupBarrier();
+
+  var fill = 0.0;
+  var cut = 0.0;
+  var lo = 3.4e38;
+  var hi = -3.4e38;
+  if (gid.x < P.size.x && gid.y < P.size.y) {
+    let p = vec2<i32>(gid.xy);
+    let d = textureLoad(a_tex, p, 0).r - textureLoad(b_tex, p, 0).r;
+    // Bit test instead of d != d: fast-math compilers may fold the self-comparison away.
+    if ((bitcast<u32>(d) & 0x7fffffffu) <= 0x7f800000u) {
+      lo = d;
+      hi = d;
+      atomicAdd(&n_valid, 1u);
+      if (d > 0.0) {
+        fill = d;
+        atomicAdd(&n_fill, 1u);
+      } else if (d < 0.0) {
+        cut = -d;
+        atomicAdd(&n_cut, 1u);
+      }
+      atomicAdd(&wg_hist[bin_index(d)], 1u);
+    }
+  }
+  s_fill[li] = fill;
+  s_cut[li] = cut;
+  s_lo[li] = lo;
+  s_hi[li] = hi;
+  workgroupBarrier();
+
+  for (var s = WG / 2u; s > 0u; s = s >> 1u) {
+    if (li < s) {
+      s_fill[li] = s_fill[li] + s_fill[li + s];
+      s_cut[li] = s_cut[li] + s_cut[li + s];
+      s_lo[li] = min(s_lo[li], s_lo[li + s]);
+      s_hi[li] = max(s_hi[li], s_hi[li + s]);
+    }
+    workgroupBarrier();
+  }
+
+  if (li == 0u) {
+    partials[wid.y * nwg.x + wid.x] = Partial(s_fill[0], s_cut[0], s_lo[0], s_hi[0],
+                                              atomicLoad(&n_fill), atomicLoad(&n_cut), atomicLoad(&n_valid), 0u);
+  }
+  for (var i = li; i < P.bins + 2u; i = i + WG) {
+    let c = atomicLoad(&wg_hist[i]);
+    if (c > 0u) {
+      atomicAdd(&hist[i], c);
+    }
+  }
+}
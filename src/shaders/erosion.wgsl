@@ -0,0 +1,259 @@
+// Hydraulic (pipe model) + thermal erosion — GPU twin of src/terrain/erosion.rs (keep the
+// pass order and f32 arithmetic in sync with ErosionCpu).
+// Every pass reads `src` and writes the whole cell to `dst`; the host swaps the two buffers
+// between passes, so a pass never sees a neighbour's half-written state.
+//   cs_init      height texture -> dst (terrain only)
+//   cs_flux      rain + pipe outflow flux
+//   cs_erode     water depth, velocity, dissolve / deposit
+//   cs_transport semi-Lagrangian sediment advection + evaporation
+//   cs_talus     thermal outflow rate
+//   cs_slide     thermal exchange (mass conserving)
+//   cs_store     src terrain -> height target
+
+struct Params {
+  size        : vec2<u32>,
+  dt          : f32,
+  cell        : f32,
+  rain        : f32,
+  evaporation : f32,
+  capacity    : f32,
+  dissolve    : f32,
+  deposit     : f32,
+  talus       : f32,
+  thermal     : f32,
+  gravity     : f32,
+};
+
+struct Cell {
+  h    : f32,
+  w    : f32,
+  s    : f32,
+  rate : f32,
+  flux : vec4<f32>,   // left, right, top (row - 1), bottom (row + 1)
+  vel  : vec2<f32>,   // cells per unit time
+  _pad : vec2<f32>,
+};
+
+@group(0) @binding(0) var<uniform> P : Params;
+@group(0) @binding(1) var<storage, read> src : array<Cell>;
+@group(0) @binding(2) var<storage, read_write> dst : array<Cell>;
+@group(0) @binding(3) var height_tex : texture_2d<f32>;
+@group(0) @binding(4) var height_out : texture_storage_2d<r32float, write>;
+
+const SQRT_2 : f32 = 1.4142135;
+
+fn idx(p: vec2<i32>) -> u32 {
+  return u32(p.y) * P.size.x + u32(p.x);
+}
+
+fn inside(p: vec2<i32>) -> bool {
+  return p.x >= 0 && p.y >= 0 && p.x < i32(P.size.x) && p.y < i32(P.size.y);
+}
+
+// Bit test: `v != v` may be folded away by backends that assume no NaNs.
+fn is_nan(v: f32) -> bool {
+  return (bitcast<u32>(v) & 0x7fffffffu) > 0x7f800000u;
+}
+
+// Neighbour exists and is not a wall.
+fn is_open(p: vec2<i32>) -> bool {
+  return inside(p) && !is_nan(src[idx(p)].h);
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_init(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  var c : Cell;
+  c.h = textureLoad(height_tex, p, 0).r;
+  dst[idx(p)] = c;
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_flux(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  var c = src[idx(p)];
+  if (is_nan(c.h)) {
+    c.flux = vec4<f32>(0.0);
+    dst[idx(p)] = c;
+    return;
+  }
+  c.w = c.w + P.dt * P.rain;
+  let surface = c.h + c.w;
+  var f = vec4<f32>(0.0);
+  var pipes = array<vec2<i32>, 4>(vec2<i32>(-1, 0), vec2<i32>(1, 0), vec2<i32>(0, -1), vec2<i32>(0, 1));
+  for (var k = 0; k < 4; k++) {
+    let q = p + pipes[k];
+    if (is_open(q)) {
+      let n = src[idx(q)];
+      let dh = surface - (n.h + (n.w + P.dt * P.rain));
+      f[k] = max(c.flux[k] + P.dt * P.gravity * P.cell * dh, 0.0);
+    }
+  }
+  let total = f.x + f.y + f.z + f.w;
+  if (total > 0.0) {
+    f = f * min(c.w * P.cell * P.cell / (total * P.dt), 1.0);
+  }
+  c.flux = f;
+  dst[idx(p)] = c;
+}
+
+// Flux of neighbour `q` through its pipe `k` (0 for edges and walls).
+fn flux_of(q: vec2<i32>, k: i32) -> f32 {
+  if (!is_open(q)) { return 0.0; }
+  return src[idx(q)].flux[k];
+}
+
+// Terrain height of `q`, or `fallback` for edges and walls.
+fn height_or(q: vec2<i32>, fallback: f32) -> f32 {
+  if (!is_open(q)) { return fallback; }
+  return src[idx(q)].h;
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_erode(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  var c = src[idx(p)];
+  if (is_nan(c.h)) {
+    dst[idx(p)] = c;
+    return;
+  }
+  let from_l = flux_of(p + vec2<i32>(-1, 0), 1);
+  let from_r = flux_of(p + vec2<i32>(1, 0), 0);
+  let from_t = flux_of(p + vec2<i32>(0, -1), 3);
+  let from_b = flux_of(p + vec2<i32>(0, 1), 2);
+  let inflow = from_l + from_r + from_t + from_b;
+  let outflow = c.flux.x + c.flux.y + c.flux.z + c.flux.w;
+  let w2 = max(c.w + P.dt * (inflow - outflow) / (P.cell * P.cell), 0.0);
+  let mean = 0.5 * (c.w + w2);
+  let wx = 0.5 * (from_l - c.flux.x + c.flux.y - from_r);
+  let wy = 0.5 * (from_t - c.flux.z + c.flux.w - from_b);
+  let to_cells = P.cell * P.cell * mean;
+  c.vel = select(vec2<f32>(0.0), vec2<f32>(wx / to_cells, wy / to_cells), mean > 1e-6);
+  c.w = w2;
+
+  let gx = (height_or(p + vec2<i32>(1, 0), c.h) - height_or(p + vec2<i32>(-1, 0), c.h)) / (2.0 * P.cell);
+  let gy = (height_or(p + vec2<i32>(0, 1), c.h) - height_or(p + vec2<i32>(0, -1), c.h)) / (2.0 * P.cell);
+  let g2 = gx * gx + gy * gy;
+  let sin_tilt = max(sqrt(g2 / (1.0 + g2)), 0.01);
+  let speed = sqrt(c.vel.x * c.vel.x + c.vel.y * c.vel.y) * P.cell;
+  // Sheet flow thinner than a texel carries proportionally less.
+  let capacity = P.capacity * sin_tilt * speed * min(w2 / P.cell, 1.0);
+  if (capacity > c.s) {
+    let a = P.dt * P.dissolve * (capacity - c.s);
+    c.h = c.h - a;
+    c.s = c.s + a;
+  } else {
+    let a = P.dt * P.deposit * (c.s - capacity);
+    c.h = c.h + a;
+    c.s = c.s - a;
+  }
+  dst[idx(p)] = c;
+}
+
+// (dx, dy, distance in texels) of the 8 thermal neighbours.
+fn neighbours() -> array<vec3<f32>, 8> {
+  return array<vec3<f32>, 8>(
+    vec3<f32>(-1.0, 0.0, 1.0), vec3<f32>(1.0, 0.0, 1.0), vec3<f32>(0.0, -1.0, 1.0), vec3<f32>(0.0, 1.0, 1.0),
+    vec3<f32>(-1.0, -1.0, SQRT_2), vec3<f32>(1.0, -1.0, SQRT_2), vec3<f32>(-1.0, 1.0, SQRT_2), vec3<f32>(1.0, 1.0, SQRT_2));
+}
+
+fn sediment_at(x: u32, y: u32) -> f32 {
+  let n = src[y * P.size.x + x];
+  return select(n.s, 0.0, is_nan(n.h));
+}
+
+fn lerp(a: f32, b: f32, t: f32) -> f32 {
+  return a * (1.0 - t) + b * t;
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_transport(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  var c = src[idx(p)];
+  if (is_nan(c.h)) {
+    dst[idx(p)] = c;
+    return;
+  }
+  let last = vec2<f32>(P.size - vec2<u32>(1u, 1u));
+  let px = clamp(f32(p.x) - c.vel.x * P.dt, 0.0, last.x);
+  let py = clamp(f32(p.y) - c.vel.y * P.dt, 0.0, last.y);
+  let x0f = floor(px);
+  let y0f = floor(py);
+  let fx = px - x0f;
+  let fy = py - y0f;
+  let x0 = u32(x0f);
+  let y0 = u32(y0f);
+  let x1 = min(x0 + 1u, P.size.x - 1u);
+  let y1 = min(y0 + 1u, P.size.y - 1u);
+  c.s = lerp(lerp(sediment_at(x0, y0), sediment_at(x1, y0), fx), lerp(sediment_at(x0, y1), sediment_at(x1, y1), fx), fy);
+  c.w = max(c.w * (1.0 - P.evaporation * P.dt), 0.0);
+  dst[idx(p)] = c;
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_talus(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  var c = src[idx(p)];
+  c.rate = 0.0;
+  if (is_nan(c.h)) {
+    dst[idx(p)] = c;
+    return;
+  }
+  var sum = 0.0;
+  var mx = 0.0;
+  var nb = neighbours();
+  for (var k = 0; k < 8; k++) {
+    let q = p + vec2<i32>(nb[k].xy);
+    if (is_open(q)) {
+      let d = c.h - src[idx(q)].h;
+      if (d > P.talus * nb[k].z * P.cell) {
+        sum = sum + d;
+        mx = max(mx, d);
+      }
+    }
+  }
+  if (sum > 0.0) {
+    c.rate = min(P.dt * P.thermal, 1.0) * 0.5 * mx / sum;
+  }
+  dst[idx(p)] = c;
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_slide(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  var c = src[idx(p)];
+  if (is_nan(c.h)) {
+    dst[idx(p)] = c;
+    return;
+  }
+  var h = c.h;
+  var nb = neighbours();
+  for (var k = 0; k < 8; k++) {
+    let q = p + vec2<i32>(nb[k].xy);
+    if (is_open(q)) {
+      let n = src[idx(q)];
+      let d = c.h - n.h;
+      let t = P.talus * nb[k].z * P.cell;
+      if (d > t) {
+        h = h - c.rate * d;
+      } else if (-d > t) {
+        h = h + n.rate * -d;
+      }
+    }
+  }
+  c.h = h;
+  dst[idx(p)] = c;
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_store(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  textureStore(height_out, p, vec4<f32>(src[idx(p)].h, 0.0, 0.0, 0.0));
+}
@@ -0,0 +1,154 @@
+// Flood-inundation kernels — GPU twin of src/terrain/flood.rs (keep the connectivity in sync).
+// `field` holds one order-preserving u32 key per texel so both propagations are atomic max/min:
+//   mode 0: water surface W — seeds start at their level, W flows to a 4-neighbour whose ground is below it;
+//   mode 1: spill level S — the lowest water level that connects a texel to any seed (minimax path height).
+// Relaxation is monotone, so racing workgroups only speed up convergence; the host repeats
+// `cs_relax` until `counters[0]` stays 0, then `cs_depth` writes water depth for the overlay.
+
+struct Params {
+  size  : vec2<u32>,
+  mode  : u32,       // 0 = water surface, 1 = spill levels
+  seeds : u32,
+  level : f32,       // cs_depth in mode 1
+  _p0 : f32, _p1 : f32, _p2 : f32,   // pad to 32 B
+};
+
+struct Seed {
+  x : u32,
+  y : u32,
+  level : f32,       // mode 0 only
+  _p : f32,
+};
+
+@group(0) @binding(0) var height_tex : texture_2d<f32>;
+@group(0) @binding(1) var<uniform> P : Params;
+@group(0) @binding(2) var<storage, read_write> field : array<atomic<u32>>;
+@group(0) @binding(3) var<storage, read> seeds : array<Seed>;
+@group(0) @binding(4) var<storage, read_write> counters : array<atomic<u32>>;   // [changed, wet cells]
+@group(0) @binding(5) var water_out : texture_storage_2d<r32float, write>;
+
+// Relaxation steps per dispatch; storage barriers let a front cross a whole tile in one dispatch.
+const LOCAL_ITERS : u32 = 16u;
+const KEY_NONE : u32 = 0u;            // mode 0: dry
+const KEY_UNREACHED : u32 = 0xffffffffu;  // mode 1: no seed connects
+
+// Order-preserving float -> u32 (and back), as terrain::flood::key / unkey.
+fn key(f: f32) -> u32 {
+  let b = bitcast<u32>(f);
+  return select(b | 0x80000000u, ~b, (b & 0x80000000u) != 0u);
+}
+
+fn unkey(k: u32) -> f32 {
+  return bitcast<f32>(select(~k, k & 0x7fffffffu, (k & 0x80000000u) != 0u));
+}
+
+fn is_nan(f: f32) -> bool {
+  return (bitcast<u32>(f) & 0x7fffffffu) > 0x7f800000u;
+}
+
+fn ground(p: vec2<u32>) -> f32 {
+  return textureLoad(height_tex, vec2<i32>(p), 0).r;
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_init(@builtin(global_invocation_id) gid : vec3<u32>) {
+  if (gid.x < P.size.x && gid.y < P.size.y) {
+    atomicStore(&field[gid.y * P.size.x + gid.x], select(KEY_NONE, KEY_UNREACHED, P.mode == 1u));
+  }
+}
+
+@compute @workgroup_size(64)
+fn cs_seed(@builtin(global_invocation_id) gid : vec3<u32>) {
+  if (gid.x >= P.seeds) {
+    return;
+  }
+  let s = seeds[gid.x];
+  let p = vec2<u32>(s.x, s.y);
+  let h = ground(p);
+  if (is_nan(h)) {
+    return;
+  }
+  let i = s.y * P.size.x + s.x;
+  if (P.mode == 0u) {
+    if (h < s.level) {
+      atomicMax(&field[i], key(s.level));
+    }
+  } else {
+    atomicMin(&field[i], key(h));
+  }
+}
+
+fn relax(p: vec2<u32>, h: f32) {
+  let i = p.y * P.size.x + p.x;
+  var up = KEY_NONE;          // mode 0: highest neighbouring water surface
+  var down = KEY_UNREACHED;   // mode 1: lowest neighbouring spill level
+  if (p.x > 0u) {
+    let k = atomicLoad(&field[i - 1u]);
+    up = max(up, k);
+    down = min(down, k);
+  }
+  if (p.x + 1u < P.size.x) {
+    let k = atomicLoad(&field[i + 1u]);
+    up = max(up, k);
+    down = min(down, k);
+  }
+  if (p.y > 0u) {
+    let k = atomicLoad(&field[i - P.size.x]);
+    up = max(up, k);
+    down = min(down, k);
+  }
+  if (p.y + 1u < P.size.y) {
+    let k = atomicLoad(&field[i + P.size.x]);
+    up = max(up, k);
+    down = min(down, k);
+  }
+  if (P.mode == 0u) {
+    if (up > key(h) && atomicMax(&field[i], up) < up) {
+      atomicStore(&counters[0], 1u);
+    }
+  } else if (down != KEY_UNREACHED) {
+    let cand = max(down, key(h));
+    if (atomicMin(&field[i], cand) > cand) {
+      atomicStore(&counters[0], 1u);
+    }
+  }
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_relax(@builtin(global_invocation_id) gid : vec3<u32>) {
+  let inside = gid.x < P.size.x && gid.y < P.size.y;
+  var h = 0.0;
+  if (inside) {
+    h = ground(gid.xy);
+  }
+  let active = inside && !is_nan(h);
+  for (var it = 0u; it < LOCAL_ITERS; it = it + 1u) {
+    if (active) {
+      relax(gid.xy, h);
+    }
+    storageBarrier();
+  }
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_depth(@builtin(global_invocation_id) gid : vec3<u32>) {
+  if (gid.x >= P.size.x || gid.y >= P.size.y) {
+    return;
+  }
+  let h = ground(gid.xy);
+  let k = atomicLoad(&field[gid.y * P.size.x + gid.x]);
+  var depth = 0.0;
+  if (!is_nan(h)) {
+    if (P.mode == 0u) {
+      if (k > key(h)) {
+        depth = unkey(k) - h;
+      }
+    } else if (k < key(P.level) && h < P.level) {
+      depth = P.level - h;
+    }
+  }
+  if (depth > 0.0) {
+    atomicAdd(&counters[1], 1u);
+  }
+  textureStore(water_out, vec2<i32>(gid.xy), vec4<f32>(depth, 0.0, 0.0, 0.0));
+}
@@ -0,0 +1,85 @@
+// Procedural DEM generator — GPU twin of src/terrain/procgen.rs (keep the math in sync).
+// One invocation per texel; writes straight into the R32Float height texture.
+
+struct Params {
+  size       : vec2<u32>,
+  seed       : u32,
+  kind       : u32,     // 0 = fbm, 1 = ridged, 2 = eroded
+  octaves    : u32,
+  step       : f32,     // noise-space distance between adjacent texels
+  lacunarity : f32,
+  gain       : f32,
+  amplitude  : f32,
+  _p0 : f32, _p1 : f32, _p2 : f32,   // pad to 48 B
+};
+
+@group(0) @binding(0) var<uniform> P : Params;
+@group(0) @binding(1) var out_height : texture_storage_2d<r32float, write>;
+
+const INV_24 : f32 = 1.0 / 16777215.0;
+
+fn pcg(v: u32) -> u32 {
+  let state = v * 747796405u + 2891336453u;
+  let word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+  return (word >> 22u) ^ word;
+}
+
+fn lattice(ix: i32, iy: i32, seed_hash: u32) -> f32 {
+  let h = pcg(bitcast<u32>(ix) ^ pcg(bitcast<u32>(iy) + seed_hash));
+  return f32(h & 0x00FFFFFFu) * INV_24 * 2.0 - 1.0;
+}
+
+// Value noise with analytic derivatives: (value, d/dx, d/dy).
+fn noised(p: vec2<f32>, seed_hash: u32) -> vec3<f32> {
+  let f = floor(p);
+  let i = vec2<i32>(f);
+  let t = p - f;
+  let u  = t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+  let du = 30.0 * t * t * (t * (t - 2.0) + 1.0);
+
+  let a = lattice(i.x,     i.y,     seed_hash);
+  let b = lattice(i.x + 1, i.y,     seed_hash);
+  let c = lattice(i.x,     i.y + 1, seed_hash);
+  let d = lattice(i.x + 1, i.y + 1, seed_hash);
+  let k1 = b - a;
+  let k2 = c - a;
+  let k3 = a - b - c + d;
+
+  let v = a + k1 * u.x + k2 * u.y + k3 * u.x * u.y;
+  return vec3<f32>(v, du.x * (k1 + k3 * u.y), du.y * (k2 + k3 * u.x));
+}
+
+@compute @workgroup_size(8, 8, 1)
+fn cs_main(@builtin(global_invocation_id) gid : vec3<u32>) {
+  if (gid.x >= P.size.x || gid.y >= P.size.y) {
+    return;
+  }
+  let seed_hash = pcg(P.seed);
+  var p = vec2<f32>(f32(gid.x) * P.step, f32(gid.y) * P.step);
+  var sum = 0.0;
+  var d = vec2<f32>(0.0, 0.0);
+  var amp = 1.0;
+  var norm = 0.0;
+
+  for (var o = 0u; o < P.octaves; o = o + 1u) {
+    let n = noised(p, seed_hash);
+    if (P.kind == 1u) {
+      let r = 1.0 - abs(n.x);
+      sum = sum + amp * r * r;
+    } else if (P.kind == 2u) {
+      d = d + n.yz;
+      sum = sum + amp * n.x / (1.0 + dot(d, d));
+    } else {
+      sum = sum + amp * n.x;
+    }
+    p = p * P.lacunarity;
+    norm = norm + amp;
+    amp = amp * P.gain;
+  }
+
+  var v = sum / norm;
+  if (P.kind == 1u) {
+    v = v * 2.0 - 1.0;
+  }
+  textureStore(out_height, vec2<i32>(gid.xy), vec4<f32>(v * P.amplitude, 0.0, 0.0, 1.0));
+}
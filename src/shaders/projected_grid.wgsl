@@ -0,0 +1,41 @@
+// Projected grid (src/terrain/projected.rs): one vertex per screen-grid point, projected onto the
+// terrain plane (y = 0) and written in the terrain vertex layout [x, z, u, v] (plane units), so
+// the unchanged terrain pipeline samples the height in its vertex stage.
+//   cs_project  screen point -> ray through inv_view_proj -> plane hit, clamped to the extent
+
+struct Params {
+  inv_view_proj : mat4x4<f32>,   // world from clip (wgpu depth 0..1)
+  dims          : vec2<u32>,     // grid vertices per row, rows
+  margin        : f32,           // NDC overscan beyond [-1, 1] on each side
+  spacing       : f32,           // world units per plane unit
+  extent        : f32,           // plane half-size in plane units
+  _p0 : f32, _p1 : f32, _p2 : f32,
+};
+
+@group(0) @binding(0) var<uniform> P : Params;
+@group(0) @binding(1) var<storage, read_write> verts : array<vec4<f32>>;
+
+fn unproject(ndc: vec2<f32>, z: f32) -> vec3<f32> {
+  let p = P.inv_view_proj * vec4<f32>(ndc, z, 1.0);
+  return p.xyz / p.w;
+}
+
+@compute @workgroup_size(64)
+fn cs_project(@builtin(global_invocation_id) gid: vec3<u32>) {
+  if (gid.x >= P.dims.x * P.dims.y) { return; }
+  let t = vec2<f32>(vec2<u32>(gid.x % P.dims.x, gid.x / P.dims.x)) / vec2<f32>(P.dims - vec2<u32>(1u, 1u));
+  let span = 1.0 + P.margin;
+  let ndc = vec2<f32>(-span + 2.0 * span * t.x, span - 2.0 * span * t.y);   // row 0 at the top
+  let p0 = unproject(ndc, 0.0);
+  let d = unproject(ndc, 1.0) - p0;
+  var xz = p0.xz;
+  if (p0.y > 0.0 && d.y < 0.0) {
+    xz = p0.xz + d.xz * (-p0.y / d.y);
+  } else if (length(d.xz) > 0.0) {
+    // At or above the horizon: run out along the view direction past the extent.
+    xz = p0.xz + normalize(d.xz) * (length(p0.xz) + 3.0 * P.extent * P.spacing);
+  }
+  let e = P.extent;
+  let pos = clamp(xz / P.spacing, vec2<f32>(-e), vec2<f32>(e));
+  verts[gid.x] = vec4<f32>(pos, (pos + e) / (2.0 * e));
+}
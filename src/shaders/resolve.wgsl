@@ -0,0 +1,29 @@
+// Box-filter resolve of a supersampled colour target (src/terrain/resolve.rs).
+// textureLoad on an *Srgb texture returns linear values and the *Srgb target encodes again,
+// so the factor x factor footprint is averaged in linear light.
+
+struct Params {
+  factor : u32,
+  _p0 : u32, _p1 : u32, _p2 : u32,
+};
+
+@group(0) @binding(0) var<uniform> P : Params;
+@group(0) @binding(1) var src : texture_2d<f32>;
+
+@vertex
+fn vs_main(@builtin(vertex_index) v: u32) -> @builtin(position) vec4<f32> {
+  let uv = vec2<f32>(f32((v << 1u) & 2u), f32(v & 2u));
+  return vec4<f32>(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+
+@fragment
+fn fs_main(@builtin(position) pos: vec4<f32>) -> @location(0) vec4<f32> {
+  let base = vec2<u32>(pos.xy) * P.factor;
+  var sum = vec4<f32>(0.0);
+  for (var y = 0u; y < P.factor; y++) {
+    for (var x = 0u; x < P.factor; x++) {
+      sum += textureLoad(src, base + vec2<u32>(x, y), 0);
+    }
+  }
+  return sum / f32(P.factor * P.factor);
+}
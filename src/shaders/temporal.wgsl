@@ -0,0 +1,113 @@
+// Temporal reprojection of the previous frame (src/terrain/temporal.rs).
+// Every covered history pixel is forward-projected into the new view; the nearest one per new
+// pixel wins (keys = inverted depth bits, so atomicMax keeps the smallest depth and ties go to
+// the highest source index: the result depends only on the camera sequence).
+//   cs_scatter  history depth -> keys (nearest reprojected depth per new pixel)
+//   cs_claim    sources whose key won -> src (index + 1)
+//   cs_resolve  drop pixels seen through a gap in a nearer surface; count the rest
+//   vs_prime / fs_prime  fullscreen: reused colour + depth, z = 0 so the terrain pass skips them
+
+struct Params {
+  reproject    : mat4x4<f32>,   // new clip from old clip (P * V1 * V0^-1 * P^-1)
+  size         : vec2<u32>,
+  z_from_depth : vec2<f32>,     // old clip z = x * depth + y
+  tolerance    : f32,           // relative depth gap treated as a disocclusion
+  _p0 : f32, _p1 : f32, _p2 : f32,
+};
+
+@group(0) @binding(0) var<uniform> P : Params;
+@group(0) @binding(1) var history_depth : texture_2d<f32>;
+@group(0) @binding(2) var<storage, read_write> keys : array<atomic<u32>>;
+@group(0) @binding(3) var<storage, read_write> src : array<atomic<u32>>;
+@group(0) @binding(4) var<storage, read_write> counter : array<atomic<u32>>;
+
+// Prime pass (group 1 so the module never binds one slot twice).
+@group(1) @binding(0) var history_color : texture_2d<f32>;
+@group(1) @binding(1) var<storage, read> final_keys : array<u32>;
+@group(1) @binding(2) var<storage, read> final_src : array<u32>;
+
+fn inside(p: vec2<i32>) -> bool {
+  return p.x >= 0 && p.y >= 0 && p.x < i32(P.size.x) && p.y < i32(P.size.y);
+}
+
+// (ok, destination index, key) of history pixel p.
+fn reproject(p: vec2<i32>) -> vec3<u32> {
+  let d = textureLoad(history_depth, p, 0).r;
+  if (!(d > 0.0)) { return vec3<u32>(0u); }
+  let size = vec2<f32>(P.size);
+  let ndc = vec2<f32>((f32(p.x) + 0.5) / size.x * 2.0 - 1.0, 1.0 - (f32(p.y) + 0.5) / size.y * 2.0);
+  let clip = P.reproject * vec4<f32>(ndc * d, P.z_from_depth.x * d + P.z_from_depth.y, d);
+  if (clip.w <= 1e-6) { return vec3<u32>(0u); }
+  let n = clip.xyz / clip.w;
+  if (any(abs(n.xy) > vec2<f32>(1.0)) || n.z < 0.0 || n.z > 1.0) { return vec3<u32>(0u); }
+  let q = min(vec2<u32>(vec2<f32>((n.x + 1.0) * 0.5, (1.0 - n.y) * 0.5) * size), P.size - vec2<u32>(1u, 1u));
+  return vec3<u32>(1u, q.y * P.size.x + q.x, 0xffffffffu - bitcast<u32>(clip.w));
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_scatter(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  let r = reproject(p);
+  if (r.x == 1u) {
+    atomicMax(&keys[r.y], r.z);
+  }
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_claim(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let p = vec2<i32>(gid.xy);
+  if (!inside(p)) { return; }
+  let r = reproject(p);
+  if (r.x == 1u && atomicLoad(&keys[r.y]) == r.z) {
+    atomicMax(&src[r.y], u32(p.y) * P.size.x + u32(p.x) + 1u);
+  }
+}
+
+@compute @workgroup_size(16, 16)
+fn cs_resolve(@builtin(global_invocation_id) gid: vec3<u32>) {
+  let q = vec2<i32>(gid.xy);
+  if (!inside(q)) { return; }
+  let i = u32(q.y) * P.size.x + u32(q.x);
+  if (atomicLoad(&src[i]) == 0u) { return; }
+  let d = bitcast<f32>(0xffffffffu - atomicLoad(&keys[i]));
+  var offs = array<vec2<i32>, 4>(vec2<i32>(-1, 0), vec2<i32>(1, 0), vec2<i32>(0, -1), vec2<i32>(0, 1));
+  for (var k = 0; k < 4; k++) {
+    let n = q + offs[k];
+    if (inside(n)) {
+      let kn = atomicLoad(&keys[u32(n.y) * P.size.x + u32(n.x)]);
+      // A much nearer neighbour: this pixel shows a surface through a reprojection gap.
+      if (kn != 0u && bitcast<f32>(0xffffffffu - kn) < d * (1.0 - P.tolerance)) {
+        atomicStore(&src[i], 0u);
+        return;
+      }
+    }
+  }
+  atomicAdd(&counter[0], 1u);
+}
+
+struct PrimeOut {
+  @location(0) color : vec4<f32>,
+  @location(1) depth : f32,
+  @builtin(frag_depth) z : f32,
+};
+
+@vertex
+fn vs_prime(@builtin(vertex_index) v: u32) -> @builtin(position) vec4<f32> {
+  let uv = vec2<f32>(f32((v << 1u) & 2u), f32(v & 2u));
+  return vec4<f32>(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+
+@fragment
+fn fs_prime(@builtin(position) pos: vec4<f32>) -> PrimeOut {
+  let w = textureDimensions(history_color).x;
+  let q = vec2<u32>(pos.xy);
+  let i = q.y * w + q.x;
+  let s = final_src[i];
+  if (s == 0u) { discard; }
+  var o : PrimeOut;
+  o.color = textureLoad(history_color, vec2<u32>((s - 1u) % w, (s - 1u) / w), 0);
+  o.depth = bitcast<f32>(0xffffffffu - final_keys[i]);
+  o.z = 0.0;
+  return o;
+}
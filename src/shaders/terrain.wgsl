@@ -1,6 +1,9 @@
 // T3.3 Terrain shader — compatible with Rust pipeline bind group layouts.
 // Layout: 0=Globals UBO, 1=height R32Float + NonFiltering sampler, 2=LUT RGBA8 + Filtering sampler.
 // This version adds a deterministic analytic height fallback to avoid uniform output with a 1×1 dummy height.
+//
+// Permutations (src/terrain/variants.rs): HEIGHT_TEX, ANALYTIC_FALLBACK, LUT, SHADOWS, AO, NORMAL_MAP,
+// PUSH_CONSTANTS, DATASET, HEIGHT_SEQ, DIFF, WATER, SCALAR, TEMPORAL. Disabled features are stripped before compilation; their bind groups become empty layouts.
 
 // ---------- Globals UBO (176 bytes total, must match Rust) ----------
 struct Globals {
@@ -9,17 +12,74 @@ struct Globals {
   sun_exposure : vec4<f32>,    // xyz = sun_dir, w = exposure
   // packs (spacing, h_range, exaggeration, 0) for source-compat with globals.spacing.x, .y, .z
   spacing : vec4<f32>,
-  _pad_tail : vec4<f32>,       // pad to 176 B
+  _pad_tail : vec4<f32>,       // xyz = per-draw world offset (UBO path), w = sequence position; pads to 176 B
 };
 
+#ifdef PUSH_CONSTANTS
+// Per-draw camera data (112 B, must match terrain::DrawPush). Group 0 is empty in this permutation.
+struct DrawPush {
+  view_proj : mat4x4<f32>,
+  sun_exposure : vec4<f32>,
+  spacing : vec4<f32>,
+  offset : vec4<f32>,          // xyz = world offset, w = sequence position
+};
+var<push_constant> draw : DrawPush;
+
+fn g_sun_exposure() -> vec4<f32> { return draw.sun_exposure; }
+fn g_spacing() -> vec4<f32> { return draw.spacing; }
+fn g_offset() -> vec3<f32> { return draw.offset.xyz; }
+fn g_layer() -> f32 { return draw.offset.w; }
+#else
 @group(0) @binding(0) var<uniform> globals : Globals;
 
+fn g_sun_exposure() -> vec4<f32> { return globals.sun_exposure; }
+fn g_spacing() -> vec4<f32> { return globals.spacing; }
+fn g_offset() -> vec3<f32> { return globals._pad_tail.xyz; }
+fn g_layer() -> f32 { return globals._pad_tail.w; }
+#endif
+
 // ---------- Textures & samplers ----------
+#ifdef HEIGHT_TEX
+#ifdef HEIGHT_SEQ
+// Ring of time steps (Scene.render_sequence); g_layer() = ring layer + blend toward the next.
+@group(1) @binding(0) var height_tex  : texture_2d_array<f32>;
+#else
 @group(1) @binding(0) var height_tex  : texture_2d<f32>;  // R32Float, non-filterable
+#endif
 @group(1) @binding(1) var height_samp : sampler;          // NonFiltering at pipeline level
+#ifdef DIFF
+// Change detection (Scene.set_diff): height_tex = epoch a, height_b = epoch b (same size).
+struct DiffParams {
+  range   : f32,     // |a - b| at the ends of the diverging LUT (group 2)
+  surface : f32,     // geometry from epoch a (0) or b (1); shading always uses a's normals
+  _p0 : f32, _p1 : f32,
+};
+@group(1) @binding(2) var height_b : texture_2d<f32>;     // R32Float, non-filterable
+@group(1) @binding(3) var<uniform> diff : DiffParams;
+#endif
+#endif
 
+#ifdef LUT
 @group(2) @binding(0) var lut_tex  : texture_2d<f32>;     // RGBA8 (sRGB/UNORM), filterable
 @group(2) @binding(1) var lut_samp : sampler;
+#endif
+#ifdef WATER
+// Flood depth above ground (Scene.flood / set_water_level), same size as the height texture.
+@group(2) @binding(2) var water_tex : texture_2d<f32>;   // R32Float, non-filterable
+#endif
+#ifdef SCALAR
+// Colormap coordinate in [0,1] (Scene.set_scalar, e.g. log flow accumulation); any size.
+@group(2) @binding(3) var scalar_tex : texture_2d<f32>;  // R32Float, non-filterable
+#endif
+
+#ifdef DATASET
+// Dataset pass (Scene.render_dataset): class raster + per-frame view (dynamic offset).
+struct DatasetView {
+  view : mat4x4<f32>,
+};
+@group(3) @binding(0) var class_tex : texture_2d<u32>;    // R8Uint categorical raster
+@group(3) @binding(1) var<uniform> ds : DatasetView;
+#endif
 
 // ---------- IO ----------
 struct VsIn {
@@ -33,59 +93,255 @@ struct VsOut {
   @location(0) uv             : vec2<f32>,
   @location(1) height         : f32,
   @location(2) xz             : vec2<f32>,   // pass plane x/z to fragment for shading
+#ifdef DATASET
+  @location(3) view_depth     : f32,         // clip w = -z_view for perspective projections
+#else
+#ifdef TEMPORAL
+  @location(3) view_depth     : f32,         // history depth for the next frame's reprojection
+#endif
+#endif
 };
 
+#ifdef DATASET
+struct FsDataset {
+  @location(0) color    : vec4<f32>,   // as the colour-only pass (depth-tested here)
+  @location(1) depth    : f32,         // R32Float linear view depth
+  @location(2) normal   : vec2<f32>,   // RG16Float view-space normal xy (z = sqrt(1 - x² - y²))
+  @location(3) class_id : u32,         // R8Uint class from the categorical raster
+};
+#else
+#ifdef TEMPORAL
+// Temporal pass (Scene.set_temporal): colour plus the linear depth kept as history.
+struct FsTemporal {
+  @location(0) color : vec4<f32>,
+  @location(1) depth : f32,            // R32Float linear view depth
+};
+#endif
+#endif
+
+#ifdef ANALYTIC_FALLBACK
 // Analytic fallback height that varies across the grid. Amplitude ≈ ±0.5 (matches Globals defaults).
 fn analytic_height(x: f32, z: f32) -> f32 {
   return sin(x * 1.3) * 0.25 + cos(z * 1.1) * 0.25;
 }
+#endif
+
+#ifdef HEIGHT_TEX
+#ifdef HEIGHT_SEQ
+// Adjacent ring layers and the blend between them, interpolated on the GPU.
+fn seq_layers() -> vec3<f32> {
+  let n = i32(textureNumLayers(height_tex));
+  let a = i32(floor(g_layer())) % n;
+  return vec3<f32>(f32(a), f32((a + 1) % n), fract(g_layer()));
+}
+
+fn height_uv(uv: vec2<f32>) -> f32 {
+  let l = seq_layers();
+  let ha = textureSampleLevel(height_tex, height_samp, uv, i32(l.x), 0.0).r;
+  let hb = textureSampleLevel(height_tex, height_samp, uv, i32(l.y), 0.0).r;
+  return mix(ha, hb, l.z);
+}
+
+fn height_at(p: vec2<i32>) -> f32 {
+  let l = seq_layers();
+  let q = clamp(p, vec2<i32>(0, 0), vec2<i32>(textureDimensions(height_tex)) - vec2<i32>(1, 1));
+  return mix(textureLoad(height_tex, q, i32(l.x), 0).r, textureLoad(height_tex, q, i32(l.y), 0).r, l.z);
+}
+#else
+fn height_uv(uv: vec2<f32>) -> f32 {
+  return textureSampleLevel(height_tex, height_samp, uv, 0.0).r;
+}
+
+// Texel fetch with edge clamp (the height texture is non-filterable).
+fn height_at(p: vec2<i32>) -> f32 {
+  let last = vec2<i32>(textureDimensions(height_tex)) - vec2<i32>(1, 1);
+  return textureLoad(height_tex, clamp(p, vec2<i32>(0, 0), last), 0).r;
+}
+#endif
+
+fn height_texel(uv: vec2<f32>) -> vec2<i32> {
+  return vec2<i32>(uv * vec2<f32>(textureDimensions(height_tex) - vec2<u32>(1u, 1u)) + 0.5);
+}
+
+#ifdef DIFF
+// a - b at texel p; NaN (nodata in either epoch) maps to 0.
+fn diff_at(p: vec2<i32>) -> f32 {
+  let last = vec2<i32>(textureDimensions(height_b)) - vec2<i32>(1, 1);
+  let d = height_at(p) - textureLoad(height_b, clamp(p, vec2<i32>(0, 0), last), 0).r;
+  return select(d, 0.0, (bitcast<u32>(d) & 0x7fffffffu) > 0x7f800000u);
+}
+#endif
+#endif
 
 // ---------- Vertex ----------
 @vertex
 fn vs_main(in: VsIn) -> VsOut {
-  let spacing      = max(globals.spacing.x, 1e-8);
-  let exaggeration = globals.spacing.z;
+  let spacing      = max(g_spacing().x, 1e-8);
+  let exaggeration = g_spacing().z;
 
+  var h = 0.0;
+#ifdef HEIGHT_TEX
   // Sample height with a NonFiltering sampler; level 0 to avoid filtering.
-  let h_tex = textureSampleLevel(height_tex, height_samp, in.uv, 0.0).r;
-
-  // Deterministic analytic fallback guarantees variation even if height_tex is 1x1.
-  let h_ana = analytic_height(in.pos_xy.x, in.pos_xy.y);
-
-  let h = h_tex + h_ana;
+#ifdef DIFF
+  h = h + select(height_uv(in.uv), textureSampleLevel(height_b, height_samp, in.uv, 0.0).r, diff.surface > 0.5);
+#else
+  h = h + height_uv(in.uv);
+#endif
+#endif
+#ifdef ANALYTIC_FALLBACK
+  // Deterministic analytic fallback guarantees variation even with a 1x1 height texture.
+  h = h + analytic_height(in.pos_xy.x, in.pos_xy.y);
+#endif
 
   // Build world position (XY are plane coords, Y is height).
-  let world = vec3<f32>(in.pos_xy.x * spacing, h * exaggeration, in.pos_xy.y * spacing);
+  let world = vec3<f32>(in.pos_xy.x * spacing, h * exaggeration, in.pos_xy.y * spacing) + g_offset();
 
   var out : VsOut;
+#ifdef PUSH_CONSTANTS
+  out.clip_pos = draw.view_proj * vec4<f32>(world, 1.0);
+#else
   out.clip_pos = globals.proj * (globals.view * vec4<f32>(world, 1.0));
+#endif
   out.uv       = in.uv;
   out.height   = h;
   out.xz       = in.pos_xy;
+#ifdef DATASET
+  out.view_depth = out.clip_pos.w;
+#else
+#ifdef TEMPORAL
+  out.view_depth = out.clip_pos.w;
+#endif
+#endif
   return out;
 }
 
 // ---------- Fragment ----------
 @fragment
+#ifdef DATASET
+fn fs_main(in: VsOut) -> FsDataset {
+#else
+#ifdef TEMPORAL
+fn fs_main(in: VsOut) -> FsTemporal {
+#else
 fn fs_main(in: VsOut) -> @location(0) vec4<f32> {
+#endif
+#endif
+#ifdef DIFF
+  // Map a - b into [0,1] around the LUT midpoint (no change = 0.5).
+  let t = clamp(0.5 + diff_at(height_texel(in.uv)) / (2.0 * max(diff.range, 1e-8)), 0.0, 1.0);
+#else
+#ifdef SCALAR
+  let scalar_px = vec2<i32>(in.uv * vec2<f32>(textureDimensions(scalar_tex) - vec2<u32>(1u, 1u)) + 0.5);
+  let t = clamp(textureLoad(scalar_tex, scalar_px, 0).r, 0.0, 1.0);
+#else
   // Map height into [0,1] using h_range stored in spacing.y (avoid div by 0).
-  let h_range = max(globals.spacing.y, 1e-8);
+  let h_range = max(g_spacing().y, 1e-8);
   let t = clamp(0.5 + in.height / (2.0 * h_range), 0.0, 1.0);
+#endif
+#endif
 
+#ifdef LUT
   // 256x1 LUT: sample along X at row center (v=0.5).
-  let lut_color = textureSampleLevel(lut_tex, lut_samp, vec2<f32>(t, 0.5), 0.0);
+  let base = textureSampleLevel(lut_tex, lut_samp, vec2<f32>(t, 0.5), 0.0).rgb;
+#else
+  let base = vec3<f32>(t, t, t);
+#endif
 
-  // Simple Lambert term from analytic slope (adds spatial variation even with flat height_tex).
+#ifdef NORMAL_MAP
+  // Central differences on the height texture (texel pitch = spacing).
+  let c = height_texel(in.uv);
+  let k = g_spacing().z / (2.0 * max(g_spacing().x, 1e-8));
+  let dhdx = (height_at(c + vec2<i32>(1, 0)) - height_at(c - vec2<i32>(1, 0))) * k;
+  let dhdz = (height_at(c + vec2<i32>(0, 1)) - height_at(c - vec2<i32>(0, 1))) * k;
+  let n = normalize(vec3<f32>(-dhdx, 1.0, -dhdz));
+#else
+#ifdef ANALYTIC_FALLBACK
+  // Simple Lambert term from analytic slope (adds spatial variation even on a flat height texture).
   let dhdx = 1.3 * cos(in.xz.x * 1.3) * 0.25;
   let dhdz = -1.1 * sin(in.xz.y * 1.1) * 0.25;
   let n = normalize(vec3<f32>(-dhdx, 1.0, -dhdz));
+#else
+  let n = vec3<f32>(0.0, 1.0, 0.0);
+#endif
+#endif
 
-  let L = normalize(globals.sun_exposure.xyz);
+  let L = normalize(g_sun_exposure().xyz);
   let lambert = clamp(dot(n, L), 0.0, 1.0);
-  let exposure = globals.sun_exposure.w;
+  let exposure = g_sun_exposure().w;
 
   // Mix in a small ambient floor to avoid large flat regions in the PNG.
-  let shade = mix(0.15, 1.0, lambert);
+  var shade = mix(0.15, 1.0, lambert);
+
+#ifdef SHADOWS
+  // March 24 texels toward the sun; occluded if the terrain rises above the ray.
+  {
+    let c0 = height_texel(in.uv);
+    let h0 = height_at(c0);
+    let dir = normalize(L.xz + vec2<f32>(1e-6, 0.0));
+    let rise = L.y / max(length(L.xz), 1e-4) * max(g_spacing().x, 1e-8) / max(g_spacing().z, 1e-8);
+    var lit = 1.0;
+    for (var s = 1; s <= 24; s = s + 1) {
+      let p = c0 + vec2<i32>(round(dir * f32(s)));
+      if (height_at(p) > h0 + rise * f32(s)) {
+        lit = 0.35;
+        break;
+      }
+    }
+    shade = shade * lit;
+  }
+#endif
 
-  return vec4<f32>(lut_color.rgb * exposure * shade, 1.0);
-}
\ No newline at end of file
+#ifdef AO
+  // Fraction of 8 neighbours (radius 3 texels) higher than this texel, weighted by the rise.
+  {
+    let c0 = height_texel(in.uv);
+    let h0 = height_at(c0);
+    var occ = 0.0;
+    for (var i = 0; i < 8; i = i + 1) {
+      let a = f32(i) * 0.785398;
+      let p = c0 + vec2<i32>(round(vec2<f32>(cos(a), sin(a)) * 3.0));
+      occ = occ + clamp((height_at(p) - h0) * g_spacing().z / (3.0 * max(g_spacing().x, 1e-8)), 0.0, 1.0);
+    }
+    shade = shade * (1.0 - 0.5 * occ / 8.0);
+  }
+#endif
+
+  var rgb = base * exposure * shade;
+#ifdef WATER
+  // Blend toward lit water; deeper water (relative to h_range) is more opaque.
+  {
+    let wd = textureLoad(water_tex, height_texel(in.uv), 0).r;
+    if (wd > 0.0) {
+      let water = vec3<f32>(0.04, 0.22, 0.5) * exposure * mix(0.6, 1.0, lambert);
+      rgb = mix(rgb, water, clamp(0.45 + wd / max(g_spacing().y, 1e-8), 0.45, 0.9));
+    }
+  }
+#endif
+
+#ifdef DATASET
+  // Surface normal for the normal target: height-texture central differences when available.
+  var ns = n;
+#ifdef HEIGHT_TEX
+  {
+    let c = height_texel(in.uv);
+    let k = g_spacing().z / (2.0 * max(g_spacing().x, 1e-8));
+    let dx = (height_at(c + vec2<i32>(1, 0)) - height_at(c - vec2<i32>(1, 0))) * k;
+    let dz = (height_at(c + vec2<i32>(0, 1)) - height_at(c - vec2<i32>(0, 1))) * k;
+    ns = normalize(vec3<f32>(-dx, 1.0, -dz));
+  }
+#endif
+  let cdim = vec2<f32>(textureDimensions(class_tex) - vec2<u32>(1u, 1u));
+  var o : FsDataset;
+  o.color = vec4<f32>(rgb, 1.0);
+  o.depth = in.view_depth;
+  o.normal = normalize((ds.view * vec4<f32>(ns, 0.0)).xyz).xy;
+  o.class_id = textureLoad(class_tex, vec2<i32>(in.uv * cdim + 0.5), 0).r;
+  return o;
+#else
+#ifdef TEMPORAL
+  return FsTemporal(vec4<f32>(rgb, 1.0), in.view_depth);
+#else
+  return vec4<f32>(rgb, 1.0);
+#endif
+#endif
+}
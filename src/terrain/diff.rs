@@ -0,0 +1,247 @@
+//! DEM differencing statistics (change detection between two height epochs).
+//!
+//! `DiffStatsGpu` runs `shaders/diff_stats.wgsl` over two `R32Float` textures: every
+//! 16×16 workgroup bins `a - b` into a shared-memory histogram (merged into the global one
+//! with one atomic per non-empty bin) and tree-reduces fill/cut/min/max into a `Partial`
+//! that the host sums in f64. `stats_cpu` is the reference with the same binning.
+
+/// Largest histogram the shader's shared-memory bins can hold.
+pub const MAX_BINS: u32 = 256;
+/// Texels per workgroup edge (`@workgroup_size(16, 16)`).
+const WG_EDGE: u32 = 16;
+
+/// Shader uniform block (32 bytes, must match `diff_stats.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct StatsParams {
+    pub size: [u32; 2],
+    pub bins: u32,
+    pub _p0: u32,
+    pub lo: f32,
+    pub hi: f32,
+    pub _p1: [f32; 2],
+}
+
+/// Per-workgroup reduction (32 bytes, must match `diff_stats.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct Partial {
+    pub fill: f32,
+    pub cut: f32,
+    pub lo: f32,
+    pub hi: f32,
+    pub fill_cells: u32,
+    pub cut_cells: u32,
+    pub valid: u32,
+    pub _p: u32,
+}
+
+/// Difference statistics over the valid (non-NaN) texels of `a - b`.
+#[derive(Debug, Clone, PartialEq)]
+pub struct DiffSummary {
+    /// `bins + 2` counts: below `lo`, the `bins` bins, above `hi`.
+    pub hist: Vec<u32>,
+    /// Sum of positive differences (deposition), in height units per texel.
+    pub fill: f64,
+    /// Sum of magnitudes of negative differences (erosion).
+    pub cut: f64,
+    pub fill_cells: u64,
+    pub cut_cells: u64,
+    pub valid: u64,
+    pub min: f32,
+    pub max: f32,
+}
+
+impl DiffSummary {
+    /// Fold per-workgroup partials and the global histogram.
+    pub fn from_partials(hist: Vec<u32>, partials: &[Partial]) -> Self {
+        let mut s = Self { hist, fill: 0.0, cut: 0.0, fill_cells: 0, cut_cells: 0, valid: 0, min: f32::INFINITY, max: f32::NEG_INFINITY };
+        for p in partials {
+            s.fill += p.fill as f64;
+            s.cut += p.cut as f64;
+            s.fill_cells += p.fill_cells as u64;
+            s.cut_cells += p.cut_cells as u64;
+            s.valid += p.valid as u64;
+            if p.valid > 0 {
+                s.min = s.min.min(p.lo);
+                s.max = s.max.max(p.hi);
+            }
+        }
+        s
+    }
+}
+
+/// Histogram slot of `d` in `[below, bins..., above]` (the last bin includes `hi`).
+pub fn bin_index(d: f32, bins: u32, lo: f32, hi: f32) -> usize {
+    if d < lo {
+        return 0;
+    }
+    if d > hi {
+        return bins as usize + 1;
+    }
+    let k = ((d - lo) / (hi - lo).max(1e-30) * bins as f32).max(0.0) as u32;
+    1 + k.min(bins - 1) as usize
+}
+
+/// CPU reference of the GPU reduction (row-major `a` and `b` of equal length).
+pub fn stats_cpu(a: &[f32], b: &[f32], bins: u32, lo: f32, hi: f32) -> DiffSummary {
+    let mut s = DiffSummary::from_partials(vec![0; bins as usize + 2], &[]);
+    for (x, y) in a.iter().zip(b) {
+        let d = x - y;
+        if d.is_nan() {
+            continue;
+        }
+        s.valid += 1;
+        if d > 0.0 {
+            s.fill += d as f64;
+            s.fill_cells += 1;
+        } else if d < 0.0 {
+            s.cut += -d as f64;
+            s.cut_cells += 1;
+        }
+        s.min = s.min.min(d);
+        s.max = s.max.max(d);
+        s.hist[bin_index(d, bins, lo, hi)] += 1;
+    }
+    s
+}
+
+/// Compute pipeline + layout, created once per Scene on first use.
+pub struct DiffStatsGpu {
+    pub pipeline: wgpu::ComputePipeline,
+    pub bgl: wgpu::BindGroupLayout,
+}
+
+impl DiffStatsGpu {
+    pub fn new(device: &wgpu::Device) -> Self {
+        let texture = |binding| wgpu::BindGroupLayoutEntry {
+            binding,
+            visibility: wgpu::ShaderStages::COMPUTE,
+            ty: wgpu::BindingType::Texture {
+                sample_type: wgpu::TextureSampleType::Float { filterable: false },
+                view_dimension: wgpu::TextureViewDimension::D2,
+                multisampled: false,
+            },
+            count: None,
+        };
+        let storage = |binding| wgpu::BindGroupLayoutEntry {
+            binding,
+            visibility: wgpu::ShaderStages::COMPUTE,
+            ty: wgpu::BindingType::Buffer {
+                ty: wgpu::BufferBindingType::Storage { read_only: false },
+                has_dynamic_offset: false,
+                min_binding_size: None,
+            },
+            count: None,
+        };
+        let bgl = device.create_bind_group_layout(&wgpu::BindGroupLayoutDescriptor {
+            label: Some("vf.DiffStats.bgl"),
+            entries: &[
+                texture(0),
+                texture(1),
+                wgpu::BindGroupLayoutEntry {
+                    binding: 2,
+                    visibility: wgpu::ShaderStages::COMPUTE,
+                    ty: wgpu::BindingType::Buffer {
+                        ty: wgpu::BufferBindingType::Uniform,
+                        has_dynamic_offset: false,
+                        min_binding_size: None,
+                    },
+                    count: None,
+                },
+                storage(3),
+                storage(4),
+            ],
+        });
+        let layout = device.create_pipeline_layout(&wgpu::PipelineLayoutDescriptor {
+            label: Some("vf.DiffStats.pipelineLayout"),
+            bind_group_layouts: &[&bgl],
+            push_constant_ranges: &[],
+        });
+        let shader = device.create_shader_module(wgpu::ShaderModuleDescriptor {
+            label: Some("vf.DiffStats.shader"),
+            source: wgpu::ShaderSource::Wgsl(include_str!("../shaders/diff_stats.wgsl").into()),
+        });
+        let pipeline = device.create_compute_pipeline(&wgpu::ComputePipelineDescriptor {
+            label: Some("vf.DiffStats.pipeline"),
+            layout: Some(&layout),
+            module: &shader,
+            entry_point: "cs_main",
+        });
+        Self { pipeline, bgl }
+    }
+
+    /// Workgroups dispatched for a `w × h` pair (= partials written).
+    pub fn workgroups(w: u32, h: u32) -> (u32, u32) {
+        ((w + WG_EDGE - 1) / WG_EDGE, (h + WG_EDGE - 1) / WG_EDGE)
+    }
+
+    /// Record the reduction. `hist` must be zeroed and hold `bins + 2` u32; `partials` one
+    /// `Partial` per workgroup of `workgroups(p.size)`.
+    pub fn encode(&self, device: &wgpu::Device, encoder: &mut wgpu::CommandEncoder, a: &wgpu::TextureView,
+                  b: &wgpu::TextureView, p: &StatsParams, hist: &wgpu::Buffer, partials: &wgpu::Buffer) {
+        use wgpu::util::DeviceExt;
+        let ubo = device.create_buffer_init(&wgpu::util::BufferInitDescriptor {
+            label: Some("vf.DiffStats.params"),
+            contents: bytemuck::bytes_of(p),
+            usage: wgpu::BufferUsages::UNIFORM,
+        });
+        let bg = device.create_bind_group(&wgpu::BindGroupDescriptor {
+            label: Some("vf.DiffStats.bg"),
+            layout: &self.bgl,
+            entries: &[
+                wgpu::BindGroupEntry { binding: 0, resource: wgpu::BindingResource::TextureView(a) },
+                wgpu::BindGroupEntry { binding: 1, resource: wgpu::BindingResource::TextureView(b) },
+                wgpu::BindGroupEntry { binding: 2, resource: ubo.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 3, resource: hist.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 4, resource: partials.as_entire_binding() },
+            ],
+        });
+        let (gx, gy) = Self::workgroups(p.size[0], p.size[1]);
+        let mut cp = encoder.begin_compute_pass(&wgpu::ComputePassDescriptor {
+            label: Some("vf.DiffStats.pass"),
+            timestamp_writes: None,
+        });
+        cp.set_pipeline(&self.pipeline);
+        cp.set_bind_group(0, &bg, &[]);
+        cp.dispatch_workgroups(gx, gy, 1);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn blocks_are_32_bytes() {
+        assert_eq!(std::mem::size_of::<StatsParams>(), 32);
+        assert_eq!(std::mem::size_of::<Partial>(), 32);
+    }
+
+    #[test]
+    fn binning_matches_numpy_edges() {
+        // numpy.histogram([-1, -0.5, 0, 0.5, 1], bins=4, range=(-1, 1)) -> [1, 1, 1, 2]
+        let s = stats_cpu(&[-1.0, -0.5, 0.0, 0.5, 1.0, 2.0, -3.0], &[0.0; 7], 4, -1.0, 1.0);
+        assert_eq!(s.hist, vec![1, 1, 1, 1, 2, 1]);
+    }
+
+    #[test]
+    fn cut_fill_and_nodata() {
+        let a = [3.0, 1.0, f32::NAN, 2.0];
+        let b = [1.0, 2.0, 0.0, 2.0];
+        let s = stats_cpu(&a, &b, 8, -2.0, 2.0);
+        assert_eq!((s.fill, s.cut, s.fill_cells, s.cut_cells, s.valid), (2.0, 1.0, 1, 1, 3));
+        assert_eq!((s.min, s.max), (-1.0, 2.0));
+    }
+
+    #[test]
+    fn partials_fold_like_cpu() {
+        let p = [
+            Partial { fill: 2.0, cut: 0.0, lo: 0.0, hi: 2.0, fill_cells: 1, cut_cells: 0, valid: 2, _p: 0 },
+            Partial { fill: 0.0, cut: 0.0, lo: 3.4e38, hi: -3.4e38, fill_cells: 0, cut_cells: 0, valid: 0, _p: 0 },
+            Partial { fill: 0.0, cut: 1.0, lo: -1.0, hi: -1.0, fill_cells: 0, cut_cells: 1, valid: 1, _p: 0 },
+        ];
+        let s = DiffSummary::from_partials(vec![0; 3], &p);
+        assert_eq!((s.fill, s.cut, s.valid, s.min, s.max), (2.0, 1.0, 3, -1.0, 2.0));
+    }
+}
@@ -0,0 +1,514 @@
+//! Pipe-model hydraulic erosion (Mei et al. 2007) plus thermal weathering on a heightfield.
+//!
+//! State is one `Cell` per texel in two storage buffers that every pass ping-pongs between
+//! (read one, write the other), so no pass reads what its neighbours are writing. One
+//! iteration is five passes:
+//! 1. `flux`: rain, then outflow flux through the four virtual pipes from the water-surface
+//!    difference, scaled so a cell never loses more water than it holds;
+//! 2. `erode`: water depth from net flux, velocity from the pipe fluxes, then dissolve or
+//!    deposit toward the transport capacity `capacity · sin(tilt) · |v| · min(depth / cell, 1)`;
+//! 3. `transport`: semi-Lagrangian sediment advection along the velocity, evaporation;
+//! 4. `talus`: per-cell rate at which material above the talus slope leaves (8 neighbours);
+//! 5. `slide`: each cell loses its outflow and gains its neighbours' (mass conserving).
+//! NaN cells are walls: they hold no water and take part in no exchange.
+//!
+//! `ErosionGpu` runs `shaders/erosion.wgsl`; `ErosionCpu` runs the same passes in the same
+//! f32 order as the reference the GPU is validated against (expect small drift where the
+//! GPU contracts mul+add into FMA).
+
+/// Texels per workgroup edge of the kernels (`@workgroup_size(16, 16)`).
+const WG_EDGE: u32 = 16;
+/// Passes per iteration (flux, erode, transport, talus, slide).
+pub const PASSES: u32 = 5;
+
+/// Per-texel simulation state (48 bytes, must match `erosion.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct Cell {
+    /// Terrain height.
+    pub h: f32,
+    /// Water depth.
+    pub w: f32,
+    /// Suspended sediment.
+    pub s: f32,
+    /// Thermal outflow per unit of height difference (written by `talus`).
+    pub rate: f32,
+    /// Outflow flux toward the left, right, top (row - 1) and bottom (row + 1) neighbours.
+    pub flux: [f32; 4],
+    /// Water velocity in cells per unit time (x = column, y = row).
+    pub vel: [f32; 2],
+    pub _pad: [f32; 2],
+}
+
+/// Shader uniform block (48 bytes, must match `erosion.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct ErosionParams {
+    pub size: [u32; 2],
+    /// Time step.
+    pub dt: f32,
+    /// Horizontal texel size, in height units.
+    pub cell: f32,
+    /// Water added per unit time to every cell.
+    pub rain: f32,
+    /// Fraction of water evaporated per unit time.
+    pub evaporation: f32,
+    /// Sediment capacity constant.
+    pub capacity: f32,
+    /// Dissolving rate toward capacity.
+    pub dissolve: f32,
+    /// Deposition rate toward capacity.
+    pub deposit: f32,
+    /// Tangent of the talus angle above which material slides.
+    pub talus: f32,
+    /// Thermal weathering rate.
+    pub thermal: f32,
+    /// Gravity of the pipe model.
+    pub gravity: f32,
+}
+
+impl ErosionParams {
+    /// Defaults for heights of order 1 over a unit-square DEM (`cell = 1 / max(w, h)`).
+    pub fn new(width: u32, height: u32) -> Self {
+        Self {
+            size: [width, height],
+            dt: 0.02,
+            cell: 1.0 / width.max(height).max(1) as f32,
+            rain: 0.01,
+            evaporation: 0.5,
+            capacity: 0.5,
+            dissolve: 0.3,
+            deposit: 0.3,
+            talus: 1.2,
+            thermal: 0.1,
+            gravity: 9.81,
+        }
+    }
+
+    /// Non-finite or negative values are rejected (`dt` and `cell` must be > 0).
+    pub fn validate(&self) -> Result<(), String> {
+        let named = [
+            ("dt", self.dt), ("cell", self.cell), ("rain", self.rain), ("evaporation", self.evaporation),
+            ("capacity", self.capacity), ("dissolve", self.dissolve), ("deposit", self.deposit),
+            ("talus", self.talus), ("thermal", self.thermal), ("gravity", self.gravity),
+        ];
+        for (name, v) in named {
+            if !v.is_finite() || v < 0.0 {
+                return Err(format!("{} must be finite and >= 0 (got {})", name, v));
+            }
+        }
+        if self.dt <= 0.0 || self.cell <= 0.0 {
+            return Err("dt and cell must be > 0".to_string());
+        }
+        Ok(())
+    }
+
+    /// Set the tunable field `name` (one of `TUNABLE`); call `validate` afterwards.
+    pub fn set(&mut self, name: &str, value: f32) -> Result<(), String> {
+        let field = match name {
+            "dt" => &mut self.dt,
+            "cell" => &mut self.cell,
+            "rain" => &mut self.rain,
+            "evaporation" => &mut self.evaporation,
+            "capacity" => &mut self.capacity,
+            "dissolve" => &mut self.dissolve,
+            "deposit" => &mut self.deposit,
+            "talus" => &mut self.talus,
+            "thermal" => &mut self.thermal,
+            "gravity" => &mut self.gravity,
+            _ => return Err(format!("unknown erosion parameter '{}' (expected one of {})", name, TUNABLE.join(", "))),
+        };
+        *field = value;
+        Ok(())
+    }
+}
+
+/// Keyword parameters accepted by `ErosionParams::set`.
+pub const TUNABLE: [&str; 10] = ["dt", "cell", "rain", "evaporation", "capacity", "dissolve", "deposit", "talus", "thermal", "gravity"];
+
+/// Initial state: terrain from `heights`, everything else zero.
+pub fn initial_cells(heights: &[f32]) -> Vec<Cell> {
+    heights.iter().map(|&h| Cell { h, ..Cell::default() }).collect()
+}
+
+/// Serial reference of the GPU passes.
+pub struct ErosionCpu {
+    pub p: ErosionParams,
+    pub cells: Vec<Cell>,
+    next: Vec<Cell>,
+}
+
+impl ErosionCpu {
+    pub fn new(p: ErosionParams, heights: &[f32]) -> Self {
+        let cells = initial_cells(heights);
+        Self { p, next: cells.clone(), cells }
+    }
+
+    pub fn run(&mut self, iterations: u32) {
+        for _ in 0..iterations {
+            self.pass(Self::flux);
+            self.pass(Self::erode);
+            self.pass(Self::transport);
+            self.pass(Self::talus);
+            self.pass(Self::slide);
+        }
+    }
+
+    fn pass(&mut self, f: fn(&ErosionParams, &[Cell], usize, usize) -> Cell) {
+        let (w, h) = (self.p.size[0] as usize, self.p.size[1] as usize);
+        for y in 0..h {
+            for x in 0..w {
+                self.next[y * w + x] = f(&self.p, &self.cells, x, y);
+            }
+        }
+        std::mem::swap(&mut self.cells, &mut self.next);
+    }
+
+    /// Neighbour `(dx, dy)` of `(x, y)` if it is inside the grid and not a wall.
+    fn at(p: &ErosionParams, c: &[Cell], x: usize, y: usize, dx: i32, dy: i32) -> Option<Cell> {
+        let (nx, ny) = (x as i32 + dx, y as i32 + dy);
+        if nx < 0 || ny < 0 || nx >= p.size[0] as i32 || ny >= p.size[1] as i32 {
+            return None;
+        }
+        let n = c[ny as usize * p.size[0] as usize + nx as usize];
+        (!n.h.is_nan()).then_some(n)
+    }
+
+    fn flux(p: &ErosionParams, c: &[Cell], x: usize, y: usize) -> Cell {
+        let mut me = c[y * p.size[0] as usize + x];
+        if me.h.is_nan() {
+            return Cell { flux: [0.0; 4], ..me };
+        }
+        me.w += p.dt * p.rain;
+        let surface = me.h + me.w;
+        let mut f = [0.0f32; 4];
+        for (k, (dx, dy)) in PIPES.iter().enumerate() {
+            if let Some(n) = Self::at(p, c, x, y, *dx, *dy) {
+                let dh = surface - (n.h + (n.w + p.dt * p.rain));
+                f[k] = (me.flux[k] + p.dt * p.gravity * p.cell * dh).max(0.0);
+            }
+        }
+        let out = f[0] + f[1] + f[2] + f[3];
+        if out > 0.0 {
+            let k = (me.w * p.cell * p.cell / (out * p.dt)).min(1.0);
+            for v in &mut f {
+                *v *= k;
+            }
+        }
+        me.flux = f;
+        me
+    }
+
+    fn erode(p: &ErosionParams, c: &[Cell], x: usize, y: usize) -> Cell {
+        let mut me = c[y * p.size[0] as usize + x];
+        if me.h.is_nan() {
+            return me;
+        }
+        // Inflow: each neighbour's flux through the pipe facing this cell.
+        let nf = |dx, dy, k: usize| Self::at(p, c, x, y, dx, dy).map_or(0.0, |n| n.flux[k]);
+        let (from_l, from_r, from_t, from_b) = (nf(-1, 0, 1), nf(1, 0, 0), nf(0, -1, 3), nf(0, 1, 2));
+        let inflow = from_l + from_r + from_t + from_b;
+        let outflow = me.flux[0] + me.flux[1] + me.flux[2] + me.flux[3];
+        let w2 = (me.w + p.dt * (inflow - outflow) / (p.cell * p.cell)).max(0.0);
+        let mean = 0.5 * (me.w + w2);
+        let wx = 0.5 * (from_l - me.flux[0] + me.flux[1] - from_r);
+        let wy = 0.5 * (from_t - me.flux[2] + me.flux[3] - from_b);
+        let to_cells = p.cell * p.cell * mean;
+        me.vel = if mean > 1e-6 { [wx / to_cells, wy / to_cells] } else { [0.0, 0.0] };
+        me.w = w2;
+        // Tilt from central differences of the terrain (walls / edges use this cell).
+        let nh = |dx, dy| Self::at(p, c, x, y, dx, dy).map_or(me.h, |n| n.h);
+        let gx = (nh(1, 0) - nh(-1, 0)) / (2.0 * p.cell);
+        let gy = (nh(0, 1) - nh(0, -1)) / (2.0 * p.cell);
+        let g2 = gx * gx + gy * gy;
+        let sin_tilt = (g2 / (1.0 + g2)).sqrt().max(0.01);
+        let speed = (me.vel[0] * me.vel[0] + me.vel[1] * me.vel[1]).sqrt() * p.cell;
+        // Sheet flow thinner than a texel carries proportionally less.
+        let capacity = p.capacity * sin_tilt * speed * (w2 / p.cell).min(1.0);
+        if capacity > me.s {
+            let a = p.dt * p.dissolve * (capacity - me.s);
+            me.h -= a;
+            me.s += a;
+        } else {
+            let a = p.dt * p.deposit * (me.s - capacity);
+            me.h += a;
+            me.s -= a;
+        }
+        me
+    }
+
+    fn transport(p: &ErosionParams, c: &[Cell], x: usize, y: usize) -> Cell {
+        let mut me = c[y * p.size[0] as usize + x];
+        if me.h.is_nan() {
+            return me;
+        }
+        let (wm, hm) = ((p.size[0] - 1) as f32, (p.size[1] - 1) as f32);
+        let px = (x as f32 - me.vel[0] * p.dt).clamp(0.0, wm);
+        let py = (y as f32 - me.vel[1] * p.dt).clamp(0.0, hm);
+        let (x0, y0) = (px.floor(), py.floor());
+        let (fx, fy) = (px - x0, py - y0);
+        let (x0, y0) = (x0 as usize, y0 as usize);
+        let (x1, y1) = ((x0 + 1).min(wm as usize), (y0 + 1).min(hm as usize));
+        let w = p.size[0] as usize;
+        let s = |x: usize, y: usize| { let n = c[y * w + x]; if n.h.is_nan() { 0.0 } else { n.s } };
+        let mix = |a: f32, b: f32, t: f32| a * (1.0 - t) + b * t;
+        me.s = mix(mix(s(x0, y0), s(x1, y0), fx), mix(s(x0, y1), s(x1, y1), fx), fy);
+        me.w = (me.w * (1.0 - p.evaporation * p.dt)).max(0.0);
+        me
+    }
+
+    fn talus(p: &ErosionParams, c: &[Cell], x: usize, y: usize) -> Cell {
+        let mut me = c[y * p.size[0] as usize + x];
+        me.rate = 0.0;
+        if me.h.is_nan() {
+            return me;
+        }
+        let (mut sum, mut max) = (0.0f32, 0.0f32);
+        for &(dx, dy, dist) in &NEIGHBOURS {
+            if let Some(n) = Self::at(p, c, x, y, dx, dy) {
+                let d = me.h - n.h;
+                if d > p.talus * dist * p.cell {
+                    sum += d;
+                    max = max.max(d);
+                }
+            }
+        }
+        if sum > 0.0 {
+            me.rate = (p.dt * p.thermal).min(1.0) * 0.5 * max / sum;
+        }
+        me
+    }
+
+    fn slide(p: &ErosionParams, c: &[Cell], x: usize, y: usize) -> Cell {
+        let mut me = c[y * p.size[0] as usize + x];
+        if me.h.is_nan() {
+            return me;
+        }
+        let mut h = me.h;
+        for &(dx, dy, dist) in &NEIGHBOURS {
+            if let Some(n) = Self::at(p, c, x, y, dx, dy) {
+                let d = me.h - n.h;
+                let t = p.talus * dist * p.cell;
+                if d > t {
+                    h -= me.rate * d;
+                } else if -d > t {
+                    h += n.rate * -d;
+                }
+            }
+        }
+        me.h = h;
+        me
+    }
+}
+
+/// Pipe neighbours in `Cell::flux` order: left, right, top, bottom.
+const PIPES: [(i32, i32); 4] = [(-1, 0), (1, 0), (0, -1), (0, 1)];
+/// Thermal neighbours with their distance in texels.
+const NEIGHBOURS: [(i32, i32, f32); 8] = [
+    (-1, 0, 1.0), (1, 0, 1.0), (0, -1, 1.0), (0, 1, 1.0),
+    (-1, -1, std::f32::consts::SQRT_2), (1, -1, std::f32::consts::SQRT_2),
+    (-1, 1, std::f32::consts::SQRT_2), (1, 1, std::f32::consts::SQRT_2),
+];
+
+/// Compute pipelines of `shaders/erosion.wgsl` and their shared layout.
+pub struct ErosionGpu {
+    init: wgpu::ComputePipeline,
+    passes: [wgpu::ComputePipeline; PASSES as usize],
+    store: wgpu::ComputePipeline,
+    bgl: wgpu::BindGroupLayout,
+}
+
+impl ErosionGpu {
+    pub fn new(device: &wgpu::Device) -> Self {
+        let buffer = |binding, ty| wgpu::BindGroupLayoutEntry {
+            binding,
+            visibility: wgpu::ShaderStages::COMPUTE,
+            ty: wgpu::BindingType::Buffer { ty, has_dynamic_offset: false, min_binding_size: None },
+            count: None,
+        };
+        let bgl = device.create_bind_group_layout(&wgpu::BindGroupLayoutDescriptor {
+            label: Some("vf.Erosion.bgl"),
+            entries: &[
+                buffer(0, wgpu::BufferBindingType::Uniform),
+                buffer(1, wgpu::BufferBindingType::Storage { read_only: true }),
+                buffer(2, wgpu::BufferBindingType::Storage { read_only: false }),
+                wgpu::BindGroupLayoutEntry {
+                    binding: 3,
+                    visibility: wgpu::ShaderStages::COMPUTE,
+                    ty: wgpu::BindingType::Texture {
+                        sample_type: wgpu::TextureSampleType::Float { filterable: false },
+                        view_dimension: wgpu::TextureViewDimension::D2,
+                        multisampled: false,
+                    },
+                    count: None,
+                },
+                wgpu::BindGroupLayoutEntry {
+                    binding: 4,
+                    visibility: wgpu::ShaderStages::COMPUTE,
+                    ty: wgpu::BindingType::StorageTexture {
+                        access: wgpu::StorageTextureAccess::WriteOnly,
+                        format: wgpu::TextureFormat::R32Float,
+                        view_dimension: wgpu::TextureViewDimension::D2,
+                    },
+                    count: None,
+                },
+            ],
+        });
+        let layout = device.create_pipeline_layout(&wgpu::PipelineLayoutDescriptor {
+            label: Some("vf.Erosion.pipelineLayout"),
+            bind_group_layouts: &[&bgl],
+            push_constant_ranges: &[],
+        });
+        let shader = device.create_shader_module(wgpu::ShaderModuleDescriptor {
+            label: Some("vf.Erosion.shader"),
+            source: wgpu::ShaderSource::Wgsl(include_str!("../shaders/erosion.wgsl").into()),
+        });
+        let pipeline = |entry_point| device.create_compute_pipeline(&wgpu::ComputePipelineDescriptor {
+            label: Some("vf.Erosion.pipeline"),
+            layout: Some(&layout),
+            module: &shader,
+            entry_point,
+        });
+        Self {
+            init: pipeline("cs_init"),
+            passes: [
+                pipeline("cs_flux"),
+                pipeline("cs_erode"),
+                pipeline("cs_transport"),
+                pipeline("cs_talus"),
+                pipeline("cs_slide"),
+            ],
+            store: pipeline("cs_store"),
+            bgl,
+        }
+    }
+
+    /// One ping-pong direction: `src` → `dst` state buffers, the `ErosionParams` UBO, the
+    /// source height texture (read by `cs_init`) and the `R32Float` height target.
+    pub fn bind(&self, device: &wgpu::Device, params: &wgpu::Buffer, src: &wgpu::Buffer, dst: &wgpu::Buffer,
+                height: &wgpu::TextureView, target: &wgpu::TextureView) -> wgpu::BindGroup {
+        device.create_bind_group(&wgpu::BindGroupDescriptor {
+            label: Some("vf.Erosion.bg"),
+            layout: &self.bgl,
+            entries: &[
+                wgpu::BindGroupEntry { binding: 0, resource: params.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 1, resource: src.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 2, resource: dst.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 3, resource: wgpu::BindingResource::TextureView(height) },
+                wgpu::BindGroupEntry { binding: 4, resource: wgpu::BindingResource::TextureView(target) },
+            ],
+        })
+    }
+
+    fn grid(p: &ErosionParams) -> (u32, u32) {
+        ((p.size[0] + WG_EDGE - 1) / WG_EDGE, (p.size[1] + WG_EDGE - 1) / WG_EDGE)
+    }
+
+    /// Load the height texture into the `dst` buffer of `bg`.
+    pub fn encode_init(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, p: &ErosionParams) {
+        let mut cp = encoder.begin_compute_pass(&wgpu::ComputePassDescriptor { label: Some("vf.Erosion.init"), timestamp_writes: None });
+        cp.set_pipeline(&self.init);
+        cp.set_bind_group(0, bg, &[]);
+        let (gx, gy) = Self::grid(p);
+        cp.dispatch_workgroups(gx, gy, 1);
+    }
+
+    /// `iterations` iterations in one compute pass; `bgs[cur]` reads the buffer that holds
+    /// the current state. Returns the new `cur`.
+    pub fn encode_iterations(&self, encoder: &mut wgpu::CommandEncoder, bgs: &[wgpu::BindGroup; 2], mut cur: usize,
+                             p: &ErosionParams, iterations: u32) -> usize {
+        let mut cp = encoder.begin_compute_pass(&wgpu::ComputePassDescriptor { label: Some("vf.Erosion.iterate"), timestamp_writes: None });
+        let (gx, gy) = Self::grid(p);
+        for _ in 0..iterations {
+            for pipeline in &self.passes {
+                cp.set_pipeline(pipeline);
+                cp.set_bind_group(0, &bgs[cur], &[]);
+                cp.dispatch_workgroups(gx, gy, 1);
+                cur ^= 1;
+            }
+        }
+        cur
+    }
+
+    /// Write the current terrain height into the height target.
+    pub fn encode_store(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, p: &ErosionParams) {
+        let mut cp = encoder.begin_compute_pass(&wgpu::ComputePassDescriptor { label: Some("vf.Erosion.store"), timestamp_writes: None });
+        cp.set_pipeline(&self.store);
+        cp.set_bind_group(0, bg, &[]);
+        let (gx, gy) = Self::grid(p);
+        cp.dispatch_workgroups(gx, gy, 1);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn hill(w: u32, h: u32) -> Vec<f32> {
+        (0..w * h)
+            .map(|i| {
+                let (x, y) = ((i % w) as f32 / w as f32 - 0.5, (i / w) as f32 / h as f32 - 0.5);
+                0.4 * (-(x * x + y * y) * 12.0).exp() + 0.03 * (x * 40.0).sin() * (y * 33.0).cos()
+            })
+            .collect()
+    }
+
+    #[test]
+    fn blocks_match_wgsl() {
+        assert_eq!(std::mem::size_of::<Cell>(), 48);
+        assert_eq!(std::mem::size_of::<ErosionParams>(), 48);
+    }
+
+    #[test]
+    fn thermal_conserves_mass_and_lowers_steep_slopes() {
+        let (w, h) = (24, 20);
+        let mut heights = hill(w, h);
+        heights[5 * w as usize + 5] = f32::NAN;
+        let p = ErosionParams { rain: 0.0, talus: 0.2, thermal: 5.0, ..ErosionParams::new(w, h) };
+        let mut sim = ErosionCpu::new(p, &heights);
+        let before: f64 = heights.iter().filter(|v| !v.is_nan()).map(|&v| v as f64).sum();
+        let peak = heights.iter().cloned().filter(|v| !v.is_nan()).fold(f32::MIN, f32::max);
+        sim.run(50);
+        let after: f64 = sim.cells.iter().filter(|c| !c.h.is_nan()).map(|c| c.h as f64).sum();
+        assert!((before - after).abs() < 1e-3, "{} vs {}", before, after);
+        assert!(sim.cells.iter().filter(|c| !c.h.is_nan()).all(|c| c.h < peak + 1e-6));
+        assert!(sim.cells.iter().map(|c| c.h).fold(f32::MIN, f32::max) < peak);
+        assert!(sim.cells[5 * w as usize + 5].h.is_nan());
+    }
+
+    #[test]
+    fn rain_runs_downhill_and_erodes() {
+        let (w, h) = (32, 32);
+        let heights = hill(w, h);
+        let mut sim = ErosionCpu::new(ErosionParams { thermal: 0.0, ..ErosionParams::new(w, h) }, &heights);
+        sim.run(200);
+        assert!(sim.cells.iter().all(|c| c.h.is_finite() && c.w >= 0.0 && c.s.is_finite()));
+        let changed = sim.cells.iter().zip(&heights).filter(|(c, &h0)| (c.h - h0).abs() > 1e-5).count();
+        assert!(changed > (w * h) as usize / 4, "{} cells changed", changed);
+        // Water gathers below the peak, not on it.
+        let centre = sim.cells[(h / 2 * w + w / 2) as usize].w;
+        let rim = sim.cells[(2 * w + 2) as usize].w;
+        assert!(rim >= centre, "rim {} centre {}", rim, centre);
+    }
+
+    #[test]
+    fn flat_dry_terrain_is_a_fixed_point() {
+        let p = ErosionParams { rain: 0.0, ..ErosionParams::new(8, 8) };
+        let mut sim = ErosionCpu::new(p, &[0.25; 64]);
+        sim.run(10);
+        assert!(sim.cells.iter().all(|c| *c == Cell { h: 0.25, ..Cell::default() }));
+    }
+
+    #[test]
+    fn invalid_params_rejected() {
+        assert!(ErosionParams::new(4, 4).validate().is_ok());
+        assert!(ErosionParams { dt: 0.0, ..ErosionParams::new(4, 4) }.validate().is_err());
+        assert!(ErosionParams { rain: f32::NAN, ..ErosionParams::new(4, 4) }.validate().is_err());
+        let mut p = ErosionParams::new(4, 4);
+        for name in super::TUNABLE {
+            p.set(name, 0.5).unwrap();
+        }
+        assert_eq!((p.dt, p.gravity, p.size), (0.5, 0.5, [4, 4]));
+        assert!(p.set("size", 1.0).is_err());
+    }
+}
@@ -0,0 +1,325 @@
+//! Connected flood inundation from seed cells (4-connectivity, NaN = wall).
+//!
+//! `FloodGpu` runs `shaders/flood.wgsl` over the `R32Float` height texture that is already
+//! bound for rendering, so changing seeds or levels never re-uploads the DEM. Two fields
+//! are propagated with atomic max/min on order-preserving `key`s until a pass changes
+//! nothing:
+//! - water surface (`Mode::Surface`): each seed floods the ground below its own level and
+//!   a cell keeps the highest surface that reaches it;
+//! - spill level (`Mode::Spill`): the lowest level at which a cell connects to any seed.
+//!   Computed once, it answers every water level with one per-texel comparison, which is
+//!   what level sweeps use.
+//! `flood_depth_cpu` (priority flood in descending level order) and `spill_levels_cpu`
+//! (minimax Dijkstra) are the references the GPU results are validated against.
+
+use std::cmp::Reverse;
+use std::collections::BinaryHeap;
+
+/// Texels per workgroup edge of the 2-D kernels (`@workgroup_size(16, 16)`).
+const WG_EDGE: u32 = 16;
+/// Invocations per workgroup of `cs_seed`.
+const WG_SEEDS: u32 = 64;
+
+/// Which field the kernels propagate.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Mode {
+    Surface = 0,
+    Spill = 1,
+}
+
+/// Shader uniform block (32 bytes, must match `flood.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct FloodParams {
+    pub size: [u32; 2],
+    pub mode: u32,
+    pub seeds: u32,
+    /// Water level tested by `cs_depth` in spill mode.
+    pub level: f32,
+    pub _p: [f32; 3],
+}
+
+/// One seed cell (16 bytes, must match `flood.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct Seed {
+    pub x: u32,
+    pub y: u32,
+    /// Water level of this seed (surface mode only).
+    pub level: f32,
+    pub _p: f32,
+}
+
+/// Order-preserving f32 → u32 (`a < b` ⇔ `key(a) < key(b)` for non-NaN values).
+pub fn key(f: f32) -> u32 {
+    let b = f.to_bits();
+    if b & 0x8000_0000 != 0 { !b } else { b | 0x8000_0000 }
+}
+
+/// Inverse of `key`.
+pub fn unkey(k: u32) -> f32 {
+    f32::from_bits(if k & 0x8000_0000 != 0 { k & 0x7fff_ffff } else { !k })
+}
+
+fn neighbours(i: usize, w: usize, h: usize) -> impl Iterator<Item = usize> {
+    let (x, y) = (i % w, i / w);
+    [
+        (x > 0).then(|| i - 1),
+        (x + 1 < w).then(|| i + 1),
+        (y > 0).then(|| i - w),
+        (y + 1 < h).then(|| i + w),
+    ]
+    .into_iter()
+    .flatten()
+}
+
+/// Water depth (0 = dry) of a row-major `w × h` DEM flooded from `seeds` (`Seed::level`
+/// each). Seeds are processed from the highest level down: a seed floods every cell
+/// reachable through ground below its level that no higher seed already claimed.
+pub fn flood_depth_cpu(heights: &[f32], w: usize, h: usize, seeds: &[Seed]) -> Vec<f32> {
+    let mut depth = vec![0f32; w * h];
+    let mut claimed = vec![false; w * h];
+    let mut order: Vec<&Seed> = seeds.iter().collect();
+    order.sort_by(|a, b| b.level.total_cmp(&a.level));
+    let mut stack = Vec::new();
+    for s in order {
+        let i = s.y as usize * w + s.x as usize;
+        // NaN ground compares false, so nodata never floods.
+        if claimed[i] || !(heights[i] < s.level) {
+            continue;
+        }
+        claimed[i] = true;
+        stack.push(i);
+        while let Some(c) = stack.pop() {
+            depth[c] = s.level - heights[c];
+            for n in neighbours(c, w, h) {
+                if !claimed[n] && heights[n] < s.level {
+                    claimed[n] = true;
+                    stack.push(n);
+                }
+            }
+        }
+    }
+    depth
+}
+
+/// Lowest water level connecting each cell to a seed (`(x, y)` cells) through 4-neighbours:
+/// the minimum over paths of the highest ground on the path. `+inf` where no path exists
+/// (NaN walls). A cell is wet at level `L` exactly when its spill level is below `L`.
+pub fn spill_levels_cpu(heights: &[f32], w: usize, h: usize, seeds: &[(u32, u32)]) -> Vec<f32> {
+    let mut spill = vec![f32::INFINITY; w * h];
+    let mut heap = BinaryHeap::new();
+    for &(x, y) in seeds {
+        let i = y as usize * w + x as usize;
+        if !heights[i].is_nan() && heights[i] < spill[i] {
+            spill[i] = heights[i];
+            heap.push(Reverse((key(heights[i]), i)));
+        }
+    }
+    while let Some(Reverse((k, c))) = heap.pop() {
+        if k != key(spill[c]) {
+            continue;
+        }
+        for n in neighbours(c, w, h) {
+            if heights[n].is_nan() {
+                continue;
+            }
+            let cand = spill[c].max(heights[n]);
+            if cand < spill[n] {
+                spill[n] = cand;
+                heap.push(Reverse((key(cand), n)));
+            }
+        }
+    }
+    spill
+}
+
+/// Compute pipelines (one per entry point, one shared layout), created once per Scene.
+pub struct FloodGpu {
+    init: wgpu::ComputePipeline,
+    seed: wgpu::ComputePipeline,
+    relax: wgpu::ComputePipeline,
+    depth: wgpu::ComputePipeline,
+    pub bgl: wgpu::BindGroupLayout,
+}
+
+impl FloodGpu {
+    pub fn new(device: &wgpu::Device) -> Self {
+        let buffer = |binding, ty| wgpu::BindGroupLayoutEntry {
+            binding,
+            visibility: wgpu::ShaderStages::COMPUTE,
+            ty: wgpu::BindingType::Buffer { ty, has_dynamic_offset: false, min_binding_size: None },
+            count: None,
+        };
+        let bgl = device.create_bind_group_layout(&wgpu::BindGroupLayoutDescriptor {
+            label: Some("vf.Flood.bgl"),
+            entries: &[
+                wgpu::BindGroupLayoutEntry {
+                    binding: 0,
+                    visibility: wgpu::ShaderStages::COMPUTE,
+                    ty: wgpu::BindingType::Texture {
+                        sample_type: wgpu::TextureSampleType::Float { filterable: false },
+                        view_dimension: wgpu::TextureViewDimension::D2,
+                        multisampled: false,
+                    },
+                    count: None,
+                },
+                buffer(1, wgpu::BufferBindingType::Uniform),
+                buffer(2, wgpu::BufferBindingType::Storage { read_only: false }),
+                buffer(3, wgpu::BufferBindingType::Storage { read_only: true }),
+                buffer(4, wgpu::BufferBindingType::Storage { read_only: false }),
+                wgpu::BindGroupLayoutEntry {
+                    binding: 5,
+                    visibility: wgpu::ShaderStages::COMPUTE,
+                    ty: wgpu::BindingType::StorageTexture {
+                        access: wgpu::StorageTextureAccess::WriteOnly,
+                        format: wgpu::TextureFormat::R32Float,
+                        view_dimension: wgpu::TextureViewDimension::D2,
+                    },
+                    count: None,
+                },
+            ],
+        });
+        let layout = device.create_pipeline_layout(&wgpu::PipelineLayoutDescriptor {
+            label: Some("vf.Flood.pipelineLayout"),
+            bind_group_layouts: &[&bgl],
+            push_constant_ranges: &[],
+        });
+        let shader = device.create_shader_module(wgpu::ShaderModuleDescriptor {
+            label: Some("vf.Flood.shader"),
+            source: wgpu::ShaderSource::Wgsl(include_str!("../shaders/flood.wgsl").into()),
+        });
+        let pipeline = |entry_point| device.create_compute_pipeline(&wgpu::ComputePipelineDescriptor {
+            label: Some("vf.Flood.pipeline"),
+            layout: Some(&layout),
+            module: &shader,
+            entry_point,
+        });
+        Self {
+            init: pipeline("cs_init"),
+            seed: pipeline("cs_seed"),
+            relax: pipeline("cs_relax"),
+            depth: pipeline("cs_depth"),
+            bgl,
+        }
+    }
+
+    /// Bind the height texture, `FloodParams` UBO, the per-texel `field` (u32 each), the
+    /// seeds, the `[changed, wet]` counters and the `R32Float` depth target.
+    pub fn bind(&self, device: &wgpu::Device, height: &wgpu::TextureView, params: &wgpu::Buffer, field: &wgpu::Buffer,
+                seeds: &wgpu::Buffer, counters: &wgpu::Buffer, water: &wgpu::TextureView) -> wgpu::BindGroup {
+        device.create_bind_group(&wgpu::BindGroupDescriptor {
+            label: Some("vf.Flood.bg"),
+            layout: &self.bgl,
+            entries: &[
+                wgpu::BindGroupEntry { binding: 0, resource: wgpu::BindingResource::TextureView(height) },
+                wgpu::BindGroupEntry { binding: 1, resource: params.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 2, resource: field.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 3, resource: seeds.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 4, resource: counters.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 5, resource: wgpu::BindingResource::TextureView(water) },
+            ],
+        })
+    }
+
+    fn pass(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, pipeline: &wgpu::ComputePipeline, groups: (u32, u32), repeat: u32) {
+        let mut cp = encoder.begin_compute_pass(&wgpu::ComputePassDescriptor {
+            label: Some("vf.Flood.pass"),
+            timestamp_writes: None,
+        });
+        cp.set_pipeline(pipeline);
+        cp.set_bind_group(0, bg, &[]);
+        for _ in 0..repeat {
+            cp.dispatch_workgroups(groups.0, groups.1, 1);
+        }
+    }
+
+    fn grid(p: &FloodParams) -> (u32, u32) {
+        ((p.size[0] + WG_EDGE - 1) / WG_EDGE, (p.size[1] + WG_EDGE - 1) / WG_EDGE)
+    }
+
+    /// Reset the field for `p.mode` and write the seeds into it.
+    pub fn encode_start(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, p: &FloodParams) {
+        self.pass(encoder, bg, &self.init, Self::grid(p), 1);
+        self.pass(encoder, bg, &self.seed, ((p.seeds + WG_SEEDS - 1) / WG_SEEDS, 1), 1);
+    }
+
+    /// `repeat` relaxation dispatches (each runs `LOCAL_ITERS` steps per tile); they raise
+    /// `counters[0]` if anything changed.
+    pub fn encode_relax(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, p: &FloodParams, repeat: u32) {
+        self.pass(encoder, bg, &self.relax, Self::grid(p), repeat);
+    }
+
+    /// Write water depth into the target and add the wet cells to `counters[1]`.
+    pub fn encode_depth(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, p: &FloodParams) {
+        self.pass(encoder, bg, &self.depth, Self::grid(p), 1);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn seed(x: u32, y: u32, level: f32) -> Seed {
+        Seed { x, y, level, _p: 0.0 }
+    }
+
+    #[test]
+    fn blocks_match_wgsl() {
+        assert_eq!(std::mem::size_of::<FloodParams>(), 32);
+        assert_eq!(std::mem::size_of::<Seed>(), 16);
+    }
+
+    #[test]
+    fn keys_preserve_order() {
+        let v = [f32::NEG_INFINITY, -3.5, -0.0, 0.0, 1e-30, 2.0, f32::INFINITY];
+        for pair in v.windows(2) {
+            assert!(key(pair[0]) <= key(pair[1]), "{:?}", pair);
+        }
+        for x in v {
+            assert_eq!(unkey(key(x)).to_bits(), x.to_bits());
+        }
+    }
+
+    #[test]
+    fn ridge_separates_basins_until_overtopped() {
+        // Two basins split by a ridge of height 5 in column 2.
+        let h = [
+            1.0, 1.0, 5.0, 0.0, 0.0,
+            1.0, 2.0, 5.0, 0.0, 0.0,
+        ];
+        let low = flood_depth_cpu(&h, 5, 2, &[seed(0, 0, 3.0)]);
+        assert_eq!(low, vec![2.0, 2.0, 0.0, 0.0, 0.0, 2.0, 1.0, 0.0, 0.0, 0.0]);
+        let high = flood_depth_cpu(&h, 5, 2, &[seed(0, 0, 6.0)]);
+        assert!(high.iter().all(|&d| d > 0.0));
+        let spill = spill_levels_cpu(&h, 5, 2, &[(0, 0)]);
+        assert_eq!(spill, vec![1.0, 1.0, 5.0, 5.0, 5.0, 1.0, 2.0, 5.0, 5.0, 5.0]);
+    }
+
+    #[test]
+    fn higher_seed_wins_and_nan_is_a_wall() {
+        let h = [0.0, f32::NAN, 0.0, 0.0];
+        let d = flood_depth_cpu(&h, 4, 1, &[seed(0, 0, 1.0), seed(3, 0, 2.0)]);
+        assert_eq!(d, vec![1.0, 0.0, 2.0, 2.0]);
+        let s = spill_levels_cpu(&h, 4, 1, &[(0, 0)]);
+        assert_eq!((s[0], s[2]), (0.0, f32::INFINITY));
+        assert!(s[1].is_infinite());
+    }
+
+    #[test]
+    fn spill_levels_agree_with_uniform_flood() {
+        let (w, h) = (23, 17);
+        let dem: Vec<f32> = (0..w * h)
+            .map(|i| (((i * 7919) % 97) as f32 / 97.0) + ((i % w) as f32 * 0.3).sin())
+            .collect();
+        let cells = [(3u32, 4u32), (20, 10)];
+        let spill = spill_levels_cpu(&dem, w, h, &cells);
+        for level in [-0.5f32, 0.2, 0.7, 1.1, 1.6, 2.5] {
+            let seeds: Vec<Seed> = cells.iter().map(|&(x, y)| seed(x, y, level)).collect();
+            let depth = flood_depth_cpu(&dem, w, h, &seeds);
+            for i in 0..w * h {
+                assert_eq!(depth[i] > 0.0, spill[i] < level, "level {} cell {}", level, i);
+            }
+        }
+    }
+}
@@ -0,0 +1,647 @@
+//! Hydrology preprocessing on row-major DEMs: depression filling, D8 / D-infinity flow
+//! direction and flow accumulation. NaN cells are nodata; water leaves the DEM through its
+//! border and through cells next to nodata.
+//!
+//! Filling and D8 accumulation are tiled so tiles run in parallel (rayon) and only a small
+//! graph is solved serially:
+//! - `fill_depressions` (after Barnes 2016): every tile is priority-flooded from its own
+//!   perimeter, which labels each cell with the perimeter watershed it drains to and records
+//!   spill elevations between neighbouring watersheds (inside the tile and across tile
+//!   edges). A minimax search over that watershed graph from the outside gives each
+//!   watershed its water level, and a cell's filled height is the larger of its tile-local
+//!   fill and that level. `fill_depressions_serial` is the single-queue reference.
+//! - `accumulate_d8`: each tile accumulates its own cells in topological order and maps every
+//!   cell to the cell where its flow leaves the tile; flow crossing tile edges is resolved on
+//!   the graph of those exits, then each tile adds the inflow at its entry cells in one more
+//!   topological pass.
+//! D-infinity accumulation splits flow between two receivers, so it runs as one serial
+//! topological pass after a parallel in-degree count.
+
+use std::cmp::Reverse;
+use std::collections::{BinaryHeap, HashMap, VecDeque};
+
+use rayon::prelude::*;
+
+use super::flood::key;
+
+/// ESRI D8 codes (E, SE, S, SW, W, NW, N, NE; 0 = no receiver), one per `D8_OFFSETS` entry.
+pub const D8_CODES: [u8; 8] = [1, 2, 4, 8, 16, 32, 64, 128];
+/// `(dx, dy)` per D8 direction; rows grow southwards.
+pub const D8_OFFSETS: [(i32, i32); 8] = [(1, 0), (1, 1), (0, 1), (-1, 1), (-1, 0), (-1, -1), (0, -1), (1, -1)];
+/// Default tile edge for the tiled kernels.
+pub const DEFAULT_TILE: usize = 512;
+/// D-infinity angle of cells without a downslope receiver.
+pub const DINF_NONE: f32 = -1.0;
+
+const NONE: u32 = u32::MAX;
+const OCEAN: u32 = 0;
+
+/// A row-major `w × h` grid.
+#[derive(Debug, Clone, Copy)]
+pub struct Grid {
+    pub w: usize,
+    pub h: usize,
+}
+
+impl Grid {
+    fn neighbour(&self, i: usize, k: usize) -> Option<usize> {
+        let (x, y) = ((i % self.w) as i32 + D8_OFFSETS[k].0, (i / self.w) as i32 + D8_OFFSETS[k].1);
+        (x >= 0 && y >= 0 && (x as usize) < self.w && (y as usize) < self.h).then(|| y as usize * self.w + x as usize)
+    }
+
+    /// On the DEM border or next to nodata: water can leave the DEM here.
+    fn is_outlet(&self, dem: &[f32], i: usize) -> bool {
+        (0..8).any(|k| self.neighbour(i, k).map_or(true, |n| dem[n].is_nan()))
+    }
+
+    fn receiver(&self, code: u8, i: usize) -> Option<usize> {
+        D8_CODES.iter().position(|&c| c == code).and_then(|k| self.neighbour(i, k))
+    }
+}
+
+fn distance(k: usize) -> f32 {
+    if k % 2 == 1 { std::f32::consts::SQRT_2 } else { 1.0 }
+}
+
+/// Single priority queue fill (Barnes 2014, no epsilon): every cell is raised to the lowest
+/// level at which water on it can reach an outlet (8-connectivity).
+pub fn fill_depressions_serial(dem: &[f32], g: Grid) -> Vec<f32> {
+    let mut out = dem.to_vec();
+    let mut closed = vec![false; dem.len()];
+    let mut pq = BinaryHeap::new();
+    for i in 0..dem.len() {
+        if !dem[i].is_nan() && g.is_outlet(dem, i) {
+            closed[i] = true;
+            pq.push(Reverse((key(dem[i]), i)));
+        }
+    }
+    while let Some(Reverse((_, c))) = pq.pop() {
+        for k in 0..8 {
+            if let Some(n) = g.neighbour(c, k) {
+                if !closed[n] && !dem[n].is_nan() {
+                    closed[n] = true;
+                    out[n] = dem[n].max(out[c]);
+                    pq.push(Reverse((key(out[n]), n)));
+                }
+            }
+        }
+    }
+    out
+}
+
+/// Tile `t` of a `tile`-sized tiling: `(x0, y0, tw, th)`.
+#[derive(Debug, Clone, Copy)]
+struct Tile {
+    x0: usize,
+    y0: usize,
+    tw: usize,
+    th: usize,
+}
+
+impl Tile {
+    fn all(g: Grid, tile: usize) -> Vec<Tile> {
+        let mut v = Vec::new();
+        for y0 in (0..g.h).step_by(tile) {
+            for x0 in (0..g.w).step_by(tile) {
+                v.push(Tile { x0, y0, tw: tile.min(g.w - x0), th: tile.min(g.h - y0) });
+            }
+        }
+        v
+    }
+
+    fn global(&self, g: Grid, l: usize) -> usize {
+        (self.y0 + l / self.tw) * g.w + self.x0 + l % self.tw
+    }
+
+    /// Local index of global cell `i`, if it lies in this tile.
+    fn local(&self, g: Grid, i: usize) -> Option<usize> {
+        let (x, y) = (i % g.w, i / g.w);
+        (x >= self.x0 && y >= self.y0 && x < self.x0 + self.tw && y < self.y0 + self.th)
+            .then(|| (y - self.y0) * self.tw + x - self.x0)
+    }
+
+    fn on_perimeter(&self, l: usize) -> bool {
+        let (x, y) = (l % self.tw, l / self.tw);
+        x == 0 || y == 0 || x + 1 == self.tw || y + 1 == self.th
+    }
+}
+
+/// Tile-local fill: filled heights, watershed labels (1-based, 0 = nodata) and the
+/// minimum spill elevation between labels (`OCEAN` = leaves the DEM).
+struct TileFill {
+    filled: Vec<f32>,
+    labels: Vec<u32>,
+    count: u32,
+    edges: HashMap<(u32, u32), f32>,
+}
+
+fn add_edge(edges: &mut HashMap<(u32, u32), f32>, a: u32, b: u32, e: f32) {
+    let k = if a < b { (a, b) } else { (b, a) };
+    let v = edges.entry(k).or_insert(f32::INFINITY);
+    *v = v.min(e);
+}
+
+fn fill_tile(dem: &[f32], g: Grid, t: Tile) -> TileFill {
+    let n = t.tw * t.th;
+    let mut filled = vec![f32::NAN; n];
+    let mut labels = vec![0u32; n];
+    let mut closed = vec![false; n];
+    let mut edges = HashMap::new();
+    let mut count = 0;
+    let mut pq = BinaryHeap::new();
+    for l in 0..n {
+        let i = t.global(g, l);
+        if !dem[i].is_nan() && (t.on_perimeter(l) || g.is_outlet(dem, i)) {
+            closed[l] = true;
+            filled[l] = dem[i];
+            pq.push(Reverse((key(dem[i]), l)));
+        }
+    }
+    while let Some(Reverse((_, c))) = pq.pop() {
+        let ci = t.global(g, c);
+        if labels[c] == 0 {
+            count += 1;
+            labels[c] = count;
+        }
+        if g.is_outlet(dem, ci) {
+            add_edge(&mut edges, labels[c], OCEAN, filled[c]);
+        }
+        for k in 0..8 {
+            let Some(ni) = g.neighbour(ci, k) else { continue };
+            let Some(nl) = t.local(g, ni) else { continue };
+            if dem[ni].is_nan() {
+                continue;
+            }
+            if labels[nl] == 0 {
+                labels[nl] = labels[c];
+                if !closed[nl] {
+                    closed[nl] = true;
+                    filled[nl] = dem[ni].max(filled[c]);
+                    pq.push(Reverse((key(filled[nl]), nl)));
+                }
+            } else if labels[nl] != labels[c] {
+                add_edge(&mut edges, labels[c], labels[nl], filled[c].max(filled[nl]));
+            }
+        }
+    }
+    TileFill { filled, labels, count, edges }
+}
+
+/// Parallel tiled fill; equal to `fill_depressions_serial` for any `tile >= 2`.
+pub fn fill_depressions(dem: &[f32], g: Grid, tile: usize) -> Vec<f32> {
+    let tile = tile.max(2);
+    let tiles = Tile::all(g, tile);
+    let fills: Vec<TileFill> = tiles.par_iter().map(|&t| fill_tile(dem, g, t)).collect();
+    // Global label ids: OCEAN = 0, then each tile's labels after the previous tiles'.
+    let mut offset = Vec::with_capacity(fills.len());
+    let mut total = 1u32;
+    for f in &fills {
+        offset.push(total - 1);
+        total += f.count;
+    }
+    let tiles_x = (g.w + tile - 1) / tile;
+    let label_of = |i: usize| -> u32 {
+        let ti = (i / g.w / tile) * tiles_x + (i % g.w) / tile;
+        let l = fills[ti].labels[tiles[ti].local(g, i).unwrap()];
+        if l == 0 { NONE } else { l + offset[ti] }
+    };
+    // Spill edges: within tiles, and between perimeter cells of neighbouring tiles.
+    let edges: Vec<(u32, u32, f32)> = tiles
+        .par_iter()
+        .enumerate()
+        .flat_map_iter(|(ti, t)| {
+            let f = &fills[ti];
+            let mut e: Vec<(u32, u32, f32)> = f.edges.iter()
+                .map(|(&(a, b), &w)| (if a == OCEAN { OCEAN } else { a + offset[ti] }, b + offset[ti], w))
+                .collect();
+            let mut cross = HashMap::new();
+            for l in (0..t.tw * t.th).filter(|&l| t.on_perimeter(l) && f.labels[l] != 0) {
+                let i = t.global(g, l);
+                for k in 0..8 {
+                    if let Some(n) = g.neighbour(i, k).filter(|&n| t.local(g, n).is_none() && !dem[n].is_nan()) {
+                        add_edge(&mut cross, f.labels[l] + offset[ti], label_of(n), dem[i].max(dem[n]));
+                    }
+                }
+            }
+            e.extend(cross.into_iter().map(|((a, b), w)| (a, b, w)));
+            e.into_iter()
+        })
+        .collect();
+    // Minimax search from OCEAN over the watershed graph.
+    let mut adj: Vec<Vec<(u32, f32)>> = vec![Vec::new(); total as usize];
+    for &(a, b, w) in &edges {
+        adj[a as usize].push((b, w));
+        adj[b as usize].push((a, w));
+    }
+    let mut level = vec![f32::INFINITY; total as usize];
+    level[OCEAN as usize] = f32::NEG_INFINITY;
+    let mut pq = BinaryHeap::new();
+    pq.push(Reverse((key(f32::NEG_INFINITY), OCEAN)));
+    while let Some(Reverse((k, u))) = pq.pop() {
+        if k != key(level[u as usize]) {
+            continue;
+        }
+        for &(v, w) in &adj[u as usize] {
+            let cand = level[u as usize].max(w);
+            if cand < level[v as usize] {
+                level[v as usize] = cand;
+                pq.push(Reverse((key(cand), v)));
+            }
+        }
+    }
+    let mut out = vec![f32::NAN; dem.len()];
+    out.par_chunks_mut(g.w).enumerate().for_each(|(y, row)| {
+        let ty = y / tile;
+        for (x, o) in row.iter_mut().enumerate() {
+            let ti = ty * tiles_x + x / tile;
+            let (t, f) = (&tiles[ti], &fills[ti]);
+            let l = (y - t.y0) * t.tw + x - t.x0;
+            if f.labels[l] != 0 {
+                let lv = level[(f.labels[l] + offset[ti]) as usize];
+                *o = if lv.is_finite() { f.filled[l].max(lv) } else { f.filled[l] };
+            }
+        }
+    });
+    out
+}
+
+/// Steepest-descent D8 codes (`D8_CODES`; 0 = outlet, pit or nodata). Cells on flats are
+/// routed toward the nearest lower cell or outlet of the same flat (breadth-first), so a
+/// filled DEM gets a receiver everywhere except at outlets.
+pub fn d8_directions(dem: &[f32], g: Grid) -> Vec<u8> {
+    let mut dir = vec![0u8; dem.len()];
+    dir.par_chunks_mut(g.w).enumerate().for_each(|(y, row)| {
+        for (x, d) in row.iter_mut().enumerate() {
+            let i = y * g.w + x;
+            let mut best = 0.0f32;
+            for k in 0..8 {
+                if let Some(n) = g.neighbour(i, k) {
+                    let s = (dem[i] - dem[n]) / distance(k);
+                    if s > best {
+                        best = s;
+                        *d = D8_CODES[k];
+                    }
+                }
+            }
+        }
+    });
+    resolve_flats(dem, g, &mut dir);
+    dir
+}
+
+fn resolve_flats(dem: &[f32], g: Grid, dir: &mut [u8]) {
+    let unresolved = |dir: &[u8], i: usize| dir[i] == 0 && !dem[i].is_nan() && !g.is_outlet(dem, i);
+    let seeds: Vec<usize> = (0..dem.len())
+        .into_par_iter()
+        .filter(|&i| {
+            !dem[i].is_nan()
+                && !unresolved(dir, i)
+                && (0..8).any(|k| g.neighbour(i, k).map_or(false, |n| dem[n] == dem[i] && unresolved(dir, n)))
+        })
+        .collect();
+    let mut queue: VecDeque<usize> = seeds.into();
+    while let Some(c) = queue.pop_front() {
+        for k in 0..8 {
+            if let Some(n) = g.neighbour(c, k) {
+                if dem[n] == dem[c] && unresolved(dir, n) {
+                    dir[n] = D8_CODES[(k + 4) % 8];
+                    queue.push_back(n);
+                }
+            }
+        }
+    }
+}
+
+/// D-infinity (Tarboton 1997) flow angles in radians counter-clockwise from east (north =
+/// up = decreasing row), or `DINF_NONE`. Flat cells take their D8 flat-routing direction.
+pub fn dinf_directions(dem: &[f32], g: Grid) -> Vec<f32> {
+    // (e1, e2) D8 indices, ac, af per facet.
+    const FACETS: [(usize, usize, f32, f32); 8] = [
+        (0, 7, 0.0, 1.0), (6, 7, 1.0, -1.0), (6, 5, 1.0, 1.0), (4, 5, 2.0, -1.0),
+        (4, 3, 2.0, 1.0), (2, 3, 3.0, -1.0), (2, 1, 3.0, 1.0), (0, 1, 4.0, -1.0),
+    ];
+    let quarter = std::f32::consts::FRAC_PI_2;
+    let mut ang = vec![DINF_NONE; dem.len()];
+    ang.par_chunks_mut(g.w).enumerate().for_each(|(y, row)| {
+        for (x, a) in row.iter_mut().enumerate() {
+            let i = y * g.w + x;
+            if dem[i].is_nan() {
+                continue;
+            }
+            let mut best = 0.0f32;
+            for &(k1, k2, ac, af) in &FACETS {
+                let (Some(n1), Some(n2)) = (g.neighbour(i, k1), g.neighbour(i, k2)) else { continue };
+                let (e1, e2) = (dem[n1], dem[n2]);
+                if e1.is_nan() || e2.is_nan() {
+                    continue;
+                }
+                let (s1, s2) = (dem[i] - e1, e1 - e2);
+                let (r, s) = match s2.atan2(s1) {
+                    r if r < 0.0 => (0.0, s1),
+                    r if r > std::f32::consts::FRAC_PI_4 => (std::f32::consts::FRAC_PI_4, (dem[i] - e2) / std::f32::consts::SQRT_2),
+                    r => (r, s1.hypot(s2)),
+                };
+                if s > best {
+                    best = s;
+                    *a = (af * r + ac * quarter) % std::f32::consts::TAU;
+                }
+            }
+        }
+    });
+    if ang.par_iter().enumerate().any(|(i, &a)| a == DINF_NONE && !dem[i].is_nan() && !g.is_outlet(dem, i)) {
+        let d8 = d8_directions(dem, g);
+        ang.par_iter_mut().enumerate().for_each(|(i, a)| {
+            if *a == DINF_NONE {
+                if let Some(k) = D8_CODES.iter().position(|&c| c == d8[i]) {
+                    *a = (8 - k) as f32 % 8.0 * std::f32::consts::FRAC_PI_4;
+                }
+            }
+        });
+    }
+    ang
+}
+
+/// Per-tile topological order and exits of a D8 grid.
+struct TileFlow {
+    /// Local cells, upstream before downstream.
+    order: Vec<u32>,
+    /// Cells counted in the tile (itself plus in-tile upstream cells).
+    local: Vec<f64>,
+    /// Last in-tile cell on each cell's downstream path if that path leaves the tile.
+    exit: Vec<u32>,
+}
+
+fn flow_tile(dem: &[f32], dir: &[u8], g: Grid, t: Tile) -> TileFlow {
+    let n = t.tw * t.th;
+    let recv = |l: usize| g.receiver(dir[t.global(g, l)], t.global(g, l));
+    let mut indeg = vec![0u32; n];
+    for l in 0..n {
+        if let Some(r) = recv(l).and_then(|r| t.local(g, r)) {
+            indeg[r] += 1;
+        }
+    }
+    let mut order: Vec<u32> = (0..n as u32).filter(|&l| indeg[l as usize] == 0).collect();
+    let mut local = vec![0f64; n];
+    let mut head = 0;
+    while head < order.len() {
+        let l = order[head] as usize;
+        head += 1;
+        if dem[t.global(g, l)].is_nan() {
+            continue;
+        }
+        local[l] += 1.0;
+        if let Some(r) = recv(l).and_then(|r| t.local(g, r)) {
+            local[r] += local[l];
+            indeg[r] -= 1;
+            if indeg[r] == 0 {
+                order.push(r as u32);
+            }
+        }
+    }
+    let mut exit = vec![NONE; n];
+    for &l in order.iter().rev() {
+        let l = l as usize;
+        exit[l] = match recv(l) {
+            Some(r) => match t.local(g, r) {
+                Some(rl) => exit[rl],
+                None if !dem[r].is_nan() => l as u32,
+                None => NONE,
+            },
+            None => NONE,
+        };
+    }
+    TileFlow { order, local, exit }
+}
+
+/// Tiled parallel D8 flow accumulation: number of cells (itself included) draining through
+/// each cell; NaN on nodata.
+pub fn accumulate_d8(dem: &[f32], dir: &[u8], g: Grid, tile: usize) -> Vec<f32> {
+    let tile = tile.max(2);
+    let tiles = Tile::all(g, tile);
+    let tiles_x = (g.w + tile - 1) / tile;
+    let tile_of = |i: usize| (i / g.w / tile) * tiles_x + (i % g.w) / tile;
+    let flows: Vec<TileFlow> = tiles.par_iter().map(|&t| flow_tile(dem, dir, g, t)).collect();
+
+    // Exit cells (global index) and where their flow enters the next tile.
+    let exits: Vec<usize> = tiles
+        .par_iter()
+        .enumerate()
+        .flat_map_iter(|(ti, t)| {
+            let f = &flows[ti];
+            (0..t.tw * t.th).filter(move |&l| f.exit[l] == l as u32).map(move |l| t.global(g, l))
+        })
+        .collect();
+    let node: HashMap<usize, usize> = exits.iter().enumerate().map(|(k, &i)| (i, k)).collect();
+    // The exit an entry cell's flow reaches in its own tile.
+    let exit_after = |r: usize| -> Option<usize> {
+        let ti = tile_of(r);
+        let e = flows[ti].exit[tiles[ti].local(g, r).unwrap()];
+        (e != NONE).then(|| node[&tiles[ti].global(g, e as usize)])
+    };
+    let mut indeg = vec![0u32; exits.len()];
+    for &q in &exits {
+        if let Some(k) = exit_after(g.receiver(dir[q], q).unwrap()) {
+            indeg[k] += 1;
+        }
+    }
+    let mut inflow = vec![0f64; exits.len()];
+    let mut entry: HashMap<usize, f64> = HashMap::new();
+    let mut queue: Vec<usize> = (0..exits.len()).filter(|&k| indeg[k] == 0).collect();
+    while let Some(k) = queue.pop() {
+        let q = exits[k];
+        let out = flows[tile_of(q)].local[tiles[tile_of(q)].local(g, q).unwrap()] + inflow[k];
+        let r = g.receiver(dir[q], q).unwrap();
+        *entry.entry(r).or_insert(0.0) += out;
+        if let Some(k2) = exit_after(r) {
+            inflow[k2] += out;
+            indeg[k2] -= 1;
+            if indeg[k2] == 0 {
+                queue.push(k2);
+            }
+        }
+    }
+
+    // Add the entries' inflow along each tile's topological order.
+    let mut entries: Vec<Vec<(usize, f64)>> = vec![Vec::new(); tiles.len()];
+    for (&r, &v) in &entry {
+        let ti = tile_of(r);
+        entries[ti].push((tiles[ti].local(g, r).unwrap(), v));
+    }
+    let totals: Vec<Vec<f64>> = tiles
+        .par_iter()
+        .enumerate()
+        .map(|(ti, t)| {
+            let f = &flows[ti];
+            let mut acc = f.local.clone();
+            if !entries[ti].is_empty() {
+                let mut add = vec![0f64; acc.len()];
+                for &(l, v) in &entries[ti] {
+                    add[l] += v;
+                }
+                for &l in &f.order {
+                    let l = l as usize;
+                    acc[l] += add[l];
+                    let i = t.global(g, l);
+                    if let Some(r) = g.receiver(dir[i], i).and_then(|r| t.local(g, r)) {
+                        add[r] += add[l];
+                    }
+                }
+            }
+            acc
+        })
+        .collect();
+    let mut out = vec![f32::NAN; dem.len()];
+    out.par_chunks_mut(g.w).enumerate().for_each(|(y, row)| {
+        for (x, o) in row.iter_mut().enumerate() {
+            let i = y * g.w + x;
+            if !dem[i].is_nan() {
+                let ti = tile_of(i);
+                *o = totals[ti][tiles[ti].local(g, i).unwrap()] as f32;
+            }
+        }
+    });
+    out
+}
+
+/// D-infinity flow accumulation (flow split between the two cells bounding each angle in
+/// proportion to the angle). Serial topological pass after a parallel in-degree count.
+pub fn accumulate_dinf(dem: &[f32], ang: &[f32], g: Grid) -> Vec<f32> {
+    let eighth = std::f32::consts::FRAC_PI_4;
+    // Receivers (cell, share) of cell i; D8 index k at angle k * 45° CCW from east is
+    // D8_OFFSETS index (8 - k) % 8.
+    let split = |i: usize| -> [(Option<usize>, f64); 2] {
+        let a = ang[i];
+        if a < 0.0 || dem[i].is_nan() {
+            return [(None, 0.0), (None, 0.0)];
+        }
+        let k = ((a / eighth).floor() as usize).min(7);
+        let p2 = ((a - k as f32 * eighth) / eighth).clamp(0.0, 1.0) as f64;
+        let valid = |n: Option<usize>| n.filter(|&n| !dem[n].is_nan());
+        [
+            (valid(g.neighbour(i, (8 - k) % 8)), 1.0 - p2),
+            (valid(g.neighbour(i, (16 - k - 1) % 8)), p2),
+        ]
+    };
+    let indeg: Vec<std::sync::atomic::AtomicU32> = (0..dem.len()).map(|_| std::sync::atomic::AtomicU32::new(0)).collect();
+    (0..dem.len()).into_par_iter().for_each(|i| {
+        for (n, p) in split(i) {
+            if let Some(n) = n.filter(|_| p > 0.0) {
+                indeg[n].fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+            }
+        }
+    });
+    let mut indeg: Vec<u32> = indeg.into_iter().map(|a| a.into_inner()).collect();
+    let mut acc = vec![0f64; dem.len()];
+    let mut stack: Vec<usize> = (0..dem.len()).filter(|&i| indeg[i] == 0).collect();
+    while let Some(i) = stack.pop() {
+        if dem[i].is_nan() {
+            continue;
+        }
+        acc[i] += 1.0;
+        for (n, p) in split(i) {
+            if let Some(n) = n.filter(|_| p > 0.0) {
+                acc[n] += acc[i] * p;
+                indeg[n] -= 1;
+                if indeg[n] == 0 {
+                    stack.push(n);
+                }
+            }
+        }
+    }
+    acc.par_iter().zip(dem.par_iter()).map(|(&a, &h)| if h.is_nan() { f32::NAN } else { a as f32 }).collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn rough(w: usize, h: usize) -> Vec<f32> {
+        (0..w * h)
+            .map(|i| {
+                let (x, y) = ((i % w) as f32, (i / w) as f32);
+                (x * 0.37).sin() * (y * 0.23).cos() + (((i * 2654435761usize) >> 7) % 101) as f32 * 0.01
+            })
+            .collect()
+    }
+
+    #[test]
+    fn tiled_fill_matches_serial() {
+        let g = Grid { w: 67, h: 41 };
+        let mut dem = rough(g.w, g.h);
+        dem[20 * g.w + 30] = f32::NAN;
+        let serial = fill_depressions_serial(&dem, g);
+        for tile in [2, 5, 16, 64, 128] {
+            let tiled = fill_depressions(&dem, g, tile);
+            for i in 0..dem.len() {
+                assert!(serial[i] == tiled[i] || (serial[i].is_nan() && tiled[i].is_nan()), "tile {} cell {}", tile, i);
+            }
+        }
+        assert!(serial.iter().zip(&dem).all(|(f, h)| !(f < h)));
+    }
+
+    #[test]
+    fn filled_pit_drains_everywhere() {
+        let g = Grid { w: 5, h: 5 };
+        let mut dem = vec![2.0f32; 25];
+        dem[12] = 0.0;
+        dem[2] = 1.0;
+        let filled = fill_depressions(&dem, g, 3);
+        assert_eq!(filled[12], 2.0);
+        let dir = d8_directions(&filled, g);
+        for i in 0..25 {
+            assert!(dir[i] != 0 || g.is_outlet(&filled, i), "cell {} has no receiver", i);
+        }
+        let acc = accumulate_d8(&filled, &dir, g, 2);
+        let outflow: f32 = (0..25).filter(|&i| dir[i] == 0).map(|i| acc[i]).sum();
+        assert_eq!(outflow, 25.0);
+    }
+
+    #[test]
+    fn d8_codes_and_accumulation_on_a_ramp() {
+        // Slopes down to the east: every cell drains east, accumulation counts the row.
+        let g = Grid { w: 6, h: 3 };
+        let dem: Vec<f32> = (0..18).map(|i| 10.0 - (i % 6) as f32).collect();
+        let dir = d8_directions(&dem, g);
+        assert!((0..18).filter(|i| i % 6 != 5).all(|i| dir[i] == 1));
+        for tile in [2, 3, 4, 64] {
+            let acc = accumulate_d8(&dem, &dir, g, tile);
+            assert_eq!(&acc[..6], &[1.0, 2.0, 3.0, 4.0, 5.0, 6.0]);
+        }
+        let ang = dinf_directions(&dem, g);
+        assert!((0..18).filter(|i| i % 6 != 5).all(|i| ang[i].abs() < 1e-6));
+        let acc = accumulate_dinf(&dem, &ang, g);
+        assert_eq!(&acc[6..12], &[1.0, 2.0, 3.0, 4.0, 5.0, 6.0]);
+    }
+
+    #[test]
+    fn tiled_accumulation_matches_single_tile() {
+        let g = Grid { w: 53, h: 37 };
+        let mut dem = rough(g.w, g.h);
+        dem[10 * g.w + 10] = f32::NAN;
+        let filled = fill_depressions(&dem, g, 16);
+        let dir = d8_directions(&filled, g);
+        let whole = accumulate_d8(&filled, &dir, g, 1 << 20);
+        for tile in [2, 7, 16] {
+            let tiled = accumulate_d8(&filled, &dir, g, tile);
+            for i in 0..dem.len() {
+                assert!(whole[i] == tiled[i] || (whole[i].is_nan() && tiled[i].is_nan()), "tile {} cell {}", tile, i);
+            }
+        }
+        let valid = dem.iter().filter(|h| !h.is_nan()).count() as f32;
+        let outflow: f32 = (0..dem.len()).filter(|&i| dir[i] == 0 && !dem[i].is_nan()).map(|i| whole[i]).sum();
+        assert_eq!(outflow, valid);
+    }
+
+    #[test]
+    fn dinf_splits_between_facet_neighbours() {
+        // Plane falling toward the east-north-east: angle between E (0) and NE (45°).
+        let g = Grid { w: 9, h: 9 };
+        let dem: Vec<f32> = (0..81).map(|i| -((i % 9) as f32) * 1.0 + (i / 9) as f32 * 0.5).collect();
+        let ang = dinf_directions(&dem, g);
+        let c = ang[4 * 9 + 4];
+        assert!((c - 0.5f32.atan2(1.0)).abs() < 1e-5, "{}", c);
+        let acc = accumulate_dinf(&dem, &ang, g);
+        let total: f32 = (0..81).filter(|&i| g.is_outlet(&dem, i)).map(|i| acc[i]).sum::<f32>();
+        assert!(total >= 81.0 - 1e-3);
+    }
+}
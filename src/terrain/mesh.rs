@@ -147,6 +147,7 @@ use pyo3::Bound;
 use numpy::{PyArray2, PyArray1};
 
 #[pyfunction]
+#[pyo3(signature = (nx, nz, spacing, origin=None))]
 #[pyo3(text_signature = "(nx, nz, spacing=(1.0,1.0), origin='center')")]
 /// Generate a regular grid mesh for heightmaps.
 /// 
@@ -188,8 +189,8 @@ pub fn grid_generate(py: Python<'_>, nx: u32, nz: u32, spacing: (f32, f32), orig
     }
     
     // Create numpy arrays using zero-copy where possible
-    let xy_array = numpy::PyArray2::from_vec2_bound(py, &xy_flat.chunks_exact(2).map(|chunk| chunk.to_vec()).collect::<Vec<_>>())?;
-    let uv_array = numpy::PyArray2::from_vec2_bound(py, &uv_flat.chunks_exact(2).map(|chunk| chunk.to_vec()).collect::<Vec<_>>())?;
+    let xy_array = numpy::PyArray2::from_vec2(py, &xy_flat.chunks_exact(2).map(|chunk| chunk.to_vec()).collect::<Vec<_>>())?;
+    let uv_array = numpy::PyArray2::from_vec2(py, &uv_flat.chunks_exact(2).map(|chunk| chunk.to_vec()).collect::<Vec<_>>())?;
     
     // Convert indices to u32 if needed
     let indices_u32: Vec<u32> = match mesh.indices {
@@ -197,7 +198,7 @@ pub fn grid_generate(py: Python<'_>, nx: u32, nz: u32, spacing: (f32, f32), orig
         Indices::U32(ref indices_u32) => indices_u32.clone(),
     };
     
-    let idx_array = numpy::PyArray1::from_vec_bound(py, indices_u32);
+    let idx_array = numpy::PyArray1::from_vec(py, indices_u32);
     
     Ok((xy_array, uv_array, idx_array))
 }
@@ -11,6 +11,16 @@ pub mod pipeline;
 pub use pipeline::TerrainPipeline;
 // T33-END:terrain-mod
 
+pub mod diff;
+pub mod erosion;
+pub mod flood;
+pub mod hydro;
+pub mod procgen;
+pub mod projected;
+pub mod resolve;
+pub mod temporal;
+pub mod variants;
+
 use pyo3::prelude::*;
 use std::num::NonZeroU32;
 use wgpu::util::DeviceExt;
@@ -174,6 +184,31 @@ impl TerrainUniforms {
     }
 }
 
+// ---------- Per-draw push constants (PUSH_CONSTANTS permutation, 112 bytes) ----------
+
+/// Camera + per-draw parameters for the push-constant fast path; must match `DrawPush`
+/// in terrain.wgsl and stay within `device_caps::TERRAIN_PUSH_BYTES`.
+#[repr(C)]
+#[derive(Debug, Copy, Clone, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct DrawPush {
+    pub view_proj: [[f32; 4]; 4],      // 64 B
+    pub sun_exposure: [f32; 4],        // 16 B
+    pub spacing_h_exag_pad: [f32; 4],  // 16 B
+    pub offset: [f32; 4],              // xyz = world translation of this draw
+}
+
+impl DrawPush {
+    pub fn from_uniforms(u: &TerrainUniforms, offset: [f32; 3]) -> Self {
+        let vp = glam::Mat4::from_cols_array_2d(&u.proj) * glam::Mat4::from_cols_array_2d(&u.view);
+        Self {
+            view_proj: vp.to_cols_array_2d(),
+            sun_exposure: u.sun_exposure,
+            spacing_h_exag_pad: u.spacing_h_exag_pad,
+            offset: [offset[0], offset[1], offset[2], 0.0],
+        }
+    }
+}
+
 // T2.1 Global state
 #[derive(Debug, Clone)]
 pub struct Globals {
@@ -255,6 +290,7 @@ pub struct TerrainSpike {
 #[pymethods]
 impl TerrainSpike {
     #[new]
+    #[pyo3(signature = (width, height, grid=None, colormap=None))]
     #[pyo3(text_signature = "(width, height, grid=128, colormap='viridis')")]
     pub fn new(width: u32, height: u32, grid: Option<u32>, colormap: Option<String>) -> PyResult<Self> {
         let grid = grid.unwrap_or(128).max(2);
@@ -542,7 +578,7 @@ impl TerrainSpike {
         // Convert TerrainUniforms (176 bytes) to 44 floats
         let bytes = bytemuck::bytes_of(&self.last_uniforms);
         let float_slice: &[f32] = bytemuck::cast_slice(bytes);
-        Ok(numpy::PyArray1::from_vec_bound(py, float_slice.to_vec()))
+        Ok(numpy::PyArray1::from_vec(py, float_slice.to_vec()))
     }
 }
 
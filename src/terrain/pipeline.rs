@@ -2,96 +2,215 @@
 //! Terrain pipeline state & bindings (T3.3).
 //! Creates bind group layouts (0: Globals UBO, 1: height+sampler, 2: LUT+sampler)
 //! and a render pipeline targeting Rgba8UnormSrgb. No integration/draw in this task.
+//! `create_with` specializes the shader for a `ShaderFeatures` mask; groups whose feature
+//! is off keep their index but get an empty layout. The DATASET permutation adds group 3
+//! (class raster + per-frame view), three extra colour targets and a depth buffer; DIFF
+//! adds the second height epoch and its `DiffParams` UBO to group 1; WATER adds the flood
+//! depth texture and SCALAR the colormap source texture to group 2. TEMPORAL adds a
+//! linear-depth target and the depth buffer the reprojection pass primes.
 
 use std::borrow::Cow;
 use wgpu::*;
 
+use super::variants::{terrain_source, ShaderFeatures};
+
+/// Extra render targets of the DATASET permutation (locations 1..=3) and its depth buffer.
+pub const DATASET_DEPTH_FORMAT: TextureFormat = TextureFormat::R32Float;
+pub const DATASET_NORMAL_FORMAT: TextureFormat = TextureFormat::Rg16Float;
+pub const DATASET_CLASS_FORMAT: TextureFormat = TextureFormat::R8Uint;
+pub const DATASET_ZBUFFER_FORMAT: TextureFormat = TextureFormat::Depth32Float;
+/// Linear-depth history target of the TEMPORAL permutation (location 1); it shares the
+/// DATASET depth formats.
+pub const TEMPORAL_DEPTH_FORMAT: TextureFormat = DATASET_DEPTH_FORMAT;
+
 pub struct TerrainPipeline {
     pub layout: PipelineLayout,
     pub pipeline: RenderPipeline,
     pub bgl_globals: BindGroupLayout,
     pub bgl_height: BindGroupLayout,
     pub bgl_lut: BindGroupLayout,
+    /// Group 3 (DATASET only; not part of the pipeline layout otherwise).
+    pub bgl_dataset: BindGroupLayout,
+    pub features: ShaderFeatures,
 }
 
 impl TerrainPipeline {
     /// Create the terrain pipeline. Does **not** record commands or create bind groups.
     pub fn create(device: &Device, color_format: TextureFormat) -> Self {
+        Self::create_with(device, color_format, ShaderFeatures::DEFAULT)
+    }
+
+    /// Create the pipeline for one shader permutation (see `variants::PipelineCache`).
+    pub fn create_with(device: &Device, color_format: TextureFormat, features: ShaderFeatures) -> Self {
+        let features = features.resolve();
+        let push = features.contains(ShaderFeatures::PUSH_CONSTANTS);
         // ---- Bind group layouts -------------------------------------------------
         // group(0) — Globals UBO (@group(0) @binding(0) var<uniform> globals : Globals)
+        // Empty with PUSH_CONSTANTS: camera data travels in `DrawPush` instead.
+        let globals_entries = [
+            BindGroupLayoutEntry {
+                binding: 0,
+                visibility: ShaderStages::VERTEX_FRAGMENT,
+                ty: BindingType::Buffer {
+                    ty: BufferBindingType::Uniform,
+                    has_dynamic_offset: false,
+                    min_binding_size: None, // WGSL layout validated by naga
+                },
+                count: None,
+            },
+        ];
         let bgl_globals = device.create_bind_group_layout(&BindGroupLayoutDescriptor {
             label: Some("vf.Terrain.bgl.globals"),
-            entries: &[
-                BindGroupLayoutEntry {
-                    binding: 0,
-                    visibility: ShaderStages::VERTEX_FRAGMENT,
-                    ty: BindingType::Buffer {
-                        ty: BufferBindingType::Uniform,
-                        has_dynamic_offset: false,
-                        min_binding_size: None, // WGSL layout validated by naga
-                    },
-                    count: None,
-                },
-            ],
+            entries: if push { &[] } else { &globals_entries[..] },
         });
 
-        // group(1) — height R32Float texture + sampler
-        let bgl_height = device.create_bind_group_layout(&BindGroupLayoutDescriptor {
-            label: Some("vf.Terrain.bgl.height"),
-            entries: &[
-                BindGroupLayoutEntry {
-                    binding: 0,
-                    visibility: ShaderStages::VERTEX_FRAGMENT,
-                    ty: BindingType::Texture {
-                        sample_type: TextureSampleType::Float { filterable: false },
-                        view_dimension: TextureViewDimension::D2,
-                        multisampled: false,
+        // group(1) — height R32Float texture + sampler (+ DIFF: epoch b + DiffParams UBO)
+        let height_entries = [
+            BindGroupLayoutEntry {
+                binding: 0,
+                visibility: ShaderStages::VERTEX_FRAGMENT,
+                ty: BindingType::Texture {
+                    sample_type: TextureSampleType::Float { filterable: false },
+                    view_dimension: if features.contains(ShaderFeatures::HEIGHT_SEQ) {
+                        TextureViewDimension::D2Array
+                    } else {
+                        TextureViewDimension::D2
                     },
-                    count: None,
+                    multisampled: false,
                 },
-                BindGroupLayoutEntry {
-                    binding: 1,
-                    visibility: ShaderStages::VERTEX_FRAGMENT,
-                    ty: BindingType::Sampler(SamplerBindingType::NonFiltering),
-                    count: None,
+                count: None,
+            },
+            BindGroupLayoutEntry {
+                binding: 1,
+                visibility: ShaderStages::VERTEX_FRAGMENT,
+                ty: BindingType::Sampler(SamplerBindingType::NonFiltering),
+                count: None,
+            },
+            BindGroupLayoutEntry {
+                binding: 2,
+                visibility: ShaderStages::VERTEX_FRAGMENT,
+                ty: BindingType::Texture {
+                    sample_type: TextureSampleType::Float { filterable: false },
+                    view_dimension: TextureViewDimension::D2,
+                    multisampled: false,
                 },
-            ],
+                count: None,
+            },
+            BindGroupLayoutEntry {
+                binding: 3,
+                visibility: ShaderStages::VERTEX_FRAGMENT,
+                ty: BindingType::Buffer {
+                    ty: BufferBindingType::Uniform,
+                    has_dynamic_offset: false,
+                    min_binding_size: BufferSize::new(16),
+                },
+                count: None,
+            },
+        ];
+        let height_count = match (features.contains(ShaderFeatures::HEIGHT_TEX), features.contains(ShaderFeatures::DIFF)) {
+            (false, _) => 0,
+            (true, false) => 2,
+            (true, true) => 4,
+        };
+        let bgl_height = device.create_bind_group_layout(&BindGroupLayoutDescriptor {
+            label: Some("vf.Terrain.bgl.height"),
+            entries: &height_entries[..height_count],
         });
 
-        // group(2) — LUT RGBA8UnormSrgb texture + sampler
+        // group(2) — LUT RGBA8UnormSrgb texture + sampler (+ WATER: R32Float depth at binding 2,
+        // SCALAR: R32Float colormap source at binding 3)
+        let lut_entries = [
+            BindGroupLayoutEntry {
+                binding: 0,
+                visibility: ShaderStages::FRAGMENT,
+                ty: BindingType::Texture {
+                    sample_type: TextureSampleType::Float { filterable: true },
+                    view_dimension: TextureViewDimension::D2,
+                    multisampled: false,
+                },
+                count: None,
+            },
+            BindGroupLayoutEntry {
+                binding: 1,
+                visibility: ShaderStages::FRAGMENT,
+                ty: BindingType::Sampler(SamplerBindingType::Filtering),
+                count: None,
+            },
+        ];
+        let water_entry = BindGroupLayoutEntry {
+            binding: 2,
+            visibility: ShaderStages::FRAGMENT,
+            ty: BindingType::Texture {
+                sample_type: TextureSampleType::Float { filterable: false },
+                view_dimension: TextureViewDimension::D2,
+                multisampled: false,
+            },
+            count: None,
+        };
+        let scalar_entry = BindGroupLayoutEntry { binding: 3, ..water_entry };
+        let mut group2 = Vec::with_capacity(4);
+        if features.contains(ShaderFeatures::LUT) {
+            group2.extend_from_slice(&lut_entries);
+        }
+        if features.contains(ShaderFeatures::WATER) {
+            group2.push(water_entry);
+        }
+        if features.contains(ShaderFeatures::SCALAR) {
+            group2.push(scalar_entry);
+        }
         let bgl_lut = device.create_bind_group_layout(&BindGroupLayoutDescriptor {
             label: Some("vf.Terrain.bgl.lut"),
-            entries: &[
-                BindGroupLayoutEntry {
-                    binding: 0,
-                    visibility: ShaderStages::FRAGMENT,
-                    ty: BindingType::Texture {
-                        sample_type: TextureSampleType::Float { filterable: true },
-                        view_dimension: TextureViewDimension::D2,
-                        multisampled: false,
-                    },
-                    count: None,
+            entries: &group2,
+        });
+
+        // group(3) — DATASET: class raster (R8Uint) + per-frame view (dynamic-offset UBO)
+        let dataset = features.contains(ShaderFeatures::DATASET);
+        let dataset_entries = [
+            BindGroupLayoutEntry {
+                binding: 0,
+                visibility: ShaderStages::FRAGMENT,
+                ty: BindingType::Texture {
+                    sample_type: TextureSampleType::Uint,
+                    view_dimension: TextureViewDimension::D2,
+                    multisampled: false,
                 },
-                BindGroupLayoutEntry {
-                    binding: 1,
-                    visibility: ShaderStages::FRAGMENT,
-                    ty: BindingType::Sampler(SamplerBindingType::Filtering),
-                    count: None,
+                count: None,
+            },
+            BindGroupLayoutEntry {
+                binding: 1,
+                visibility: ShaderStages::FRAGMENT,
+                ty: BindingType::Buffer {
+                    ty: BufferBindingType::Uniform,
+                    has_dynamic_offset: true,
+                    min_binding_size: BufferSize::new(64),
                 },
-            ],
+                count: None,
+            },
+        ];
+        let bgl_dataset = device.create_bind_group_layout(&BindGroupLayoutDescriptor {
+            label: Some("vf.Terrain.bgl.dataset"),
+            entries: if dataset { &dataset_entries[..] } else { &[] },
         });
 
+        let groups = [&bgl_globals, &bgl_height, &bgl_lut, &bgl_dataset];
         let layout = device.create_pipeline_layout(&PipelineLayoutDescriptor {
             label: Some("vf.Terrain.pipelineLayout"),
-            bind_group_layouts: &[&bgl_globals, &bgl_height, &bgl_lut],
-            push_constant_ranges: &[],
+            bind_group_layouts: if dataset { &groups[..] } else { &groups[..3] },
+            push_constant_ranges: if push {
+                &[PushConstantRange {
+                    stages: ShaderStages::VERTEX_FRAGMENT,
+                    range: 0..crate::device_caps::TERRAIN_PUSH_BYTES,
+                }]
+            } else {
+                &[]
+            },
         });
 
         // ---- Shader module ------------------------------------------------------
         // NOTE: this path is relative to this file (src/terrain/pipeline.rs)
         let shader = device.create_shader_module(ShaderModuleDescriptor {
             label: Some("vf.Terrain.shader"),
-            source: ShaderSource::Wgsl(Cow::Borrowed(include_str!("../shaders/terrain.wgsl"))),
+            source: ShaderSource::Wgsl(Cow::Owned(terrain_source(features))),
         });
 
         // ---- Vertex buffer layout ----------------------------------------------
@@ -104,6 +223,24 @@ impl TerrainPipeline {
         }];
 
         // ---- Render pipeline ----------------------------------------------------
+        let color_target = Some(ColorTargetState {
+            format: color_format, // Rgba8UnormSrgb recommended
+            blend: None,          // straight alpha by default; no blending for opaque terrain
+            write_mask: ColorWrites::ALL,
+        });
+        let aux_target = |format| Some(ColorTargetState { format, blend: None, write_mask: ColorWrites::ALL });
+        let dataset_targets = [
+            color_target,
+            aux_target(DATASET_DEPTH_FORMAT),
+            aux_target(DATASET_NORMAL_FORMAT),
+            aux_target(DATASET_CLASS_FORMAT),
+        ];
+        let temporal = features.contains(ShaderFeatures::TEMPORAL) && !dataset;
+        let color_targets = match (dataset, temporal) {
+            (true, _) => &dataset_targets[..],
+            (false, true) => &dataset_targets[..2],
+            (false, false) => &dataset_targets[..1],
+        };
         let pipeline = device.create_render_pipeline(&RenderPipelineDescriptor {
             label: Some("vf.Terrain.pipeline"),
             layout: Some(&layout),
@@ -115,11 +252,7 @@ impl TerrainPipeline {
             fragment: Some(FragmentState {
                 module: &shader,
                 entry_point: "fs_main", // must match T3.2
-                targets: &[Some(ColorTargetState {
-                    format: color_format, // Rgba8UnormSrgb recommended
-                    blend: None,          // straight alpha by default; no blending for opaque terrain
-                    write_mask: ColorWrites::ALL,
-                })],
+                targets: color_targets,
             }),
             primitive: PrimitiveState {
                 topology: PrimitiveTopology::TriangleList,
@@ -130,7 +263,15 @@ impl TerrainPipeline {
                 polygon_mode: PolygonMode::Fill,
                 conservative: false,
             },
-            depth_stencil: None, // no depth for single-layer terrain in spike
+            // No depth for single-layer terrain in spike; the dataset pass needs exact visibility
+            // and the temporal pass a depth buffer primed with the reused pixels.
+            depth_stencil: (dataset || temporal).then(|| DepthStencilState {
+                format: DATASET_ZBUFFER_FORMAT,
+                depth_write_enabled: true,
+                depth_compare: CompareFunction::Less,
+                stencil: StencilState::default(),
+                bias: DepthBiasState::default(),
+            }),
             multisample: MultisampleState {
                 count: 1,                  // MSAA=1 per roadmap
                 mask: !0,
@@ -139,37 +280,96 @@ impl TerrainPipeline {
             multiview: None,
         });
 
-        Self { layout, pipeline, bgl_globals, bgl_height, bgl_lut }
+        Self { layout, pipeline, bgl_globals, bgl_height, bgl_lut, bgl_dataset, features }
     }
 
     // ---------- Bind-group helpers (builders) ----------
+    /// Empty group with PUSH_CONSTANTS (the layout has no entries).
     pub fn make_bg_globals(&self, device: &Device, ubo: &Buffer) -> BindGroup {
+        let entries = [BindGroupEntry { binding: 0, resource: ubo.as_entire_binding() }];
         device.create_bind_group(&BindGroupDescriptor {
             label: Some("vf.Terrain.bg.globals"),
             layout: &self.bgl_globals,
-            entries: &[BindGroupEntry { binding: 0, resource: ubo.as_entire_binding() }],
+            entries: if self.features.contains(ShaderFeatures::PUSH_CONSTANTS) { &[] } else { &entries[..] },
         })
     }
 
+    /// Empty group when HEIGHT_TEX is off (the layout has no entries).
     pub fn make_bg_height(&self, device: &Device, view: &TextureView, samp: &Sampler) -> BindGroup {
+        let entries = [
+            BindGroupEntry { binding: 0, resource: BindingResource::TextureView(view) },
+            BindGroupEntry { binding: 1, resource: BindingResource::Sampler(samp) },
+        ];
         device.create_bind_group(&BindGroupDescriptor {
             label: Some("vf.Terrain.bg.height"),
             layout: &self.bgl_height,
+            entries: if self.features.contains(ShaderFeatures::HEIGHT_TEX) { &entries[..] } else { &[] },
+        })
+    }
+
+    /// Group 1 of the DIFF permutation: epoch a (`view`), epoch b and the 16-byte `DiffParams`.
+    pub fn make_bg_height_diff(&self, device: &Device, view: &TextureView, view_b: &TextureView, samp: &Sampler, params: &Buffer) -> BindGroup {
+        device.create_bind_group(&BindGroupDescriptor {
+            label: Some("vf.Terrain.bg.height_diff"),
+            layout: &self.bgl_height,
             entries: &[
                 BindGroupEntry { binding: 0, resource: BindingResource::TextureView(view) },
                 BindGroupEntry { binding: 1, resource: BindingResource::Sampler(samp) },
+                BindGroupEntry { binding: 2, resource: BindingResource::TextureView(view_b) },
+                BindGroupEntry { binding: 3, resource: params.as_entire_binding() },
             ],
         })
     }
 
+    /// Empty group when LUT is off (the layout has no entries).
     pub fn make_bg_lut(&self, device: &Device, view: &TextureView, samp: &Sampler) -> BindGroup {
+        let entries = [
+            BindGroupEntry { binding: 0, resource: BindingResource::TextureView(view) },
+            BindGroupEntry { binding: 1, resource: BindingResource::Sampler(samp) },
+        ];
         device.create_bind_group(&BindGroupDescriptor {
             label: Some("vf.Terrain.bg.lut"),
             layout: &self.bgl_lut,
-            entries: &[
-                BindGroupEntry { binding: 0, resource: BindingResource::TextureView(view) },
-                BindGroupEntry { binding: 1, resource: BindingResource::Sampler(samp) },
-            ],
+            entries: if self.features.contains(ShaderFeatures::LUT) { &entries[..] } else { &[] },
+        })
+    }
+
+    /// Group 2 of a WATER and/or SCALAR permutation: the LUT pair when LUT is on, plus the
+    /// flood depth texture and the colormap source texture of the active overlays.
+    pub fn make_bg_lut_overlays(&self, device: &Device, view: &TextureView, samp: &Sampler,
+                                water: Option<&TextureView>, scalar: Option<&TextureView>) -> BindGroup {
+        let mut entries = Vec::with_capacity(4);
+        if self.features.contains(ShaderFeatures::LUT) {
+            entries.push(BindGroupEntry { binding: 0, resource: BindingResource::TextureView(view) });
+            entries.push(BindGroupEntry { binding: 1, resource: BindingResource::Sampler(samp) });
+        }
+        if let Some(w) = water.filter(|_| self.features.contains(ShaderFeatures::WATER)) {
+            entries.push(BindGroupEntry { binding: 2, resource: BindingResource::TextureView(w) });
+        }
+        if let Some(v) = scalar.filter(|_| self.features.contains(ShaderFeatures::SCALAR)) {
+            entries.push(BindGroupEntry { binding: 3, resource: BindingResource::TextureView(v) });
+        }
+        device.create_bind_group(&BindGroupDescriptor {
+            label: Some("vf.Terrain.bg.lut_overlays"),
+            layout: &self.bgl_lut,
+            entries: &entries,
+        })
+    }
+
+    /// Group 3 of the DATASET permutation; `views` holds one 64-byte view matrix per
+    /// dynamic offset.
+    pub fn make_bg_dataset(&self, device: &Device, class_view: &TextureView, views: &Buffer) -> BindGroup {
+        let entries = [
+            BindGroupEntry { binding: 0, resource: BindingResource::TextureView(class_view) },
+            BindGroupEntry {
+                binding: 1,
+                resource: BindingResource::Buffer(BufferBinding { buffer: views, offset: 0, size: BufferSize::new(64) }),
+            },
+        ];
+        device.create_bind_group(&BindGroupDescriptor {
+            label: Some("vf.Terrain.bg.dataset"),
+            layout: &self.bgl_dataset,
+            entries: if self.features.contains(ShaderFeatures::DATASET) { &entries[..] } else { &[] },
         })
     }
 }
@@ -0,0 +1,234 @@
+//! Projected grid: terrain geometry with a constant, screen-matched vertex count.
+//!
+//! Instead of a fixed world-space mesh, every frame `ProjectedGridGpu` casts one ray per
+//! point of a screen-space grid (`cell` pixels apart, plus `margin` of overscan) through
+//! the inverse view-projection and intersects it with the terrain plane `y = 0`
+//! (`shaders/projected_grid.wgsl`). The hits, clamped to the plane extent, are written in
+//! the terrain vertex layout `[x, z, u, v]`, so the unchanged `TerrainPipeline` draws them
+//! and samples the height in its vertex stage. Rays at or above the horizon run out to the
+//! far edge of the extent, where their triangles collapse. Vertex count depends only on
+//! the output size and `cell`, never on the DEM size or the zoom.
+//!
+//! Heights displace the vertices after projection, so relief can shift silhouettes by a
+//! fraction of a cell relative to the world mesh, and the grid slides over the terrain as
+//! the camera moves. `margin` covers relief pushed in from beyond the screen edges.
+
+/// Threads per workgroup of `cs_project`.
+const WG_SIZE: u32 = 64;
+
+/// Plane half-size, in plane units, of the Scene mesh (`[-1.5, 1.5]²`).
+pub const PLANE_EXTENT: f32 = 1.5;
+
+/// Shader uniform block (96 bytes, must match `projected_grid.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct ProjectedGridParams {
+    /// World from clip (`(P · V)⁻¹`, column-major).
+    pub inv_view_proj: [[f32; 4]; 4],
+    /// Vertices per row, rows.
+    pub dims: [u32; 2],
+    /// NDC overscan beyond `[-1, 1]` on each side.
+    pub margin: f32,
+    /// World units per plane unit (`TerrainUniforms` spacing).
+    pub spacing: f32,
+    pub extent: f32,
+    pub _p: [f32; 3],
+}
+
+impl ProjectedGridParams {
+    pub fn new(view: glam::Mat4, proj: glam::Mat4, dims: [u32; 2], margin: f32, spacing: f32) -> Self {
+        Self {
+            inv_view_proj: (proj * view).inverse().to_cols_array_2d(),
+            dims,
+            margin,
+            spacing: spacing.max(1e-8),
+            extent: PLANE_EXTENT,
+            _p: [0.0; 3],
+        }
+    }
+
+    /// Grid vertices for a `width × height` output with one vertex every `cell` pixels.
+    pub fn dims_for(width: u32, height: u32, cell: u32) -> [u32; 2] {
+        let cell = cell.max(1);
+        [(width + cell - 1) / cell + 1, (height + cell - 1) / cell + 1]
+    }
+
+    pub fn vertex_count(&self) -> u32 {
+        self.dims[0] * self.dims[1]
+    }
+
+    /// NDC position of grid vertex `(i, j)` (row 0 at the top).
+    pub fn ndc(&self, i: u32, j: u32) -> glam::Vec2 {
+        let t = glam::Vec2::new(i as f32 / (self.dims[0] - 1) as f32, j as f32 / (self.dims[1] - 1) as f32);
+        let span = 1.0 + self.margin;
+        glam::Vec2::new(-span + 2.0 * span * t.x, span - 2.0 * span * t.y)
+    }
+
+    /// CPU mirror of `cs_project`: the `[x, z, u, v]` vertex of grid point `(i, j)`.
+    pub fn vertex(&self, i: u32, j: u32) -> [f32; 4] {
+        let inv = glam::Mat4::from_cols_array_2d(&self.inv_view_proj);
+        let ndc = self.ndc(i, j);
+        let p0 = inv.project_point3(ndc.extend(0.0));
+        let d = inv.project_point3(ndc.extend(1.0)) - p0;
+        let (p0xz, dxz) = (glam::Vec2::new(p0.x, p0.z), glam::Vec2::new(d.x, d.z));
+        let xz = if p0.y > 0.0 && d.y < 0.0 {
+            p0xz + dxz * (-p0.y / d.y)
+        } else if dxz.length() > 0.0 {
+            p0xz + dxz.normalize() * (p0xz.length() + 3.0 * self.extent * self.spacing)
+        } else {
+            p0xz
+        };
+        let e = self.extent;
+        let pos = (xz / self.spacing).clamp(glam::Vec2::splat(-e), glam::Vec2::splat(e));
+        let uv = (pos + e) / (2.0 * e);
+        [pos.x, pos.y, uv.x, uv.y]
+    }
+}
+
+/// Triangle list over a `cols × rows` vertex grid whose row 0 is the top of the screen
+/// (counter-clockwise on screen, like the Scene mesh seen from above).
+pub fn grid_indices(cols: u32, rows: u32) -> Vec<u32> {
+    let mut idx = Vec::with_capacity(((cols - 1) * (rows - 1) * 6) as usize);
+    for j in 0..rows - 1 {
+        for i in 0..cols - 1 {
+            let a = j * cols + i;
+            let (b, c, d) = (a + 1, a + cols, a + cols + 1);
+            idx.extend_from_slice(&[a, c, b, b, c, d]);
+        }
+    }
+    idx
+}
+
+/// Compute pipeline projecting the grid into a vertex buffer.
+pub struct ProjectedGridGpu {
+    pipeline: wgpu::ComputePipeline,
+    bgl: wgpu::BindGroupLayout,
+}
+
+impl ProjectedGridGpu {
+    pub fn new(device: &wgpu::Device) -> Self {
+        let buffer = |binding, ty| wgpu::BindGroupLayoutEntry {
+            binding,
+            visibility: wgpu::ShaderStages::COMPUTE,
+            ty: wgpu::BindingType::Buffer { ty, has_dynamic_offset: false, min_binding_size: None },
+            count: None,
+        };
+        let bgl = device.create_bind_group_layout(&wgpu::BindGroupLayoutDescriptor {
+            label: Some("vf.ProjectedGrid.bgl"),
+            entries: &[
+                buffer(0, wgpu::BufferBindingType::Uniform),
+                buffer(1, wgpu::BufferBindingType::Storage { read_only: false }),
+            ],
+        });
+        let shader = device.create_shader_module(wgpu::ShaderModuleDescriptor {
+            label: Some("vf.ProjectedGrid.shader"),
+            source: wgpu::ShaderSource::Wgsl(include_str!("../shaders/projected_grid.wgsl").into()),
+        });
+        let layout = device.create_pipeline_layout(&wgpu::PipelineLayoutDescriptor {
+            label: Some("vf.ProjectedGrid.pipelineLayout"),
+            bind_group_layouts: &[&bgl],
+            push_constant_ranges: &[],
+        });
+        let pipeline = device.create_compute_pipeline(&wgpu::ComputePipelineDescriptor {
+            label: Some("vf.ProjectedGrid.pipeline"),
+            layout: Some(&layout),
+            module: &shader,
+            entry_point: "cs_project",
+        });
+        Self { pipeline, bgl }
+    }
+
+    /// `params` holds a `ProjectedGridParams`; `verts` (STORAGE | VERTEX) has 16 bytes per
+    /// grid vertex.
+    pub fn bind(&self, device: &wgpu::Device, params: &wgpu::Buffer, verts: &wgpu::Buffer) -> wgpu::BindGroup {
+        device.create_bind_group(&wgpu::BindGroupDescriptor {
+            label: Some("vf.ProjectedGrid.bg"),
+            layout: &self.bgl,
+            entries: &[
+                wgpu::BindGroupEntry { binding: 0, resource: params.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 1, resource: verts.as_entire_binding() },
+            ],
+        })
+    }
+
+    /// Project every grid vertex of `p` into the bound vertex buffer.
+    pub fn encode(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, p: &ProjectedGridParams) {
+        let mut cp = encoder.begin_compute_pass(&wgpu::ComputePassDescriptor { label: Some("vf.ProjectedGrid.project"), timestamp_writes: None });
+        cp.set_pipeline(&self.pipeline);
+        cp.set_bind_group(0, bg, &[]);
+        cp.dispatch_workgroups((p.vertex_count() + WG_SIZE - 1) / WG_SIZE, 1, 1);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use glam::{Mat4, Vec3};
+
+    fn proj() -> Mat4 {
+        crate::camera::perspective_wgpu(45f32.to_radians(), 4.0 / 3.0, 0.1, 100.0)
+    }
+
+    #[test]
+    fn params_match_wgsl_layout() {
+        assert_eq!(std::mem::size_of::<ProjectedGridParams>(), 96);
+    }
+
+    #[test]
+    fn vertex_count_follows_output_size_only() {
+        assert_eq!(ProjectedGridParams::dims_for(640, 480, 4), [161, 121]);
+        assert_eq!(ProjectedGridParams::dims_for(641, 480, 4), [162, 121]);
+        assert_eq!(ProjectedGridParams::dims_for(8, 8, 0), [9, 9]);
+    }
+
+    #[test]
+    fn screen_centre_hits_the_look_at_point() {
+        let view = Mat4::look_at_rh(Vec3::new(3.0, 2.0, 3.0), Vec3::ZERO, Vec3::Y);
+        let p = ProjectedGridParams::new(view, proj(), [5, 5], 0.0, 1.0);
+        let v = p.vertex(2, 2);
+        assert!(v[0].abs() < 1e-4 && v[1].abs() < 1e-4, "{v:?}");
+        assert!((v[2] - 0.5).abs() < 1e-4 && (v[3] - 0.5).abs() < 1e-4);
+    }
+
+    #[test]
+    fn hits_project_back_to_their_screen_point() {
+        // Looking down from above: every ray hits inside the extent (spacing 2 shrinks it).
+        let view = Mat4::look_at_rh(Vec3::new(0.0, 3.0, 0.5), Vec3::ZERO, Vec3::Y);
+        let p = ProjectedGridParams::new(view, proj(), [9, 7], 0.0, 2.0);
+        let vp = proj() * view;
+        for j in 0..7 {
+            for i in 0..9 {
+                let v = p.vertex(i, j);
+                assert!(v[0].abs() < PLANE_EXTENT && v[1].abs() < PLANE_EXTENT, "{v:?}");
+                let ndc = vp.project_point3(Vec3::new(v[0] * 2.0, 0.0, v[1] * 2.0));
+                assert!((ndc.truncate() - p.ndc(i, j)).length() < 1e-3, "{i} {j}: {ndc:?}");
+            }
+        }
+    }
+
+    #[test]
+    fn rays_above_the_horizon_clamp_to_the_far_edge() {
+        // Horizontal view toward -z: the top half of the screen never meets the plane.
+        let view = Mat4::look_at_rh(Vec3::new(0.0, 0.5, 3.0), Vec3::new(0.0, 0.5, 0.0), Vec3::Y);
+        let p = ProjectedGridParams::new(view, proj(), [5, 5], 0.1, 1.0);
+        for i in 0..5 {
+            let v = p.vertex(i, 0);
+            assert_eq!((v[1], v[3]), (-PLANE_EXTENT, 0.0), "{v:?}");
+        }
+        // The bottom row is below the horizon and in front of the camera.
+        let v = p.vertex(2, 4);
+        assert!(v[1] > -PLANE_EXTENT && v[1] <= PLANE_EXTENT, "{v:?}");
+    }
+
+    #[test]
+    fn indices_are_counter_clockwise_on_screen() {
+        let p = ProjectedGridParams { dims: [4, 3], margin: 0.0, ..bytemuck::Zeroable::zeroed() };
+        let idx = grid_indices(4, 3);
+        assert_eq!(idx.len(), 3 * 2 * 6);
+        let at = |k: u32| p.ndc(k % 4, k / 4);
+        for t in idx.chunks_exact(3) {
+            let (a, b, c) = (at(t[0]), at(t[1]), at(t[2]));
+            assert!((b - a).perp_dot(c - a) > 0.0);
+        }
+    }
+}
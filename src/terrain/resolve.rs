@@ -0,0 +1,109 @@
+//! Supersampling resolve: box-filter a `factor`× colour target down to the output size.
+//!
+//! The terrain pipeline renders single-sampled, so antialiasing renders at `factor` times
+//! the output size and `SupersampleResolve` averages each `factor × factor` footprint in a
+//! fullscreen pass (`shaders/resolve.wgsl`). Both textures are `Rgba8UnormSrgb`, so the
+//! average is taken in linear light.
+
+/// Shader uniform block (16 bytes, must match `resolve.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct ResolveParams {
+    pub factor: u32,
+    pub _p: [u32; 3],
+}
+
+/// Fullscreen resolve pipeline for one output format.
+pub struct SupersampleResolve {
+    pipeline: wgpu::RenderPipeline,
+    bgl: wgpu::BindGroupLayout,
+}
+
+impl SupersampleResolve {
+    pub fn new(device: &wgpu::Device, format: wgpu::TextureFormat) -> Self {
+        let bgl = device.create_bind_group_layout(&wgpu::BindGroupLayoutDescriptor {
+            label: Some("vf.Resolve.bgl"),
+            entries: &[
+                wgpu::BindGroupLayoutEntry {
+                    binding: 0,
+                    visibility: wgpu::ShaderStages::FRAGMENT,
+                    ty: wgpu::BindingType::Buffer { ty: wgpu::BufferBindingType::Uniform, has_dynamic_offset: false, min_binding_size: None },
+                    count: None,
+                },
+                wgpu::BindGroupLayoutEntry {
+                    binding: 1,
+                    visibility: wgpu::ShaderStages::FRAGMENT,
+                    ty: wgpu::BindingType::Texture {
+                        sample_type: wgpu::TextureSampleType::Float { filterable: false },
+                        view_dimension: wgpu::TextureViewDimension::D2,
+                        multisampled: false,
+                    },
+                    count: None,
+                },
+            ],
+        });
+        let shader = device.create_shader_module(wgpu::ShaderModuleDescriptor {
+            label: Some("vf.Resolve.shader"),
+            source: wgpu::ShaderSource::Wgsl(include_str!("../shaders/resolve.wgsl").into()),
+        });
+        let layout = device.create_pipeline_layout(&wgpu::PipelineLayoutDescriptor {
+            label: Some("vf.Resolve.pipelineLayout"),
+            bind_group_layouts: &[&bgl],
+            push_constant_ranges: &[],
+        });
+        let pipeline = device.create_render_pipeline(&wgpu::RenderPipelineDescriptor {
+            label: Some("vf.Resolve.pipeline"),
+            layout: Some(&layout),
+            vertex: wgpu::VertexState { module: &shader, entry_point: "vs_main", buffers: &[] },
+            fragment: Some(wgpu::FragmentState {
+                module: &shader,
+                entry_point: "fs_main",
+                targets: &[Some(wgpu::ColorTargetState { format, blend: None, write_mask: wgpu::ColorWrites::ALL })],
+            }),
+            primitive: wgpu::PrimitiveState::default(),
+            depth_stencil: None,
+            multisample: wgpu::MultisampleState::default(),
+            multiview: None,
+        });
+        Self { pipeline, bgl }
+    }
+
+    /// `params` holds a `ResolveParams`; `src` is `factor` times the target size.
+    pub fn bind(&self, device: &wgpu::Device, params: &wgpu::Buffer, src: &wgpu::TextureView) -> wgpu::BindGroup {
+        device.create_bind_group(&wgpu::BindGroupDescriptor {
+            label: Some("vf.Resolve.bg"),
+            layout: &self.bgl,
+            entries: &[
+                wgpu::BindGroupEntry { binding: 0, resource: params.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 1, resource: wgpu::BindingResource::TextureView(src) },
+            ],
+        })
+    }
+
+    /// Resolve the bound source into `target` (every texel is written; no clear needed).
+    pub fn encode(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, target: &wgpu::TextureView,
+                  timestamps: Option<wgpu::RenderPassTimestampWrites>) {
+        let mut rp = encoder.begin_render_pass(&wgpu::RenderPassDescriptor {
+            label: Some("vf.Resolve.pass"),
+            color_attachments: &[Some(wgpu::RenderPassColorAttachment {
+                view: target, resolve_target: None,
+                ops: wgpu::Operations { load: wgpu::LoadOp::Clear(wgpu::Color::BLACK), store: wgpu::StoreOp::Store },
+            })],
+            timestamp_writes: timestamps,
+            ..Default::default()
+        });
+        rp.set_pipeline(&self.pipeline);
+        rp.set_bind_group(0, bg, &[]);
+        rp.draw(0..3, 0..1);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::ResolveParams;
+
+    #[test]
+    fn params_match_wgsl_layout() {
+        assert_eq!(std::mem::size_of::<ResolveParams>(), 16);
+    }
+}
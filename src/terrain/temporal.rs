@@ -0,0 +1,281 @@
+//! Temporal reprojection: reuse the previous frame's pixels after a small camera move.
+//!
+//! The TEMPORAL terrain permutation writes colour, linear view depth and a z-buffer. For the
+//! next frame `TemporalGpu` forward-projects every covered history pixel into the new view
+//! (`shaders/temporal.wgsl`), keeps the nearest candidate per pixel and drops candidates
+//! that show through a gap in a nearer surface. A fullscreen prime draw then writes the
+//! surviving colour and depth with `z = 0`, so in the terrain draw that follows in the same
+//! pass the depth test rejects those pixels before shading; only disoccluded or uncovered
+//! pixels are shaded again. Keys are inverted depth bits and ties go to the highest source
+//! index, so the result depends only on the camera sequence, not on thread scheduling.
+
+/// Texels per workgroup edge of the kernels (`@workgroup_size(16, 16)`).
+const WG_EDGE: u32 = 16;
+
+/// Shader uniform block (96 bytes, must match `temporal.wgsl`).
+#[repr(C)]
+#[derive(Debug, Clone, Copy, bytemuck::Pod, bytemuck::Zeroable)]
+pub struct TemporalParams {
+    /// New clip position from old clip position (`P · V1 · V0⁻¹ · P⁻¹`, column-major).
+    pub reproject: [[f32; 4]; 4],
+    pub size: [u32; 2],
+    /// Old clip z as `x · depth + y` (depth = clip w = linear view depth).
+    pub z_from_depth: [f32; 2],
+    /// Relative depth gap to a neighbour that marks a pixel as disoccluded.
+    pub tolerance: f32,
+    pub _p: [f32; 3],
+}
+
+impl TemporalParams {
+    /// Parameters for moving from `view0` to `view1` under the shared projection `proj`.
+    pub fn new(view0: glam::Mat4, view1: glam::Mat4, proj: glam::Mat4, width: u32, height: u32, tolerance: f32) -> Self {
+        let reproject = proj * view1 * view0.inverse() * proj.inverse();
+        Self {
+            reproject: reproject.to_cols_array_2d(),
+            size: [width, height],
+            z_from_depth: [-proj.z_axis.z, proj.w_axis.z],
+            tolerance,
+            _p: [0.0; 3],
+        }
+    }
+
+    /// CPU mirror of the shader's `reproject`: the new pixel of history pixel `(x, y)` at
+    /// linear depth `depth`, with its new depth, or `None` if it leaves the view.
+    pub fn reproject_pixel(&self, x: u32, y: u32, depth: f32) -> Option<((u32, u32), f32)> {
+        let (w, h) = (self.size[0] as f32, self.size[1] as f32);
+        let ndc = glam::Vec2::new((x as f32 + 0.5) / w * 2.0 - 1.0, 1.0 - (y as f32 + 0.5) / h * 2.0);
+        let clip0 = glam::Vec4::new(ndc.x * depth, ndc.y * depth, self.z_from_depth[0] * depth + self.z_from_depth[1], depth);
+        let clip = glam::Mat4::from_cols_array_2d(&self.reproject) * clip0;
+        if clip.w <= 1e-6 {
+            return None;
+        }
+        let n = clip.truncate() / clip.w;
+        if n.x.abs() > 1.0 || n.y.abs() > 1.0 || n.z < 0.0 || n.z > 1.0 {
+            return None;
+        }
+        let qx = (((n.x + 1.0) * 0.5 * w) as u32).min(self.size[0] - 1);
+        let qy = (((1.0 - n.y) * 0.5 * h) as u32).min(self.size[1] - 1);
+        Some(((qx, qy), clip.w))
+    }
+}
+
+/// Largest screen displacement (fraction of the viewport, per axis) of `points` between the
+/// view-projections `vp0` and `vp1`; infinite when no point is in front of both cameras.
+pub fn screen_motion(vp0: glam::Mat4, vp1: glam::Mat4, points: &[glam::Vec3]) -> f32 {
+    let mut motion = None::<f32>;
+    for p in points {
+        let (a, b) = (vp0 * p.extend(1.0), vp1 * p.extend(1.0));
+        if a.w <= 1e-6 || b.w <= 1e-6 {
+            continue;
+        }
+        let d = (b.truncate().truncate() / b.w - a.truncate().truncate() / a.w).abs().max_element() * 0.5;
+        motion = Some(motion.map_or(d, |m| m.max(d)));
+    }
+    motion.unwrap_or(f32::INFINITY)
+}
+
+/// Reprojection kernels and the prime pipeline. The prime pipeline renders into the same
+/// attachments as the TEMPORAL terrain permutation (`color_format` + linear depth, z-buffer).
+pub struct TemporalGpu {
+    scatter: wgpu::ComputePipeline,
+    claim: wgpu::ComputePipeline,
+    resolve: wgpu::ComputePipeline,
+    prime: wgpu::RenderPipeline,
+    bgl: wgpu::BindGroupLayout,
+    bgl_prime: wgpu::BindGroupLayout,
+    bgl_empty: wgpu::BindGroupLayout,
+}
+
+impl TemporalGpu {
+    pub fn new(device: &wgpu::Device, color_format: wgpu::TextureFormat) -> Self {
+        use super::pipeline::{DATASET_ZBUFFER_FORMAT, TEMPORAL_DEPTH_FORMAT};
+        let texture = |binding, visibility| wgpu::BindGroupLayoutEntry {
+            binding,
+            visibility,
+            ty: wgpu::BindingType::Texture {
+                sample_type: wgpu::TextureSampleType::Float { filterable: false },
+                view_dimension: wgpu::TextureViewDimension::D2,
+                multisampled: false,
+            },
+            count: None,
+        };
+        let buffer = |binding, visibility, ty| wgpu::BindGroupLayoutEntry {
+            binding,
+            visibility,
+            ty: wgpu::BindingType::Buffer { ty, has_dynamic_offset: false, min_binding_size: None },
+            count: None,
+        };
+        let cs = wgpu::ShaderStages::COMPUTE;
+        let fs = wgpu::ShaderStages::FRAGMENT;
+        let rw = wgpu::BufferBindingType::Storage { read_only: false };
+        let ro = wgpu::BufferBindingType::Storage { read_only: true };
+        let bgl = device.create_bind_group_layout(&wgpu::BindGroupLayoutDescriptor {
+            label: Some("vf.Temporal.bgl"),
+            entries: &[
+                buffer(0, cs, wgpu::BufferBindingType::Uniform),
+                texture(1, cs),
+                buffer(2, cs, rw),
+                buffer(3, cs, rw),
+                buffer(4, cs, rw),
+            ],
+        });
+        let bgl_prime = device.create_bind_group_layout(&wgpu::BindGroupLayoutDescriptor {
+            label: Some("vf.Temporal.bgl.prime"),
+            entries: &[texture(0, fs), buffer(1, fs, ro), buffer(2, fs, ro)],
+        });
+        let bgl_empty = device.create_bind_group_layout(&wgpu::BindGroupLayoutDescriptor { label: Some("vf.Temporal.bgl.empty"), entries: &[] });
+        let shader = device.create_shader_module(wgpu::ShaderModuleDescriptor {
+            label: Some("vf.Temporal.shader"),
+            source: wgpu::ShaderSource::Wgsl(include_str!("../shaders/temporal.wgsl").into()),
+        });
+        let layout = device.create_pipeline_layout(&wgpu::PipelineLayoutDescriptor {
+            label: Some("vf.Temporal.pipelineLayout"),
+            bind_group_layouts: &[&bgl],
+            push_constant_ranges: &[],
+        });
+        let pipeline = |entry_point| device.create_compute_pipeline(&wgpu::ComputePipelineDescriptor {
+            label: Some("vf.Temporal.pipeline"),
+            layout: Some(&layout),
+            module: &shader,
+            entry_point,
+        });
+        let prime_layout = device.create_pipeline_layout(&wgpu::PipelineLayoutDescriptor {
+            label: Some("vf.Temporal.primeLayout"),
+            bind_group_layouts: &[&bgl_empty, &bgl_prime],
+            push_constant_ranges: &[],
+        });
+        let target = |format| Some(wgpu::ColorTargetState { format, blend: None, write_mask: wgpu::ColorWrites::ALL });
+        let prime = device.create_render_pipeline(&wgpu::RenderPipelineDescriptor {
+            label: Some("vf.Temporal.prime"),
+            layout: Some(&prime_layout),
+            vertex: wgpu::VertexState { module: &shader, entry_point: "vs_prime", buffers: &[] },
+            fragment: Some(wgpu::FragmentState {
+                module: &shader,
+                entry_point: "fs_prime",
+                targets: &[target(color_format), target(TEMPORAL_DEPTH_FORMAT)],
+            }),
+            primitive: wgpu::PrimitiveState::default(),
+            depth_stencil: Some(wgpu::DepthStencilState {
+                format: DATASET_ZBUFFER_FORMAT,
+                depth_write_enabled: true,
+                depth_compare: wgpu::CompareFunction::Always,
+                stencil: wgpu::StencilState::default(),
+                bias: wgpu::DepthBiasState::default(),
+            }),
+            multisample: wgpu::MultisampleState::default(),
+            multiview: None,
+        });
+        Self {
+            scatter: pipeline("cs_scatter"),
+            claim: pipeline("cs_claim"),
+            resolve: pipeline("cs_resolve"),
+            prime,
+            bgl,
+            bgl_prime,
+            bgl_empty,
+        }
+    }
+
+    /// Reprojection inputs: the `TemporalParams` UBO, the history linear depth and the
+    /// per-pixel `keys` / `src` words plus the reused-pixel `counter` (all zeroed per frame).
+    pub fn bind(&self, device: &wgpu::Device, params: &wgpu::Buffer, history_depth: &wgpu::TextureView,
+                keys: &wgpu::Buffer, src: &wgpu::Buffer, counter: &wgpu::Buffer) -> wgpu::BindGroup {
+        device.create_bind_group(&wgpu::BindGroupDescriptor {
+            label: Some("vf.Temporal.bg"),
+            layout: &self.bgl,
+            entries: &[
+                wgpu::BindGroupEntry { binding: 0, resource: params.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 1, resource: wgpu::BindingResource::TextureView(history_depth) },
+                wgpu::BindGroupEntry { binding: 2, resource: keys.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 3, resource: src.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 4, resource: counter.as_entire_binding() },
+            ],
+        })
+    }
+
+    /// Prime-draw inputs (group 1): the history colour and the resolved `keys` / `src`.
+    pub fn bind_prime(&self, device: &wgpu::Device, history_color: &wgpu::TextureView,
+                      keys: &wgpu::Buffer, src: &wgpu::Buffer) -> wgpu::BindGroup {
+        device.create_bind_group(&wgpu::BindGroupDescriptor {
+            label: Some("vf.Temporal.bg.prime"),
+            layout: &self.bgl_prime,
+            entries: &[
+                wgpu::BindGroupEntry { binding: 0, resource: wgpu::BindingResource::TextureView(history_color) },
+                wgpu::BindGroupEntry { binding: 1, resource: keys.as_entire_binding() },
+                wgpu::BindGroupEntry { binding: 2, resource: src.as_entire_binding() },
+            ],
+        })
+    }
+
+    /// Empty group 0 of the prime pipeline.
+    pub fn bind_empty(&self, device: &wgpu::Device) -> wgpu::BindGroup {
+        device.create_bind_group(&wgpu::BindGroupDescriptor {
+            label: Some("vf.Temporal.bg.empty"),
+            layout: &self.bgl_empty,
+            entries: &[],
+        })
+    }
+
+    /// Scatter, claim and resolve into the cleared `keys` / `src` / `counter` of `bg`.
+    pub fn encode_reproject(&self, encoder: &mut wgpu::CommandEncoder, bg: &wgpu::BindGroup, p: &TemporalParams) {
+        let mut cp = encoder.begin_compute_pass(&wgpu::ComputePassDescriptor { label: Some("vf.Temporal.reproject"), timestamp_writes: None });
+        let (gx, gy) = ((p.size[0] + WG_EDGE - 1) / WG_EDGE, (p.size[1] + WG_EDGE - 1) / WG_EDGE);
+        for pipeline in [&self.scatter, &self.claim, &self.resolve] {
+            cp.set_pipeline(pipeline);
+            cp.set_bind_group(0, bg, &[]);
+            cp.dispatch_workgroups(gx, gy, 1);
+        }
+    }
+
+    /// Fullscreen draw writing the reused pixels (colour, depth, z = 0) into `rp`.
+    pub fn draw_prime<'a>(&'a self, rp: &mut wgpu::RenderPass<'a>, empty: &'a wgpu::BindGroup, bg: &'a wgpu::BindGroup) {
+        rp.set_pipeline(&self.prime);
+        rp.set_bind_group(0, empty, &[]);
+        rp.set_bind_group(1, bg, &[]);
+        rp.draw(0..3, 0..1);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use glam::{Mat4, Vec3};
+
+    fn proj() -> Mat4 {
+        crate::camera::perspective_wgpu(45f32.to_radians(), 4.0 / 3.0, 0.1, 100.0)
+    }
+
+    #[test]
+    fn params_match_wgsl_layout() {
+        assert_eq!(std::mem::size_of::<TemporalParams>(), 96);
+    }
+
+    #[test]
+    fn unchanged_view_maps_pixels_to_themselves() {
+        let view = Mat4::look_at_rh(Vec3::new(3.0, 2.0, 3.0), Vec3::ZERO, Vec3::Y);
+        let p = TemporalParams::new(view, view, proj(), 64, 48, 0.02);
+        for &(x, y, d) in &[(0u32, 0u32, 1.0f32), (31, 20, 4.2), (63, 47, 50.0)] {
+            let ((qx, qy), d1) = p.reproject_pixel(x, y, d).unwrap();
+            assert_eq!((qx, qy), (x, y));
+            assert!((d1 - d).abs() < 1e-3 * d);
+        }
+    }
+
+    #[test]
+    fn sideways_move_shifts_pixels_and_motion_grows() {
+        let eye = Vec3::new(0.0, 2.0, 5.0);
+        let v0 = Mat4::look_at_rh(eye, Vec3::ZERO, Vec3::Y);
+        let v1 = Mat4::look_at_rh(eye + Vec3::X * 0.1, Vec3::X * 0.1, Vec3::Y);
+        let p = TemporalParams::new(v0, v1, proj(), 64, 48, 0.02);
+        // Camera moves right: the scene moves left on screen.
+        let ((qx, qy), _) = p.reproject_pixel(40, 24, 5.0).unwrap();
+        assert!(qx < 40 && qy == 24);
+        let pts = [Vec3::ZERO, Vec3::new(1.0, 0.0, 1.0)];
+        let small = screen_motion(proj() * v0, proj() * v1, &pts);
+        let v2 = Mat4::look_at_rh(eye + Vec3::X, Vec3::X, Vec3::Y);
+        assert!(small > 0.0 && small < screen_motion(proj() * v0, proj() * v2, &pts));
+        assert_eq!(screen_motion(proj() * v0, proj() * v0, &pts), 0.0);
+        // Behind the camera in both views: no estimate.
+        assert!(screen_motion(proj() * v0, proj() * v1, &[Vec3::new(0.0, 2.0, 10.0)]).is_infinite());
+    }
+}
@@ -0,0 +1,266 @@
+//! Terrain shader permutations.
+//!
+//! `terrain.wgsl` is written with `#ifdef NAME` / `#ifndef NAME` / `#else` / `#endif`
+//! blocks. A `ShaderFeatures` mask selects which defines are on; `preprocess` strips the
+//! inactive blocks so a disabled feature contributes no ALU and no bindings (its bind
+//! group layout is left empty). `PipelineCache` compiles each (mask, format) once.
+
+use std::collections::HashMap;
+use std::sync::Arc;
+
+use super::pipeline::TerrainPipeline;
+
+/// Bit mask of terrain shader features (one WGSL define per bit).
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct ShaderFeatures(pub u32);
+
+impl ShaderFeatures {
+    /// Sample the height texture (group 1) in the vertex stage.
+    pub const HEIGHT_TEX: Self = Self(1 << 0);
+    /// Add the analytic sin/cos height and shade with its analytic normal.
+    pub const ANALYTIC_FALLBACK: Self = Self(1 << 1);
+    /// Colour through the 256×1 LUT (group 2); grayscale ramp otherwise.
+    pub const LUT: Self = Self(1 << 2);
+    /// Heightfield ray-march toward the sun (needs HEIGHT_TEX).
+    pub const SHADOWS: Self = Self(1 << 3);
+    /// 8-tap height-difference ambient occlusion (needs HEIGHT_TEX).
+    pub const AO: Self = Self(1 << 4);
+    /// Normals from height-texture central differences (needs HEIGHT_TEX).
+    pub const NORMAL_MAP: Self = Self(1 << 5);
+    /// Camera + per-draw data in push constants instead of the group-0 UBO.
+    /// Chosen by the device (`device_caps`), not by callers.
+    pub const PUSH_CONSTANTS: Self = Self(1 << 6);
+    /// Extra depth/normal/class render targets and a depth buffer (`Scene.render_dataset`).
+    /// Chosen per call, not by callers.
+    pub const DATASET: Self = Self(1 << 7);
+    /// Height from a texture-array ring with per-draw layer blending (`Scene.render_sequence`).
+    /// Chosen by the Scene while a height sequence is bound.
+    pub const HEIGHT_SEQ: Self = Self(1 << 8);
+    /// Second height epoch coloured by (a - b) through a diverging LUT (`Scene.set_diff`);
+    /// implies NORMAL_MAP so both epochs are shaded with epoch a's normals.
+    /// Chosen by the Scene while a difference is bound.
+    pub const DIFF: Self = Self(1 << 9);
+    /// Water-depth overlay from the flood kernels (`Scene.flood`; needs HEIGHT_TEX).
+    /// Chosen by the Scene while an inundation extent is bound.
+    pub const WATER: Self = Self(1 << 10);
+    /// Colormap coordinate from a pre-normalised scalar texture instead of height
+    /// (`Scene.set_scalar`, e.g. flow accumulation). Chosen by the Scene while one is bound.
+    pub const SCALAR: Self = Self(1 << 11);
+    /// Linear-depth history target and a depth buffer for reprojection (`Scene.set_temporal`).
+    /// Chosen per call, not by callers; DATASET takes precedence.
+    pub const TEMPORAL: Self = Self(1 << 12);
+
+    /// Behaviour of the original single shader.
+    pub const DEFAULT: Self = Self(Self::HEIGHT_TEX.0 | Self::ANALYTIC_FALLBACK.0 | Self::LUT.0);
+
+    /// (flag, WGSL define / Python name) in bit order.
+    pub const ALL: &'static [(ShaderFeatures, &'static str)] = &[
+        (Self::HEIGHT_TEX, "HEIGHT_TEX"),
+        (Self::ANALYTIC_FALLBACK, "ANALYTIC_FALLBACK"),
+        (Self::LUT, "LUT"),
+        (Self::SHADOWS, "SHADOWS"),
+        (Self::AO, "AO"),
+        (Self::NORMAL_MAP, "NORMAL_MAP"),
+        (Self::PUSH_CONSTANTS, "PUSH_CONSTANTS"),
+        (Self::DATASET, "DATASET"),
+        (Self::HEIGHT_SEQ, "HEIGHT_SEQ"),
+        (Self::DIFF, "DIFF"),
+        (Self::WATER, "WATER"),
+        (Self::SCALAR, "SCALAR"),
+        (Self::TEMPORAL, "TEMPORAL"),
+    ];
+
+    pub const fn empty() -> Self { Self(0) }
+
+    pub fn contains(self, other: Self) -> bool { self.0 & other.0 == other.0 }
+
+    pub fn union(self, other: Self) -> Self { Self(self.0 | other.0) }
+
+    pub fn without(self, other: Self) -> Self { Self(self.0 & !other.0) }
+
+    /// Set or clear `flag`.
+    pub fn with(self, flag: Self, on: bool) -> Self {
+        if on { self.union(flag) } else { self.without(flag) }
+    }
+
+    /// Parse case-insensitive feature names (`["height_tex", "lut", "shadows"]`).
+    pub fn from_names<S: AsRef<str>>(names: &[S]) -> Result<Self, String> {
+        let mut mask = Self::empty();
+        for n in names {
+            let up = n.as_ref().to_uppercase();
+            let (flag, _) = Self::ALL
+                .iter()
+                .find(|(_, name)| *name == up)
+                .ok_or_else(|| format!(
+                    "unknown shader feature '{}'. Supported: {}",
+                    n.as_ref(),
+                    Self::ALL.iter().map(|(_, n)| *n).collect::<Vec<_>>().join(", ")
+                ))?;
+            mask = mask.union(*flag);
+        }
+        Ok(mask.resolve())
+    }
+
+    /// Add implied features (texture-based shading and the water overlay need the height
+    /// binding; DIFF shades with height-texture normals).
+    pub fn resolve(self) -> Self {
+        let f = if self.contains(Self::DIFF) { self.union(Self::NORMAL_MAP) } else { self };
+        let needs_height = Self(Self::SHADOWS.0 | Self::AO.0 | Self::NORMAL_MAP.0 | Self::HEIGHT_SEQ.0 | Self::WATER.0);
+        if f.0 & needs_height.0 != 0 { f.union(Self::HEIGHT_TEX) } else { f }
+    }
+
+    pub fn names(self) -> Vec<&'static str> {
+        Self::ALL.iter().filter(|(f, _)| self.contains(*f)).map(|(_, n)| *n).collect()
+    }
+}
+
+/// Strip `#ifdef` / `#ifndef` / `#else` / `#endif` blocks. Directive and inactive lines
+/// become blank lines so naga error line numbers still match the source file.
+pub fn preprocess(src: &str, defines: &[&str]) -> Result<String, String> {
+    // (parent active, condition, inside #else)
+    let mut stack: Vec<(bool, bool, bool)> = Vec::new();
+    let mut active = true;
+    let mut out = String::with_capacity(src.len());
+    for (i, line) in src.lines().enumerate() {
+        let t = line.trim();
+        let directive = if let Some(name) = t.strip_prefix("#ifdef ") {
+            let cond = defines.contains(&name.trim());
+            stack.push((active, cond, false));
+            active = active && cond;
+            true
+        } else if let Some(name) = t.strip_prefix("#ifndef ") {
+            let cond = !defines.contains(&name.trim());
+            stack.push((active, cond, false));
+            active = active && cond;
+            true
+        } else if t == "#else" {
+            let top = stack.last_mut().ok_or_else(|| format!("line {}: #else without #ifdef", i + 1))?;
+            if top.2 {
+                return Err(format!("line {}: duplicate #else", i + 1));
+            }
+            top.2 = true;
+            active = top.0 && !top.1;
+            true
+        } else if t == "#endif" {
+            let top = stack.pop().ok_or_else(|| format!("line {}: #endif without #ifdef", i + 1))?;
+            active = top.0;
+            true
+        } else {
+            false
+        };
+        if active && !directive {
+            out.push_str(line);
+        }
+        out.push('\n');
+    }
+    if !stack.is_empty() {
+        return Err("unterminated #ifdef".to_string());
+    }
+    Ok(out)
+}
+
+/// Specialized `terrain.wgsl` source for `features`.
+pub fn terrain_source(features: ShaderFeatures) -> String {
+    let defines = features.names();
+    preprocess(include_str!("../shaders/terrain.wgsl"), &defines)
+        .expect("terrain.wgsl preprocessor directives are balanced")
+}
+
+/// Compiled terrain pipelines keyed by (feature mask, colour format). One cache per device.
+#[derive(Default)]
+pub struct PipelineCache {
+    map: HashMap<(u32, wgpu::TextureFormat), Arc<TerrainPipeline>>,
+    pub hits: u64,
+    pub misses: u64,
+}
+
+impl PipelineCache {
+    pub fn new() -> Self { Self::default() }
+
+    pub fn get_or_create(&mut self, device: &wgpu::Device, format: wgpu::TextureFormat, features: ShaderFeatures) -> Arc<TerrainPipeline> {
+        let features = features.resolve();
+        if let Some(p) = self.map.get(&(features.0, format)) {
+            self.hits += 1;
+            return p.clone();
+        }
+        self.misses += 1;
+        let p = Arc::new(TerrainPipeline::create_with(device, format, features));
+        self.map.insert((features.0, format), p.clone());
+        p
+    }
+
+    /// Seed the cache with a pipeline compiled elsewhere on the same device (`warmup`).
+    pub fn insert(&mut self, format: wgpu::TextureFormat, features: ShaderFeatures, pipeline: Arc<TerrainPipeline>) {
+        self.map.insert((features.resolve().0, format), pipeline);
+    }
+
+    pub fn len(&self) -> usize { self.map.len() }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn nested_blocks_and_else() {
+        let src = "a\n#ifdef X\nb\n#ifndef Y\nc\n#else\nd\n#endif\n#else\ne\n#endif\nf";
+        assert_eq!(preprocess(src, &["X"]).unwrap().split_whitespace().collect::<Vec<_>>(), ["a", "b", "c", "f"]);
+        assert_eq!(preprocess(src, &["X", "Y"]).unwrap().split_whitespace().collect::<Vec<_>>(), ["a", "b", "d", "f"]);
+        assert_eq!(preprocess(src, &[]).unwrap().split_whitespace().collect::<Vec<_>>(), ["a", "e", "f"]);
+        assert_eq!(preprocess(src, &[]).unwrap().lines().count(), src.lines().count());
+    }
+
+    #[test]
+    fn unbalanced_directives_rejected() {
+        assert!(preprocess("#ifdef X\n", &[]).is_err());
+        assert!(preprocess("#endif\n", &[]).is_err());
+        assert!(preprocess("#ifdef X\n#else\n#else\n#endif", &[]).is_err());
+    }
+
+    #[test]
+    fn feature_names_resolve_dependencies() {
+        let f = ShaderFeatures::from_names(&["shadows", "lut"]).unwrap();
+        assert!(f.contains(ShaderFeatures::HEIGHT_TEX));
+        assert_eq!(f.names(), ["HEIGHT_TEX", "LUT", "SHADOWS"]);
+        assert!(ShaderFeatures::from_names(&["bloom"]).is_err());
+    }
+
+    #[test]
+    fn every_variant_is_balanced_and_drops_unused_bindings() {
+        for mask in 0..(1u32 << ShaderFeatures::ALL.len()) {
+            let f = ShaderFeatures(mask).resolve();
+            let src = terrain_source(f);
+            assert_eq!(src.contains("height_tex"), f.contains(ShaderFeatures::HEIGHT_TEX), "{:?}", f.names());
+            assert_eq!(src.contains("lut_tex"), f.contains(ShaderFeatures::LUT), "{:?}", f.names());
+            assert_eq!(src.contains("analytic_height"), f.contains(ShaderFeatures::ANALYTIC_FALLBACK));
+            assert_eq!(src.contains("var<uniform> globals"), !f.contains(ShaderFeatures::PUSH_CONSTANTS));
+            assert_eq!(src.contains("class_tex"), f.contains(ShaderFeatures::DATASET));
+            assert_eq!(src.contains("texture_2d_array"), f.contains(ShaderFeatures::HEIGHT_SEQ));
+            assert_eq!(src.contains("height_b"), f.contains(ShaderFeatures::DIFF));
+            assert!(!f.contains(ShaderFeatures::DIFF) || f.contains(ShaderFeatures::NORMAL_MAP));
+            assert_eq!(src.contains("water_tex"), f.contains(ShaderFeatures::WATER));
+            assert_eq!(src.contains("scalar_tex"), f.contains(ShaderFeatures::SCALAR));
+            let temporal = f.contains(ShaderFeatures::TEMPORAL) && !f.contains(ShaderFeatures::DATASET);
+            assert_eq!(src.contains("FsTemporal"), temporal);
+        }
+    }
+
+    #[test]
+    fn every_variant_is_valid_wgsl() {
+        use naga::valid::{Capabilities, ValidationFlags, Validator};
+        let mut seen = std::collections::HashSet::new();
+        // Push constants are the only optional capability a permutation may use.
+        let mut validator = Validator::new(ValidationFlags::all(), Capabilities::PUSH_CONSTANT);
+        for mask in 0..(1u32 << ShaderFeatures::ALL.len()) {
+            let f = ShaderFeatures(mask).resolve();
+            if !seen.insert(f.0) {
+                continue;
+            }
+            let module = naga::front::wgsl::parse_str(&terrain_source(f))
+                .unwrap_or_else(|e| panic!("{:?}: {}", f.names(), e));
+            if let Err(e) = validator.validate(&module) {
+                panic!("{:?}: {:?}", f.names(), e);
+            }
+        }
+    }
+}
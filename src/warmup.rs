@@ -0,0 +1,100 @@
+//! Background device + pipeline initialization ("warmup").
+//!
+//! `warmup()` (or `VF_WARMUP=1` at import, handled by the Python shim) spawns a Rust
+//! thread that creates the shared `WgpuContext` and a Scene device, and compiles the
+//! triangle pipeline and the Scene's default terrain permutation. The first `Scene(...)` on
+//! the preferred adapter adopts that device and pipeline. A `Renderer(...)` created meanwhile
+//! blocks only on the shared context if it is still being built. A `Scene(...)` created
+//! before the Scene device is ready builds its own, and the warm one is then discarded.
+
+use std::sync::Mutex;
+use std::time::Instant;
+
+use once_cell::sync::{Lazy, OnceCell};
+use pyo3::prelude::*;
+use pyo3::types::PyDict;
+
+#[derive(Default)]
+struct WarmupState {
+    started: Option<Instant>,
+    device_ms: Option<f64>,
+    pipelines_ms: Option<f64>,
+    total_ms: Option<f64>,
+    error: Option<String>,
+}
+
+static STATE: Lazy<Mutex<WarmupState>> = Lazy::new(|| Mutex::new(WarmupState::default()));
+
+/// Set once by the warmup thread when it finishes (`Err` carries its failure).
+static DONE: OnceCell<Result<(), String>> = OnceCell::new();
+
+static TRIANGLE_PIPELINE: OnceCell<wgpu::RenderPipeline> = OnceCell::new();
+
+/// Shared triangle pipeline (compiled once per process, possibly by the warmup thread).
+pub(crate) fn triangle_pipeline() -> &'static wgpu::RenderPipeline {
+    TRIANGLE_PIPELINE.get_or_init(|| crate::create_pipeline(&crate::WgpuContext::get().device, crate::TEXTURE_FORMAT))
+}
+
+fn run() {
+    let t0 = Instant::now();
+    let result = std::panic::catch_unwind(|| {
+        crate::WgpuContext::get();
+        let device_ms = t0.elapsed().as_secs_f64() * 1000.0;
+        STATE.lock().unwrap().device_ms = Some(device_ms);
+        triangle_pipeline();
+        crate::scene::warm_scene_device()?;
+        Ok::<f64, String>(t0.elapsed().as_secs_f64() * 1000.0 - device_ms)
+    });
+    let mut st = STATE.lock().unwrap();
+    let result = match result {
+        Ok(r) => r,
+        Err(e) => Err(e.downcast_ref::<&str>().map(|s| s.to_string())
+            .or_else(|| e.downcast_ref::<String>().cloned())
+            .unwrap_or_else(|| "warmup thread panicked".to_string())),
+    };
+    match &result {
+        Ok(pipelines_ms) => st.pipelines_ms = Some(*pipelines_ms),
+        Err(msg) => st.error = Some(msg.clone()),
+    }
+    st.total_ms = Some(t0.elapsed().as_secs_f64() * 1000.0);
+    drop(st);
+    DONE.set(result.map(|_| ())).ok();
+}
+
+/// Start background initialization (idempotent). Returns immediately unless `block`, which
+/// waits for the warmup thread whichever call started it.
+#[pyfunction]
+#[pyo3(signature = (block=false))]
+#[pyo3(text_signature = "(block=False)")]
+pub fn warmup(py: Python<'_>, block: bool) -> PyResult<()> {
+    {
+        let mut st = STATE.lock().unwrap();
+        if st.started.is_none() {
+            std::thread::Builder::new()
+                .name("vf-warmup".into())
+                .spawn(run)
+                .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+            st.started = Some(Instant::now());
+        }
+    }
+    if block {
+        py.allow_threads(|| DONE.wait().clone()).map_err(pyo3::exceptions::PyRuntimeError::new_err)?;
+    }
+    Ok(())
+}
+
+/// `{started, ready, device_ms, pipelines_ms, total_ms, error}`; timings are `None` until
+/// the corresponding stage finished on the warmup thread.
+#[pyfunction]
+#[pyo3(text_signature = "()")]
+pub fn warmup_status(py: Python<'_>) -> PyResult<PyObject> {
+    let st = STATE.lock().unwrap();
+    let d = PyDict::new(py);
+    d.set_item("started", st.started.is_some())?;
+    d.set_item("ready", matches!(DONE.get(), Some(Ok(()))))?;
+    d.set_item("device_ms", st.device_ms)?;
+    d.set_item("pipelines_ms", st.pipelines_ms)?;
+    d.set_item("total_ms", st.total_ms)?;
+    d.set_item("error", st.error.clone())?;
+    Ok(d.into_any().unbind())
+}
@@ -0,0 +1,55 @@
+"""Shared fixtures for the Scene tests.
+
+`make_scene` and `views` are factories, so a test can build several Scenes or camera sets.
+A module with other Scene defaults overrides `make_scene` with a fixture of the same name
+that wraps this one.
+"""
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        vf = None
+
+LOOK_AT = ((3, 2, 3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+
+
+@pytest.fixture
+def make_scene():
+    """`make_scene(w=64, h=48, grid=32, colormap="viridis", seed=None, camera=False,
+    shared_device=False)`.
+
+    `seed` generates a 128² fBm DEM; `camera` sets the standard 3/4 view of the origin.
+    Skips the test when no GPU is available.
+    """
+    def make(w=64, h=48, grid=32, colormap="viridis", seed=None, camera=False, shared_device=False):
+        if vf is None:
+            pytest.skip("Extension module _vulkan_forge not built")
+        try:
+            scn = vf.Scene(w, h, grid=grid, colormap=colormap, shared_device=shared_device)
+        except RuntimeError as e:
+            pytest.skip(f"GPU unavailable: {e}")
+        if seed is not None:
+            scn.generate_height(128, 128, kind="fbm", seed=seed)
+        if camera:
+            scn.set_camera_look_at(*LOOK_AT)
+        return scn
+
+    return make
+
+
+@pytest.fixture
+def views():
+    """`views(n)`: (n, 4, 4) float32 view matrices orbiting the origin."""
+    def make(n):
+        out = []
+        for i in range(n):
+            a = 2.0 * np.pi * i / n
+            out.append(vf.camera_look_at((3.0 * np.cos(a), 2.0, 3.0 * np.sin(a)), (0, 0, 0), (0, 1, 0)))
+        return np.ascontiguousarray(np.stack(out), dtype=np.float32)
+
+    return make
@@ -0,0 +1,95 @@
+import json
+import os
+import subprocess
+import sys
+
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping adapter ranking tests.", allow_module_level=True)
+
+
+def _rank(force=False):
+    try:
+        ranked = vf.rank_adapters(force)
+    except RuntimeError as e:
+        pytest.skip(f"GPU unavailable: {e}")
+    if not ranked:
+        pytest.skip("GPU unavailable: no adapters enumerated")
+    return ranked
+
+
+def test_cache_path_follows_env(tmp_path, monkeypatch):
+    path = tmp_path / "adapters.json"
+    monkeypatch.setenv("VF_ADAPTER_CACHE", str(path))
+    assert vf.adapter_cache_path() == str(path)
+
+
+def test_rank_writes_cache_and_reuses_it(tmp_path, monkeypatch):
+    path = tmp_path / "adapters.json"
+    monkeypatch.setenv("VF_ADAPTER_CACHE", str(path))
+    first = _rank()
+    assert path.exists()
+    doc = json.loads(path.read_text())
+    assert doc["version"] == 1
+    assert {r["key"] for r in first} == set(doc["entries"])
+    assert not any(r["cached"] for r in first)
+
+    # Fastest first; failed adapters (median_ms None) sort last.
+    times = [r["median_ms"] for r in first]
+    ok = [t for t in times if t is not None]
+    assert ok == sorted(ok)
+    assert times[: len(ok)] == ok
+
+    second = _rank()
+    assert all(r["cached"] for r in second)
+    assert [r["key"] for r in second] == [r["key"] for r in first]
+
+
+def test_scene_uses_ranked_adapter(tmp_path, monkeypatch):
+    monkeypatch.setenv("VF_ADAPTER_CACHE", str(tmp_path / "adapters.json"))
+    ranked = _rank()
+    if ranked[0]["median_ms"] is None:
+        pytest.skip("GPU unavailable: no adapter completed the benchmark")
+    scn = vf.Scene(32, 32, grid=8)
+    assert scn.render_rgba().shape == (32, 32, 4)
+
+
+def test_force_rerank_keeps_entries_of_absent_adapters(tmp_path, monkeypatch):
+    path = tmp_path / "adapters.json"
+    monkeypatch.setenv("VF_ADAPTER_CACHE", str(path))
+    first = _rank()
+    doc = json.loads(path.read_text())
+    doc["entries"]["gone|Vulkan|old|0.0|0000:0000"] = {"name": "gone", "median_ms": 0.001}
+    path.write_text(json.dumps(doc))
+    again = _rank(force=True)
+    assert not any(r["cached"] for r in again)
+    entries = json.loads(path.read_text())["entries"]
+    assert "gone|Vulkan|old|0.0|0000:0000" in entries
+    assert {r["key"] for r in first} <= set(entries)
+
+
+# Fresh interpreter: the Renderer context is a process-wide singleton.
+DEFAULTS = r"""
+import json
+import vulkan_forge as vf
+print(json.dumps({"scene": vf.Scene(32, 32, grid=8).device_caps()["adapter_key"],
+                  "renderer": vf.context_caps()["adapter_key"]}))
+"""
+
+
+def test_top_ranked_adapter_is_the_default(tmp_path, monkeypatch):
+    monkeypatch.setenv("VF_ADAPTER_CACHE", str(tmp_path / "adapters.json"))
+    ranked = _rank()
+    if ranked[0]["median_ms"] is None:
+        pytest.skip("GPU unavailable: no adapter completed the benchmark")
+    assert vf.Scene(32, 32, grid=8).device_caps()["adapter_key"] == ranked[0]["key"]
+    out = subprocess.run([sys.executable, "-c", DEFAULTS], check=True, capture_output=True, text=True,
+                         timeout=120, env=dict(os.environ))
+    picked = json.loads(out.stdout.strip().splitlines()[-1])
+    assert picked == {"scene": ranked[0]["key"], "renderer": ranked[0]["key"]}
@@ -0,0 +1,60 @@
+import asyncio
+
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping async render tests.", allow_module_level=True)
+
+
+def test_render_async_matches_blocking(make_scene):
+    scn = make_scene()
+    expected = scn.render_rgba()
+    got = asyncio.run(scn.render_async())
+    assert got.shape == (48, 64, 4)
+    np.testing.assert_array_equal(got, expected)
+
+
+def test_many_in_flight_on_one_loop(make_scene, views):
+    scn = make_scene()
+    V = views(8)
+    expected = scn.render_views_rgba(V)
+
+    async def main():
+        return await asyncio.gather(*(scn.render_async(V[i:i + 1]) for i in range(8) for _ in range(8)))
+
+    results = asyncio.run(main())
+    assert len(results) == 64
+    for k, img in enumerate(results):
+        np.testing.assert_array_equal(img[0], expected[k // 8])
+
+
+def test_frame_readback_paths(make_scene, views):
+    scn = make_scene()
+    frame = scn.submit(views(2))
+    assert frame.shape == [2, 48, 64, 4]
+    out = frame.readback()
+    assert out.shape == (2, 48, 64, 4)
+    assert frame.ready()
+    with pytest.raises(RuntimeError):
+        frame.readback()
+
+    async def main():
+        f = scn.submit()
+        return await f.readback_async()
+
+    assert asyncio.run(main()).shape == (48, 64, 4)
+
+
+def test_dropped_frame_releases_slot(make_scene):
+    scn = make_scene()
+    frame = scn.submit()
+    del frame
+    scn.render_rgba()
+    _, in_use = scn.render_slot_stats()
+    assert in_use == 0
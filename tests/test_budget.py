@@ -0,0 +1,80 @@
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping frame budget tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    def make(w=128, h=96, grid=64):
+        return make_scene(w, h, grid=grid, colormap="terrain", seed=2, camera=True)
+    return make
+
+
+def test_ladder_and_validation(make_scene):
+    scn = make_scene()
+    ladder = scn.set_frame_budget(16.0)
+    assert [(l["grid"], l["aa"], l["shadows"], l["ao"]) for l in ladder] == [
+        (16, 1, False, False), (32, 1, False, False), (64, 1, False, False),
+        (64, 1, True, False), (64, 1, True, True), (64, 2, True, True),
+    ]
+    assert len(scn.set_frame_budget(16.0, effects=[], max_aa=1, min_grid=32)) == 2
+    for bad in (dict(target_ms=0.0), dict(target_ms=16.0, max_aa=5), dict(target_ms=16.0, effects=["bloom"]),
+                dict(target_ms=16.0, up_headroom=1.5)):
+        with pytest.raises(ValueError):
+            scn.set_frame_budget(**bad)
+    assert scn.set_frame_budget(None) == []
+    with pytest.raises(RuntimeError):
+        scn.render_budgeted()
+
+
+def test_generous_budget_climbs_to_full_quality(make_scene):
+    scn = make_scene()
+    ladder = scn.set_frame_budget(10_000.0, max_aa=2, up_after=1)
+    levels = []
+    for _ in range(2 * len(ladder)):
+        out = scn.render_budgeted()
+        assert out["rgba"].shape == (96, 128, 4) and out["rgba"].dtype == np.uint8
+        levels.append(out["quality"]["level"])
+    assert levels[0] == 0 and levels[-1] == len(ladder) - 1
+    assert all(b - a in (0, 1) for a, b in zip(levels, levels[1:]))
+    q, t, b = out["quality"], out["timings"], out["budget"]
+    assert (q["grid"], q["aa"], q["shadows"], q["ao"]) == (64, 2, True, True)
+    assert "SHADOWS" in q["features"] and "AO" in q["features"]
+    assert b["reason"] == "max_quality" and b["next_level"] == q["level"] and b["ewma_ms"] > 0
+    assert t["total_ms"] >= t["wait_ms"] > 0
+    assert t["gpu_terrain_ms"] is None or t["gpu_terrain_ms"] >= 0
+    assert t["gpu_resolve_ms"] is None or t["gpu_resolve_ms"] >= 0
+
+
+def test_full_grid_level_matches_render_rgba(make_scene):
+    scn = make_scene()
+    ladder = scn.set_frame_budget(10_000.0, effects=[], max_aa=1, up_after=1)
+    for _ in range(len(ladder)):
+        out = scn.render_budgeted()
+    assert out["quality"]["grid"] == 64
+    np.testing.assert_array_equal(out["rgba"], scn.render_rgba())
+    # Coarser levels still cover the frame: same size, close to the full mesh.
+    scn.set_frame_budget(10_000.0, effects=[], max_aa=1)
+    coarse = scn.render_budgeted()
+    assert coarse["quality"]["grid"] == 16
+    assert np.abs(coarse["rgba"].astype(np.int16) - out["rgba"].astype(np.int16)).mean() < 20.0
+
+
+def test_impossible_budget_stays_at_lowest_level(make_scene):
+    scn = make_scene()
+    scn.set_frame_budget(1e-6)
+    for _ in range(5):
+        out = scn.render_budgeted()
+        assert out["quality"]["level"] == 0 and out["budget"]["reason"] == "min_quality"
+    # Features the controller does not toggle follow the Scene.
+    scn.set_features(["height_tex", "lut", "shadows"])
+    scn.set_frame_budget(1e-6, effects=["ao"])
+    out = scn.render_budgeted()
+    assert out["quality"]["shadows"] and not out["quality"]["ao"]
@@ -0,0 +1,123 @@
+import os
+import sys
+import threading
+
+import numpy as np
+import pytest
+
+if not sys.platform.startswith(("linux", "darwin")):
+    pytest.skip("render daemon needs AF_UNIX + POSIX shared memory", allow_module_level=True)
+
+try:
+    import vulkan_forge
+    from vulkan_forge.daemon import RemoteScene, RenderDaemon, daemon_stats
+except ImportError:
+    pytest.skip("Extension module _vulkan_forge not built; skipping daemon tests.", allow_module_level=True)
+
+vf = vulkan_forge._ext
+
+
+@pytest.fixture
+def daemon(tmp_path):
+    path = str(tmp_path / "vf.sock")
+    try:
+        vf.Scene(32, 32, grid=16)
+    except RuntimeError as e:
+        pytest.skip(f"GPU unavailable: {e}")
+    with RenderDaemon(path, batch_window_ms=20.0) as d:
+        yield d
+
+
+def dem():
+    yy, xx = np.mgrid[0:64, 0:64].astype(np.float32) / 64.0
+    return np.ascontiguousarray(0.5 + 0.25 * np.sin(6.0 * xx) * np.cos(4.0 * yy), dtype=np.float32)
+
+
+def test_remote_matches_local(daemon):
+    cam = ((3.0, 2.0, 3.0), (0.0, 0.0, 0.0), (0.0, 1.0, 0.0), 45.0, 0.1, 100.0)
+    local = vf.Scene(64, 48, grid=32, colormap="viridis")
+    local.set_height_from_r32f(dem())
+    local.set_camera_look_at(*cam)
+    remote = RemoteScene(64, 48, grid=32, colormap="viridis", socket_path=daemon.socket_path)
+    remote.set_height_from_r32f(dem())
+    remote.set_camera_look_at(*cam)
+    np.testing.assert_array_equal(remote.render_rgba(), local.render_rgba())
+
+    V = np.stack([vf.camera_look_at((0.0, 3.0, 3.0), (0, 0, 0), (0, 1, 0)),
+                  vf.camera_look_at((3.0, 3.0, 0.0), (0, 0, 0), (0, 1, 0))]).astype(np.float32)
+    np.testing.assert_array_equal(remote.render_views_rgba(V), local.render_views_rgba(V))
+
+
+def test_dem_uploaded_once_and_scenes_shared(daemon):
+    a = RemoteScene(32, 32, grid=16, socket_path=daemon.socket_path)
+    b = RemoteScene(32, 32, grid=16, socket_path=daemon.socket_path)
+    a.set_height_from_r32f(dem())
+    b.set_height_from_r32f(dem())
+    a.render_rgba()
+    b.render_rgba()
+    st = daemon_stats(daemon.socket_path)
+    assert st["dems"] == 1
+    assert st["scenes"] == 1
+    assert st["requests"] == 2
+
+
+def test_projections_share_one_scene(daemon):
+    eye = ((3.0, 2.0, 3.0), (0.0, 0.0, 0.0), (0.0, 1.0, 0.0))
+    wide = RemoteScene(32, 32, grid=16, socket_path=daemon.socket_path)
+    tele = RemoteScene(32, 32, grid=16, socket_path=daemon.socket_path)
+    plain = RemoteScene(32, 32, grid=16, socket_path=daemon.socket_path)
+    wide.set_camera_look_at(*eye, 70.0, 0.1, 100.0)
+    tele.set_camera_look_at(*eye, 20.0, 0.1, 100.0)
+    for fovy, remote in ((70.0, wide), (20.0, tele), (None, plain), (70.0, wide)):
+        local = vf.Scene(32, 32, grid=16)
+        if fovy is not None:
+            local.set_camera_look_at(*eye, fovy, 0.1, 100.0)
+        np.testing.assert_array_equal(remote.render_rgba(), local.render_rgba())
+    assert daemon_stats(daemon.socket_path)["scenes"] == 1
+
+
+def test_socket_is_owner_only(daemon):
+    assert os.stat(daemon.socket_path).st_mode & 0o777 == 0o600
+
+
+def test_concurrent_requests_are_batched(daemon):
+    from vulkan_forge import daemon as mod
+    scenes = []
+    for _ in range(4):
+        # One connection each (as separate client processes would have), so requests overlap.
+        mod._Channel._instances.clear()
+        s = RemoteScene(32, 32, grid=16, socket_path=daemon.socket_path)
+        s.set_camera_look_at((3.0, 2.0, 3.0), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+        scenes.append(s)
+    out = [None] * len(scenes)
+    barrier = threading.Barrier(len(scenes))
+
+    def go(i):
+        barrier.wait()
+        out[i] = scenes[i].render_rgba()
+
+    threads = [threading.Thread(target=go, args=(i,)) for i in range(len(scenes))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for img in out[1:]:
+        np.testing.assert_array_equal(img, out[0])
+    st = daemon.stats()
+    assert st["batches"] < st["requests"]
+
+
+def test_errors_cross_the_socket(daemon):
+    with pytest.raises(RuntimeError):
+        RemoteScene(32, 32, colormap="not-a-colormap", socket_path=daemon.socket_path)
+    s = RemoteScene(32, 32, socket_path=daemon.socket_path)
+    with pytest.raises(ValueError):
+        s.render_views_rgba(np.zeros((0, 4, 4), np.float32))
+    s.close()
+    with pytest.raises(RuntimeError):
+        s.render_rgba()
+
+
+def test_no_daemon_raises(tmp_path):
+    with pytest.raises(RuntimeError):
+        RemoteScene(32, 32, socket_path=str(tmp_path / "missing.sock"))
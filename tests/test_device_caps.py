@@ -0,0 +1,43 @@
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping device caps tests.", allow_module_level=True)
+
+FAST_PATHS = ("push_constants", "timestamp_query", "norm16_textures")
+
+
+def test_context_caps_reports_fast_paths_and_limits():
+    try:
+        caps = vf.context_caps()
+    except BaseException as e:  # no adapter → the shared context panics
+        pytest.skip(f"GPU unavailable: {e}")
+    for k in FAST_PATHS + ("downlevel", "max_texture_dimension_2d", "max_buffer_size"):
+        assert k in caps
+    if not caps["downlevel"]:
+        assert caps["max_texture_dimension_2d"] >= 2048
+
+
+def test_scene_downlevel_override(monkeypatch):
+    monkeypatch.setenv("VF_DOWNLEVEL", "1")
+    try:
+        scn = vf.Scene(32, 32, grid=8)
+    except RuntimeError as e:
+        pytest.skip(f"GPU unavailable: {e}")
+    caps = scn.device_caps()
+    assert caps["downlevel"] and not any(caps[k] for k in FAST_PATHS)
+    assert not scn.push_constants_enabled()
+    assert scn.render_rgba().shape == (32, 32, 4)
+
+
+def test_probe_and_enumerate_include_negotiated():
+    probe = vf.device_probe("AUTO")
+    if probe.get("status") != "ok":
+        pytest.skip("no adapter")
+    assert set(FAST_PATHS) <= set(probe["negotiated"])
+    for ad in vf.enumerate_adapters():
+        assert "negotiated" in ad
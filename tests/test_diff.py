@@ -0,0 +1,123 @@
+import functools
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping DEM difference tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    return functools.partial(make_scene, camera=True)
+
+
+def epochs(h=40, w=56, seed=0):
+    rng = np.random.default_rng(seed)
+    yy, xx = np.mgrid[0:h, 0:w].astype(np.float32) / max(h, w)
+    a = np.ascontiguousarray(0.3 * np.sin(6 * xx) * np.cos(4 * yy), dtype=np.float32)
+    b = np.ascontiguousarray(a + rng.normal(0.0, 0.05, a.shape), dtype=np.float32)
+    return a, b
+
+
+def test_stats_match_numpy(make_scene):
+    scn = make_scene()
+    a, b = epochs()
+    b[3, 4] = np.nan
+    rng = scn.set_diff(a, b)
+    d = (a - b).astype(np.float32)
+    valid = d[~np.isnan(d)]
+    assert rng == pytest.approx(np.abs(valid).max(), rel=1e-6)
+
+    s = scn.diff_stats(bins=32, cell_area=2.0)
+    hist, edges = np.histogram(valid, bins=32, range=(valid.min(), valid.max()))
+    assert s["hist"].dtype == np.uint32 and s["hist"].shape == (32,)
+    assert np.abs(s["hist"].astype(int) - hist).sum() <= 4  # f32 rounding at bin edges
+    assert s["hist"].sum() + s["below"] + s["above"] == valid.size
+    np.testing.assert_allclose(s["edges"], edges, rtol=1e-5, atol=1e-6)
+    assert s["fill_volume"] == pytest.approx(2.0 * valid[valid > 0].sum(), rel=1e-4)
+    assert s["cut_volume"] == pytest.approx(-2.0 * valid[valid < 0].sum(), rel=1e-4)
+    assert s["net_volume"] == pytest.approx(s["fill_volume"] - s["cut_volume"])
+    assert (s["valid_cells"], s["nodata_cells"]) == (valid.size, 1)
+    assert (s["fill_cells"], s["cut_cells"]) == ((valid > 0).sum(), (valid < 0).sum())
+    assert s["min"] == pytest.approx(valid.min()) and s["max"] == pytest.approx(valid.max())
+
+
+def test_fixed_range_counts_outliers(make_scene):
+    scn = make_scene()
+    a, b = epochs()
+    scn.set_diff(a, b)
+    s = scn.diff_stats(bins=8, range=(-0.05, 0.05))
+    d = (a - b).ravel()
+    assert s["below"] == (d < -0.05).sum() and s["above"] == (d > 0.05).sum()
+    assert s["hist"].sum() == ((d >= -0.05) & (d <= 0.05)).sum()
+
+
+def test_update_epoch_touches_only_the_window(make_scene):
+    scn = make_scene()
+    a, b = epochs()
+    scn.set_diff(a, b)
+    patch = np.full((5, 7), 1.0, np.float32)
+    scn.update_epoch("b", patch, x=10, y=20)
+    b2 = b.copy()
+    b2[20:25, 10:17] = patch
+    d = a - b2
+    s = scn.diff_stats(bins=4)
+    assert s["cut_volume"] == pytest.approx(-d[d < 0].sum(), rel=1e-4)
+    assert s["min"] == pytest.approx(d.min())
+
+
+def test_render_colours_sign_and_restores(make_scene):
+    scn = make_scene()
+    a, _ = epochs()
+    scn.set_height_from_r32f(a)
+    before = scn.render_rgba()
+
+    scn.set_diff(a + 0.2, a, range=0.2)
+    fill = scn.render_rgba().astype(int)
+    assert {"DIFF", "NORMAL_MAP"} <= set(scn.features())
+    scn.update_epoch("a", a - 0.2)
+    cut = scn.render_rgba().astype(int)
+    terrain = (fill.sum(-1) > 60) & (cut.sum(-1) > 60)
+    assert (fill[..., 2] - fill[..., 0])[terrain].mean() > 0   # deposition is blue
+    assert (cut[..., 0] - cut[..., 2])[terrain].mean() > 0     # erosion is red
+
+    scn.set_features(["height_tex", "lut"])
+    assert "DIFF" in scn.features()
+    scn.set_features(["height_tex", "analytic_fallback", "lut"])
+    scn.clear_diff()
+    assert "DIFF" not in scn.features() and "NORMAL_MAP" not in scn.features()
+    np.testing.assert_array_equal(scn.render_rgba(), before)
+
+
+def test_surface_switches_geometry(make_scene):
+    scn = make_scene()
+    a, b = epochs()
+    scn.set_diff(a, b + 0.5, range=1.0)
+    on_a = scn.render_rgba()
+    scn.set_diff_style(range=1.0, surface="b")
+    assert not np.array_equal(scn.render_rgba(), on_a)
+
+
+def test_errors(make_scene):
+    scn = make_scene()
+    a, b = epochs()
+    with pytest.raises(ValueError):
+        scn.update_epoch("a", a)
+    with pytest.raises(ValueError):
+        scn.set_diff(a, b[:10])
+    scn.set_diff(a, b)
+    with pytest.raises(ValueError):
+        scn.update_epoch("c", a)
+    with pytest.raises(ValueError):
+        scn.update_epoch("a", np.zeros((4, 4), np.float32), x=a.shape[1] - 2)
+    with pytest.raises(ValueError):
+        scn.diff_stats(bins=0)
+    with pytest.raises(ValueError):
+        scn.diff_stats(range=(1.0, -1.0))
+    with pytest.raises(RuntimeError):
+        scn.render_sequence(np.stack([a, b]))
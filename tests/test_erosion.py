@@ -0,0 +1,99 @@
+import functools
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping erosion tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    return functools.partial(make_scene, camera=True)
+
+
+def ridge(h=40, w=56):
+    # A steep ridge with a valley and a nodata hole: both hydraulic and thermal passes act.
+    yy, xx = np.mgrid[0:h, 0:w].astype(np.float32)
+    dem = 0.5 * np.exp(-((xx - w / 2) / 6.0) ** 2) + 0.002 * yy + 0.01 * np.sin(xx / 3.0) * np.cos(yy / 4.0)
+    dem = dem.astype(np.float32)
+    dem[5:8, 6:9] = np.nan
+    return np.ascontiguousarray(dem)
+
+
+def test_gpu_matches_cpu_reference(make_scene):
+    scn = make_scene()
+    dem = ridge()
+    scn.set_height_from_r32f(dem)
+    run = scn.erode(30, batch=7)
+    assert run["iterations"] == 30 and run["total_iterations"] == 30 and "frames" not in run
+    gpu = scn.erosion_fields()
+    ref = vf.erosion_cpu(dem, 30)
+    for k in ("height", "water", "sediment"):
+        assert gpu[k].shape == dem.shape and gpu[k].dtype == np.float32
+        np.testing.assert_allclose(gpu[k], ref[k], atol=1e-4, equal_nan=True)
+    assert np.all(np.isnan(gpu["height"][5:8, 6:9])) and np.all(gpu["water"][5:8, 6:9] == 0)
+    # Calls continue one simulation; batching does not change the result.
+    assert scn.erode(10, batch=3)["total_iterations"] == 40
+    np.testing.assert_allclose(scn.erosion_fields()["height"], vf.erosion_cpu(dem, 40)["height"], atol=2e-4, equal_nan=True)
+
+
+def test_thermal_conserves_mass_and_relaxes_slopes():
+    dem = ridge()
+    dem[np.isnan(dem)] = 0.0
+    dem[:, 20:36] += 0.3
+    out = vf.erosion_cpu(dem, 200, rain=0.0, thermal=0.5, talus=0.5)["height"]
+    assert out.sum() == pytest.approx(dem.sum(), rel=1e-5)
+    assert np.abs(np.diff(out, axis=1)).max() < np.abs(np.diff(dem, axis=1)).max()
+
+
+def test_rain_carves_and_renders_without_readback(make_scene):
+    scn = make_scene()
+    dem = ridge()
+    dem[np.isnan(dem)] = 0.0
+    scn.set_height_from_r32f(dem)
+    before = scn.render_rgba()
+    run = scn.erode(60, batch=16, record_every=20, rain=0.05)
+    frames = run["frames"]
+    assert frames.shape == (3, 48, 64, 4) and frames.dtype == np.uint8
+    assert not np.array_equal(frames[-1], before)
+    np.testing.assert_array_equal(scn.render_rgba(), frames[-1])
+    f = scn.erosion_fields()
+    assert f["water"].max() > 0 and not np.allclose(f["height"], dem)
+    scn.reset_erosion()
+    np.testing.assert_array_equal(scn.render_rgba(), before)
+    with pytest.raises(RuntimeError):
+        scn.erosion_fields()
+
+
+def test_new_height_drops_erosion(make_scene):
+    scn = make_scene()
+    scn.set_height_from_r32f(ridge())
+    scn.erode(2)
+    scn.generate_height(32, 32, kind="ridged", seed=1)
+    with pytest.raises(RuntimeError):
+        scn.erosion_fields()
+    assert scn.erode(1)["total_iterations"] == 1
+    assert scn.erosion_fields()["height"].shape == (32, 32)
+
+
+def test_errors(make_scene):
+    dem = ridge()
+    with pytest.raises(TypeError):
+        vf.erosion_cpu(dem, 1, viscosity=1.0)
+    with pytest.raises(ValueError):
+        vf.erosion_cpu(dem, 1, dt=0.0)
+    with pytest.raises(ValueError):
+        vf.erosion_cpu(dem, 1, rain=-1.0)
+    scn = make_scene()
+    scn.set_height_from_r32f(dem)
+    with pytest.raises(ValueError):
+        scn.erode(1, batch=0)
+    with pytest.raises(ValueError):
+        scn.erode(1, thermal=float("nan"))
+    with pytest.raises(RuntimeError):
+        scn.erosion_fields()
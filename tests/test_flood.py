@@ -0,0 +1,125 @@
+import functools
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping flood tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    return functools.partial(make_scene, camera=True)
+
+
+def basins(h=45, w=61):
+    # Two bowls split by a ridge, a winding channel and a nodata hole.
+    yy, xx = np.mgrid[0:h, 0:w].astype(np.float32)
+    dem = 0.4 * np.sin(xx / 5.0) * np.cos(yy / 7.0) + 0.02 * xx
+    dem[:, w // 2] = 1.0
+    dem[5:h - 5:4, 3:w // 2 - 3] = 0.9
+    dem[8:12, 40:44] = np.nan
+    return np.ascontiguousarray(dem, dtype=np.float32)
+
+
+def test_matches_cpu_priority_flood(make_scene):
+    scn = make_scene()
+    dem = basins()
+    scn.set_height_from_r32f(dem)
+    seeds = np.array([[2, 2], [50, 30], [20, 40]])
+    levels = np.array([0.3, 0.6, 0.1], np.float32)
+    run = scn.flood(seeds, levels)
+    ref = vf.flood_depth_cpu(dem, seeds, levels)
+    depth = scn.water_depth()
+    assert depth.shape == dem.shape and depth.dtype == np.float32
+    np.testing.assert_array_equal(depth > 0, ref > 0)
+    np.testing.assert_allclose(depth, ref, atol=1e-6)
+    assert run["wet_cells"] == (ref > 0).sum() and run["passes"] >= 1
+    assert np.all(depth[np.isnan(dem)] == 0)
+    assert "WATER" in scn.features()
+
+
+def test_shared_level_uses_spill_field(make_scene):
+    scn = make_scene()
+    dem = basins()
+    scn.set_height_from_r32f(dem)
+    seeds = [(2, 2), (50, 30)]
+    spill = vf.flood_spill_cpu(dem, seeds)
+    for level in (0.2, 0.95, 1.2):
+        ref = vf.flood_depth_cpu(dem, seeds, level)
+        np.testing.assert_array_equal(ref > 0, spill < level)
+    scn.flood(seeds, 0.2)
+    for level in (0.95, -1.0, 1.2):
+        wet = scn.set_water_level(level)
+        assert wet == (spill < level).sum()
+        np.testing.assert_array_equal(scn.water_depth() > 0, spill < level)
+
+
+def test_sweep_is_monotone_and_matches_reference(make_scene):
+    scn = make_scene()
+    dem = basins()
+    scn.set_height_from_r32f(dem)
+    seeds = np.array([[2, 2]])
+    levels = np.linspace(-0.5, 1.5, 100, dtype=np.float32)
+    wet = scn.flood_sweep(seeds, levels)
+    spill = vf.flood_spill_cpu(dem, seeds)
+    assert wet.dtype == np.uint32 and wet.shape == (100,)
+    np.testing.assert_array_equal(wet, [(spill < l).sum() for l in levels])
+    assert np.all(np.diff(wet.astype(np.int64)) >= 0)
+    # The overlay is left at the last level and later levels reuse the field.
+    assert (scn.water_depth() > 0).sum() == wet[-1]
+    assert scn.set_water_level(float(levels[0])) == wet[0]
+
+
+def test_overlay_renders_and_clears(make_scene):
+    scn = make_scene()
+    dem = basins()
+    scn.set_height_from_r32f(dem)
+    dry = scn.render_rgba()
+    scn.flood([[2, 2]], 0.5)
+    wet = scn.render_rgba().astype(int)
+    assert not np.array_equal(wet, dry)
+    changed = np.any(wet != dry, axis=-1)
+    assert (wet[..., 2] - wet[..., 0])[changed].mean() > 0   # water is blue
+    scn.set_features(["height_tex", "lut", "shadows"])
+    assert "WATER" in scn.features()
+    scn.set_features(["height_tex", "analytic_fallback", "lut"])
+    scn.clear_water()
+    assert "WATER" not in scn.features()
+    np.testing.assert_array_equal(scn.render_rgba(), dry)
+
+
+def test_new_height_drops_the_flood(make_scene):
+    scn = make_scene()
+    dem = basins()
+    scn.set_height_from_r32f(dem)
+    scn.flood([[2, 2]], 0.5)
+    scn.set_height_from_r32f(dem[:20, :20].copy())
+    assert "WATER" not in scn.features()
+    with pytest.raises(RuntimeError):
+        scn.water_depth()
+    with pytest.raises(ValueError):
+        scn.set_water_level(0.5)
+
+
+def test_errors(make_scene):
+    scn = make_scene()
+    dem = basins()
+    scn.set_height_from_r32f(dem)
+    with pytest.raises(ValueError):
+        scn.flood([[dem.shape[1], 0]], 0.5)
+    with pytest.raises(ValueError):
+        scn.flood([[-1, 0]], 0.5)
+    with pytest.raises(ValueError):
+        scn.flood([[0, 0], [1, 1]], [0.5])
+    with pytest.raises(ValueError):
+        scn.flood([[0, 0]], float("nan"))
+    with pytest.raises(ValueError):
+        scn.flood_sweep([[0, 0]], [])
+    scn.set_diff(dem, dem)
+    with pytest.raises(ValueError):
+        scn.flood([[0, 0]], 0.5)
@@ -0,0 +1,60 @@
+import sys
+import sysconfig
+import threading
+
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping free-threading tests.", allow_module_level=True)
+
+FREE_THREADED = bool(sysconfig.get_config_var("Py_GIL_DISABLED"))
+
+
+def test_build_info():
+    info = vf.build_info()
+    # Loaded on a free-threaded interpreter means it was built for one, and vice versa.
+    assert info["free_threaded_ready"] is FREE_THREADED
+    assert info["pyo3"].startswith("0.23")
+    # abi3 wheels cannot load on a free-threaded interpreter.
+    if FREE_THREADED:
+        assert info["abi3"] is False
+
+
+@pytest.mark.skipif(not FREE_THREADED, reason="needs free-threaded CPython (3.13t)")
+def test_import_keeps_gil_disabled():
+    assert not sys._is_gil_enabled()
+
+
+def test_renderer_per_thread_on_shared_device():
+    # Create the shared device up front: without an adapter it panics (pyo3 PanicException,
+    # a BaseException) or raises RuntimeError. Anything raised in the threads is a failure.
+    try:
+        vf.Renderer(32, 32)
+    except BaseException as e:
+        if not isinstance(e, RuntimeError) and type(e).__name__ != "PanicException":
+            raise
+        pytest.skip(f"GPU unavailable: {e}")
+
+    errors = []
+    out = {}
+
+    def worker(i):
+        try:
+            out[i] = vf.Renderer(32, 32).render_triangle_rgba()
+        except BaseException as e:
+            errors.append(e)
+
+    ts = [threading.Thread(target=worker, args=(i,)) for i in range(4)]
+    for t in ts:
+        t.start()
+    for t in ts:
+        t.join()
+    assert not errors, errors
+    for i in range(1, 4):
+        np.testing.assert_array_equal(out[i], out[0])
@@ -0,0 +1,114 @@
+import threading
+
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping render_sequence tests.", allow_module_level=True)
+
+
+def series(t, h=32, w=32):
+    yy, xx = np.mgrid[0:h, 0:w].astype(np.float32) / max(h, w)
+    return np.ascontiguousarray(np.stack([0.3 * np.sin(6 * xx + k) * np.cos(4 * yy) for k in range(t)]), dtype=np.float32)
+
+
+def per_step(scn, dem, times):
+    frames = []
+    for t in times:
+        scn.set_height_from_r32f(np.ascontiguousarray(dem[int(t)]))
+        frames.append(scn.render_rgba())
+    return np.stack(frames)
+
+
+@pytest.mark.parametrize("ring", [2, 3, 8])
+def test_integer_times_match_per_step_upload(make_scene, ring):
+    scn = make_scene()
+    scn.set_camera_look_at((3, 2, 3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    dem = series(6)
+    seq = scn.render_sequence(dem, ring=ring)
+    assert seq.shape == (6, 48, 64, 4) and seq.dtype == np.uint8
+    np.testing.assert_allclose(seq.astype(int), per_step(scn, dem, range(6)).astype(int), atol=1)
+    assert scn.sequence_stats()["steps_uploaded"] == 6
+
+
+def test_fractional_times_blend_neighbours(make_scene):
+    scn = make_scene()
+    scn.set_camera_look_at((3, 2, 3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    dem = series(3)
+    seq = scn.render_sequence(dem, times=[1.0, 1.5, 2.0], ring=2).astype(int)
+    lo, hi = np.minimum(seq[0], seq[2]), np.maximum(seq[0], seq[2])
+    assert np.mean((seq[1] >= lo - 2) & (seq[1] <= hi + 2)) > 0.95
+    assert not np.array_equal(seq[1], seq[0])
+
+
+def test_memmapped_series_and_out(make_scene, tmp_path):
+    scn = make_scene()
+    dem = series(5)
+    np.save(tmp_path / "dem.npy", dem)
+    mm = np.load(tmp_path / "dem.npy", mmap_mode="r")
+    V = np.ascontiguousarray(np.stack([vf.camera_look_at((3, 2, 3 - 0.2 * i), (0, 0, 0), (0, 1, 0)) for i in range(5)]),
+                             dtype=np.float32)
+    out = np.lib.format.open_memmap(tmp_path / "frames.npy", mode="w+", dtype=np.uint8, shape=(5, 48, 64, 4))
+    assert scn.render_sequence(mm, views=V, ring=2, out=out) is out
+    np.testing.assert_array_equal(out, scn.render_sequence(list(dem), views=V, ring=4))
+
+
+def test_scene_is_restored_after_playback(make_scene):
+    scn = make_scene()
+    dem = series(2)
+    scn.set_height_from_r32f(dem[0])
+    before = scn.render_rgba()
+    scn.render_sequence(dem)
+    np.testing.assert_array_equal(scn.render_rgba(), before)
+    assert "HEIGHT_SEQ" not in scn.features()
+
+
+def test_concurrent_renders_keep_the_scene_height(make_scene):
+    scn = make_scene()
+    dem = series(48)
+    scn.set_height_from_r32f(dem[0])
+    before = scn.render_rgba()
+    alone = scn.render_sequence(dem, ring=4)
+    result, started, done = {}, threading.Event(), threading.Event()
+
+    def play():
+        started.set()
+        try:
+            result["seq"] = scn.render_sequence(dem, ring=4)
+        finally:
+            done.set()
+
+    t = threading.Thread(target=play)
+    t.start()
+    started.wait()
+    during = []
+    while not done.is_set() or not during:
+        during.append(scn.render_rgba())
+        assert "HEIGHT_SEQ" not in scn.features()
+    t.join()
+    # Renders during playback draw the Scene height, and playback is unaffected by them.
+    for img in during:
+        np.testing.assert_array_equal(img, before)
+    np.testing.assert_array_equal(result["seq"], alone)
+
+
+def test_errors(make_scene):
+    scn = make_scene()
+    dem = series(3)
+    with pytest.raises(ValueError):
+        scn.render_sequence(dem, times=[1.0, 0.5])
+    with pytest.raises(ValueError):
+        scn.render_sequence(dem, times=[3.5])
+    with pytest.raises(ValueError):
+        scn.render_sequence(dem, views=np.zeros((2, 4, 4), np.float32))
+    with pytest.raises(ValueError):
+        scn.render_sequence(dem, ring=1)
+    with pytest.raises(ValueError):
+        scn.render_sequence([dem[0], dem[1][:16]])
+    with pytest.raises(TypeError):
+        scn.render_sequence(dem.astype(np.float64))
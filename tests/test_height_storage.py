@@ -0,0 +1,75 @@
+import pytest
+import numpy as np
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping terrain tests.", allow_module_level=True)
+
+
+def ramp(shape=(33, 47)):
+    h, w = shape
+    return np.linspace(-10.0, 50.0, num=h * w, dtype=np.float32).reshape((h, w))
+
+
+@pytest.mark.parametrize("storage", ["f16", "u16"])
+def test_compact_storage_stats_close_to_f32(storage):
+    hm = ramp()
+    ref = vf.Renderer(16, 16)
+    ref.add_terrain(hm, (1.0, 1.0), 1.0, colormap="viridis")
+    r = vf.Renderer(16, 16)
+    r.add_terrain(hm, (1.0, 1.0), 1.0, colormap="viridis", storage=storage)
+
+    assert r.host_height_bytes() == ref.host_height_bytes() // 2
+    for got, want in zip(r.terrain_stats(), ref.terrain_stats()):
+        assert got == pytest.approx(want, abs=0.05)
+
+
+@pytest.mark.parametrize("storage,fmt", [("f32", "R32Float"), ("f16", "R16Float")])
+def test_native_upload_format_and_roundtrip(storage, fmt):
+    hm = ramp()
+    r = vf.Renderer(16, 16)
+    r.add_terrain(hm, (1.0, 1.0), 1.0, colormap="viridis", storage=storage)
+    r.upload_height()
+    assert r.height_texture_format() == fmt
+    np.testing.assert_allclose(r.read_full_height_texture(), hm, atol=0.05)
+
+
+def test_u16_upload_roundtrip():
+    hm = ramp()
+    r = vf.Renderer(16, 16)
+    r.add_terrain(hm, (1.0, 1.0), 1.0, colormap="viridis", storage="u16")
+    r.upload_height()
+    assert r.height_texture_format() in ("R16Unorm", "R32Float")
+    np.testing.assert_allclose(r.read_full_height_texture(), hm, atol=60.0 / 65535 + 1e-4)
+
+
+def test_u16_rejects_nan_cells():
+    hm = ramp()
+    hm[3, 5] = np.nan
+    r = vf.Renderer(16, 16)
+    with pytest.raises(ValueError, match="non-finite"):
+        r.add_terrain(hm, (1.0, 1.0), 1.0, colormap="viridis", storage="u16")
+
+
+def test_drop_after_upload_keeps_stats():
+    hm = ramp()
+    r = vf.Renderer(16, 16)
+    r.add_terrain(hm, (1.0, 1.0), 1.0, colormap="viridis", storage="f16", host_policy="drop_after_upload")
+    before = r.terrain_stats()
+    r.upload_height()
+    assert r.host_height_bytes() == 0
+    assert r.terrain_stats() == pytest.approx(before)
+    with pytest.raises(RuntimeError):
+        r.normalize_terrain("minmax", range=(0.0, 1.0), eps=None)
+    with pytest.raises(RuntimeError):
+        r.upload_height()
+
+
+def test_invalid_storage_rejected():
+    r = vf.Renderer(16, 16)
+    with pytest.raises(ValueError):
+        r.add_terrain(ramp(), (1.0, 1.0), 1.0, colormap="viridis", storage="f8")
@@ -0,0 +1,145 @@
+import functools
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping hydrology tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    return functools.partial(make_scene, camera=True)
+
+
+def rough(h=57, w=83, seed=3):
+    # Smooth relief plus integer-quantised noise: many pits and flats, and a nodata hole.
+    rng = np.random.default_rng(seed)
+    yy, xx = np.mgrid[0:h, 0:w].astype(np.float32)
+    dem = np.round(4.0 * np.sin(xx / 9.0) * np.cos(yy / 7.0) + rng.integers(0, 3, (h, w)))
+    dem[20:24, 30:33] = np.nan
+    return np.ascontiguousarray(dem, dtype=np.float32)
+
+
+def fill_reference(dem):
+    # Single-queue priority flood (8-neighbours) the tiled fill must reproduce exactly.
+    import heapq
+    h, w = dem.shape
+    out, closed, pq = dem.copy(), np.isnan(dem), []
+    for y in range(h):
+        for x in range(w):
+            if np.isnan(dem[y, x]):
+                continue
+            win = dem[max(y - 1, 0):y + 2, max(x - 1, 0):x + 2]
+            if y in (0, h - 1) or x in (0, w - 1) or np.isnan(win).any():
+                closed[y, x] = True
+                heapq.heappush(pq, (float(dem[y, x]), y, x))
+    while pq:
+        e, y, x = heapq.heappop(pq)
+        for dy in (-1, 0, 1):
+            for dx in (-1, 0, 1):
+                ny, nx = y + dy, x + dx
+                if 0 <= ny < h and 0 <= nx < w and not closed[ny, nx]:
+                    closed[ny, nx] = True
+                    out[ny, nx] = max(dem[ny, nx], e)
+                    heapq.heappush(pq, (float(out[ny, nx]), ny, nx))
+    return out
+
+
+def test_fill_matches_priority_flood_for_any_tiling():
+    dem = rough()
+    ref = fill_reference(dem)
+    for tile, threads in ((512, None), (7, 1), (16, 4), (2, 3)):
+        filled = vf.hydrology(dem, tile=tile, threads=threads)["filled"]
+        np.testing.assert_array_equal(filled, ref)
+    assert np.all(ref[~np.isnan(dem)] >= dem[~np.isnan(dem)])
+
+
+def test_d8_drains_every_cell_to_an_outlet():
+    dem = rough()
+    hyd = vf.hydrology(dem, method="d8", tile=16)
+    d, acc = hyd["direction"], hyd["accumulation"]
+    assert d.dtype == np.uint8 and acc.dtype == np.float32 and acc.shape == dem.shape
+    assert set(np.unique(d)) <= {0, 1, 2, 4, 8, 16, 32, 64, 128}
+    # After filling, only outlets (border / next to nodata) have no receiver.
+    valid = ~np.isnan(dem)
+    padded = np.pad(np.isnan(dem), 1, constant_values=True)
+    outlet = np.zeros_like(valid)
+    for dy in range(3):
+        for dx in range(3):
+            outlet |= padded[dy:dy + dem.shape[0], dx:dx + dem.shape[1]]
+    assert np.all(d[valid & ~outlet] != 0)
+    assert acc[valid & (d == 0)].sum() == valid.sum()
+    assert np.all(acc[valid] >= 1) and np.all(np.isnan(acc[~valid]))
+    # Tiling does not change the accumulation.
+    for tile, threads in ((5, 2), (1024, 1)):
+        np.testing.assert_array_equal(vf.hydrology(dem, tile=tile, threads=threads)["accumulation"], acc)
+
+
+def test_ramp_directions():
+    dem = np.ascontiguousarray(np.tile(np.arange(10, 0, -1, dtype=np.float32), (4, 1)))
+    hyd = vf.hydrology(dem, fill=False)
+    assert np.all(hyd["direction"][:, :-1] == 1)            # east
+    np.testing.assert_array_equal(hyd["accumulation"][1], np.arange(1, 11))
+    hyd = vf.hydrology(dem, method="dinf", fill=False)
+    np.testing.assert_allclose(hyd["direction"][:, :-1], 0.0, atol=1e-6)
+    np.testing.assert_allclose(hyd["accumulation"][1], np.arange(1, 11), rtol=1e-6)
+    north = np.ascontiguousarray(np.tile(np.arange(1, 8, dtype=np.float32)[:, None], (1, 5)))  # falls toward row 0
+    np.testing.assert_allclose(vf.hydrology(north, method="dinf", fill=False)["direction"][1:], np.pi / 2, rtol=1e-6)
+
+
+def test_dinf_conserves_flow():
+    dem = rough(seed=5)
+    hyd = vf.hydrology(dem, method="dinf")
+    valid = ~np.isnan(dem)
+    ang, acc = hyd["direction"], hyd["accumulation"]
+    assert ang.dtype == np.float32
+    assert np.all((ang[valid] == -1) | ((ang[valid] >= 0) & (ang[valid] < 2 * np.pi)))
+    assert np.all(acc[valid] >= 1 - 1e-4)
+    assert acc[valid & (ang == -1)].sum() == pytest.approx(valid.sum(), rel=1e-4)
+
+
+def test_renderer_hydrology_uses_terrain_heights():
+    r = vf.Renderer(32, 32)
+    dem = rough(40, 40)
+    dem[np.isnan(dem)] = 0.0
+    r.add_terrain(dem, spacing=(1.0, 1.0), exaggeration=1.0, colormap="viridis")
+    np.testing.assert_array_equal(r.hydrology()["accumulation"], vf.hydrology(dem)["accumulation"])
+
+
+def test_accumulation_as_colormap_source(make_scene):
+    scn = make_scene()
+    dem = rough()
+    dem[np.isnan(dem)] = 0.0
+    scn.set_height_from_r32f(dem / 8.0)
+    by_height = scn.render_rgba()
+    acc = vf.hydrology(dem)["accumulation"]
+    scn.set_scalar(acc, log=True)
+    assert "SCALAR" in scn.features()
+    by_flow = scn.render_rgba()
+    assert not np.array_equal(by_flow, by_height)
+    scn.set_features(["height_tex", "lut", "shadows"])
+    assert "SCALAR" in scn.features()
+    scn.set_features(["height_tex", "analytic_fallback", "lut"])
+    scn.clear_scalar()
+    assert "SCALAR" not in scn.features()
+    np.testing.assert_array_equal(scn.render_rgba(), by_height)
+
+
+def test_errors(make_scene):
+    dem = rough()
+    with pytest.raises(ValueError):
+        vf.hydrology(dem, method="mfd")
+    with pytest.raises(ValueError):
+        vf.hydrology(dem, threads=0)
+    with pytest.raises(ValueError):
+        vf.hydrology(dem, tile=0)
+    scn = make_scene()
+    with pytest.raises(ValueError):
+        scn.set_scalar(np.full((4, 4), np.nan, np.float32))
+    with pytest.raises(ValueError):
+        scn.set_scalar(np.ones((4, 4), np.float32), range=(1.0, 1.0))
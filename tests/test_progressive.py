@@ -0,0 +1,111 @@
+import asyncio
+import threading
+
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping progressive tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    def make(w=128, h=96, grid=64):
+        return make_scene(w, h, grid=grid, colormap="terrain", seed=2, camera=True)
+    return make
+
+
+def test_preview_then_refined_frame(make_scene):
+    scn = make_scene()
+    stages, finished = [], threading.Event()
+
+    def on_stage(stage, rgba):
+        stages.append((stage, None if rgba is None else rgba.shape))
+        if stage != "preview":
+            finished.set()
+
+    pf = scn.render_progressive(callback=on_stage)
+    assert pf.preview.shape == (24, 32, 4) and pf.preview.dtype == np.uint8
+    assert stages[0] == ("preview", (24, 32, 4))
+    final = pf.result(timeout=30)
+    assert final.shape == (96, 128, 4) and pf.done() and not pf.cancelled()
+    assert finished.wait(30) and stages[1] == ("final", (96, 128, 4))
+    s = pf.stats()
+    assert s["state"] == "done" and s["aa"] == 2 and s["grid"] == 64 and s["preview_grid"] == 16
+    assert s["preview_size"] == (32, 24) and s["preview_ms"] > 0 and s["refine_ms"] > 0
+    # The supersampled frame stays close to the plain render of the same camera.
+    ref = scn.render_rgba()
+    assert np.abs(final.astype(np.int16) - ref.astype(np.int16)).mean() < 4.0
+
+
+def test_refinement_without_aa_matches_render_rgba(make_scene):
+    scn = make_scene()
+    pf = scn.render_progressive(preview_scale=2, preview_grid=8, aa=1)
+    assert pf.preview.shape == (48, 64, 4)
+    np.testing.assert_array_equal(pf.result(timeout=30), scn.render_rgba())
+
+
+def hold_refiner(scn):
+    """Queue a refinement whose callback parks the refiner thread; set the returned event to
+    release it. Refinements queued meanwhile only start after the release."""
+    gate, parked = threading.Event(), threading.Event()
+
+    def park(stage, rgba):
+        if stage != "preview":
+            parked.set()
+            gate.wait(30)
+
+    scn.render_progressive(callback=park, aa=1)
+    assert parked.wait(30)
+    return gate
+
+
+def test_camera_change_and_cancel_drop_refinements(make_scene):
+    scn = make_scene(256, 192)
+    gate = hold_refiner(scn)
+    frames = [scn.render_progressive(aa=4) for _ in range(3)]
+    scn.set_camera_look_at((3, 2.5, -3), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    gate.set()
+    for f in frames:
+        assert f.result(timeout=30) is None and f.cancelled()
+        assert f.stats()["state"] == "cancelled" and f.stats()["refine_ms"] == 0.0
+    kept = scn.render_progressive(aa=1)
+    assert kept.result(timeout=30) is not None
+
+    gate = hold_refiner(scn)
+    queued = [scn.render_progressive(aa=4) for _ in range(3)]
+    assert queued[-1].cancel()
+    gate.set()
+    assert queued[-1].result(timeout=30) is None and queued[-1].cancelled()
+    assert all(f.result(timeout=30) is not None for f in queued[:-1])
+
+
+def test_content_change_drops_refinements(make_scene):
+    scn = make_scene()
+    gate = hold_refiner(scn)
+    pf = scn.render_progressive(aa=1)
+    scn.generate_height(128, 128, kind="ridged", seed=1)
+    gate.set()
+    assert pf.result(timeout=30) is None and pf.cancelled()
+    assert pf.stats()["error"] is None
+
+
+def test_result_async_and_validation(make_scene):
+    scn = make_scene()
+    pf = scn.render_progressive(aa=1)
+
+    async def main():
+        return await pf.result_async()
+
+    assert asyncio.run(main()).shape == (96, 128, 4)
+    # Awaiting an already finished refinement resolves immediately.
+    assert asyncio.run(main()).shape == (96, 128, 4)
+    with pytest.raises(ValueError):
+        scn.render_progressive(aa=0)
+    with pytest.raises(ValueError):
+        scn.render_progressive(preview_scale=0)
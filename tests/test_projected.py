@@ -0,0 +1,68 @@
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping projected grid tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    def make(w=128, h=96, grid=64):
+        return make_scene(w, h, grid=grid, colormap="terrain", seed=2, camera=True)
+    return make
+
+
+def diff(a, b):
+    return np.abs(a.astype(np.int16) - b.astype(np.int16)).mean()
+
+
+def test_projected_grid_close_to_dense_mesh(make_scene):
+    ref = make_scene(grid=512).render_rgba()
+    scn = make_scene(grid=64)
+    mesh = scn.render_rgba()
+    scn.set_projected_grid(cell=2)
+    img = scn.render_rgba()
+    assert img.shape == (96, 128, 4) and img.dtype == np.uint8
+    assert diff(img, ref) < 6.0
+    assert diff(img, mesh) < 8.0
+    scn.set_projected_grid(False)
+    np.testing.assert_array_equal(scn.render_rgba(), mesh)
+
+
+def test_vertex_count_independent_of_dem(make_scene):
+    scn = make_scene()
+    scn.set_projected_grid(cell=4, margin=0.1)
+    counts = []
+    for size in (32, 512):
+        scn.generate_height(size, size, kind="fbm", seed=3)
+        scn.render_rgba()
+        counts.append(scn.projected_grid_stats()["vertices"])
+    s = scn.projected_grid_stats()
+    assert counts == [33 * 25, 33 * 25]
+    assert s["enabled"] and s["grid"] == (33, 25) and s["cell"] == 4 and s["frames"] == 2
+    assert s["triangles"] == 32 * 24 * 2 and s["mesh_vertices"] == 64 * 64
+    scn.set_projected_grid(False)
+    assert not scn.projected_grid_stats()["enabled"]
+
+
+def test_horizon_view_keeps_the_sky_clear(make_scene):
+    scn = make_scene()
+    scn.set_camera_look_at((0, 0.6, 3), (0, 0.6, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    mesh = scn.render_rgba()
+    scn.set_projected_grid()
+    img = scn.render_rgba()
+    np.testing.assert_array_equal(img[0], mesh[0])
+    assert diff(img, mesh) < 10.0
+
+
+def test_validation(make_scene):
+    scn = make_scene()
+    with pytest.raises(ValueError):
+        scn.set_projected_grid(cell=0)
+    with pytest.raises(ValueError):
+        scn.set_projected_grid(margin=1.5)
@@ -0,0 +1,39 @@
+import pytest
+import numpy as np
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping push-constant tests.", allow_module_level=True)
+
+
+def test_render_views_matches_single_renders(make_scene, views):
+    scn = make_scene()
+    batch = scn.render_views_rgba(views(3))
+    assert batch.shape == (3, 48, 64, 4) and batch.dtype == np.uint8
+    scn.set_camera_look_at((3.0, 2.0, 0.0), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    np.testing.assert_allclose(batch[0].astype(int), scn.render_rgba().astype(int), atol=2)
+    assert not np.array_equal(batch[0], batch[1])
+
+
+def test_push_constant_and_ubo_paths_agree(make_scene, views, monkeypatch):
+    fast = make_scene()
+    monkeypatch.setenv("VF_NO_PUSH_CONSTANTS", "1")
+    slow = make_scene()
+    assert not slow.push_constants_enabled()
+    offs = np.array([[0.0, 0.0, 0.0], [1.0, 0.0, -1.0]], dtype=np.float32)
+    np.testing.assert_allclose(fast.render_views_rgba(views(2)).astype(int),
+                               slow.render_views_rgba(views(2)).astype(int), atol=2)
+    np.testing.assert_allclose(fast.render_instances_rgba(offs).astype(int),
+                               slow.render_instances_rgba(offs).astype(int), atol=2)
+
+
+def test_bad_shapes_rejected(make_scene):
+    scn = make_scene()
+    with pytest.raises(ValueError):
+        scn.render_views_rgba(np.zeros((2, 3, 3), dtype=np.float32))
+    with pytest.raises(ValueError):
+        scn.render_instances_rgba(np.zeros((2, 2), dtype=np.float32))
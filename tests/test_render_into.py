@@ -0,0 +1,69 @@
+import sys
+
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping render_views_into tests.", allow_module_level=True)
+
+
+@pytest.mark.parametrize("chunk", [1, 3, 16])
+def test_into_memmap_matches_batch(make_scene, views, tmp_path, chunk):
+    scn = make_scene()
+    V = views(7)
+    expected = scn.render_views_rgba(V)
+    out = np.lib.format.open_memmap(tmp_path / "frames.npy", mode="w+", dtype=np.uint8, shape=(7, 48, 64, 4))
+    assert scn.render_views_into(V, out, chunk=chunk) == 7
+    out.flush()
+    del out
+    np.testing.assert_array_equal(np.load(tmp_path / "frames.npy"), expected)
+
+
+def test_into_slice_of_larger_memmap(make_scene, views, tmp_path):
+    scn = make_scene()
+    V = views(6)
+    out = np.memmap(tmp_path / "frames.u8", mode="w+", dtype=np.uint8, shape=(10, 48, 64, 4))
+    scn.render_views_into(V, out[2:8])
+    np.testing.assert_array_equal(out[2:8], scn.render_views_rgba(V))
+    assert not out[:2].any() and not out[8:].any()
+
+
+@pytest.mark.skipif(not sys.platform.startswith(("linux", "darwin")), reason="POSIX shared memory")
+def test_into_shared_memory(make_scene, views):
+    from multiprocessing import shared_memory
+
+    scn = make_scene()
+    V = views(4)
+    shm = shared_memory.SharedMemory(create=True, size=4 * 48 * 64 * 4)
+    try:
+        scn.render_views_into(V, shm)
+        frames = np.ndarray((4, 48, 64, 4), dtype=np.uint8, buffer=shm.buf)
+        np.testing.assert_array_equal(frames, scn.render_views_rgba(V))
+        del frames
+    finally:
+        shm.close()
+        shm.unlink()
+
+
+def test_into_rejects_bad_targets(make_scene, views):
+    scn = make_scene()
+    V = views(2)
+    with pytest.raises(ValueError):
+        scn.render_views_into(V, np.zeros((3, 48, 64, 4), np.uint8))
+    with pytest.raises(ValueError):
+        scn.render_views_into(V, np.zeros((2, 64, 48, 4), np.uint8))
+    ro = np.zeros((2, 48, 64, 4), np.uint8)
+    ro.flags.writeable = False
+    with pytest.raises(ValueError):
+        scn.render_views_into(V, ro)
+    with pytest.raises(ValueError):
+        scn.render_views_into(V, np.zeros((2, 48, 64, 8), np.uint8)[..., :4])
+    with pytest.raises(TypeError):
+        scn.render_views_into(V, np.zeros((2, 48, 64, 4), np.float32))
+    with pytest.raises(ValueError):
+        scn.render_views_into(V, np.zeros((2, 48, 64, 4), np.uint8), chunk=0)
@@ -0,0 +1,51 @@
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping render stream tests.", allow_module_level=True)
+
+
+@pytest.mark.parametrize("depth", [1, 3, 16])
+def test_stream_matches_batch(make_scene, views, depth):
+    scn = make_scene()
+    V = views(6)
+    expected = scn.render_views_rgba(V)
+    stream = scn.render_stream(V, depth=depth)
+    assert len(stream) == 6
+    frames = list(stream)
+    assert len(frames) == 6
+    for got, want in zip(frames, expected):
+        assert got.shape == (48, 64, 4)
+        np.testing.assert_array_equal(got, want)
+    st = stream.stats()
+    assert st["yielded"] == 6 and st["in_flight"] == 0
+
+
+def test_stream_uses_bounded_ring(make_scene, views):
+    scn = make_scene()
+    stream = scn.render_stream(views(10), depth=2)
+    next(stream)
+    assert stream.stats()["in_flight"] == 2
+    for _ in stream:
+        pass
+    slots, in_use = scn.render_slot_stats()
+    assert in_use == 0 and slots <= 3
+
+
+def test_abandoned_stream_releases_slots(make_scene, views):
+    scn = make_scene()
+    stream = scn.render_stream(views(8), depth=4)
+    next(stream)
+    del stream
+    assert scn.render_slot_stats()[1] == 0
+
+
+def test_depth_validated(make_scene, views):
+    scn = make_scene()
+    with pytest.raises(ValueError):
+        scn.render_stream(views(2), depth=0)
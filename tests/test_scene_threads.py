@@ -0,0 +1,71 @@
+import threading
+
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping Scene threading tests.", allow_module_level=True)
+
+
+def view(i, n):
+    a = 2.0 * np.pi * i / n
+    m = vf.camera_look_at((3.0 * np.cos(a), 2.0, 3.0 * np.sin(a)), (0, 0, 0), (0, 1, 0))
+    return np.ascontiguousarray(np.asarray(m, dtype=np.float32)[None])
+
+
+def test_concurrent_renders_match_serial(make_scene):
+    scn = make_scene()
+    n = 4
+    views = [view(i, n) for i in range(n)]
+    serial = [scn.render_views_rgba(v)[0] for v in views]
+
+    out = [[] for _ in range(n)]
+    errors = []
+
+    def worker(i):
+        try:
+            for _ in range(5):
+                out[i].append(scn.render_views_rgba(views[i])[0])
+        except Exception as e:  # surfaced below; a thread exception would otherwise be lost
+            errors.append(e)
+
+    ts = [threading.Thread(target=worker, args=(i,)) for i in range(n)]
+    for t in ts:
+        t.start()
+    for t in ts:
+        t.join()
+    assert not errors
+    for i in range(n):
+        for img in out[i]:
+            np.testing.assert_array_equal(img, serial[i])
+    slots, in_use = scn.render_slot_stats()
+    assert 1 <= slots <= n and in_use == 0
+
+
+def test_setters_while_rendering(make_scene):
+    scn = make_scene()
+    stop = threading.Event()
+    errors = []
+
+    def render():
+        try:
+            while not stop.is_set():
+                assert scn.render_rgba().shape == (48, 64, 4)
+        except Exception as e:
+            errors.append(e)
+
+    t = threading.Thread(target=render)
+    t.start()
+    try:
+        for i in range(10):
+            scn.set_camera_look_at((3.0, 2.0, float(i)), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+            scn.set_features(["height_tex", "lut"] if i % 2 else ["lut"])
+    finally:
+        stop.set()
+        t.join()
+    assert not errors
@@ -0,0 +1,86 @@
+import functools
+
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping scheduler tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    # Only Scenes on one shared device can be merged into a submission.
+    return functools.partial(make_scene, shared_device=True)
+
+
+def test_results_match_direct_renders(make_scene, views):
+    a, b = make_scene(), make_scene()
+    b.set_camera_look_at((0.0, 4.0, 2.0), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+    V = views(5)
+    sched = vf.RenderScheduler(max_in_flight=2, max_frames_per_submit=2)
+    ta = sched.submit(a, V)
+    tb = sched.submit(b)
+    np.testing.assert_array_equal(ta.result(timeout=30), a.render_views_rgba(V))
+    np.testing.assert_array_equal(tb.result(timeout=30), b.render_rgba())
+    assert ta.done() and tb.done()
+    t = ta.timings()
+    assert t["chunks"] == 3  # 5 frames in chunks of 2
+    assert t["queue_ms"] >= 0.0 and t["exec_ms"] >= 0.0
+    with pytest.raises(RuntimeError):
+        ta.result()  # pixels are handed out once
+
+
+def test_compatible_jobs_share_submissions(make_scene):
+    scenes = [make_scene() for _ in range(4)]
+    sched = vf.RenderScheduler(max_in_flight=1, max_frames_per_submit=8)
+    tickets = [sched.submit(s) for s in scenes for _ in range(3)]
+    for t in tickets:
+        t.result(timeout=30)
+    st = sched.stats()
+    assert st["completed"] == len(tickets)
+    assert st["submissions"] < len(tickets)
+    assert st["jobs_per_submission"] > 1.0
+
+
+def test_private_scenes_are_never_merged(make_scene):
+    scenes = [make_scene(shared_device=False) for _ in range(3)]
+    sched = vf.RenderScheduler(max_in_flight=1, max_frames_per_submit=8)
+    tickets = [sched.submit(s) for s in scenes]
+    for s, t in zip(scenes, tickets):
+        np.testing.assert_array_equal(t.result(timeout=30), s.render_rgba())
+    st = sched.stats()
+    assert st["submissions"] == len(tickets) and st["jobs_per_submission"] == 1.0
+    assert st["failed"] == 0
+
+
+def test_interactive_preempts_bulk(make_scene, views):
+    bulk_scene, ui_scene = make_scene(), make_scene()
+    sched = vf.RenderScheduler(max_in_flight=1, max_frames_per_submit=1)
+    bulk = sched.submit(bulk_scene, views(32), priority=0)
+    ui = sched.submit(ui_scene, priority=10, deadline_ms=10_000)
+    ui.result(timeout=30)
+    # Pre-emption happens at chunk boundaries: the bulk job cannot have finished first.
+    assert not bulk.done()
+    bulk.result(timeout=60)
+    st = sched.stats()
+    assert set(st["by_priority"]) == {0, 10}
+    assert ui.timings()["deadline_missed"] is False
+
+
+def test_validation(make_scene):
+    with pytest.raises(ValueError):
+        vf.RenderScheduler(max_in_flight=0)
+    scn = make_scene()
+    sched = vf.RenderScheduler()
+    with pytest.raises(ValueError):
+        sched.submit(scn, deadline_ms=-1.0)
+    with pytest.raises(ValueError):
+        sched.submit(scn, np.zeros((0, 4, 4), np.float32))
+    sched.close()
+    with pytest.raises(RuntimeError):
+        sched.submit(scn)
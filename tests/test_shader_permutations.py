@@ -0,0 +1,53 @@
+import pytest
+import numpy as np
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping permutation tests.", allow_module_level=True)
+
+
+def test_default_features_match_legacy_shader(make_scene):
+    scn = make_scene()
+    assert [f for f in scn.features() if f != "PUSH_CONSTANTS"] == ["HEIGHT_TEX", "ANALYTIC_FALLBACK", "LUT"]
+    assert scn.pipeline_cache_stats()[0] == 1
+
+
+@pytest.mark.parametrize("features", [
+    ["height_tex"],
+    ["analytic_fallback"],
+    [],
+    ["lut", "normal_map", "shadows", "ao"],
+])
+def test_every_variant_renders(make_scene, features):
+    scn = make_scene()
+    scn.set_features(features)
+    img = scn.render_rgba()
+    assert img.shape == (48, 64, 4) and img.dtype == np.uint8
+
+
+def test_implied_height_texture_and_cache_reuse(make_scene):
+    scn = make_scene()
+    scn.set_features(["shadows"])
+    assert "HEIGHT_TEX" in scn.features()
+    scn.set_features(["height_tex", "analytic_fallback", "lut"])
+    scn.set_features(["SHADOWS", "height_tex"])
+    compiled, hits, _ = scn.pipeline_cache_stats()
+    assert compiled == 2 and hits >= 2
+
+
+def test_features_change_output(make_scene):
+    scn = make_scene()
+    scn.generate_height(64, 64, kind="ridged", seed=2)
+    a = scn.render_rgba()
+    scn.set_features(["height_tex", "lut", "normal_map", "shadows"])
+    assert not np.array_equal(a, scn.render_rgba())
+
+
+def test_unknown_feature_rejected(make_scene):
+    scn = make_scene()
+    with pytest.raises(ValueError):
+        scn.set_features(["bloom"])
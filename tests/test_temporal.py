@@ -0,0 +1,115 @@
+import functools
+import math
+
+import numpy as np
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping temporal tests.", allow_module_level=True)
+
+
+@pytest.fixture
+def make_scene(make_scene):
+    return functools.partial(make_scene, 96, 72, grid=64, colormap="terrain", seed=5)
+
+
+def look(scn, deg):
+    a = math.radians(deg)
+    scn.set_camera_look_at((3.5 * math.cos(a), 2.0, 3.5 * math.sin(a)), (0, 0, 0), (0, 1, 0), 45.0, 0.1, 100.0)
+
+
+def orbit(scn, angles):
+    frames = []
+    for deg in angles:
+        look(scn, deg)
+        frames.append(scn.render_rgba())
+    return frames
+
+
+def full_render(scn, deg):
+    # The first frame after (re-)enabling has no history and is rendered in full.
+    scn.set_temporal(False)
+    scn.set_temporal(True)
+    look(scn, deg)
+    return scn.render_rgba()
+
+
+ANGLES = [30.0 + 0.5 * i for i in range(6)]
+
+
+def test_small_moves_reuse_pixels_and_stay_close_to_full_renders(make_scene):
+    scn = make_scene()
+    scn.set_temporal(True, max_motion=0.1)
+    frames = orbit(scn, ANGLES)
+    s = scn.temporal_stats()
+    assert s["enabled"] and s["frames"] == len(ANGLES) and s["full_frames"] == 1
+    assert 0.15 < s["mean_reused_fraction"] and 0.0 < s["reused_fraction"] <= 1.0
+    assert 0.0 < s["motion"] <= 0.1
+    ref = full_render(scn, ANGLES[-1])
+    diff = np.abs(frames[-1].astype(np.int16) - ref.astype(np.int16)).max(axis=2)
+    # Reprojection snaps to whole pixels: a few edge texels may differ, the bulk must not.
+    assert (diff > 24).mean() < 0.05
+
+
+def test_slow_pan_reprojects_from_the_last_full_frame(make_scene):
+    scn = make_scene()
+    scn.set_temporal(True, max_motion=0.02)
+    angles = [30.0 + 0.05 * i for i in range(60)]
+    frames, ages = [], []
+    for deg in angles:
+        look(scn, deg)
+        frames.append(scn.render_rgba())
+        ages.append(scn.temporal_stats()["history_age"])
+    s = scn.temporal_stats()
+    # Each step is far below max_motion; the motion since the last full frame is not.
+    assert 1 < s["full_frames"] < len(angles) and ages.count(0) == s["full_frames"]
+    assert all(b in (0, a + 1) for a, b in zip(ages, ages[1:]))
+    assert not np.array_equal(frames[0], frames[-1])
+    ref = full_render(scn, angles[-1])
+    diff = np.abs(frames[-1].astype(np.int16) - ref.astype(np.int16)).max(axis=2)
+    assert (diff > 24).mean() < 0.05
+
+
+def test_temporal_frames_are_deterministic(make_scene):
+    a, b = make_scene(), make_scene()
+    for scn in (a, b):
+        scn.set_temporal(True)
+    for x, y in zip(orbit(a, ANGLES), orbit(b, ANGLES)):
+        np.testing.assert_array_equal(x, y)
+
+
+def test_large_motion_and_content_changes_render_in_full(make_scene):
+    scn = make_scene()
+    scn.set_temporal(True, max_motion=0.1)
+    orbit(scn, [0.0, 40.0])
+    s = scn.temporal_stats()
+    assert s["full_frames"] == 2 and s["reused_fraction"] == 0.0 and s["motion"] > 0.1
+    look(scn, 40.0)
+    scn.render_rgba()
+    assert scn.temporal_stats()["reused_fraction"] > 0.2
+    scn.set_sun(20.0, 90.0)                       # uniforms changed
+    scn.render_rgba()
+    assert scn.temporal_stats()["motion"] is None
+    scn.generate_height(128, 128, kind="ridged", seed=1)   # content changed
+    scn.render_rgba()
+    assert scn.temporal_stats()["full_frames"] == 4
+
+
+def test_stats_reset_and_disable(make_scene):
+    scn = make_scene()
+    assert scn.temporal_stats()["enabled"] is False
+    scn.set_temporal(True)
+    orbit(scn, ANGLES[:2])
+    scn.set_temporal(True, max_motion=0.05)
+    s = scn.temporal_stats()
+    assert s["frames"] == 0 and s["mean_reused_fraction"] == 0.0
+    scn.set_temporal(False)
+    assert scn.temporal_stats()["enabled"] is False
+    assert scn.render_rgba().shape == (72, 96, 4)
+    with pytest.raises(ValueError):
+        scn.set_temporal(True, depth_tolerance=0.0)
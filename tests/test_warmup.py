@@ -0,0 +1,72 @@
+import json
+import subprocess
+import sys
+
+import pytest
+
+try:
+    import _vulkan_forge as vf
+except ImportError:
+    try:
+        import vulkan_forge._vulkan_forge as vf
+    except ImportError:
+        pytest.skip("Extension module _vulkan_forge not built; skipping warmup tests.", allow_module_level=True)
+
+# Each check runs in a fresh interpreter: the warmed devices are process-wide singletons.
+SCRIPT = r"""
+import json, os, time
+os.environ["VF_WARMUP"] = "1"
+import vulkan_forge as vf
+st0 = vf.warmup_status()
+vf.warmup(block=True)
+st1 = vf.warmup_status()
+img = vf.Renderer(16, 16).render_triangle_rgba()
+cache = vf.Scene(16, 16, grid=8).pipeline_cache_stats()
+print(json.dumps({"st0": st0, "st1": st1, "shape": list(img.shape), "scene_cache": cache}))
+"""
+
+
+def test_env_warmup_starts_at_import_and_completes():
+    try:
+        out = subprocess.run([sys.executable, "-c", SCRIPT], check=True, capture_output=True, text=True, timeout=120)
+    except subprocess.CalledProcessError as e:
+        pytest.skip(f"GPU unavailable: {e.stderr[-200:]}")
+    rep = json.loads(out.stdout.strip().splitlines()[-1])
+    assert rep["st0"]["started"]
+    assert rep["st1"]["ready"] and rep["st1"]["error"] is None
+    assert rep["st1"]["device_ms"] is not None and rep["st1"]["total_ms"] >= rep["st1"]["device_ms"]
+    assert rep["shape"] == [16, 16, 4]
+    # The Scene adopts the warmed device and reuses its default pipeline.
+    assert rep["scene_cache"] == [1, 1, 0]
+
+
+CONCURRENT = r"""
+import json, threading
+import vulkan_forge as vf
+vf.warmup()
+states = []
+def wait():
+    vf.warmup(block=True)
+    states.append(vf.warmup_status()["ready"])
+ts = [threading.Thread(target=wait) for _ in range(4)]
+for t in ts: t.start()
+for t in ts: t.join()
+print(json.dumps(states))
+"""
+
+
+def test_block_waits_for_warmup_started_elsewhere():
+    try:
+        out = subprocess.run([sys.executable, "-c", CONCURRENT], check=True, capture_output=True, text=True, timeout=120)
+    except subprocess.CalledProcessError as e:
+        pytest.skip(f"GPU unavailable: {e.stderr[-200:]}")
+    assert json.loads(out.stdout.strip().splitlines()[-1]) == [True] * 4
+
+
+def test_warmup_is_idempotent_in_process():
+    try:
+        vf.warmup(block=True)
+        vf.warmup(block=True)
+    except RuntimeError as e:
+        pytest.skip(f"GPU unavailable: {e}")
+    assert vf.warmup_status()["ready"]